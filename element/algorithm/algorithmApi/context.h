@@ -20,6 +20,7 @@
 #include "common/bmnn_utils.h"
 #include "common/common_defs.h"
 #include "common/object_metadata.h"
+#include "common/tpu_kernel_module.h"
 
 namespace sophon_stream {
 namespace element {
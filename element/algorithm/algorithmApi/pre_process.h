@@ -10,6 +10,7 @@
 #ifndef SOPHON_STREAM_ELEMENT_ALGORITHMAPI_PREPROCESS_H_
 #define SOPHON_STREAM_ELEMENT_ALGORITHMAPI_PREPROCESS_H_
 
+#include "common/batch_tensors.h"
 #include "context.h"
 
 namespace sophon_stream {
@@ -70,6 +71,54 @@ class PreProcess {
       }
     }
   }
+
+  /**
+   * @brief max_batch > 1时，先从网络的显存池取一块连续的batch输入，
+   * 第j个目标的输入tensor是其中第j个槽位的视图；预处理用acquireInputMem
+   * 把结果直接写进槽位，推理时mergeInputDeviceMem不再拷贝
+   * @brief 槽位显存归batch所有，目标被预处理换成自己申请的显存时仍由目标释放，
+   * 见common::stageBatchInputs
+   */
+  template <typename T, typename U = Context,
+            typename std::enable_if<std::is_base_of<U, T>::value, int>::type* =
+                nullptr>
+  void initBatchTensors(std::shared_ptr<T> context,
+                        common::ObjectMetadatas& objectMetadatas) {
+    if (context->max_batch <= 1 ||
+        objectMetadatas.size() > static_cast<std::size_t>(context->max_batch)) {
+      initTensors(context, objectMetadatas);
+      return;
+    }
+
+    std::vector<common::BatchTensorLayout> layouts(context->input_num);
+    for (int i = 0; i < context->input_num; ++i) {
+      layouts[i].dtype = context->bmNetwork->m_netinfo->input_dtypes[i];
+      layouts[i].shape =
+          context->bmNetwork->m_netinfo->stages[0].input_shapes[i];
+      // 与mergeInputDeviceMem的大小一致
+      int input_bytes = context->max_batch * layouts[i].shape.dims[1] *
+                        context->net_h * context->net_w;
+      if (BM_FLOAT32 == context->bmNetwork->m_netinfo->input_dtypes[0])
+        input_bytes *= 4;
+      layouts[i].bytes = input_bytes;
+    }
+    common::stageBatchInputs(context->bmNetwork->tensorPool(), context->handle,
+                             layouts, context->max_batch, objectMetadatas);
+  }
+
+  /**
+   * @brief 取预处理结果的显存：目标有batch槽位且放得下时直接用槽位，
+   * 否则单独申请
+   * @return bm_malloc_device_byte_heap的返回值，使用槽位时为BM_SUCCESS
+   */
+  template <typename T, typename U = Context,
+            typename std::enable_if<std::is_base_of<U, T>::value, int>::type* =
+                nullptr>
+  bm_status_t acquireInputMem(std::shared_ptr<T> context,
+                              std::shared_ptr<common::ObjectMetadata>& obj,
+                              int size_byte, bm_device_mem_t* mem) {
+    return common::acquireSlotOrAlloc(*obj->mInputBMtensors, size_byte, mem);
+  }
 };
 }  // namespace element
 }  // namespace sophon_stream
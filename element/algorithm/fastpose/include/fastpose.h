@@ -65,6 +65,8 @@ class Fastpose : public ::sophon_stream::framework::Element {
    */
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   /**
    * @brief 从json文件读取的配置项
    */
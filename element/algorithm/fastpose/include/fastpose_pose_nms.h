@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_FASTPOSE_POSE_NMS_H_
+#define SOPHON_STREAM_ELEMENT_FASTPOSE_POSE_NMS_H_
+
+#include <memory>
+#include <vector>
+
+#include "common/detected_object_metadata.h"
+#include "common/posed_object_metadata.h"
+
+namespace sophon_stream {
+namespace element {
+namespace fastpose {
+
+struct PoseNMSParams {
+  float delta1;
+  float mu;
+  float delta2;
+  float gamma;
+  float scoreThreds;
+  float matchThreds;
+  float alpha;
+  float face_factor;
+  float hand_factor;
+  float hand_weight_score;
+  float face_weight_score;
+  float hand_weight_dist;
+  float face_weight_dist;
+};
+
+/**
+ * @brief 姿态NMS，只依赖host内存，不依赖opencv和bmcv
+ * @param params NMS参数
+ * @param det_data 每个姿态对应的检测框，用于计算参考距离
+ * @param num_joints 关键点个数，133或136时按全身关键点处理
+ * @param area_thresh 合并后姿态外接框的最小面积
+ * @param body_keypoints 每个姿态的关键点，被保留的姿态会被合并后的结果覆盖
+ * @param pick_ids 输出保留的姿态序号
+ */
+void poseNMS(
+    const PoseNMSParams& params,
+    std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
+    int num_samples, int num_joints, float area_thresh,
+    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
+    std::vector<int>& pick_ids);
+
+}  // namespace fastpose
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_FASTPOSE_POSE_NMS_H_
@@ -15,6 +15,7 @@
 
 #include "algorithmApi/post_process.h"
 #include "fastpose_context.h"
+#include "fastpose_pose_nms.h"
 
 using namespace sophon_stream::common;
 
@@ -22,22 +23,6 @@ namespace sophon_stream {
 namespace element {
 namespace fastpose {
 
-struct PoseNMSParams {
-  float delta1;
-  float mu;
-  float delta2;
-  float gamma;
-  float scoreThreds;
-  float matchThreds;
-  float alpha;
-  float face_factor;
-  float hand_factor;
-  float hand_weight_score;
-  float face_weight_score;
-  float hand_weight_dist;
-  float face_weight_dist;
-};
-
 class FastposePostProcess : public ::sophon_stream::element::PostProcess {
  public:
   void init(std::shared_ptr<FastposeContext> context);
@@ -65,30 +50,6 @@ class FastposePostProcess : public ::sophon_stream::element::PostProcess {
       int num_samples, int num_joints, float areaThres,
       std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
       std::vector<int>& pick_ids);
-  void poseNMSBody(
-      std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
-      int num_samples, int num_joints, float areaThres,
-      std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-      std::vector<int>& pick_ids);
-  void getParametricDistance(
-      std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-      std::vector<float>& dist, std::vector<int>& dist_indx, int pick_id,
-      int num_joints, bool use_dist_mask, float* final_dist);
-  void PCKMatch(std::vector<float>& dist, int num_joints, float ref_dist,
-                int* num_match_keypoints);
-  void PCKMatchFullBody(
-      std::vector<float>& dist,
-      std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-      int pick_id, int num_joints, float ref_dist, int* num_match_keypoints);
-  void pMergeFast(
-      std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-      std::vector<int>& merge_ids, std::vector<float>& dist,
-      std::vector<int>& dist_indx, int pick_id, int num_joints, float ref_dist);
-  void poseNMSFullBody(
-      std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
-      int num_samples, int num_joints, float areaThres,
-      std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-      std::vector<int>& pick_ids);
   void getKeyPoints(
       std::vector<std::shared_ptr<BMNNTensor>> outputTensors,
       std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
@@ -37,10 +37,11 @@ common::ErrorCode Fastpose::initContext(const std::string& json) {
       mContext->heatmap_loss = HeatmapLossType::MSELoss;
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(mContext->deviceId);
     mContext->handle = handle->handle();
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
+    mContext->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
     mContext->bmNetwork = mContext->bmContext->network(0);
 
     // 2. get input
@@ -193,7 +194,8 @@ common::ErrorCode Fastpose::doWork(int dataPipeId) {
     int outDataPipeId =
         getSinkElementFlag()
             ? 0
-            : (channel_id_internal % getOutputConnectorCapacity(outputPort));
+            : getOutputDataPipeId(outputPort, channel_id_internal,
+                                  objectMetadata->mFrame->mEndOfStream);
     errorCode = pushOutputData(outputPort, outDataPipeId,
                                std::static_pointer_cast<void>(objectMetadata));
     if (common::ErrorCode::SUCCESS != errorCode) {
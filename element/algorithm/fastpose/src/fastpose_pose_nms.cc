@@ -0,0 +1,343 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "fastpose_pose_nms.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace sophon_stream {
+namespace element {
+namespace fastpose {
+
+namespace {
+
+/**
+ * @brief 姿态间可能互相抑制的最大关键点距离，外接框间距超过该值的姿态对不用计算
+ */
+float getSuppressRadius(const PoseNMSParams& params, int num_joints,
+                        bool full_body) {
+  // 所有关键点距离都大于半径r时：PCK匹配要求距离不超过min(ref_dist, 7)乘以
+  // 部位系数，得分项要求距离不超过1，只剩下mu * exp(-d / (delta2 * 系数))项，
+  // 其总和不超过gamma时该姿态不会被抑制
+  float factor = 1.f, weight = num_joints;
+  if (full_body) {
+    factor = std::max({1.f, params.face_factor, params.hand_factor});
+    weight = 1.f + params.face_weight_dist + params.hand_weight_dist;
+  }
+  float radius = std::max(7.f * factor, 1.f);
+  float max_point_dist = params.mu * weight;
+  if (max_point_dist > params.gamma)
+    radius = std::max(radius, params.delta2 * factor *
+                                  std::log(max_point_dist / params.gamma));
+  // 留出余量，避免浮点误差让边界上的姿态被误排除
+  return radius * 1.01f + 1.f;
+}
+
+void getParametricDistance(
+    const PoseNMSParams& params,
+    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
+    std::vector<float>& dist, std::vector<int>& dist_indx, int pick_id,
+    int num_joints, bool use_dist_mask, float* final_dist) {
+  for (int i = 0; i < dist.size(); i++) {
+    int joint_idx = i % num_joints;
+    if (joint_idx == 0) final_dist[i / num_joints] = 0;
+
+    bool mask = dist[i] <= 1;
+    bool dist_mask;
+    if (use_dist_mask) {
+      dist_mask = body_keypoints[dist_indx[i] / num_joints]
+                      ->scores[dist_indx[i] % num_joints] < params.scoreThreds;
+      mask &= dist_mask;
+    }
+
+    float score_dist = 0;
+    if (mask)
+      score_dist =
+          tanh(body_keypoints[pick_id]->scores[joint_idx] / params.delta1) *
+          tanh(body_keypoints[dist_indx[i] / num_joints]
+                   ->scores[dist_indx[i] % num_joints] /
+               params.delta1);
+
+    if (use_dist_mask) {
+      float point_dist;
+      if (joint_idx < num_joints - 110) {
+        point_dist = exp((-1) * dist[i] / params.delta2);
+        final_dist[i / num_joints] +=
+            ((dist_mask ? score_dist : (score_dist + params.mu * point_dist)) /
+             (num_joints - 110));
+      } else if (joint_idx < num_joints - 42) {
+        point_dist =
+            exp((-1) * dist[i] / (params.delta2 * params.face_factor));
+        final_dist[i / num_joints] +=
+            ((dist_mask ? score_dist * params.face_weight_score
+                        : (score_dist * params.face_weight_score +
+                           params.mu * point_dist * params.face_weight_dist)) /
+             68);
+      } else {
+        point_dist =
+            exp((-1) * dist[i] / (params.delta2 * params.hand_factor));
+        final_dist[i / num_joints] +=
+            ((dist_mask ? score_dist * params.hand_weight_score
+                        : (score_dist * params.hand_weight_score +
+                           params.mu * point_dist * params.hand_weight_dist)) /
+             42);
+      }
+    } else {
+      float point_dist = exp((-1) * dist[i] / params.delta2);
+      final_dist[i / num_joints] += (score_dist + params.mu * point_dist);
+    }
+  }
+}
+
+void PCKMatch(std::vector<float>& dist, int num_joints, float ref_dist,
+              int* num_match_keypoints) {
+  ref_dist = std::min(ref_dist, 7.f);
+  for (int i = 0; i < dist.size(); i++) {
+    int joint_idx = i % num_joints;
+    if (joint_idx == 0) num_match_keypoints[i / num_joints] = 0;
+
+    if (dist[i] / ref_dist <= 1) num_match_keypoints[i / num_joints] += 1;
+  }
+}
+
+void PCKMatchFullBody(
+    const PoseNMSParams& params, std::vector<float>& dist,
+    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
+    int pick_id, int num_joints, float ref_dist, int* num_match_keypoints) {
+  int mask_num = 0;
+  int valid_num = dist.size() / num_joints;
+  for (int j = 0; j < num_joints; j++)
+    if (body_keypoints[pick_id]->scores[j] > params.scoreThreds / 2)
+      mask_num++;
+  if (mask_num * 2 * valid_num < 2) {
+    for (int i = 0; i < valid_num; i++) num_match_keypoints[i] = 0;
+    return;
+  }
+
+  int add_num = 1 / mask_num / 2 * num_joints;
+  ref_dist = std::min(ref_dist, 7.f);
+  for (int i = 0; i < dist.size(); i++) {
+    int joint_idx = i % num_joints;
+    if (joint_idx == 0) num_match_keypoints[i / num_joints] = 0;
+
+    if (joint_idx < 26 && dist[i] / ref_dist <= 1)
+      num_match_keypoints[i / num_joints] += add_num;
+    else if (26 <= joint_idx && joint_idx < 94 &&
+             dist[i] / ref_dist <= params.face_factor)
+      num_match_keypoints[i / num_joints] += add_num;
+    else if (94 <= joint_idx && dist[i] / ref_dist <= params.hand_factor)
+      num_match_keypoints[i / num_joints] += add_num;
+  }
+}
+
+void pMergeFast(
+    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
+    std::vector<int>& merge_ids, std::vector<float>& dist,
+    std::vector<int>& dist_indx, int pick_id, int num_joints, float ref_dist) {
+  ref_dist = std::min(ref_dist, 15.f);
+  float* normed_scores = new float[merge_ids.size() * num_joints];
+  float* sum_score = new float[num_joints];
+  for (int j = 0; j < num_joints; j++) sum_score[j] = 0;
+  for (int i = 0; i < merge_ids.size(); i++) {
+    for (int j = 0; j < num_joints; j++) {
+      if (dist[merge_ids[i] * num_joints + j] <= ref_dist) {
+        int offset = dist_indx[merge_ids[i] * num_joints + j];
+        normed_scores[i * num_joints + j] =
+            body_keypoints[offset / num_joints]->scores[offset % num_joints];
+        sum_score[j] += normed_scores[i * num_joints + j];
+      } else
+        normed_scores[i * num_joints + j] = 0;
+    }
+  }
+
+  for (int i = 0; i < merge_ids.size(); i++) {
+    for (int j = 0; j < num_joints; j++) {
+      normed_scores[i * num_joints + j] /= sum_score[j];
+    }
+  }
+
+  for (int j = 0; j < num_joints; j++) {
+    float final_pose1 = 0, final_pose2 = 0, final_score = 0;
+    for (int i = 0; i < merge_ids.size(); i++) {
+      final_pose1 +=
+          (body_keypoints[dist_indx[merge_ids[i] * num_joints + j] / num_joints]
+               ->keypoints[j * 2] *
+           normed_scores[i * num_joints + j]);
+      final_pose2 +=
+          (body_keypoints[dist_indx[merge_ids[i] * num_joints + j] / num_joints]
+               ->keypoints[j * 2 + 1] *
+           normed_scores[i * num_joints + j]);
+      final_score += (pow(normed_scores[i * num_joints + j], 2) * sum_score[j]);
+    }
+    body_keypoints[pick_id]->keypoints[j * 2] = final_pose1;
+    body_keypoints[pick_id]->keypoints[j * 2 + 1] = final_pose2;
+    body_keypoints[pick_id]->scores[j] = final_score;
+  }
+  delete[] normed_scores;
+  delete[] sum_score;
+}
+
+}  // namespace
+
+void poseNMS(
+    const PoseNMSParams& params,
+    std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
+    int num_samples, int num_joints, float area_thresh,
+    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
+    std::vector<int>& pick_ids) {
+  bool full_body = num_joints == 136 || num_joints == 133;
+  float* ref_dists = new float[num_samples];
+  float* human_scores = new float[num_samples];
+  bool* mask = new bool[num_samples];
+  int num_valid_samples = num_samples;
+  // 关键点拷贝成连续数组，并记录每个姿态关键点的外接框
+  std::vector<float> xs(num_samples * num_joints), ys(num_samples * num_joints);
+  std::vector<float> boxes(num_samples * 4);
+  auto flatten = [&](int i) {
+    float* x = xs.data() + i * num_joints;
+    float* y = ys.data() + i * num_joints;
+    float* box = boxes.data() + i * 4;
+    box[0] = box[2] = body_keypoints[i]->keypoints[0];
+    box[1] = box[3] = body_keypoints[i]->keypoints[1];
+    for (int j = 0; j < num_joints; j++) {
+      x[j] = body_keypoints[i]->keypoints[j * 2];
+      y[j] = body_keypoints[i]->keypoints[j * 2 + 1];
+      box[0] = std::min(box[0], x[j]);
+      box[1] = std::min(box[1], y[j]);
+      box[2] = std::max(box[2], x[j]);
+      box[3] = std::max(box[3], y[j]);
+    }
+  };
+  for (int i = 0; i < num_samples; i++) {
+    float width = det_data[i]->mBox.mWidth, height = det_data[i]->mBox.mHeight;
+    ref_dists[i] = params.alpha * std::max(width, height);
+    float joints_score_sum = 0;
+    for (int j = 0; j < num_joints; j++) {
+      joints_score_sum += body_keypoints[i]->scores[j];
+    }
+    human_scores[i] = joints_score_sum / num_joints;
+    mask[i] = true;
+    flatten(i);
+  }
+
+  const float radius = getSuppressRadius(params, num_joints, full_body);
+  std::vector<float> dist;
+  std::vector<int> dist_indx;
+  std::vector<float> final_dist;
+  std::vector<int> num_match_keypoints;
+  while (num_valid_samples > 0) {
+    int pick_id;
+    for (int i = 0; i < num_samples; i++) {
+      if (mask[i]) {
+        pick_id = i;
+        break;
+      }
+    }
+    int relative_pick_id = 0;
+    for (int i = pick_id + 1; i < num_samples; i++) {
+      if (mask[i] && human_scores[i] > human_scores[pick_id]) {
+        pick_id = i;
+      }
+    }
+
+    // find overlap index
+    // 外接框与pick相距超过radius的姿态不可能被pick抑制，不计算关键点距离
+    dist.clear();
+    dist_indx.clear();
+    const float* pick_x = xs.data() + pick_id * num_joints;
+    const float* pick_y = ys.data() + pick_id * num_joints;
+    const float* pick_box = boxes.data() + pick_id * 4;
+    for (int i = 0; i < num_samples; i++) {
+      if (i == pick_id) relative_pick_id = dist.size() / num_joints;
+      if (!mask[i]) continue;
+      const float* box = boxes.data() + i * 4;
+      float gap_x = std::max(box[0] - pick_box[2], pick_box[0] - box[2]);
+      float gap_y = std::max(box[1] - pick_box[3], pick_box[1] - box[3]);
+      if (gap_x > radius || gap_y > radius) continue;
+
+      const float* x = xs.data() + i * num_joints;
+      const float* y = ys.data() + i * num_joints;
+      int offset = dist.size();
+      dist.resize(offset + num_joints);
+      dist_indx.resize(offset + num_joints);
+      float* d = dist.data() + offset;
+      for (int j = 0; j < num_joints; j++) {
+        float dx = x[j] - pick_x[j];
+        float dy = y[j] - pick_y[j];
+        d[j] = std::sqrt(double(dx) * dx + double(dy) * dy);
+        dist_indx[offset + j] = i * num_joints + j;
+      }
+    }
+
+    int keep_num = dist.size() / num_joints;
+    final_dist.resize(keep_num);
+    num_match_keypoints.resize(keep_num);
+    getParametricDistance(params, body_keypoints, dist, dist_indx, pick_id, num_joints,
+                          full_body, final_dist.data());
+    if (full_body)
+      PCKMatchFullBody(params, dist, body_keypoints, pick_id, num_joints,
+                       ref_dists[pick_id], num_match_keypoints.data());
+    else
+      PCKMatch(dist, num_joints, ref_dists[pick_id],
+               num_match_keypoints.data());
+    std::vector<int> delete_ids;
+    for (int i = 0; i < keep_num; i++) {
+      if (final_dist[i] > params.gamma ||
+          num_match_keypoints[i] >= params.matchThreds) {
+        int delete_id = dist_indx[i * num_joints] / num_joints;
+        delete_ids.push_back(i);
+        mask[delete_id] = false;
+        num_valid_samples -= 1;
+      }
+    }
+    if (delete_ids.size() == 0) {
+      delete_ids.push_back(relative_pick_id);
+      mask[pick_id] = false;
+      num_valid_samples -= 1;
+    }
+
+    float pick_max_score = 0;
+    for (int j = 0; j < num_joints; j++)
+      if (body_keypoints[pick_id]->scores[j] > pick_max_score)
+        pick_max_score = body_keypoints[pick_id]->scores[j];
+    if (pick_max_score < params.scoreThreds) continue;
+    pMergeFast(body_keypoints, delete_ids, dist, dist_indx, pick_id, num_joints,
+               ref_dists[pick_id]);
+    // pick没有抑制自己时会在下一轮再次被选中，需要用合并后的关键点
+    if (mask[pick_id]) flatten(pick_id);
+    float merge_max_score = 0;
+    for (int j = 0; j < num_joints; j++)
+      if (body_keypoints[pick_id]->scores[j] > merge_max_score)
+        merge_max_score = body_keypoints[pick_id]->scores[j];
+    if (merge_max_score < params.scoreThreds) continue;
+    float xmax = body_keypoints[pick_id]->keypoints[0];
+    float xmin = xmax;
+    float ymax = body_keypoints[pick_id]->keypoints[1];
+    float ymin = ymax;
+    for (int j = 1; j < num_joints; j++) {
+      float cur_x = body_keypoints[pick_id]->keypoints[j * 2];
+      float cur_y = body_keypoints[pick_id]->keypoints[j * 2 + 1];
+      if (cur_x > xmax) xmax = cur_x;
+      if (cur_x < xmin) xmin = cur_x;
+      if (cur_y > ymax) ymax = cur_y;
+      if (cur_y < ymin) ymin = cur_y;
+    }
+    if (1.5 * 1.5 * (xmax - xmin) * (ymax - ymin) < area_thresh) continue;
+    pick_ids.push_back(pick_id);
+  }
+
+  delete[] ref_dists;
+  delete[] human_scores;
+  delete[] mask;
+}
+
+}  // namespace fastpose
+}  // namespace element
+}  // namespace sophon_stream
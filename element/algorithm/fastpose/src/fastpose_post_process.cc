@@ -9,6 +9,9 @@
 
 #include "fastpose_post_process.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace sophon_stream {
 namespace element {
 namespace fastpose {
@@ -155,386 +158,8 @@ void FastposePostProcess::poseNMS(
     int num_samples, int num_joints, float area_thresh,
     std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
     std::vector<int>& pick_ids) {
-  if (num_joints == 136 || num_joints == 133)
-    poseNMSFullBody(det_data, num_samples, num_joints, area_thresh,
-                    body_keypoints, pick_ids);
-  else
-    poseNMSBody(det_data, num_samples, num_joints, area_thresh, body_keypoints,
-                pick_ids);
-}
-
-void FastposePostProcess::poseNMSBody(
-    std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
-    int num_samples, int num_joints, float area_thresh,
-    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-    std::vector<int>& pick_ids) {
-  float* ref_dists = new float[num_samples];
-  float* human_scores = new float[num_samples];
-  bool* mask = new bool[num_samples];
-  int num_valid_samples = num_samples;
-  for (int i = 0; i < num_samples; i++) {
-    float width = det_data[i]->mBox.mWidth, height = det_data[i]->mBox.mHeight;
-    ref_dists[i] = pose_nms_params->alpha * std::max(width, height);
-    float joints_score_sum = 0;
-    for (int j = 0; j < num_joints; j++) {
-      joints_score_sum += body_keypoints[i]->scores[j];
-    }
-    human_scores[i] = joints_score_sum / num_joints;
-    mask[i] = true;
-  }
-
-  while (num_valid_samples > 0) {
-    int pick_id;
-    for (int i = 0; i < num_samples; i++) {
-      if (mask[i]) {
-        pick_id = i;
-        break;
-      }
-    }
-    int relative_pick_id = 0;
-    for (int i = pick_id + 1; i < num_samples; i++) {
-      if (mask[i] && human_scores[i] > human_scores[pick_id]) {
-        pick_id = i;
-      }
-    }
-
-    // find overlap index
-    std::vector<float> dist;
-    std::vector<int> dist_indx;
-    for (int i = 0; i < num_samples; i++) {
-      if (i == pick_id) relative_pick_id = dist.size() / num_joints;
-      if (mask[i]) {
-        for (int j = 0; j < num_joints; j++) {
-          dist.push_back(
-              sqrt(pow(body_keypoints[i]->keypoints[j * 2] -
-                           body_keypoints[pick_id]->keypoints[j * 2],
-                       2) +
-                   pow(body_keypoints[i]->keypoints[j * 2 + 1] -
-                           body_keypoints[pick_id]->keypoints[j * 2 + 1],
-                       2)));
-          dist_indx.push_back(i * num_joints + j);
-        }
-      }
-    }
-
-    int keep_num = dist.size() / num_joints;
-    float* final_dist = new float[keep_num];
-    int* num_match_keypoints = new int[keep_num];
-    getParametricDistance(body_keypoints, dist, dist_indx, pick_id, num_joints,
-                          false, final_dist);
-    PCKMatch(dist, num_joints, ref_dists[pick_id], num_match_keypoints);
-    std::vector<int> delete_ids;
-    for (int i = 0; i < keep_num; i++) {
-      if (final_dist[i] > pose_nms_params->gamma ||
-          num_match_keypoints[i] >= pose_nms_params->matchThreds) {
-        int delete_id = dist_indx[i * num_joints] / num_joints;
-        delete_ids.push_back(i);
-        mask[delete_id] = false;
-        num_valid_samples -= 1;
-      }
-    }
-    delete[] final_dist;
-    delete[] num_match_keypoints;
-    if (delete_ids.size() == 0) {
-      delete_ids.push_back(relative_pick_id);
-      mask[pick_id] = false;
-      num_valid_samples -= 1;
-    }
-
-    float pick_max_score = 0;
-    for (int j = 0; j < num_joints; j++)
-      if (body_keypoints[pick_id]->scores[j] > pick_max_score)
-        pick_max_score = body_keypoints[pick_id]->scores[j];
-    if (pick_max_score < pose_nms_params->scoreThreds) continue;
-    pMergeFast(body_keypoints, delete_ids, dist, dist_indx, pick_id, num_joints,
-               ref_dists[pick_id]);
-    float merge_max_score = 0;
-    for (int j = 0; j < num_joints; j++)
-      if (body_keypoints[pick_id]->scores[j] > merge_max_score)
-        merge_max_score = body_keypoints[pick_id]->scores[j];
-    if (merge_max_score < pose_nms_params->scoreThreds) continue;
-    float xmax = body_keypoints[pick_id]->keypoints[0];
-    float xmin = xmax;
-    float ymax = body_keypoints[pick_id]->keypoints[1];
-    float ymin = ymax;
-    for (int j = 1; j < num_joints; j++) {
-      float cur_x = body_keypoints[pick_id]->keypoints[j * 2];
-      float cur_y = body_keypoints[pick_id]->keypoints[j * 2 + 1];
-      if (cur_x > xmax) xmax = cur_x;
-      if (cur_x < xmin) xmin = cur_x;
-      if (cur_y > ymax) ymax = cur_y;
-      if (cur_y < ymin) ymin = cur_y;
-    }
-    if (1.5 * 1.5 * (xmax - xmin) * (ymax - ymin) < area_thresh) continue;
-    pick_ids.push_back(pick_id);
-  }
-
-  delete[] ref_dists;
-  delete[] human_scores;
-  delete[] mask;
-}
-
-void FastposePostProcess::getParametricDistance(
-    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-    std::vector<float>& dist, std::vector<int>& dist_indx, int pick_id,
-    int num_joints, bool use_dist_mask, float* final_dist) {
-  for (int i = 0; i < dist.size(); i++) {
-    int joint_idx = i % num_joints;
-    if (joint_idx == 0) final_dist[i / num_joints] = 0;
-
-    bool mask = dist[i] <= 1;
-    bool dist_mask;
-    if (use_dist_mask) {
-      dist_mask = body_keypoints[dist_indx[i] / num_joints]
-                      ->scores[dist_indx[i] % num_joints] <
-                  pose_nms_params->scoreThreds;
-      mask &= dist_mask;
-    }
-
-    float score_dist = 0;
-    if (mask)
-      score_dist = tanh(body_keypoints[pick_id]->scores[joint_idx] /
-                        pose_nms_params->delta1) *
-                   tanh(body_keypoints[dist_indx[i] / num_joints]
-                            ->scores[dist_indx[i] % num_joints] /
-                        pose_nms_params->delta1);
-
-    if (use_dist_mask) {
-      float point_dist;
-      if (joint_idx < num_joints - 110) {
-        point_dist = exp((-1) * dist[i] / pose_nms_params->delta2);
-        final_dist[i / num_joints] +=
-            ((dist_mask ? score_dist
-                        : (score_dist + pose_nms_params->mu * point_dist)) /
-             (num_joints - 110));
-      } else if (joint_idx < num_joints - 42) {
-        point_dist =
-            exp((-1) * dist[i] /
-                (pose_nms_params->delta2 * pose_nms_params->face_factor));
-        final_dist[i / num_joints] +=
-            ((dist_mask ? score_dist * pose_nms_params->face_weight_score
-                        : (score_dist * pose_nms_params->face_weight_score +
-                           pose_nms_params->mu * point_dist *
-                               pose_nms_params->face_weight_dist)) /
-             68);
-      } else {
-        point_dist =
-            exp((-1) * dist[i] /
-                (pose_nms_params->delta2 * pose_nms_params->hand_factor));
-        final_dist[i / num_joints] +=
-            ((dist_mask ? score_dist * pose_nms_params->hand_weight_score
-                        : (score_dist * pose_nms_params->hand_weight_score +
-                           pose_nms_params->mu * point_dist *
-                               pose_nms_params->hand_weight_dist)) /
-             42);
-      }
-    } else {
-      float point_dist = exp((-1) * dist[i] / pose_nms_params->delta2);
-      final_dist[i / num_joints] +=
-          (score_dist + pose_nms_params->mu * point_dist);
-    }
-  }
-}
-
-void FastposePostProcess::PCKMatch(std::vector<float>& dist, int num_joints,
-                                   float ref_dist, int* num_match_keypoints) {
-  ref_dist = std::min(ref_dist, 7.f);
-  for (int i = 0; i < dist.size(); i++) {
-    int joint_idx = i % num_joints;
-    if (joint_idx == 0) num_match_keypoints[i / num_joints] = 0;
-
-    if (dist[i] / ref_dist <= 1) num_match_keypoints[i / num_joints] += 1;
-  }
-}
-
-void FastposePostProcess::PCKMatchFullBody(
-    std::vector<float>& dist,
-    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-    int pick_id, int num_joints, float ref_dist, int* num_match_keypoints) {
-  int mask_num = 0;
-  int valid_num = dist.size() / num_joints;
-  for (int j = 0; j < num_joints; j++)
-    if (body_keypoints[pick_id]->scores[j] > pose_nms_params->scoreThreds / 2)
-      mask_num++;
-  if (mask_num * 2 * valid_num < 2) {
-    for (int i = 0; i < valid_num; i++) num_match_keypoints[i] = 0;
-    return;
-  }
-
-  int add_num = 1 / mask_num / 2 * num_joints;
-  ref_dist = std::min(ref_dist, 7.f);
-  for (int i = 0; i < dist.size(); i++) {
-    int joint_idx = i % num_joints;
-    if (joint_idx == 0) num_match_keypoints[i / num_joints] = 0;
-
-    if (joint_idx < 26 && dist[i] / ref_dist <= 1)
-      num_match_keypoints[i / num_joints] += add_num;
-    else if (26 <= joint_idx && joint_idx < 94 &&
-             dist[i] / ref_dist <= pose_nms_params->face_factor)
-      num_match_keypoints[i / num_joints] += add_num;
-    else if (94 <= joint_idx &&
-             dist[i] / ref_dist <= pose_nms_params->hand_factor)
-      num_match_keypoints[i / num_joints] += add_num;
-  }
-}
-
-void FastposePostProcess::pMergeFast(
-    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-    std::vector<int>& merge_ids, std::vector<float>& dist,
-    std::vector<int>& dist_indx, int pick_id, int num_joints, float ref_dist) {
-  ref_dist = std::min(ref_dist, 15.f);
-  float* normed_scores = new float[merge_ids.size() * num_joints];
-  float* sum_score = new float[num_joints];
-  for (int j = 0; j < num_joints; j++) sum_score[j] = 0;
-  for (int i = 0; i < merge_ids.size(); i++) {
-    for (int j = 0; j < num_joints; j++) {
-      if (dist[merge_ids[i] * num_joints + j] <= ref_dist) {
-        int offset = dist_indx[merge_ids[i] * num_joints + j];
-        normed_scores[i * num_joints + j] =
-            body_keypoints[offset / num_joints]->scores[offset % num_joints];
-        sum_score[j] += normed_scores[i * num_joints + j];
-      } else
-        normed_scores[i * num_joints + j] = 0;
-    }
-  }
-
-  for (int i = 0; i < merge_ids.size(); i++) {
-    for (int j = 0; j < num_joints; j++) {
-      normed_scores[i * num_joints + j] /= sum_score[j];
-    }
-  }
-
-  for (int j = 0; j < num_joints; j++) {
-    float final_pose1 = 0, final_pose2 = 0, final_score = 0;
-    for (int i = 0; i < merge_ids.size(); i++) {
-      final_pose1 +=
-          (body_keypoints[dist_indx[merge_ids[i] * num_joints + j] / num_joints]
-               ->keypoints[j * 2] *
-           normed_scores[i * num_joints + j]);
-      final_pose2 +=
-          (body_keypoints[dist_indx[merge_ids[i] * num_joints + j] / num_joints]
-               ->keypoints[j * 2 + 1] *
-           normed_scores[i * num_joints + j]);
-      final_score += (pow(normed_scores[i * num_joints + j], 2) * sum_score[j]);
-    }
-    body_keypoints[pick_id]->keypoints[j * 2] = final_pose1;
-    body_keypoints[pick_id]->keypoints[j * 2 + 1] = final_pose2;
-    body_keypoints[pick_id]->scores[j] = final_score;
-  }
-  delete[] normed_scores;
-  delete[] sum_score;
-}
-
-void FastposePostProcess::poseNMSFullBody(
-    std::vector<std::shared_ptr<common::DetectedObjectMetadata>>& det_data,
-    int num_samples, int num_joints, float area_thresh,
-    std::vector<std::shared_ptr<common::PosedObjectMetadata>>& body_keypoints,
-    std::vector<int>& pick_ids) {
-  float* ref_dists = new float[num_samples];
-  float* human_scores = new float[num_samples];
-  bool* mask = new bool[num_samples];
-  int num_valid_samples = num_samples;
-  for (int i = 0; i < num_samples; i++) {
-    float width = det_data[i]->mBox.mWidth, height = det_data[i]->mBox.mHeight;
-    ref_dists[i] = pose_nms_params->alpha * std::max(width, height);
-    float joints_score_sum = 0;
-    for (int j = 0; j < num_joints; j++) {
-      joints_score_sum += body_keypoints[i]->scores[j];
-    }
-    human_scores[i] = joints_score_sum / num_joints;
-    mask[i] = true;
-  }
-
-  while (num_valid_samples > 0) {
-    int pick_id;
-    for (int i = 0; i < num_samples; i++) {
-      if (mask[i]) {
-        pick_id = i;
-        break;
-      }
-    }
-    int relative_pick_id = 0;
-    for (int i = pick_id + 1; i < num_samples; i++) {
-      if (mask[i] && human_scores[i] > human_scores[pick_id]) {
-        pick_id = i;
-      }
-    }
-
-    // find overlap index
-    std::vector<float> dist;
-    std::vector<int> dist_indx;
-    for (int i = 0; i < num_samples; i++) {
-      if (i == pick_id) relative_pick_id = dist.size() / num_joints;
-      if (mask[i]) {
-        for (int j = 0; j < num_joints; j++) {
-          dist.push_back(
-              sqrt(pow(body_keypoints[i]->keypoints[j * 2] -
-                           body_keypoints[pick_id]->keypoints[j * 2],
-                       2) +
-                   pow(body_keypoints[i]->keypoints[j * 2 + 1] -
-                           body_keypoints[pick_id]->keypoints[j * 2 + 1],
-                       2.0)));
-          dist_indx.push_back(i * num_joints + j);
-        }
-      }
-    }
-
-    int keep_num = dist.size() / num_joints;
-    float* final_dist = new float[keep_num];
-    int* num_match_keypoints = new int[keep_num];
-    getParametricDistance(body_keypoints, dist, dist_indx, pick_id, num_joints,
-                          true, final_dist);
-    PCKMatchFullBody(dist, body_keypoints, pick_id, num_joints,
-                     ref_dists[pick_id], num_match_keypoints);
-    std::vector<int> delete_ids;
-    for (int i = 0; i < keep_num; i++) {
-      if (final_dist[i] > pose_nms_params->gamma ||
-          num_match_keypoints[i] >= pose_nms_params->matchThreds) {
-        int delete_id = dist_indx[i * num_joints] / num_joints;
-        delete_ids.push_back(i);
-        mask[delete_id] = false;
-        num_valid_samples -= 1;
-      }
-    }
-    delete[] final_dist;
-    delete[] num_match_keypoints;
-    if (delete_ids.size() == 0) {
-      delete_ids.push_back(relative_pick_id);
-      mask[pick_id] = false;
-      num_valid_samples -= 1;
-    }
-
-    float pick_max_score = 0;
-    for (int j = 0; j < num_joints; j++)
-      if (body_keypoints[pick_id]->scores[j] > pick_max_score)
-        pick_max_score = body_keypoints[pick_id]->scores[j];
-    if (pick_max_score < pose_nms_params->scoreThreds) continue;
-    pMergeFast(body_keypoints, delete_ids, dist, dist_indx, pick_id, num_joints,
-               ref_dists[pick_id]);
-    float merge_max_score = 0;
-    for (int j = 0; j < num_joints; j++)
-      if (body_keypoints[pick_id]->scores[j] > merge_max_score)
-        merge_max_score = body_keypoints[pick_id]->scores[j];
-    if (merge_max_score < pose_nms_params->scoreThreds) continue;
-    float xmax = body_keypoints[pick_id]->keypoints[0];
-    float xmin = xmax;
-    float ymax = body_keypoints[pick_id]->keypoints[1];
-    float ymin = ymax;
-    for (int j = 1; j < num_joints; j++) {
-      float cur_x = body_keypoints[pick_id]->keypoints[j * 2];
-      float cur_y = body_keypoints[pick_id]->keypoints[j * 2 + 1];
-      if (cur_x > xmax) xmax = cur_x;
-      if (cur_x < xmin) xmin = cur_x;
-      if (cur_y > ymax) ymax = cur_y;
-      if (cur_y < ymin) ymin = cur_y;
-    }
-    if (1.5 * 1.5 * (xmax - xmin) * (ymax - ymin) < area_thresh) continue;
-    pick_ids.push_back(pick_id);
-  }
-
-  delete[] ref_dists;
-  delete[] human_scores;
-  delete[] mask;
+  fastpose::poseNMS(*pose_nms_params, det_data, num_samples, num_joints,
+                    area_thresh, body_keypoints, pick_ids);
 }
 
 void FastposePostProcess::getKeyPoints(
@@ -10,12 +10,15 @@
 #ifndef SOPHON_STREAM_ELEMENT_LPRNET_H_
 #define SOPHON_STREAM_ELEMENT_LPRNET_H_
 
+#include <mutex>
+
 #include "element_factory.h"
 #include "group.h"
 #include "lprnet_context.h"
 #include "lprnet_inference.h"
 #include "lprnet_post_process.h"
 #include "lprnet_pre_process.h"
+#include "micro_batcher.h"
 
 namespace sophon_stream {
 namespace element {
@@ -45,6 +48,8 @@ class Lprnet : public ::sophon_stream::framework::Element {
    */
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
   void setPreprocess(std::shared_ptr<::sophon_stream::element::PreProcess> pre);
   void setInference(std::shared_ptr<::sophon_stream::element::Inference> infer);
@@ -70,6 +75,8 @@ class Lprnet : public ::sophon_stream::framework::Element {
    */
   static constexpr const char* CONFIG_INTERNAL_STAGE_NAME_FIELD = "stage";
   static constexpr const char* CONFIG_INTERNAL_MODEL_PATH_FIELD = "model_path";
+  static constexpr const char* CONFIG_INTERNAL_BATCH_TIMEOUT_MS_FIELD =
+      "batch_timeout_ms";
 
  private:
   std::shared_ptr<LprnetContext> mContext;          // context对象
@@ -84,6 +91,12 @@ class Lprnet : public ::sophon_stream::framework::Element {
   std::string mFpsProfilerName;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
 
+  // 所有dataPipe共享，跨通道凑batch
+  std::shared_ptr<framework::MicroBatcher> mBatcher;
+  std::once_flag mBatcherFlag;
+  // 每隔多少个batch打印一次平均batch占用率
+  static constexpr int kBatchStatInterval = 1000;
+
   common::ErrorCode initContext(const std::string& json);
   void process(common::ObjectMetadatas& objectMetadatas);
 };
@@ -29,6 +29,7 @@ class LprnetContext : public ::sophon_stream::element::Context {
   int m_frame_h, m_frame_w;
   int net_h, net_w, m_net_channel;
   int max_batch;
+  int batch_timeout_ms = 10;  // 跨通道凑batch的最长等待时间
   int input_num;
   int output_num;
   int min_dim;
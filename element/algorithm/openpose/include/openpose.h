@@ -45,6 +45,8 @@ class Openpose : public ::sophon_stream::framework::Element {
    */
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
   void setPreprocess(
       std::shared_ptr<::sophon_stream::element::PreProcess> pre);
@@ -74,9 +76,15 @@ class Openpose : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_MODEL_PATH_FIELD = "model_path";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_TPU_KERNEL_FIELD =
       "use_tpu_kernel";
+  static constexpr const char* CONFIG_INTERNAL_TPU_KERNEL_MODULE_PATH_FIELD =
+      "tpu_kernel_module_path";
 
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_NMS_FIELD =
       "threshold_nms";
+  static constexpr const char* CONFIG_INTERNAL_NMS_THREAD_NUMBER_FIELD =
+      "nms_thread_number";
+  static constexpr const char* CONFIG_INTERNAL_MAX_LIMB_RATIO_FIELD =
+      "max_limb_ratio";
 
  private:
   std::shared_ptr<OpenposeContext> mContext;          // context对象
@@ -37,6 +37,9 @@ class OpenposeContext : public ::sophon_stream::element::Context {
   int input_num;
   float nms_threshold;
   int thread_number;
+  int nms_thread_number = 8;
+  // 肢体两端点距离上限与热力图高度之比，0表示不限制
+  float max_limb_ratio = 0.f;
 };
 }  // namespace openpose
 }  // namespace element
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_OPENPOSE_LIMB_SCORER_H_
+#define SOPHON_STREAM_ELEMENT_OPENPOSE_LIMB_SCORER_H_
+
+#include <tuple>
+#include <vector>
+
+namespace sophon_stream {
+namespace element {
+namespace openpose {
+
+// Round functions
+// Signed
+
+template <typename T>
+inline int intRound(const T a) {
+  return int(a + 0.5f);
+}
+
+template <typename T>
+inline T fastMin(const T a, const T b) {
+  return (a < b ? a : b);
+}
+
+/**
+ * @brief 给一种肢体的所有候选端点对打分，只依赖host内存，不依赖bmcv
+ * @brief 每个组合的10个采样点按4个一组向量化计算下标和PAF点积，
+ * 结果与逐点计算逐位一致
+ * @param candidateA 端点A的峰值，[0]为个数n，之后n组(x, y, score)从下标3开始
+ * @param candidateB 端点B的峰值，格式同candidateA
+ * @param mapX 该肢体PAF的x分量，mapWidth * mapHeight
+ * @param mapY 该肢体PAF的y分量
+ * @param connections 输出(平均PAF得分, A的序号, B的序号)，序号从1开始，
+ * 按得分降序排列
+ * @param maxLength 端点距离超过该值的组合不采样直接拒绝，小于等于0时不限制
+ */
+void scoreLimbCandidates(
+    const float* candidateA, const float* candidateB, const float* mapX,
+    const float* mapY, int mapWidth, int mapHeight, int interMinAboveThreshold,
+    float interThreshold,
+    std::vector<std::tuple<double, int, int>>& connections,
+    float maxLength = 0.f);
+
+}  // namespace openpose
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_OPENPOSE_LIMB_SCORER_H_
@@ -0,0 +1,33 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_OPENPOSE_PEAK_FINDER_H_
+#define SOPHON_STREAM_ELEMENT_OPENPOSE_PEAK_FINDER_H_
+
+namespace sophon_stream {
+namespace element {
+namespace openpose {
+
+/**
+ * @brief 在一个通道的热力图上查找峰值，只依赖host内存，不依赖bmcv
+ * @brief 大于阈值且大于8邻域的点为峰值，以其7*7邻域按得分加权求亚像素坐标；
+ * 比较和加权求和都是每次4个点的向量运算
+ * @param heatMap 单通道热力图，height * width
+ * @param peaks 输出，[0]为峰值个数n，之后n组(x, y, score)从下标3开始，
+ * 至少(maxPeaks + 1) * 3个float
+ * @param maxPeaks 最多输出的峰值个数，按行优先顺序取前maxPeaks个
+ */
+void findPeaks(const float* heatMap, float* peaks, int height, int width,
+               int maxPeaks, float threshold);
+
+}  // namespace openpose
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_OPENPOSE_PEAK_FINDER_H_
@@ -13,6 +13,7 @@
 #include <opencv2/opencv.hpp>
 
 #include "algorithmApi/post_process.h"
+#include "common/thread_pool.h"
 #include "openpose_context.h"
 
 using namespace sophon_stream::common;
@@ -73,10 +74,13 @@ class OpenposePostProcess : public ::sophon_stream::element::PostProcess {
   std::shared_ptr<OpenposeContext> global_context = nullptr;
   bm_device_mem_t **aux_data = nullptr, **output_num = nullptr;
 
-  void nms(PoseBlobPtr bottom_blob, PoseBlobPtr top_blob, float threshold);
-  void nmsFunc(float* ptr, float* top_ptr, int length, int h, int w,
-               int max_peaks, float threshold, int plane_offset,
-               int top_plane_offset);
+  // 峰值查找、热力图缩放和肢体打分共用的常驻线程池，并行度由nms_thread_number配置
+  std::shared_ptr<common::ThreadPool> mPool;
+  // 肢体打分时端点距离上限与热力图高度之比，见OpenposeContext
+  float mMaxLimbRatio = 0.f;
+
+  void nms(PoseBlobPtr bottom_blob, PoseBlobPtr top_blob, float threshold,
+           int channels);
   int kernel_part_nms(int dataPipeId, int input_h, int input_w,
                       int max_peak_num, float threshold, int* num_result,
                       float* score_out_result, int* coor_out_result,
@@ -36,6 +36,22 @@ common::ErrorCode Openpose::initContext(const std::string& json) {
     auto threshNmsIt = configure.find(CONFIG_INTERNAL_THRESHOLD_NMS_FIELD);
     mContext->nms_threshold = threshNmsIt->get<float>();
 
+    auto nmsThreadIt = configure.find(CONFIG_INTERNAL_NMS_THREAD_NUMBER_FIELD);
+    if (nmsThreadIt != configure.end()) {
+      STREAM_CHECK((nmsThreadIt->is_number_integer() && *nmsThreadIt >= 1),
+                   "nms_thread_number must be a positive integer, please "
+                   "check your openpose element configuration file");
+      mContext->nms_thread_number = nmsThreadIt->get<int>();
+    }
+
+    auto maxLimbRatioIt = configure.find(CONFIG_INTERNAL_MAX_LIMB_RATIO_FIELD);
+    if (maxLimbRatioIt != configure.end()) {
+      STREAM_CHECK((maxLimbRatioIt->is_number() && *maxLimbRatioIt >= 0),
+                   "max_limb_ratio must be a non-negative number, please "
+                   "check your openpose element configuration file");
+      mContext->max_limb_ratio = maxLimbRatioIt->get<float>();
+    }
+
     auto tpu_kernelIt =
         configure.find(CONFIG_INTERNAL_THRESHOLD_TPU_KERNEL_FIELD);
     if (configure.end() == tpu_kernelIt || !tpu_kernelIt->is_boolean()) {
@@ -45,10 +61,11 @@ common::ErrorCode Openpose::initContext(const std::string& json) {
     mContext->use_tpu_kernel = tpu_kernelIt->get<bool>();
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(mContext->deviceId);
     mContext->handle = handle->handle();
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
+    mContext->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
     mContext->bmNetwork = mContext->bmContext->network(0);
 
     // 2. get input
@@ -87,20 +104,20 @@ common::ErrorCode Openpose::initContext(const std::string& json) {
 
     // 5. tpu_kernel postprocess
     if (mContext->use_tpu_kernel) {
-      tpu_kernel_module_t tpu_module;
-      std::string tpu_kernel_module_path =
-          "../../3rdparty/tpu_kernel_module/"
-          "libbm1684x_kernel_module.so";
-      std::ifstream file(tpu_kernel_module_path);
-      STREAM_CHECK(file.good(),
-                   "kernel_module.so does not exist, please check your path: ",
-                   tpu_kernel_module_path);
-      file.close();
-      tpu_module = tpu_kernel_load_module_file(mContext->bmContext->handle(),
-                                               tpu_kernel_module_path.c_str());
-      mContext->func_id = tpu_kernel_get_function(
-          mContext->bmContext->handle(), tpu_module,
-          "tpu_kernel_api_openpose_part_nms_postprocess");
+      // 模块由框架缓存，每个设备只加载一次；json中可指定模块所在目录
+      std::string tpu_kernel_module_path;
+      auto modulePathIt =
+          configure.find(CONFIG_INTERNAL_TPU_KERNEL_MODULE_PATH_FIELD);
+      if (configure.end() != modulePathIt) {
+        STREAM_CHECK(modulePathIt->is_string(),
+                     "tpu_kernel_module_path must be a string, please check "
+                     "your Json files");
+        tpu_kernel_module_path = modulePathIt->get<std::string>();
+      }
+      mContext->func_id =
+          common::TpuKernelModuleCache::getInstance().getFunction(
+              handle, "tpu_kernel_api_openpose_part_nms_postprocess",
+              tpu_kernel_module_path);
       std::cout
           << "Using tpu_kernel openpose postprocession, kernel funtion id: "
           << mContext->func_id << std::endl;
@@ -231,7 +248,8 @@ common::ErrorCode Openpose::doWork(int dataPipeId) {
     int outDataPipeId =
         getSinkElementFlag()
             ? 0
-            : (channel_id_internal % getOutputConnectorCapacity(outputPort));
+            : getOutputDataPipeId(outputPort, channel_id_internal,
+                                  objectMetadata->mFrame->mEndOfStream);
     errorCode = pushOutputData(outputPort, outDataPipeId,
                                std::static_pointer_cast<void>(objectMetadata));
     if (common::ErrorCode::SUCCESS != errorCode) {
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "openpose_limb_scorer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace sophon_stream {
+namespace element {
+namespace openpose {
+
+namespace {
+
+// GCC向量扩展，x86上对应SSE，aarch64上对应NEON
+typedef float v4f __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+
+constexpr int kNumInter = 10;
+// 10个采样点分成3组，每组4个，最后一组后2个无效
+constexpr int kGroups = (kNumInter + 3) / 4;
+
+inline v4f splat(float v) { return v4f{v, v, v, v}; }
+inline v4i splat(int v) { return v4i{v, v, v, v}; }
+
+}  // namespace
+
+void scoreLimbCandidates(
+    const float* candidateA, const float* candidateB, const float* mapX,
+    const float* mapY, int mapWidth, int mapHeight, int interMinAboveThreshold,
+    float interThreshold,
+    std::vector<std::tuple<double, int, int>>& connections, float maxLength) {
+  const auto nA = intRound(candidateA[0]);
+  const auto nB = intRound(candidateB[0]);
+  connections.clear();
+  if (nA == 0 || nB == 0) return;
+  connections.reserve(nA * nB);
+  // 有效采样点必须多于interMinAboveThreshold个，失败次数超过该上限即可提前放弃
+  const int maxMisses = kNumInter - interMinAboveThreshold - 1;
+  if (maxMisses < 0) return;
+  const float maxLengthSq = maxLength > 0 ? maxLength * maxLength : -1.f;
+
+  v4f steps[kGroups];
+  v4i valid[kGroups];
+  for (int g = 0; g < kGroups; ++g) {
+    for (int k = 0; k < 4; ++k) {
+      steps[g][k] = float(g * 4 + k);
+      valid[g][k] = g * 4 + k < kNumInter ? -1 : 0;
+    }
+  }
+  const v4i maxX = splat(mapWidth - 1);
+  const v4i maxY = splat(mapHeight - 1);
+  const v4i width = splat(mapWidth);
+  const v4f thr = splat(interThreshold);
+
+  for (auto i = 1; i <= nA; i++) {
+    const auto sX = candidateA[i * 3];
+    const auto sY = candidateA[i * 3 + 1];
+    for (auto j = 1; j <= nB; j++) {
+      const auto dX = candidateB[j * 3] - sX;
+      const auto dY = candidateB[j * 3 + 1] - sY;
+      const auto normSq = dX * dX + dY * dY;
+      // 端点距离超过肢体长度上限，不采样直接拒绝
+      if (maxLengthSq > 0 && normSq > maxLengthSq) continue;
+      const auto normVec = float(std::sqrt(normSq));
+      // If the peaksPtr are coincident. Don't connect them.
+      if (normVec <= 1e-6) continue;
+      const v4f vecX = splat(dX / normVec);
+      const v4f vecY = splat(dY / normVec);
+
+      auto sum = 0.;
+      auto count = 0;
+      auto misses = 0;
+      for (int g = 0; g < kGroups && misses <= maxMisses; ++g) {
+        // 与intRound(sX + lm * dX / numInter)逐位一致：先乘后除，加0.5后截断
+        const v4f fx = (steps[g] * dX) / float(kNumInter) + sX + 0.5f;
+        const v4f fy = (steps[g] * dY) / float(kNumInter) + sY + 0.5f;
+        v4i mX = __builtin_convertvector(fx, v4i);
+        v4i mY = __builtin_convertvector(fy, v4i);
+        mX = mX < maxX ? mX : maxX;
+        mY = mY < maxY ? mY : maxY;
+        const v4i idx = (mY * width + mX) & valid[g];
+
+        v4f pafX, pafY;
+        for (int k = 0; k < 4; ++k) {
+          pafX[k] = mapX[idx[k]];
+          pafY[k] = mapY[idx[k]];
+        }
+        const v4f score = vecX * pafX + vecY * pafY;
+        const v4i above = (score > thr) & valid[g];
+        // 按采样顺序累加，保持double求和的结果不变
+        for (int k = 0; k < 4 && g * 4 + k < kNumInter; ++k) {
+          if (above[k]) {
+            sum += score[k];
+            count++;
+          } else {
+            misses++;
+          }
+        }
+      }
+
+      // parts score + connection score
+      if (count > interMinAboveThreshold)
+        connections.emplace_back(std::make_tuple(sum / count, i, j));
+    }
+  }
+
+  // select the top minAB connection, assuming that each part occur
+  // only once sort rows in descending order based on parts +
+  // connection score
+  std::sort(connections.begin(), connections.end(),
+            std::greater<std::tuple<float, int, int>>());
+}
+
+}  // namespace openpose
+}  // namespace element
+}  // namespace sophon_stream
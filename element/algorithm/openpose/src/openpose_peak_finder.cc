@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "openpose_peak_finder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sophon_stream {
+namespace element {
+namespace openpose {
+
+namespace {
+
+// GCC向量扩展，x86上对应SSE，aarch64上对应NEON
+typedef float v4f __attribute__((vector_size(16)));
+typedef int v4i __attribute__((vector_size(16)));
+
+inline v4f load4(const float* p) {
+  v4f v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline bool any4(v4i m) { return (m[0] | m[1] | m[2] | m[3]) != 0; }
+
+inline float sum4(v4f v) { return (v[0] + v[1]) + (v[2] + v[3]); }
+
+/**
+ * @brief 4个相邻点与各自8邻域的比较，up、row、down指向第一个点左侧一列，
+ * 每行需要可读6个float
+ */
+inline v4i peakMask4(const float* up, const float* row, const float* down,
+                     v4f thr) {
+  const v4f v = load4(row + 1);
+  v4i mask = v > thr;
+  // 绝大多数点低于阈值，整组跳过
+  if (!any4(mask)) return mask;
+  return mask & (v > load4(up)) & (v > load4(up + 1)) & (v > load4(up + 2)) &
+         (v > load4(row)) & (v > load4(row + 2)) & (v > load4(down)) &
+         (v > load4(down + 1)) & (v > load4(down + 2));
+}
+
+/**
+ * @brief 以(x, y)为中心的7*7邻域按得分加权求亚像素坐标，越界部分不参与
+ * @brief 每行的7列拆成[x-3, x]和[x+1, x+4]两组向量，x+4一列置0
+ */
+inline void refinePeak(const float* heatMap, int height, int width, int x,
+                       int y, float* xOut, float* yOut) {
+  const v4f xLo = {float(x - 3), float(x - 2), float(x - 1), float(x)};
+  const v4f xHi = {float(x + 1), float(x + 2), float(x + 3), float(x + 4)};
+  const bool inside = x >= 3 && x + 4 < width;
+  v4f scoreAcc = {0, 0, 0, 0};
+  v4f xAcc = {0, 0, 0, 0};
+  v4f yAcc = {0, 0, 0, 0};
+  for (int uy = std::max(y - 3, 0); uy <= std::min(y + 3, height - 1); ++uy) {
+    const float* row = heatMap + uy * width;
+    v4f lo, hi;
+    if (inside) {
+      lo = load4(row + x - 3);
+      hi = load4(row + x + 1);
+    } else {
+      float pad[8] = {0};
+      const int begin = std::max(x - 3, 0);
+      const int end = std::min(x + 4, width);
+      memcpy(pad + begin - (x - 3), row + begin, (end - begin) * sizeof(float));
+      lo = load4(pad);
+      hi = load4(pad + 4);
+    }
+    hi[3] = 0.f;
+    const v4f sum = lo + hi;
+    scoreAcc += sum;
+    xAcc += lo * xLo + hi * xHi;
+    yAcc += sum * float(uy);
+  }
+  const float score = sum4(scoreAcc);
+  *xOut = sum4(xAcc) / score;
+  *yOut = sum4(yAcc) / score;
+}
+
+}  // namespace
+
+void findPeaks(const float* heatMap, float* peaks, int height, int width,
+               int maxPeaks, float threshold) {
+  const v4f thr = {threshold, threshold, threshold, threshold};
+  int numPeaks = 0;
+  for (int y = 1; y < height - 1 && numPeaks != maxPeaks; ++y) {
+    const float* up = heatMap + (y - 1) * width;
+    const float* row = heatMap + y * width;
+    const float* down = heatMap + (y + 1) * width;
+    for (int x0 = 1; x0 < width - 1 && numPeaks != maxPeaks; x0 += 4) {
+      v4i mask;
+      if (x0 + 4 <= width - 1) {
+        mask = peakMask4(up + x0 - 1, row + x0 - 1, down + x0 - 1, thr);
+      } else {
+        // 行尾不足4个点，复制到补齐的缓冲中比较，超出width - 2的点不计
+        float pad[3][8] = {{0}};
+        const int n = width - (x0 - 1);
+        memcpy(pad[0], up + x0 - 1, n * sizeof(float));
+        memcpy(pad[1], row + x0 - 1, n * sizeof(float));
+        memcpy(pad[2], down + x0 - 1, n * sizeof(float));
+        const v4i xs = {x0, x0 + 1, x0 + 2, x0 + 3};
+        const v4i last = {width - 1, width - 1, width - 1, width - 1};
+        mask = peakMask4(pad[0], pad[1], pad[2], thr) & (xs < last);
+      }
+      if (!any4(mask)) continue;
+
+      for (int i = 0; i < 4 && numPeaks != maxPeaks; ++i) {
+        if (!mask[i]) continue;
+        const int x = x0 + i;
+        float* peak = peaks + (numPeaks + 1) * 3;
+        refinePeak(heatMap, height, width, x, y, &peak[0], &peak[1]);
+        peak[2] = row[x];
+        numPeaks++;
+      }
+    }
+  }
+  peaks[0] = numPeaks;
+}
+
+}  // namespace openpose
+}  // namespace element
+}  // namespace sophon_stream
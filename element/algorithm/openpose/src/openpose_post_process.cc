@@ -9,26 +9,18 @@
 
 #include "openpose_post_process.h"
 
+#include "openpose_limb_scorer.h"
+#include "openpose_peak_finder.h"
+
 namespace sophon_stream {
 namespace element {
 namespace openpose {
 
 const unsigned int POSE_MAX_PEOPLE = 96;
 
-// Round functions
-// Signed
-
-template <typename T>
-inline int intRound(const T a) {
-  return int(a + 0.5f);
-}
-
-template <typename T>
-inline T fastMin(const T a, const T b) {
-  return (a < b ? a : b);
-}
-
 void OpenposePostProcess::init(std::shared_ptr<OpenposeContext> context) {
+  mPool = std::make_shared<common::ThreadPool>(context->nms_thread_number);
+  mMaxLimbRatio = context->max_limb_ratio;
   if (context->use_tpu_kernel) {
     global_context = context;
     resize_output_map_whole_device_mem =
@@ -92,64 +84,9 @@ void OpenposePostProcess::postProcess(std::shared_ptr<OpenposeContext> context,
     }
   }
 }
-void OpenposePostProcess::nmsFunc(float* ptr, float* top_ptr, int length, int h,
-                                  int w, int max_peaks, float threshold,
-                                  int plane_offset, int top_plane_offset) {
-  for (int c = 0; c < length; c++) {
-    int num_peaks = 0;
-    for (int y = 1; y < h - 1 && num_peaks != max_peaks; ++y) {
-      for (int x = 1; x < w - 1 && num_peaks != max_peaks; ++x) {
-        float value = ptr[y * w + x];
-        if (value > threshold) {
-          const float topLeft = ptr[(y - 1) * w + x - 1];
-          const float top = ptr[(y - 1) * w + x];
-          const float topRight = ptr[(y - 1) * w + x + 1];
-          const float left = ptr[y * w + x - 1];
-          const float right = ptr[y * w + x + 1];
-          const float bottomLeft = ptr[(y + 1) * w + x - 1];
-          const float bottom = ptr[(y + 1) * w + x];
-          const float bottomRight = ptr[(y + 1) * w + x + 1];
-
-          if (value > topLeft && value > top && value > topRight &&
-              value > left && value > right && value > bottomLeft &&
-              value > bottom && value > bottomRight) {
-            // 计算亚像素坐标
-            float xAcc = 0;
-            float yAcc = 0;
-            float scoreAcc = 0;
-            for (int kx = -3; kx <= 3; ++kx) {
-              int ux = x + kx;
-              if (ux >= 0 && ux < w) {
-                for (int ky = -3; ky <= 3; ++ky) {
-                  int uy = y + ky;
-                  if (uy >= 0 && uy < h) {
-                    float score = ptr[uy * w + ux];
-                    xAcc += ux * score;
-                    yAcc += uy * score;
-                    scoreAcc += score;
-                  }
-                }
-              }
-            }
 
-            xAcc /= scoreAcc;
-            yAcc /= scoreAcc;
-            scoreAcc = value;
-            top_ptr[(num_peaks + 1) * 3 + 0] = xAcc;
-            top_ptr[(num_peaks + 1) * 3 + 1] = yAcc;
-            top_ptr[(num_peaks + 1) * 3 + 2] = scoreAcc;
-            num_peaks++;
-          }
-        }
-      }
-    }
-    top_ptr[0] = num_peaks;
-    ptr += plane_offset;
-    top_ptr += top_plane_offset;
-  }
-}
 void OpenposePostProcess::nms(PoseBlobPtr bottom_blob, PoseBlobPtr top_blob,
-                              float threshold) {
+                              float threshold, int channels) {
   // maxPeaks就是最大人数，+1是为了第一位存个数
   // 算法，是每个点，如果大于阈值，同时大于上下左右值的时候，则认为是峰值
 
@@ -158,35 +95,20 @@ void OpenposePostProcess::nms(PoseBlobPtr bottom_blob, PoseBlobPtr top_blob,
 
   int w = bottom_blob->width();
   int h = bottom_blob->height();
-  int C = bottom_blob->channels();
-  int N = bottom_blob->num();
   int plane_offset = w * h;
-  float* ptr = bottom_blob->data();
-  float* top_ptr = top_blob->data();
   int top_plane_offset = top_blob->width() * top_blob->height();
   int max_peaks = top_blob->height() - 1;
 
-  for (int n = 0; n < N; ++n) {
-    const int numThreads = 8;
-    int length = C / numThreads;
-    int last = C % length;
-    std::vector<std::thread> threads;
-
-    for (int c = 0; c < numThreads - 1; ++c) {
-      threads.emplace_back(
-          &OpenposePostProcess::nmsFunc, this, ptr + c * length * plane_offset,
-          top_ptr + c * length * top_plane_offset, length, h, w, max_peaks,
-          threshold, plane_offset, top_plane_offset);
-    }
-    threads.emplace_back(&OpenposePostProcess::nmsFunc, this,
-                         ptr + (numThreads - 1) * length * plane_offset,
-                         top_ptr + (numThreads - 1) * length * top_plane_offset,
-                         last ? last : length, h, w, max_peaks, threshold,
-                         plane_offset, top_plane_offset);
-
-    for (std::thread& t : threads) {
-      t.join();
-    }
+  // 只有关键点通道的峰值会被connectBodyParts使用，PAF通道不需要做nms
+  for (int n = 0; n < bottom_blob->num(); ++n) {
+    const float* ptr =
+        bottom_blob->data() + n * bottom_blob->channels() * plane_offset;
+    float* top_ptr =
+        top_blob->data() + n * top_blob->channels() * top_plane_offset;
+    mPool->parallelFor(channels, [&](int c) {
+      findPeaks(ptr + c * plane_offset, top_ptr + c * top_plane_offset, h, w,
+                max_peaks, threshold);
+    });
   }
 }
 
@@ -301,6 +223,23 @@ void OpenposePostProcess::connectBodyPartsCpu(
   const auto peaksOffset = 3 * (maxPeaks + 1);
   const auto heatMapOffset = heatMapSize.area();
 
+  // 各肢体类型的打分互不依赖，先在线程池里并行算完，再串行拼装人体
+  std::vector<std::vector<std::tuple<double, int, int>>> limbConnections(
+      numberBodyPartPairs);
+  const float maxLimbLength = mMaxLimbRatio * heatMapSize.height;
+  mPool->parallelFor(numberBodyPartPairs, [&](int pairIndex) {
+    const auto* candidateA =
+        peaksPtr + bodyPartPairs[2 * pairIndex] * peaksOffset;
+    const auto* candidateB =
+        peaksPtr + bodyPartPairs[2 * pairIndex + 1] * peaksOffset;
+    scoreLimbCandidates(candidateA, candidateB,
+                        heatMapPtr + mapIdx[2 * pairIndex] * heatMapOffset,
+                        heatMapPtr + mapIdx[2 * pairIndex + 1] * heatMapOffset,
+                        heatMapSize.width, heatMapSize.height,
+                        interMinAboveThreshold, interThreshold,
+                        limbConnections[pairIndex], maxLimbLength);
+  });
+
   for (auto pairIndex = 0u; pairIndex < numberBodyPartPairs; pairIndex++) {
     const auto bodyPartA = bodyPartPairs[2 * pairIndex];
     const auto bodyPartB = bodyPartPairs[2 * pairIndex + 1];
@@ -365,53 +304,8 @@ void OpenposePostProcess::connectBodyPartsCpu(
       }
     } else  // if (nA != 0 && nB != 0)
     {
-      std::vector<std::tuple<double, int, int>> temp;
-      const auto numInter = 10;
-      const auto* const mapX =
-          heatMapPtr + mapIdx[2 * pairIndex] * heatMapOffset;
-      const auto* const mapY =
-          heatMapPtr + mapIdx[2 * pairIndex + 1] * heatMapOffset;
-      for (auto i = 1; i <= nA; i++) {
-        for (auto j = 1; j <= nB; j++) {
-          const auto dX = candidateB[j * 3] - candidateA[i * 3];
-          const auto dY = candidateB[j * 3 + 1] - candidateA[i * 3 + 1];
-          const auto normVec = float(std::sqrt(dX * dX + dY * dY));
-          // If the peaksPtr are coincident. Don't connect them.
-          if (normVec > 1e-6) {
-            const auto sX = candidateA[i * 3];
-            const auto sY = candidateA[i * 3 + 1];
-            const auto vecX = dX / normVec;
-            const auto vecY = dY / normVec;
-
-            auto sum = 0.;
-            auto count = 0;
-            for (auto lm = 0; lm < numInter; lm++) {
-              const auto mX = fastMin(heatMapSize.width - 1,
-                                      intRound(sX + lm * dX / numInter));
-              const auto mY = fastMin(heatMapSize.height - 1,
-                                      intRound(sY + lm * dY / numInter));
-
-              const auto idx = mY * heatMapSize.width + mX;
-              const auto score = (vecX * mapX[idx] + vecY * mapY[idx]);
-              if (score > interThreshold) {
-                sum += score;
-                count++;
-              }
-            }
-
-            // parts score + connection score
-            if (count > interMinAboveThreshold)
-              temp.emplace_back(std::make_tuple(sum / count, i, j));
-          }
-        }
-      }
-
-      // select the top minAB connection, assuming that each part occur
-      // only once sort rows in descending order based on parts +
-      // connection score
-      if (!temp.empty())
-        std::sort(temp.begin(), temp.end(),
-                  std::greater<std::tuple<float, int, int>>());
+      // 候选连接已在前面按肢体类型并行打分并排好序
+      const auto& temp = limbConnections[pairIndex];
 
       std::vector<std::tuple<int, int, double>> connectionK;
 
@@ -864,13 +758,13 @@ void OpenposePostProcess::getKeyPointsCPU(
 
   PoseBlobPtr resizedBlob =
       std::make_shared<PoseBlob>(1, chan_num, nmsSize.height, nmsSize.width);
-  for (int ch = 0; ch < chan_num; ++ch) {
+  mPool->parallelFor(chan_num, [&](int ch) {
     cv::Mat src(net_output_height, net_output_width, CV_32F,
                 base + ch_area * ch);
     cv::Mat dst(resizedBlob->height(), resizedBlob->width(), CV_32F,
                 resizedBlob->data() + nmsSize.height * nmsSize.width * ch);
     cv::resize(src, dst, nmsSize, 0, 0, cv::INTER_CUBIC);
-  }
+  });
   PoseBlobPtr nms_blob;
   if (model_type == PosedObjectMetadata::EModelType::COCO_18) {
     nms_blob = std::make_shared<PoseBlob>(1, 56, POSE_MAX_PEOPLE + 1, 3);
@@ -878,7 +772,7 @@ void OpenposePostProcess::getKeyPointsCPU(
     nms_blob = std::make_shared<PoseBlob>(1, 77, POSE_MAX_PEOPLE + 1, 3);
   }
 
-  nms(resizedBlob, nms_blob, nms_threshold);
+  nms(resizedBlob, nms_blob, nms_threshold, getNumberBodyParts(model_type));
 
   connectBodyPartsCpu(body_keypoints, resizedBlob->data(), nms_blob->data(),
                       nmsSize, POSE_MAX_PEOPLE, 9, 0.05, 3, 0.4, 1, model_type);
@@ -933,7 +827,6 @@ void OpenposePostProcess::getKeyPointsTPUKERNEL(
   PoseBlobPtr resizedBlob =
       std::make_shared<PoseBlob>(1, chan_num, nmsSize.height, nmsSize.width);
 
-  std::vector<std::thread> peak_channel_resize_threads;
   int part_nms_chan_num = getNumberBodyParts(model_type);
 
   if (resize_output_map_whole_device_mem[dataPipeId] == nullptr) {
@@ -954,23 +847,25 @@ void OpenposePostProcess::getKeyPointsTPUKERNEL(
         sizeof(float) * nmsSize.height * nmsSize.width * part_nms_chan_num);
     STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
   }
-  bm_device_mem_t resize_output_map_device_mem;
   unsigned long long resize_output_map_whole_device_mem_addr =
       bm_mem_get_device_addr(*(resize_output_map_whole_device_mem[dataPipeId]));
 
-  int interval = 3;
-  for (int ch = 0; ch < part_nms_chan_num; ch += interval) {
-    interval =
-        ch + interval > part_nms_chan_num ? part_nms_chan_num - ch : interval;
-    bm_set_device_mem(&resize_output_map_device_mem,
-                      sizeof(float) * nmsSize.height * nmsSize.width * interval,
-                      resize_output_map_whole_device_mem_addr +
-                          ch * sizeof(float) * nmsSize.height * nmsSize.width);
-    peak_channel_resize_threads.emplace_back(
-        &OpenposePostProcess::resize_multi_channel, this, base,
-        resizedBlob->data(), resize_output_map_device_mem, net_output_height,
-        net_output_width, nmsSize, true, ch, ch + interval, context);
-  }
+  // 关键点通道每3个一组缩放，并拷贝到device供tpu_kernel做nms
+  const int peakInterval = 3;
+  const int peakChunks = (part_nms_chan_num + peakInterval - 1) / peakInterval;
+  mPool->parallelFor(peakChunks, [&](int i) {
+    int ch = i * peakInterval;
+    int end = std::min(ch + peakInterval, part_nms_chan_num);
+    bm_device_mem_t resize_output_map_device_mem;
+    bm_set_device_mem(
+        &resize_output_map_device_mem,
+        sizeof(float) * nmsSize.height * nmsSize.width * (end - ch),
+        resize_output_map_whole_device_mem_addr +
+            ch * sizeof(float) * nmsSize.height * nmsSize.width);
+    resize_multi_channel(base, resizedBlob->data(),
+                         resize_output_map_device_mem, net_output_height,
+                         net_output_width, nmsSize, true, ch, end, context);
+  });
 
   int* num_result = new int[resizedBlob->channels()];
   float* score_out_result = nullptr;
@@ -983,28 +878,24 @@ void OpenposePostProcess::getKeyPointsTPUKERNEL(
     coor_out_result = new int[25 * (POSE_MAX_PEOPLE + 1) * 3];
   }
 
-  for (std::thread& t : peak_channel_resize_threads) {
-    t.join();
-  }
-  std::thread part_nms_thread(
-      &OpenposePostProcess::kernel_part_nms, this, dataPipeId, nmsSize.height,
-      nmsSize.width, POSE_MAX_PEOPLE, 0.05, num_result, score_out_result,
-      coor_out_result, model_type, context);
-
-  interval = 5;
-  std::vector<std::thread> connect_channel_resize_threads;
-  for (int ch = part_nms_chan_num; ch < chan_num; ch += interval) {
-    interval = ch + interval > chan_num ? chan_num - ch : interval;
-    connect_channel_resize_threads.emplace_back(
-        &OpenposePostProcess::resize_multi_channel, this, base,
-        resizedBlob->data(), resize_output_map_device_mem, net_output_height,
-        net_output_width, nmsSize, false, ch, ch + interval, context);
-  }
-
-  for (std::thread& t : connect_channel_resize_threads) {
-    t.join();
-  }
-  part_nms_thread.join();
+  // tpu_kernel的nms与PAF通道的缩放互不依赖，放在同一次parallelFor中并行，
+  // 下标0为nms，其余为每5个PAF通道一组的缩放
+  const int pafInterval = 5;
+  const int pafChunks =
+      (chan_num - part_nms_chan_num + pafInterval - 1) / pafInterval;
+  mPool->parallelFor(pafChunks + 1, [&](int i) {
+    if (i == 0) {
+      kernel_part_nms(dataPipeId, nmsSize.height, nmsSize.width,
+                      POSE_MAX_PEOPLE, 0.05, num_result, score_out_result,
+                      coor_out_result, model_type, context);
+      return;
+    }
+    int ch = part_nms_chan_num + (i - 1) * pafInterval;
+    int end = std::min(ch + pafInterval, chan_num);
+    resize_multi_channel(base, resizedBlob->data(), bm_device_mem_t(),
+                         net_output_height, net_output_width, nmsSize, false,
+                         ch, end, context);
+  });
 
   connectBodyPartsKernel(body_keypoints, resizedBlob->data(), num_result,
                          score_out_result, coor_out_result, nullptr, nmsSize,
@@ -19,7 +19,7 @@ common::ErrorCode OpenposePreProcess::preProcess(
     std::shared_ptr<OpenposeContext> context,
     common::ObjectMetadatas& objectMetadatas) {
   if (objectMetadatas.size() == 0) return common::ErrorCode::SUCCESS;
-  initTensors(context, objectMetadatas);
+  initBatchTensors(context, objectMetadatas);
 
   int i = 0;
   for (auto& objMetadata : objectMetadatas) {
@@ -78,7 +78,8 @@ common::ErrorCode OpenposePreProcess::preProcess(
     bm_device_mem_t mem;
     int size_byte = 0;
     bm_image_get_byte_size(converto_img, &size_byte);
-    ret = bm_malloc_device_byte(context->bmContext->handle(), &mem, size_byte);
+    // max_batch > 1时直接写进连续batch输入中该目标的槽位
+    ret = acquireInputMem(context, objectMetadatas[i], size_byte, &mem);
     STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
     bm_image_attach(converto_img, &mem);
 
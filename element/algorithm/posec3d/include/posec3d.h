@@ -10,8 +10,12 @@
 #ifndef SOPHON_STREAM_ELEMENT_POSEC3D_H_
 #define SOPHON_STREAM_ELEMENT_POSEC3D_H_
 
+#include <mutex>
+#include <unordered_map>
+
 #include "element_factory.h"
 #include "group.h"
+#include "keypoint_window.h"
 #include "posec3d_context.h"
 #include "posec3d_inference.h"
 #include "posec3d_post_process.h"
@@ -45,6 +49,8 @@ class Posec3d : public ::sophon_stream::framework::Element {
    */
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
   void setPreprocess(
       std::shared_ptr<::sophon_stream::element::PreProcess> pre);
@@ -75,6 +81,8 @@ class Posec3d : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_CLASS_NAMES_FILE_FIELD =
       "class_names_file";
   static constexpr const char* CONFIG_INTERNAL_FRAMES_NUM_FIELD = "frames_num";
+  static constexpr const char* CONFIG_INTERNAL_WINDOW_STRIDE_FIELD =
+      "window_stride";
 
  private:
   std::shared_ptr<Posec3dContext> mContext;          // context对象
@@ -89,8 +97,18 @@ class Posec3d : public ::sophon_stream::framework::Element {
   std::string mFpsProfilerName;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
 
+  // 预处理阶段按通道缓存关键点的滑动窗口，各工作线程共用
+  std::mutex mWindowMutex;
+  std::shared_ptr<framework::KeypointWindow> mWindow;
+  // 后处理阶段每个通道最近一次的识别结果，附加到两次识别之间的帧上
+  std::mutex mLabelMutex;
+  std::unordered_map<
+      int, std::vector<std::shared_ptr<common::RecognizedObjectMetadata>>>
+      mLastLabels;
+
   common::ErrorCode initContext(const std::string& json);
-  void process(common::ObjectMetadatas& objectMetadatas);
+  void process(common::ObjectMetadatas& objectMetadatas,
+               const framework::KeypointClip& clip);
 };
 
 }  // namespace posec3d
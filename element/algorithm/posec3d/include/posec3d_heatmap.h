@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_POSEC3D_HEATMAP_H_
+#define SOPHON_STREAM_ELEMENT_POSEC3D_HEATMAP_H_
+
+#include <memory>
+#include <vector>
+
+namespace sophon_stream {
+namespace element {
+namespace posec3d {
+
+using fpptr_dim3 = std::vector<
+    std::shared_ptr<std::vector<std::shared_ptr<std::vector<float>>>>>;
+using fpptr_dim2 = std::vector<std::shared_ptr<std::vector<float>>>;
+
+/**
+ * @brief 把重采样后的关键点画成模型输入heatmap，只依赖host内存，不依赖bmcv
+ * @brief 重复采样到的同一输入帧只生成一次heatmap切片，再拷贝到各个clip中；
+ * 高斯核按行列分离计算，不修改输入的关键点
+ * @param sampled_keypoints 每个采样帧每个人的(x, y)交替排列的关键点
+ * @param sampled_keypoint_scores 与sampled_keypoints对应的关键点置信度
+ * @param height 缩放前的heatmap高
+ * @param width 缩放前的heatmap宽
+ * @param num_keypoints 每个人的关键点数
+ * @param input_scale 模型输入的量化系数
+ * @param heatmap 输出，out_num个float，前后两半写入相同的值
+ * @param sigma 高斯核标准差
+ * @param scaling heatmap和关键点的缩放系数
+ * @param clip_len 每个clip的帧数
+ */
+void generatePoseHeatmap(const fpptr_dim3& sampled_keypoints,
+                         const fpptr_dim3& sampled_keypoint_scores, int height,
+                         int width, int num_keypoints, float input_scale,
+                         float* heatmap, int out_num, float sigma,
+                         float scaling, int clip_len);
+
+}  // namespace posec3d
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_POSEC3D_HEATMAP_H_
@@ -11,26 +11,26 @@
 #define SOPHON_STREAM_ELEMENT_POSEC3D_PRE_PROCESS_H_
 
 #include "algorithmApi/pre_process.h"
+#include "keypoint_window.h"
 #include "posec3d_context.h"
+#include "posec3d_heatmap.h"
 
 namespace sophon_stream {
 namespace element {
 namespace posec3d {
 
-using fpptr_dim3 = std::vector<
-    std::shared_ptr<std::vector<std::shared_ptr<std::vector<float>>>>>;
-using fpptr_dim2 = std::vector<std::shared_ptr<std::vector<float>>>;
-
 class Posec3dPreProcess : public ::sophon_stream::element::PreProcess {
  public:
   /**
-   * @brief 对一个batch的数据做预处理
+   * @brief 将一个滑动窗口的关键点生成模型输入
    * @param context context指针
-   * @param objectMetadatas 一个batch的数据
+   * @param clip 窗口内按时间顺序排列的关键点
+   * @param objectMetadatas 只含触发本次识别的一帧，输入tensor挂在这一帧上
    * @return common::ErrorCode
    * common::ErrorCode::SUCCESS，中间过程失败会中断执行
    */
   common::ErrorCode preProcess(std::shared_ptr<Posec3dContext> context,
+                               const framework::KeypointClip& clip,
                                common::ObjectMetadatas& objectMetadatas);
   void init(std::shared_ptr<Posec3dContext> context);
 
@@ -51,7 +51,8 @@ class Posec3dPreProcess : public ::sophon_stream::element::PreProcess {
 
   /**
    * @brief 对一个batch的关键点数据做偏移并生成下面预处理所需要的参数
-   * @param objectMetadatas 一个batch的数据
+   * @param img_h 原图高
+   * @param img_w 原图宽
    * @param keypoints 关键点输入
    * @param padding padding尺寸
    * @param threshold 长宽阈值
@@ -62,8 +63,8 @@ class Posec3dPreProcess : public ::sophon_stream::element::PreProcess {
    * @return common::ErrorCode
    * common::ErrorCode::SUCCESS，中间过程失败会中断执行
    */
-  common::ErrorCode poseCompact(common::ObjectMetadatas& objectMetadatas,
-                                fpptr_dim3& keypoints, float padding,
+  common::ErrorCode poseCompact(int img_h, int img_w, fpptr_dim3& keypoints,
+                                float padding,
                                 int threshold, std::vector<float>& hw_ratio,
                                 std::vector<int>& new_shape,
                                 std::vector<float>& crop_quadruple,
@@ -96,7 +97,7 @@ class Posec3dPreProcess : public ::sophon_stream::element::PreProcess {
                                std::vector<int>& crop_size);
 
   /**
-   * @brief 生成模型输入heatmap
+   * @brief 生成模型输入heatmap，见generatePoseHeatmap
    * @param context context指针
    * @param sampled_keypoints 来自uniformSampleFrames输出的重采样关键点结果
    * @param sampled_keypoint_scores 关键点输入
@@ -110,7 +111,6 @@ class Posec3dPreProcess : public ::sophon_stream::element::PreProcess {
    * common::ErrorCode::SUCCESS，中间过程失败会中断执行
    */
   common::ErrorCode generatePoseTarget(std::shared_ptr<Posec3dContext> context,
-                                       fpptr_dim3& keypoints,
                                        fpptr_dim3& sampled_keypoints,
                                        fpptr_dim3& sampled_keypoint_scores,
                                        std::vector<int>& new_shape,
@@ -34,15 +34,30 @@ common::ErrorCode Posec3d::initContext(const std::string& json) {
     auto modelPathIt = configure.find(CONFIG_INTERNAL_MODEL_PATH_FIELD);
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(mContext->deviceId);
+    mContext->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
     mContext->bmNetwork = mContext->bmContext->network(0);
     mContext->handle = handle->handle();
 
     // 2. get input
     auto frameNum = configure.find(CONFIG_INTERNAL_FRAMES_NUM_FIELD);
+    STREAM_CHECK((frameNum != configure.end() &&
+                  frameNum->is_number_integer() && *frameNum >= 1),
+                 "frames_num must be a positive integer, please check your "
+                 "posec3d element configuration file");
     mContext->max_batch = frameNum->get<int>();
+    // 缺省时窗口不重叠，与每frames_num帧识别一次的行为一致
+    mContext->window_stride = mContext->max_batch;
+    auto windowStrideIt = configure.find(CONFIG_INTERNAL_WINDOW_STRIDE_FIELD);
+    if (windowStrideIt != configure.end()) {
+      STREAM_CHECK(
+          (windowStrideIt->is_number_integer() && *windowStrideIt >= 1),
+          "window_stride must be a positive integer, please check your "
+          "posec3d element configuration file");
+      mContext->window_stride = windowStrideIt->get<int>();
+    }
     auto inputTensor = mContext->bmNetwork->inputTensor(0);
     mContext->input_num = mContext->bmNetwork->m_netinfo->input_num;
     mContext->m_net_crops_clips = inputTensor->get_shape()->dims[0];
@@ -129,11 +144,12 @@ common::ErrorCode Posec3d::initInternal(const std::string& json) {
   return errorCode;
 }
 
-void Posec3d::process(common::ObjectMetadatas& objectMetadatas) {
+void Posec3d::process(common::ObjectMetadatas& objectMetadatas,
+                      const framework::KeypointClip& clip) {
   common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
   // 预处理
   if (use_pre) {
-    errorCode = mPreProcess->preProcess(mContext, objectMetadatas);
+    errorCode = mPreProcess->preProcess(mContext, clip, objectMetadatas);
     if (common::ErrorCode::SUCCESS != errorCode) {
       for (unsigned i = 0; i < objectMetadatas.size(); i++) {
         objectMetadatas[i]->mErrorCode = errorCode;
@@ -167,71 +183,69 @@ common::ErrorCode Posec3d::doWork(int dataPipeId) {
     outputPort = outputPorts[0];
   }
 
-  common::ObjectMetadatas pendingObjectMetadatas;
-
-  if (use_pre) {
-    while (objectMetadatas.size() < mContext->max_batch &&
-           (getThreadStatus() == ThreadStatus::RUN)) {
-      // 如果队列为空则等待
-      auto data = popInputData(inputPort, dataPipeId);
-
-      if (!data) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        continue;
-      }
-      auto objectMetadata =
-          std::static_pointer_cast<common::ObjectMetadata>(data);
-      pendingObjectMetadatas.push_back(objectMetadata);
-      if (objectMetadata->mFrame->mEndOfStream) {
-        break;
-      }
-      if (!objectMetadata->mFilter) objectMetadatas.push_back(objectMetadata);
+  // 如果队列为空则等待
+  auto data = popInputData(inputPort, dataPipeId);
+  if (!data) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    return common::ErrorCode::SUCCESS;
+  }
+  auto objectMetadata = std::static_pointer_cast<common::ObjectMetadata>(data);
+  int channel_id_internal = objectMetadata->mFrame->mChannelIdInternal;
+
+  // 关键点进入按通道的滑动窗口，帧本身不再等待凑满frames_num帧，直接向下游发送；
+  // 窗口满足输出条件时，由当前这一帧携带整个clip的输入tensor
+  framework::KeypointClip clip;
+  if (objectMetadata->mFrame->mEndOfStream) {
+    if (use_pre) {
+      std::lock_guard<std::mutex> lock(mWindowMutex);
+      if (mWindow) mWindow->reset(channel_id_internal);
     }
-  } else {
-    while (pendingObjectMetadatas.size() < mContext->max_batch &&
-           (getThreadStatus() == ThreadStatus::RUN)) {
-      // 如果队列为空则等待
-      auto data = popInputData(inputPort, dataPipeId);
-
-      if (!data) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        continue;
-      }
-      auto objectMetadata =
-          std::static_pointer_cast<common::ObjectMetadata>(data);
-      pendingObjectMetadatas.push_back(objectMetadata);
-      if (objectMetadata->mFrame->mEndOfStream) {
-        break;
-      }
-      // all frame inputs are put into main objectMetadata, then the following
-      // infer and postprocess are based on main objectMetadata
-      if (!objectMetadata->mFilter && objectMetadata->is_main)
+    if (use_post) {
+      std::lock_guard<std::mutex> lock(mLabelMutex);
+      mLastLabels.erase(channel_id_internal);
+    }
+  } else if (!objectMetadata->mFilter) {
+    if (use_pre) {
+      auto frame =
+          framework::KeypointFrame::fromObjectMetadata(*objectMetadata);
+      std::lock_guard<std::mutex> lock(mWindowMutex);
+      if (!mWindow)
+        mWindow = std::make_shared<framework::KeypointWindow>(
+            mContext->max_batch, mContext->window_stride);
+      if (mWindow->push(channel_id_internal, std::move(frame), clip))
         objectMetadatas.push_back(objectMetadata);
+    } else if (objectMetadata->is_main) {
+      objectMetadatas.push_back(objectMetadata);
     }
   }
 
-  process(objectMetadatas);
-
-  if (use_post && objectMetadatas.size() > 0) {
-    // for all frames, they have the same action label
-    for (auto& objectMetadata : pendingObjectMetadatas)
-      objectMetadata->mRecognizedObjectMetadatas = objectMetadatas[0]->mRecognizedObjectMetadatas;
+  process(objectMetadatas, clip);
+
+  // 两次识别之间的帧沿用该通道最近一次的识别结果
+  if (use_post && !objectMetadata->mFrame->mEndOfStream) {
+    std::lock_guard<std::mutex> lock(mLabelMutex);
+    if (objectMetadatas.size() > 0)
+      mLastLabels[channel_id_internal] =
+          objectMetadata->mRecognizedObjectMetadatas;
+    else {
+      auto labelIt = mLastLabels.find(channel_id_internal);
+      if (labelIt != mLastLabels.end())
+        objectMetadata->mRecognizedObjectMetadatas = labelIt->second;
+    }
   }
 
-  for (auto& objectMetadata : pendingObjectMetadatas) {
-    int channel_id_internal = objectMetadata->mFrame->mChannelIdInternal;
-    int outDataPipeId =
-        getSinkElementFlag()
-            ? 0
-            : (channel_id_internal % getOutputConnectorCapacity(outputPort));
-    errorCode = pushOutputData(outputPort, outDataPipeId,
-                               std::static_pointer_cast<void>(objectMetadata));
-    if (common::ErrorCode::SUCCESS != errorCode) {
-      IVS_WARN(
-          "Send data fail, element id: {0:d}, output port: {1:d}, data: "
-          "{2:p}",
-          getId(), outputPort, static_cast<void*>(objectMetadata.get()));
-    }
+  int outDataPipeId =
+      getSinkElementFlag()
+          ? 0
+          : getOutputDataPipeId(outputPort, channel_id_internal,
+                                objectMetadata->mFrame->mEndOfStream);
+  errorCode = pushOutputData(outputPort, outDataPipeId,
+                             std::static_pointer_cast<void>(objectMetadata));
+  if (common::ErrorCode::SUCCESS != errorCode) {
+    IVS_WARN(
+        "Send data fail, element id: {0:d}, output port: {1:d}, data: "
+        "{2:p}",
+        getId(), outputPort, static_cast<void*>(objectMetadata.get()));
   }
   mFpsProfiler.add(objectMetadatas.size());
 
@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "posec3d_heatmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace sophon_stream {
+namespace element {
+namespace posec3d {
+
+void generatePoseHeatmap(const fpptr_dim3& sampled_keypoints,
+                         const fpptr_dim3& sampled_keypoint_scores, int height,
+                         int width, int num_keypoints, float input_scale,
+                         float* heatmap, int out_num, float sigma,
+                         float scaling, int clip_len) {
+  // gen an aug
+  const float eps = 1e-4;
+  int img_h = height, img_w = width;
+  // scale img_h, img_w and kps
+  img_h = int(img_h * scaling + 0.5);
+  img_w = int(img_w * scaling + 0.5);
+
+  int num_c = num_keypoints;
+  int num_frame = sampled_keypoints.size();
+  int plane = img_h * img_w;
+
+  // 多个clip重采样出的帧大多是同一输入帧的重复引用，每个输入帧只生成一次
+  std::unordered_map<const fpptr_dim2*, std::vector<int>> frame_slots;
+  std::vector<const fpptr_dim2*> frame_order;
+  for (int i = 0; i < num_frame; i++) {
+    auto& slots = frame_slots[sampled_keypoints[i].get()];
+    if (slots.empty()) frame_order.push_back(sampled_keypoints[i].get());
+    slots.push_back(i);
+  }
+
+  // 高斯核可分离：exp(-(dx^2+dy^2)/2s^2) = gx(dx) * gy(dy)，
+  // 每个关键点只需算一行一列的exp，再按外积与已有值取max
+  const float inv_two_sigma2 = 1.f / (2 * sigma * sigma);
+  // heatmap绝大部分为0，切片只记录被高斯核覆盖的区域，拷贝时只写这些像素
+  std::vector<float> slice(num_c * plane, 0.f);
+  std::vector<std::pair<int, int>> rows;  // (切片内偏移, 长度)
+  std::vector<float> kernel_x;
+  float* data = heatmap;
+  memset((void*)data, 0, out_num * sizeof(float));
+  int heatmap_start_indx = out_num / 2;
+  for (auto frame : frame_order) {
+    const auto& slots = frame_slots[frame];
+    const auto& persons = *sampled_keypoints[slots[0]];
+    const auto& person_scores = *sampled_keypoint_scores[slots[0]];
+    rows.clear();
+    for (int j = 0; j < num_c; j++) {
+      float* dst = slice.data() + j * plane;
+      for (int person_id = 0; person_id < persons.size(); person_id++) {
+        float score = person_scores[person_id]->at(j);
+        if (score < eps) continue;
+
+        float mu_x = persons[person_id]->at(j * 2) * scaling;
+        float mu_y = persons[person_id]->at(j * 2 + 1) * scaling;
+
+        int st_x = std::max(int(mu_x - 3 * sigma), 0);
+        int ed_x = std::min(int(mu_x + 3 * sigma) + 1, img_w);
+        int st_y = std::max(int(mu_y - 3 * sigma), 0);
+        int ed_y = std::min(int(mu_y + 3 * sigma) + 1, img_h);
+        if (st_x >= ed_x || st_y >= ed_y) continue;
+
+        int width = ed_x - st_x;
+        kernel_x.resize(width);
+        for (int k = 0; k < width; k++) {
+          float d = st_x + k - mu_x;
+          kernel_x[k] = std::exp(-d * d * inv_two_sigma2);
+        }
+        for (int patch_y = st_y; patch_y < ed_y; patch_y++) {
+          float d = patch_y - mu_y;
+          float weight =
+              std::exp(-d * d * inv_two_sigma2) * score * input_scale;
+          float* row = dst + patch_y * img_w + st_x;
+          for (int k = 0; k < width; k++)
+            row[k] = std::max(row[k], weight * kernel_x[k]);
+          rows.emplace_back(j * plane + patch_y * img_w + st_x, width);
+        }
+      }
+    }
+
+    // 前后两半写入相同的值，后半部分原本用于翻转增强
+    for (int i : slots) {
+      float* base = data + i / clip_len * num_c * clip_len * plane +
+                    i % clip_len * plane;
+      for (const auto& row : rows) {
+        int j = row.first / plane;
+        float* dst = base + j * clip_len * plane + row.first % plane;
+        memcpy(dst, slice.data() + row.first, row.second * sizeof(float));
+        memcpy(dst + heatmap_start_indx, slice.data() + row.first,
+               row.second * sizeof(float));
+      }
+    }
+    for (const auto& row : rows)
+      std::fill_n(slice.data() + row.first, row.second, 0.f);
+  }
+  /*
+  // original implement of the flipped half
+  if (j == 0)
+    *(base + heatmap_start_indx + patch_y * img_w + img_w - patch_x - 1) =
+        value;
+  else if (j % 2 == 0)
+    *(data + heatmap_start_indx + i / clip_len * num_c * clip_len * img_h *
+          img_w + (j - 1) * clip_len * img_h * img_w + i % clip_len * img_h *
+          img_w + patch_y * img_w + img_w - patch_x - 1) = value;
+  else if (j % 2 == 1)
+    *(data + heatmap_start_indx + i / clip_len * num_c * clip_len * img_h *
+          img_w + (j + 1) * clip_len * img_h * img_w + i % clip_len * img_h *
+          img_w + patch_y * img_w + img_w - patch_x - 1) = value;
+  */
+}
+
+}  // namespace posec3d
+}  // namespace element
+}  // namespace sophon_stream
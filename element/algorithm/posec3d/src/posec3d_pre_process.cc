@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 
 #include "common/logger.h"
@@ -74,14 +75,12 @@ common::ErrorCode Posec3dPreProcess::uniformSampleFrames(
 }
 
 common::ErrorCode Posec3dPreProcess::poseCompact(
-    common::ObjectMetadatas& objectMetadatas, fpptr_dim3& keypoints,
-    float padding, int threshold, std::vector<float>& hw_ratio,
-    std::vector<int>& new_shape, std::vector<float>& crop_quadruple,
-    bool allow_imgpad) {
+    int img_h, int img_w, fpptr_dim3& keypoints, float padding, int threshold,
+    std::vector<float>& hw_ratio, std::vector<int>& new_shape,
+    std::vector<float>& crop_quadruple, bool allow_imgpad) {
   float min_x = INT_MAX, min_y = INT_MAX, max_x = INT_MIN, max_y = INT_MIN;
   // NOTE: assert frame1.h == frame2.h, frame1.w == frame2.w, ...
-  int h = (*objectMetadatas[0]->mFrame->mSpData).height,
-      w = (*objectMetadatas[0]->mFrame->mSpData).width;
+  int h = img_h, w = img_w;
   new_shape.clear();
   new_shape.push_back(h);
   new_shape.push_back(w);
@@ -215,78 +214,13 @@ common::ErrorCode Posec3dPreProcess::centerCrop(
 }
 
 common::ErrorCode Posec3dPreProcess::generatePoseTarget(
-    std::shared_ptr<Posec3dContext> context, fpptr_dim3& keypoints,
-    fpptr_dim3& sampled_keypoints, fpptr_dim3& sampled_keypoint_scores,
-    std::vector<int>& new_shape, float* heatmap, int out_num, float sigma,
-    float scaling, int clip_len) {
-  // gen an aug
-  const float eps = 1e-4;
-  int img_h = new_shape[0], img_w = new_shape[1];
-  // scale img_h, img_w and kps
-  img_h = int(img_h * scaling + 0.5);
-  img_w = int(img_w * scaling + 0.5);
-
-  int num_c = context->m_net_keypoints;
-  int num_frame = sampled_keypoints.size();
-  for (auto& obj : keypoints) {
-    for (int j = 0; j < obj->size(); j++) {
-      for (int i = 0; i < obj->at(j)->size(); i += 2) {
-        obj->at(j)->at(i) *= scaling;
-        obj->at(j)->at(i + 1) *= scaling;
-      }
-    }
-  }
-
-  float* data = heatmap;
-  memset((void*)data, 0, out_num * sizeof(float));
-  int heatmap_start_indx = out_num / 2;
-  for (int i = 0; i < num_frame; i++) {
-    for (int j = 0; j < num_c; j++) {
-      for (int person_id = 0; person_id < sampled_keypoints[i]->size();
-           person_id++) {
-        if (sampled_keypoint_scores[i]->at(person_id)->at(j) < eps) continue;
-
-        float mu_x = sampled_keypoints[i]->at(person_id)->at(j * 2);
-        float mu_y = sampled_keypoints[i]->at(person_id)->at(j * 2 + 1);
-
-        int st_x = std::max(int(mu_x - 3 * sigma), 0);
-        int ed_x = std::min(int(mu_x + 3 * sigma) + 1, img_w);
-        int st_y = std::max(int(mu_y - 3 * sigma), 0);
-        int ed_y = std::min(int(mu_y + 3 * sigma) + 1, img_h);
-        if (st_x >= ed_x || st_y >= ed_y) continue;
-
-        float* base = data + i / clip_len * num_c * clip_len * img_h * img_w +
-                      j * clip_len * img_h * img_w +
-                      i % clip_len * img_h * img_w;
-        for (int patch_x = st_x; patch_x < ed_x; patch_x++)
-          for (int patch_y = st_y; patch_y < ed_y; patch_y++) {
-            float value = exp(-(std::pow(patch_x - mu_x, 2) +
-                                std::pow(patch_y - mu_y, 2)) /
-                              2 / std::pow(sigma, 2)) *
-                          sampled_keypoint_scores[i]->at(person_id)->at(j);
-            value *= context->input_scale;
-            if (value > *(base + patch_y * img_w + patch_x)) {
-              *(base + patch_y * img_w + patch_x) = value;
-              *(base + patch_y * img_w + patch_x + heatmap_start_indx) = value;
-              /*
-              // original implement
-              if (j == 0)
-                *(base + heatmap_start_indx + patch_y * img_w + img_w - patch_x
-              - 1) = value; else if (j % 2 == 0)
-                *(data + heatmap_start_indx + i / clip_len * num_c * clip_len *
-              img_h * img_w + (j - 1) * clip_len * img_h * img_w + i % clip_len
-              * img_h * img_w + patch_y * img_w + img_w - patch_x - 1) = value;
-              else if (j % 2 == 1)
-                *(data + heatmap_start_indx + i / clip_len * num_c * clip_len *
-              img_h * img_w + (j + 1) * clip_len * img_h * img_w + i % clip_len
-              * img_h * img_w + patch_y * img_w + img_w - patch_x - 1) = value;
-              */
-            }
-          }
-      }
-    }
-  }
-
+    std::shared_ptr<Posec3dContext> context, fpptr_dim3& sampled_keypoints,
+    fpptr_dim3& sampled_keypoint_scores, std::vector<int>& new_shape,
+    float* heatmap, int out_num, float sigma, float scaling, int clip_len) {
+  generatePoseHeatmap(sampled_keypoints, sampled_keypoint_scores, new_shape[0],
+                      new_shape[1], context->m_net_keypoints,
+                      context->input_scale, heatmap, out_num, sigma, scaling,
+                      clip_len);
   return common::ErrorCode::SUCCESS;
 }
 
@@ -329,24 +263,27 @@ void Posec3dPreProcess::initTensors(std::shared_ptr<Posec3dContext> context,
 
 common::ErrorCode Posec3dPreProcess::preProcess(
     std::shared_ptr<Posec3dContext> context,
+    const framework::KeypointClip& clip,
     common::ObjectMetadatas& objectMetadatas) {
-  if (objectMetadatas.size() == 0) return common::ErrorCode::SUCCESS;
+  if (objectMetadatas.size() == 0 || clip.empty())
+    return common::ErrorCode::SUCCESS;
   initTensors(context, objectMetadatas);
 
   fpptr_dim3 keypoints;
   fpptr_dim3 keypoint_scores;
   fpptr_dim3 sampled_keypoints;
   fpptr_dim3 sampled_keypoint_scores;
-  for (auto& obj : objectMetadatas) {
+  // 后续变换会原地修改关键点，窗口里的帧可能还被下一个clip用到，这里拷贝一份
+  for (auto& frame : clip) {
     std::shared_ptr<fpptr_dim2> single_person_keypoints =
         std::make_shared<fpptr_dim2>();
     std::shared_ptr<fpptr_dim2> single_person_keypoint_scores =
         std::make_shared<fpptr_dim2>();
-    for (auto& poseObj : obj->mPosedObjectMetadatas) {
+    for (std::size_t i = 0; i < frame->keypoints.size(); i++) {
       single_person_keypoints->push_back(
-          std::make_shared<std::vector<float>>(poseObj->keypoints));
+          std::make_shared<std::vector<float>>(frame->keypoints[i]));
       single_person_keypoint_scores->push_back(
-          std::make_shared<std::vector<float>>(poseObj->scores));
+          std::make_shared<std::vector<float>>(frame->scores[i]));
     }
     keypoints.push_back(single_person_keypoints);
     keypoint_scores.push_back(single_person_keypoint_scores);
@@ -363,8 +300,8 @@ common::ErrorCode Posec3dPreProcess::preProcess(
   std::vector<float> crop_quadruple = {0, 0, 1, 1};
 
   // rescale anf shift keypoints
-  poseCompact(objectMetadatas, keypoints, 0.25, 10, hw_ratio, new_shape,
-              crop_quadruple, true);
+  poseCompact(clip[0]->height, clip[0]->width, keypoints, 0.25, 10, hw_ratio,
+              new_shape, crop_quadruple, true);
   std::vector<int> scale = {INT_MAX, 64};
   resize(keypoints, scale, new_shape, true);
   std::vector<int> crop_size = {64, 64};
@@ -393,9 +330,8 @@ common::ErrorCode Posec3dPreProcess::preProcess(
     heatmap = objectMetadatas[0]->mInputBMtensors->cpu_data[0];
   } else
     heatmap = new float[out_num];
-  generatePoseTarget(context, keypoints, sampled_keypoints,
-                     sampled_keypoint_scores, new_shape, heatmap, out_num, 0.6,
-                     1.0, clip_len);
+  generatePoseTarget(context, sampled_keypoints, sampled_keypoint_scores,
+                     new_shape, heatmap, out_num, 0.6, 1.0, clip_len);
 
   if (context->bmNetwork->is_soc)
     assert(BM_SUCCESS ==
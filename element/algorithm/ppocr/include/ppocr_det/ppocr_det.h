@@ -45,6 +45,8 @@ class Ppocr_det : public ::sophon_stream::framework::Element {
    */
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
   void setPreprocess(std::shared_ptr<::sophon_stream::element::PreProcess> pre);
   void setInference(std::shared_ptr<::sophon_stream::element::Inference> infer);
@@ -10,8 +10,11 @@
 #ifndef SOPHON_STREAM_ELEMENT_PPOCR_REC_H_
 #define SOPHON_STREAM_ELEMENT_PPOCR_REC_H_
 
+#include <mutex>
+
 #include "element_factory.h"
 #include "group.h"
+#include "micro_batcher.h"
 #include "ppocr_rec_context.h"
 #include "ppocr_rec_inference.h"
 #include "ppocr_rec_post_process.h"
@@ -45,6 +48,8 @@ class PpocrRec : public ::sophon_stream::framework::Element {
    */
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
   void setPreprocess(std::shared_ptr<::sophon_stream::element::PreProcess> pre);
   void setInference(std::shared_ptr<::sophon_stream::element::Inference> infer);
@@ -70,6 +75,8 @@ class PpocrRec : public ::sophon_stream::framework::Element {
    */
   static constexpr const char* CONFIG_INTERNAL_STAGE_NAME_FIELD = "stage";
   static constexpr const char* CONFIG_INTERNAL_MODEL_PATH_FIELD = "model_path";
+  static constexpr const char* CONFIG_INTERNAL_BATCH_TIMEOUT_MS_FIELD =
+      "batch_timeout_ms";
   static constexpr const char* CONFIG_INTERNAL_BEAM_SEARCH_FIELD =
       "beam_search";
   static constexpr const char* CONFIG_INTERNAL_BEAM_WIDTH_FIELD = "beam_width";
@@ -89,6 +96,12 @@ class PpocrRec : public ::sophon_stream::framework::Element {
   std::string mFpsProfilerName;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
 
+  // 所有dataPipe共享，跨通道凑batch
+  std::shared_ptr<framework::MicroBatcher> mBatcher;
+  std::once_flag mBatcherFlag;
+  // 每隔多少个batch打印一次平均batch占用率
+  static constexpr int kBatchStatInterval = 1000;
+
   common::ErrorCode initContext(const std::string& json);
   void process(common::ObjectMetadatas& objectMetadatas);
 };
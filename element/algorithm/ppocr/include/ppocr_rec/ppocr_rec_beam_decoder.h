@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_PPOCR_REC_BEAM_DECODER_H_
+#define SOPHON_STREAM_ELEMENT_PPOCR_REC_BEAM_DECODER_H_
+
+#include <vector>
+
+namespace sophon_stream {
+namespace element {
+namespace ppocr_rec {
+
+/**
+ * @brief CTC前缀beam search解码器，类别0为blank
+ * @brief 每个时间步只对概率最大的beamWidth个类别扩展，用单遍扫描取top-k，
+ * 不对整行词表排序；概率在log域累加；折叠后相同的前缀合并为一个beam
+ * @brief 内部缓冲按最大长度预分配，同一个解码器可以重复解码多行，
+ * 不是线程安全的，每个线程各用一个
+ */
+class CtcBeamDecoder {
+ public:
+  CtcBeamDecoder(int beamWidth, int numClasses);
+
+  /**
+   * @brief 解码一行softmax输出
+   * @param probs timeSteps * numClasses的概率矩阵
+   * @param labels 输出折叠后的类别序列，不含blank
+   * @param confs 输出每个类别首次出现时的概率，与labels一一对应
+   */
+  void decode(const float* probs, int timeSteps, std::vector<int>& labels,
+              std::vector<float>& confs);
+
+ private:
+  // 前缀树节点，一个节点唯一表示一个折叠后的前缀
+  struct Node {
+    int parent;
+    int label;
+    float conf;
+  };
+
+  // 当前保留的beam，pb/pnb为以blank/非blank结尾的log概率
+  struct Beam {
+    int node;
+    float pb;
+    float pnb;
+  };
+
+  // 下一时间步的候选：node >= 0为已有前缀，否则为parent扩展label得到的新前缀
+  struct Candidate {
+    int node;
+    int parent;
+    int label;
+    float conf;
+    float pb;
+    float pnb;
+    float total;
+  };
+
+  void topK(const float* row);
+
+  int mBeamWidth;
+  int mNumClasses;
+
+  std::vector<Node> mNodes;
+  std::vector<Beam> mBeams;
+  std::vector<Candidate> mCandidates;
+  std::vector<int> mOrder;
+  // 每个beam的父前缀在mBeams中的下标，不在beam中为-1
+  std::vector<int> mParentSlot;
+  // 是否有其它beam以该beam为父前缀
+  std::vector<char> mHasChild;
+  std::vector<int> mTopLabels;
+  std::vector<float> mTopProbs;
+};
+
+}  // namespace ppocr_rec
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_PPOCR_REC_BEAM_DECODER_H_
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_PPOCR_REC_BUCKETS_H_
+#define SOPHON_STREAM_ELEMENT_PPOCR_REC_BUCKETS_H_
+
+#include <utility>
+#include <vector>
+
+namespace sophon_stream {
+namespace element {
+namespace ppocr_rec {
+
+struct RecModelSize {
+  int w;
+  int h;
+};
+
+/**
+ * @brief 识别模型一个stage的输入batch和宽度
+ */
+struct RecStageShape {
+  int batch;
+  int width;
+};
+
+/**
+ * @brief 按宽高比选能放下文字框的最窄的stage宽度，都放不下时选最宽的
+ * @param img_size 按宽度升序排列的stage尺寸
+ * @param img_ratio 与img_size对应的宽高比
+ * @param resize_w 输出文字框缩放后的宽度，放不下时为最宽stage的宽度
+ * @return 选中的img_size下标
+ */
+int pickWidthBucket(const std::vector<RecModelSize>& img_size,
+                    const std::vector<float>& img_ratio, int w, int h,
+                    int& resize_w);
+
+/**
+ * @brief 在输入宽度为width的stage中，选batch不小于count的最小stage；
+ * 都不够时选该宽度batch最大的stage
+ */
+int pickStage(const std::vector<RecStageShape>& stages, int width, int count);
+
+/**
+ * @brief 把一个宽度桶里的count个文字框切成若干次推理
+ * @param chunks 输出每次推理的(stage, 文字框个数)，按顺序覆盖全部文字框
+ */
+void splitBucket(const std::vector<RecStageShape>& stages, int width,
+                 int count, std::vector<std::pair<int, int>>& chunks);
+
+}  // namespace ppocr_rec
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_PPOCR_REC_BUCKETS_H_
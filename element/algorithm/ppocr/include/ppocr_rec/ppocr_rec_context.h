@@ -10,7 +10,11 @@
 #ifndef SOPHON_STREAM_ELEMENT_PPOCR_REC_CONTEXT_H_
 #define SOPHON_STREAM_ELEMENT_PPOCR_REC_CONTEXT_H_
 
+#include <atomic>
+#include <cstdint>
+
 #include "algorithmApi/context.h"
+#include "ppocr_rec_buckets.h"
 
 namespace sophon_stream {
 namespace element {
@@ -18,11 +22,6 @@ namespace ppocr_rec {
 
 #define USE_ASPECT_RATIO 1
 
-struct RecModelSize {
-  int w;
-  int h;
-};
-
 class PpocrRecContext : public ::sophon_stream::element::Context {
  public:
   int deviceId;  // 设备ID
@@ -33,6 +32,7 @@ class PpocrRecContext : public ::sophon_stream::element::Context {
 
   int net_h, net_w, m_net_channel;
   int max_batch;
+  int batch_timeout_ms = 10;  // 跨通道凑batch的最长等待时间
   int input_num;
   int output_num;
   bmcv_convert_to_attr converto_attr;
@@ -48,6 +48,13 @@ class PpocrRecContext : public ::sophon_stream::element::Context {
    * @brief ppocr network stage ratios, ratio = w / h
    */
   std::vector<float> img_ratio;
+
+  /**
+   * @brief 宽度分桶的padding统计：文字框缩放后的有效列数与实际推理的列数，
+   * 后者包含桶内右侧padding和batch中空位
+   */
+  std::atomic<std::uint64_t> valid_columns{0};
+  std::atomic<std::uint64_t> total_columns{0};
 };
 }  // namespace ppocr_rec
 }  // namespace element
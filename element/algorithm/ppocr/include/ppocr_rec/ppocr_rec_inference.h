@@ -31,6 +31,15 @@ class PpocrRecInference : public ::sophon_stream::element::Inference {
    */
   common::ErrorCode predict(std::shared_ptr<PpocrRecContext> context,
                             common::ObjectMetadatas& objectMetadatas);
+
+ private:
+  /**
+   * @brief 把objectMetadatas中indices指向的文字框按stage的shape拼成一个batch推理，
+   * 输出按stage的输出shape拆回各自的ObjectMetadata
+   */
+  void forwardBatch(std::shared_ptr<PpocrRecContext> context,
+                    common::ObjectMetadatas& objectMetadatas,
+                    const int* indices, int count, int stage);
 };
 
 }  // namespace ppocr_rec
@@ -13,27 +13,13 @@
 #include <numeric>
 
 #include "algorithmApi/post_process.h"
+#include "ppocr_rec_beam_decoder.h"
 #include "ppocr_rec_context.h"
 
 namespace sophon_stream {
 namespace element {
 namespace ppocr_rec {
 
-// get recognition results.
-struct BeamSearchCandidate {
-  std::vector<int> prefix;
-  float score;
-  std::vector<float> confs;
-  BeamSearchCandidate() : score(0.0f) {}
-  BeamSearchCandidate(const std::vector<int>& pref, float scr,
-                      const std::vector<float>& cfs)
-      : prefix(pref), score(scr), confs(cfs) {}
-
-  bool operator<(const BeamSearchCandidate& other) const {
-    return score < other.score;
-  }
-};
-
 class PpocrRecPostProcess : public ::sophon_stream::element::PostProcess {
  public:
   void init(std::shared_ptr<PpocrRecContext> context);
@@ -41,9 +41,10 @@ namespace ppocr_det {
     assert(mContext->stdd.size() == 3);
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(mContext->deviceId);
+    mContext->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
     mContext->bmNetwork = mContext->bmContext->network(0);
     mContext->handle = handle->handle();
 
@@ -190,7 +191,8 @@ namespace ppocr_det {
       int outDataPipeId =
           getSinkElementFlag()
               ? 0
-              : (channel_id_internal % getOutputConnectorCapacity(outputPort));
+              : getOutputDataPipeId(outputPort, channel_id_internal,
+                                    objectMetadata->mFrame->mEndOfStream);
       errorCode =
           pushOutputData(outputPort, outDataPipeId,
                          std::static_pointer_cast<void>(objectMetadata));
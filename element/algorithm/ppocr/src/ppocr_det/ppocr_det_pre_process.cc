@@ -31,7 +31,7 @@ common::ErrorCode Ppocr_detPreProcess::preProcess(
     std::shared_ptr<Ppocr_detContext> context,
     common::ObjectMetadatas& objectMetadatas) {
   if (objectMetadatas.size() == 0) return common::ErrorCode::SUCCESS;
-  initTensors(context, objectMetadatas);
+  initBatchTensors(context, objectMetadatas);
 
   auto jsonPlanner = context->bgr2rgb ? FORMAT_RGB_PLANAR : FORMAT_BGR_PLANAR;
   int i = 0;
@@ -136,7 +136,8 @@ common::ErrorCode Ppocr_detPreProcess::preProcess(
     bm_device_mem_t mem;
     int size_byte = 0;
     bm_image_get_byte_size(converto_img, &size_byte);
-    ret = bm_malloc_device_byte_heap(context->handle, &mem, STREAM_NPU_HEAP, size_byte);
+    // max_batch > 1时直接写进连续batch输入中该目标的槽位
+    ret = acquireInputMem(context, objectMetadatas[i], size_byte, &mem);
     STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
     bm_image_attach(converto_img, &mem);
 
@@ -33,14 +33,23 @@ common::ErrorCode PpocrRec::initContext(const std::string& json) {
     auto modelPathIt = configure.find(CONFIG_INTERNAL_MODEL_PATH_FIELD);
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(mContext->deviceId);
+    mContext->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
     mContext->bmNetwork = mContext->bmContext->network(0);
     mContext->handle = handle->handle();
 
     // 2. get input
     mContext->max_batch = mContext->bmNetwork->maxBatch();
+    auto batchTimeoutIt =
+        configure.find(CONFIG_INTERNAL_BATCH_TIMEOUT_MS_FIELD);
+    if (configure.end() != batchTimeoutIt) {
+      STREAM_CHECK(batchTimeoutIt->is_number_integer() && *batchTimeoutIt >= 0,
+                   "batch_timeout_ms must be a non-negative integer, please "
+                   "check your element configuration file");
+      mContext->batch_timeout_ms = batchTimeoutIt->get<int>();
+    }
     auto inputTensor = mContext->bmNetwork->inputTensor(0);
     mContext->m_net_channel = inputTensor->get_shape()->dims[1];
     mContext->net_h = inputTensor->get_shape()->dims[2];
@@ -69,8 +78,10 @@ common::ErrorCode PpocrRec::initContext(const std::string& json) {
                  "beam_size out of range, should be integer in range(1, 41)");
     int pre_net_h = -1;
     for (int i = 0; i < mContext->bmNetwork->m_netinfo->stage_num; i++) {
-      auto tensor = mContext->bmNetwork->inputTensor(0);
-      int net_h_ = tensor->get_shape()->dims[2];
+      // 每个stage的输入宽度对应一个分桶
+      const bm_shape_t& shape =
+          mContext->bmNetwork->m_netinfo->stages[i].input_shapes[0];
+      int net_h_ = shape.dims[2];
       if (pre_net_h == -1) {
         pre_net_h = net_h_;
       } else {
@@ -79,7 +90,7 @@ common::ErrorCode PpocrRec::initContext(const std::string& json) {
             "Invalid model size! All Stage's height must be identical.");
       }
 
-      int net_w_ = tensor->get_shape()->dims[3];
+      int net_w_ = shape.dims[3];
       bool skip_flag = false;
       for (auto& tmp_size : mContext->img_size) {
         if (tmp_size.w == net_w_) {
@@ -196,7 +207,6 @@ void PpocrRec::process(common::ObjectMetadatas& objectMetadatas) {
 common::ErrorCode PpocrRec::doWork(int dataPipeId) {
   common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
 
-  common::ObjectMetadatas objectMetadatas;
   std::vector<int> inputPorts = getInputPorts();
   int inputPort = inputPorts[0];
   int outputPort = 0;
@@ -205,36 +215,45 @@ common::ErrorCode PpocrRec::doWork(int dataPipeId) {
     outputPort = outputPorts[0];
   }
 
-  common::ObjectMetadatas pendingObjectMetadatas;
+  // group中只有pre element会调用initInternal，batcher在第一次doWork时创建
+  std::call_once(mBatcherFlag, [this] {
+    mBatcher = std::make_shared<framework::MicroBatcher>(
+        mContext->max_batch, mContext->batch_timeout_ms, kBatchStatInterval);
+  });
 
-  while (objectMetadatas.size() < mContext->max_batch &&
-         (getThreadStatus() == ThreadStatus::RUN)) {
-    // 如果队列为空则等待
+  // 本dataPipe中的数据先放进所有dataPipe共享的batcher，每次最多取max_batch个
+  bool popped = false;
+  for (int i = 0; i < mContext->max_batch; ++i) {
     auto data = popInputData(inputPort, dataPipeId);
-    if (!data) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      continue;
-    }
-
-    auto objectMetadata =
-        std::static_pointer_cast<common::ObjectMetadata>(data);
-    if (!objectMetadata->mFilter) objectMetadatas.push_back(objectMetadata);
-
-    pendingObjectMetadatas.push_back(objectMetadata);
+    if (!data) break;
+    mBatcher->push(std::static_pointer_cast<common::ObjectMetadata>(data));
+    popped = true;
+  }
 
-    if (objectMetadata->mFrame->mEndOfStream) {
-      break;
-    }
+  common::ObjectMetadatas pendingObjectMetadatas;
+  common::ObjectMetadatas objectMetadatas;
+  std::uint64_t ticket = 0;
+  bool logStats = false;
+  if (!mBatcher->pop(pendingObjectMetadatas, objectMetadatas, ticket, logStats,
+                     getThreadStatus() != ThreadStatus::RUN)) {
+    // 如果队列为空则等待；batcher中有数据时缩短等待，尽快检查是否超时
+    if (!popped)
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(mBatcher->size() > 0 ? 1 : 10));
+    return common::ErrorCode::SUCCESS;
   }
 
   process(objectMetadatas);
 
+  // 按batch序号依次发送，保证同一通道的数据顺序不变
+  mBatcher->waitTurn(ticket);
   for (auto& objectMetadata : pendingObjectMetadatas) {
     int channel_id_internal = objectMetadata->mFrame->mChannelIdInternal;
     int outDataPipeId =
         getSinkElementFlag()
             ? 0
-            : (channel_id_internal % getOutputConnectorCapacity(outputPort));
+            : getOutputDataPipeId(outputPort, channel_id_internal,
+                                  objectMetadata->mFrame->mEndOfStream);
     errorCode = pushOutputData(outputPort, outDataPipeId,
                                std::static_pointer_cast<void>(objectMetadata));
     if (common::ErrorCode::SUCCESS != errorCode) {
@@ -244,8 +263,20 @@ common::ErrorCode PpocrRec::doWork(int dataPipeId) {
           getId(), outputPort, static_cast<void*>(objectMetadata.get()));
     }
   }
+  mBatcher->finish(ticket);
   mFpsProfiler.add(objectMetadatas.size());
 
+  if (logStats) {
+    std::uint64_t total = mContext->total_columns;
+    double waste =
+        total == 0 ? 0. : 1. - double(mContext->valid_columns) / total;
+    IVS_INFO(
+        "Element id: {0:d}, batches: {1:d}, objects: {2:d}, average batch "
+        "occupancy: {3:.3f}, width padding waste: {4:.3f}",
+        getId(), mBatcher->getBatches(), mBatcher->getObjects(),
+        mBatcher->getOccupancy(), waste);
+  }
+
   return common::ErrorCode::SUCCESS;
 }
 
@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ppocr_rec_beam_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include "common/common_defs.h"
+
+namespace sophon_stream {
+namespace element {
+namespace ppocr_rec {
+
+namespace {
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+
+inline float logAdd(float a, float b) {
+  if (a < b) std::swap(a, b);
+  if (b == kNegInf) return a;
+  return a + std::log1p(std::exp(b - a));
+}
+
+}  // namespace
+
+CtcBeamDecoder::CtcBeamDecoder(int beamWidth, int numClasses)
+    : mBeamWidth(beamWidth), mNumClasses(numClasses) {
+  STREAM_CHECK(beamWidth > 0, "beam width must be positive, got ",
+               std::to_string(beamWidth));
+  STREAM_CHECK(numClasses > 0, "class number must be positive, got ",
+               std::to_string(numClasses));
+  int k = std::min(beamWidth, numClasses);
+  mBeams.reserve(beamWidth);
+  mCandidates.reserve(beamWidth * (k + 1));
+  mOrder.reserve(beamWidth * (k + 1));
+  mParentSlot.reserve(beamWidth);
+  mHasChild.reserve(beamWidth);
+  mTopLabels.resize(k);
+  mTopProbs.resize(k);
+}
+
+void CtcBeamDecoder::topK(const float* row) {
+  // 单遍扫描维护一个降序的小数组，只有超过当前第k大的值才插入
+  int k = mTopLabels.size();
+  int n = 0;
+  for (int c = 0; c < mNumClasses; ++c) {
+    float p = row[c];
+    if (n == k && p <= mTopProbs[k - 1]) continue;
+    int pos = n < k ? n++ : k - 1;
+    while (pos > 0 && mTopProbs[pos - 1] < p) {
+      mTopProbs[pos] = mTopProbs[pos - 1];
+      mTopLabels[pos] = mTopLabels[pos - 1];
+      --pos;
+    }
+    mTopProbs[pos] = p;
+    mTopLabels[pos] = c;
+  }
+}
+
+void CtcBeamDecoder::decode(const float* probs, int timeSteps,
+                            std::vector<int>& labels,
+                            std::vector<float>& confs) {
+  labels.clear();
+  confs.clear();
+  // 每步最多新增beamWidth个节点
+  mNodes.clear();
+  mNodes.reserve(static_cast<std::size_t>(timeSteps) * mBeamWidth + 1);
+  mNodes.push_back({-1, 0, 0.f});
+  mBeams.clear();
+  mBeams.push_back({0, 0.f, kNegInf});
+
+  for (int t = 0; t < timeSteps; ++t) {
+    const float* row = probs + static_cast<std::size_t>(t) * mNumClasses;
+    topK(row);
+    const float logBlank = std::log(row[0]);
+    const int beamNum = mBeams.size();
+
+    // 前beamNum个候选是已有前缀本身：补一个blank或重复最后一个字符
+    mCandidates.clear();
+    for (const Beam& beam : mBeams) {
+      const Node& node = mNodes[beam.node];
+      float total = logAdd(beam.pb, beam.pnb);
+      float pnb =
+          beam.node == 0 ? kNegInf : beam.pnb + std::log(row[node.label]);
+      mCandidates.push_back(
+          {beam.node, node.parent, node.label, node.conf, total + logBlank,
+           pnb, 0.f});
+    }
+
+    // 已有前缀恰好是另一个beam扩展一个字符得到的，合并到同一个候选
+    mParentSlot.assign(beamNum, -1);
+    mHasChild.assign(beamNum, 0);
+    for (int i = 0; i < beamNum; ++i) {
+      int parent = mNodes[mBeams[i].node].parent;
+      if (parent < 0) continue;
+      for (int j = 0; j < beamNum; ++j) {
+        if (mBeams[j].node != parent) continue;
+        mParentSlot[i] = j;
+        mHasChild[j] = 1;
+        const Beam& from = mBeams[j];
+        int label = mNodes[mBeams[i].node].label;
+        float logP = std::log(row[label]);
+        float add = (from.node != 0 && mNodes[from.node].label == label)
+                        ? from.pb + logP
+                        : logAdd(from.pb, from.pnb) + logP;
+        mCandidates[i].pnb = logAdd(mCandidates[i].pnb, add);
+        break;
+      }
+    }
+
+    // 用top-k字符扩展出新前缀
+    for (int j = 0; j < beamNum; ++j) {
+      const Beam& beam = mBeams[j];
+      int last = beam.node == 0 ? -1 : mNodes[beam.node].label;
+      float total = logAdd(beam.pb, beam.pnb);
+      for (std::size_t k = 0; k < mTopLabels.size(); ++k) {
+        int label = mTopLabels[k];
+        if (label == 0) continue;
+        bool merged = false;
+        for (int i = 0; i < beamNum && mHasChild[j] && !merged; ++i)
+          merged =
+              mParentSlot[i] == j && mNodes[mBeams[i].node].label == label;
+        if (merged) continue;
+        float logP = std::log(mTopProbs[k]);
+        float pnb = label == last ? beam.pb + logP : total + logP;
+        mCandidates.push_back(
+            {-1, beam.node, label, mTopProbs[k], kNegInf, pnb, 0.f});
+      }
+    }
+
+    for (Candidate& cand : mCandidates) cand.total = logAdd(cand.pb, cand.pnb);
+
+    mOrder.resize(mCandidates.size());
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+    auto better = [this](int a, int b) {
+      return mCandidates[a].total > mCandidates[b].total;
+    };
+    if (static_cast<int>(mOrder.size()) > mBeamWidth) {
+      std::nth_element(mOrder.begin(), mOrder.begin() + mBeamWidth,
+                       mOrder.end(), better);
+      mOrder.resize(mBeamWidth);
+    }
+    std::sort(mOrder.begin(), mOrder.end(), better);
+
+    // 只给留下来的新前缀分配节点
+    mBeams.clear();
+    for (int idx : mOrder) {
+      const Candidate& cand = mCandidates[idx];
+      int node = cand.node;
+      if (node < 0) {
+        node = mNodes.size();
+        mNodes.push_back({cand.parent, cand.label, cand.conf});
+      }
+      mBeams.push_back({node, cand.pb, cand.pnb});
+    }
+  }
+
+  for (int node = mBeams[0].node; node > 0; node = mNodes[node].parent) {
+    labels.push_back(mNodes[node].label);
+    confs.push_back(mNodes[node].conf);
+  }
+  std::reverse(labels.begin(), labels.end());
+  std::reverse(confs.begin(), confs.end());
+}
+
+}  // namespace ppocr_rec
+}  // namespace element
+}  // namespace sophon_stream
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ppocr_rec_buckets.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/common_defs.h"
+
+namespace sophon_stream {
+namespace element {
+namespace ppocr_rec {
+
+int pickWidthBucket(const std::vector<RecModelSize>& img_size,
+                    const std::vector<float>& img_ratio, int w, int h,
+                    int& resize_w) {
+  float ratio = w / float(h);
+  int bucket = img_size.size() - 1;
+  resize_w = img_size[bucket].w;
+  for (int i = 0; i < static_cast<int>(img_ratio.size()); i++) {
+    if (ratio <= img_ratio[i]) {
+      bucket = i;
+      resize_w = (int)(img_size[i].h * ratio);
+      break;
+    }
+  }
+  return bucket;
+}
+
+int pickStage(const std::vector<RecStageShape>& stages, int width, int count) {
+  int fit = -1;
+  int largest = -1;
+  for (int s = 0; s < static_cast<int>(stages.size()); ++s) {
+    if (stages[s].width != width) continue;
+    int batch = stages[s].batch;
+    if (batch >= count && (fit < 0 || batch < stages[fit].batch)) fit = s;
+    if (largest < 0 || batch > stages[largest].batch) largest = s;
+  }
+  STREAM_CHECK(largest >= 0, "No stage of the recognition model has width ",
+               std::to_string(width));
+  return fit >= 0 ? fit : largest;
+}
+
+void splitBucket(const std::vector<RecStageShape>& stages, int width,
+                 int count, std::vector<std::pair<int, int>>& chunks) {
+  chunks.clear();
+  int start = 0;
+  while (start < count) {
+    int rest = count - start;
+    int stage = pickStage(stages, width, rest);
+    int n = std::min(rest, stages[stage].batch);
+    chunks.emplace_back(stage, n);
+    start += n;
+  }
+}
+
+}  // namespace ppocr_rec
+}  // namespace element
+}  // namespace sophon_stream
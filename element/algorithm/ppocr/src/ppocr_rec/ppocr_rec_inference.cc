@@ -9,10 +9,22 @@
 
 #include "ppocr_rec_inference.h"
 
+#include <algorithm>
+#include <map>
+
 namespace sophon_stream {
 namespace element {
 namespace ppocr_rec {
 
+namespace {
+
+// 一个样本(去掉batch维)占用的字节数
+std::size_t sampleBytes(const bm_shape_t& shape, bm_data_type_t dtype) {
+  return bmrt_shape_count(&shape) / shape.dims[0] * bmrt_data_type_size(dtype);
+}
+
+}  // namespace
+
 PpocrRecInference::~PpocrRecInference() {}
 
 void PpocrRecInference::init(std::shared_ptr<PpocrRecContext> context) {}
@@ -22,25 +34,112 @@ common::ErrorCode PpocrRecInference::predict(
     common::ObjectMetadatas& objectMetadatas) {
   if (objectMetadatas.size() == 0) return common::ErrorCode::SUCCESS;
 
-  if (context->max_batch > 1) {
-    auto inputTensors = mergeInputDeviceMem(context, objectMetadatas);
-    auto outputTensors = getOutputDeviceMem(context);
+  // 预处理已按宽高比把文字框分到各stage宽度的桶里，每个桶单独组batch，
+  // 窄的文字框不再和宽的一起padding到最宽的stage；
+  // objectMetadatas的顺序不变，结果直接写回各自的ObjectMetadata
+  std::map<int, std::vector<int>> buckets;
+  for (int i = 0; i < objectMetadatas.size(); ++i) {
+    if (objectMetadatas[i]->mFrame->mEndOfStream) break;
+    int width = objectMetadatas[i]->mInputBMtensors->tensors[0]->shape.dims[3];
+    buckets[width].push_back(i);
+  }
 
-    int ret = 0;
-    ret = context->bmNetwork->forward(inputTensors->tensors,
-                                      outputTensors->tensors);
+  auto netinfo = context->bmNetwork->m_netinfo;
+  std::vector<RecStageShape> stages(netinfo->stage_num);
+  for (int s = 0; s < netinfo->stage_num; ++s) {
+    stages[s].batch = netinfo->stages[s].input_shapes[0].dims[0];
+    stages[s].width = netinfo->stages[s].input_shapes[0].dims[3];
+  }
 
-    splitOutputMemIntoObjectMetadatas(context, objectMetadatas, outputTensors);
-  } else {
-    objectMetadatas[0]->mOutputBMtensors = getOutputDeviceMem(context);
-    int ret = context->bmNetwork->forward(
-        objectMetadatas[0]->mInputBMtensors->tensors,
-        objectMetadatas[0]->mOutputBMtensors->tensors);
+  std::vector<std::pair<int, int>> chunks;
+  for (auto& bucket : buckets) {
+    const int* indices = bucket.second.data();
+    splitBucket(stages, bucket.first, bucket.second.size(), chunks);
+    for (auto& chunk : chunks) {
+      forwardBatch(context, objectMetadatas, indices, chunk.second,
+                   chunk.first);
+      indices += chunk.second;
+    }
   }
 
   return common::ErrorCode::SUCCESS;
 }
 
+void PpocrRecInference::forwardBatch(std::shared_ptr<PpocrRecContext> context,
+                                     common::ObjectMetadatas& objectMetadatas,
+                                     const int* indices, int count,
+                                     int stage) {
+  auto netinfo = context->bmNetwork->m_netinfo;
+  auto pool = context->bmNetwork->tensorPool();
+  const bm_stage_info_t& stageInfo = netinfo->stages[stage];
+  int stage_batch = stageInfo.input_shapes[0].dims[0];
+  int stage_w = stageInfo.input_shapes[0].dims[3];
+  context->total_columns += static_cast<std::uint64_t>(stage_batch) * stage_w;
+
+  // batch为1的stage直接用预处理的显存，否则按stage的shape拼接
+  std::shared_ptr<common::bmTensors> inputTensors;
+  if (stage_batch == 1) {
+    inputTensors = objectMetadatas[indices[0]]->mInputBMtensors;
+  } else {
+    inputTensors = pool->makeTensors(context->handle, context->input_num);
+    for (int i = 0; i < context->input_num; ++i) {
+      auto& tensor = inputTensors->tensors[i];
+      tensor->dtype = netinfo->input_dtypes[i];
+      tensor->shape = stageInfo.input_shapes[i];
+      tensor->st_mode = BM_STORE_1N;
+      std::size_t bytes = sampleBytes(tensor->shape, tensor->dtype);
+      bool ok = pool->acquire(bytes * stage_batch, &tensor->device_mem);
+      STREAM_CHECK(ok, "Alloc Device Memory Failed! Program Terminated.")
+      for (int k = 0; k < count; ++k) {
+        auto& objTensors = objectMetadatas[indices[k]]->mInputBMtensors;
+        bm_memcpy_d2d_byte(inputTensors->handle, tensor->device_mem,
+                           k * bytes, objTensors->tensors[i]->device_mem, 0,
+                           bytes);
+      }
+    }
+  }
+
+  auto outputTensors = pool->makeTensors(context->handle, context->output_num);
+  for (int i = 0; i < context->output_num; ++i) {
+    auto& tensor = outputTensors->tensors[i];
+    tensor->dtype = netinfo->output_dtypes[i];
+    tensor->shape = stageInfo.output_shapes[i];
+    tensor->st_mode = BM_STORE_1N;
+    bool ok = pool->acquire(
+        sampleBytes(tensor->shape, tensor->dtype) * stage_batch,
+        &tensor->device_mem);
+    STREAM_CHECK(ok, "Alloc Device Memory Failed! Program Terminated.")
+  }
+
+  int ret = context->bmNetwork->forward(inputTensors->tensors,
+                                        outputTensors->tensors);
+
+  if (stage_batch == 1) {
+    objectMetadatas[indices[0]]->mOutputBMtensors = outputTensors;
+    return;
+  }
+
+  // 输出按stage的shape拆回各文字框，后处理从shape得到该桶的时间步数
+  for (int k = 0; k < count; ++k) {
+    auto& obj = objectMetadatas[indices[k]];
+    obj->mOutputBMtensors =
+        pool->makeTensors(context->handle, context->output_num);
+    for (int i = 0; i < context->output_num; ++i) {
+      auto& tensor = obj->mOutputBMtensors->tensors[i];
+      tensor->dtype = netinfo->output_dtypes[i];
+      tensor->shape = stageInfo.output_shapes[i];
+      tensor->shape.dims[0] = 1;
+      tensor->st_mode = BM_STORE_1N;
+      std::size_t bytes = sampleBytes(tensor->shape, tensor->dtype);
+      bool ok = pool->acquire(bytes, &tensor->device_mem);
+      STREAM_CHECK(ok, "Alloc Device Memory Failed! Program Terminated.")
+      bm_memcpy_d2d_byte(context->handle, tensor->device_mem, 0,
+                         outputTensors->tensors[i]->device_mem, k * bytes,
+                         bytes);
+    }
+  }
+}
+
 }  // namespace ppocr_rec
 }  // namespace element
-}  // namespace sophon_stream
\ No newline at end of file
+}  // namespace sophon_stream
@@ -20,6 +20,11 @@ void PpocrRecPostProcess::postProcess(
     common::ObjectMetadatas& objectMetadatas) {
   if (objectMetadatas.size() == 0) return;
 
+  std::shared_ptr<CtcBeamDecoder> decoder;
+  int decoder_classes = 0;
+  std::vector<int> labels;
+  std::vector<float> conf_list;
+
   for (auto obj : objectMetadatas) {
     if (obj->mFrame->mEndOfStream) break;
     if (obj->mOutputBMtensors->tensors.size() == 0) continue;
@@ -43,77 +48,21 @@ void PpocrRecPostProcess::postProcess(
     float* predict_batch = nullptr;
     predict_batch = (float*)outputTensors[0]->get_cpu_data();
 
+    // 同一个batch内复用解码器的缓冲
+    if (context->beam_search &&
+        (decoder == nullptr || decoder_classes != outputdim_2)) {
+      decoder = std::make_shared<CtcBeamDecoder>(context->beam_width,
+                                                 outputdim_2);
+      decoder_classes = outputdim_2;
+    }
+
     for (int m = 0; m < batch_num; m++) {
       if (context->beam_search) {
-        const int k = context->beam_width;  // Beam width
-
-        std::vector<std::pair<std::string, float>>
-            beam_search_results;  // 存储Beam Search的结果
-
-        std::vector<BeamSearchCandidate> beams;
-        beams.push_back(BeamSearchCandidate({}, 1.0f, {}));  // 初始的候选序列
-
-        for (int t = 0; t < outputdim_1; t++) {
-          std::vector<BeamSearchCandidate> new_beams;
-          std::vector<float> next_char_probs;
-
-          for (int c = 0; c < outputdim_2; c++) {
-            float token_score =
-                predict_batch[(m * outputdim_1 + t) * outputdim_2 + c];
-            next_char_probs.push_back(token_score);
-          }
-
-          std::vector<int> top_candidates(next_char_probs.size());
-          std::iota(top_candidates.begin(), top_candidates.end(), 0);
-          std::sort(top_candidates.begin(), top_candidates.end(),
-                    [&](int i, int j) {
-                      return next_char_probs[i] > next_char_probs[j];
-                    });
-
-          top_candidates.resize(k);
-
-          for (const BeamSearchCandidate& beam : beams) {
-            for (int c = 0; c < top_candidates.size(); c++) {
-              std::vector<int> new_prefix = beam.prefix;
-              new_prefix.push_back(top_candidates[c]);
-              float new_score = beam.score;
-              new_score = new_score * next_char_probs[top_candidates[c]];
-              std::vector<float> new_confs = beam.confs;
-              new_confs.push_back(next_char_probs[top_candidates[c]]);
-              new_beams.emplace_back(
-                  BeamSearchCandidate(new_prefix, new_score, new_confs));
-            }
-          }
-          // std::sort(new_beams.begin(), new_beams.end());
-          std::sort(
-              new_beams.begin(), new_beams.end(),
-              [](const BeamSearchCandidate& a, const BeamSearchCandidate& b) {
-                return a.score > b.score;
-              });
-          new_beams.resize(k);
-          beams = new_beams;
-        }
-        BeamSearchCandidate best_beam = beams[0];
+        decoder->decode(predict_batch + m * outputdim_1 * outputdim_2,
+                        outputdim_1, labels, conf_list);
 
         std::string str_res;
-        std::vector<float> conf_list;
-
-        int pre_c = best_beam.prefix[0];
-        if (pre_c != 0) {
-          str_res = context->label_list_[pre_c];
-          conf_list.push_back(best_beam.confs[0]);
-        }
-        for (int idx = 0; idx < best_beam.prefix.size(); idx++) {
-          if (pre_c == best_beam.prefix[idx] || best_beam.prefix[idx] == 0) {
-            if (best_beam.prefix[idx] == 0) {
-              pre_c = best_beam.prefix[idx];
-            }
-            continue;
-          }
-          str_res += context->label_list_[best_beam.prefix[idx]];
-          conf_list.push_back(best_beam.confs[idx]);
-          pre_c = best_beam.prefix[idx];
-        }
+        for (int label : labels) str_res += context->label_list_[label];
         float score = std::accumulate(conf_list.begin(), conf_list.end(), 0.0) /
                       conf_list.size();
         if (std::isnan(score)) {
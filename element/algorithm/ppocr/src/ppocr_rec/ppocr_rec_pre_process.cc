@@ -52,23 +52,14 @@ common::ErrorCode PpocrRecPreProcess::preProcess(
 
     int h = image_aligned.height;
     int w = image_aligned.width;
-    float ratio = w / float(h);
-    int resize_h;
+    // 按宽高比分桶：选能放下该文字框的最窄的stage宽度，推理时同宽的一起组batch
     int resize_w;
-    int padding_w;
-    if (ratio > context->img_ratio.back()) {
-      resize_h = context->img_size[context->img_size.size() - 1].h;
-      resize_w = context->img_size[context->img_size.size() - 1].w;
-    } else {
-      for (int i = 0; i < context->img_ratio.size(); i++) {
-        if (ratio <= context->img_ratio[i]) {
-          resize_h = context->img_size[i].h;
-          resize_w = (int)(resize_h * ratio);
-          padding_w = context->img_size[i].w;
-          break;
-        }
-      }
-    }
+    int bucket = pickWidthBucket(context->img_size, context->img_ratio, w, h,
+                                 resize_w);
+    int stage_w = context->img_size[bucket].w;
+    int stage_h = context->img_size[bucket].h;
+    int resize_h = stage_h;
+    context->valid_columns += resize_w;
 
     // resize + padding
     bmcv_padding_atrr_t padding_attr;
@@ -84,11 +75,11 @@ common::ErrorCode PpocrRecPreProcess::preProcess(
     bmcv_rect_t crop_rect{0, 0, image_aligned.width, image_aligned.height};
 
     bm_image resized_img;
-    int aligned_net_w = FFALIGN(context->net_w, 64);
-    int strides[3] = {aligned_net_w, aligned_net_w, aligned_net_w};
-    auto ret = bm_image_create(context->bmContext->handle(), context->net_h,
-                               context->net_w, FORMAT_BGR_PLANAR,
-                               DATA_TYPE_EXT_1N_BYTE, &resized_img, strides);
+    int aligned_stage_w = FFALIGN(stage_w, 64);
+    int strides[3] = {aligned_stage_w, aligned_stage_w, aligned_stage_w};
+    auto ret = bm_image_create(context->bmContext->handle(), stage_h, stage_w,
+                               FORMAT_BGR_PLANAR, DATA_TYPE_EXT_1N_BYTE,
+                               &resized_img, strides);
     assert(BM_SUCCESS == ret);
 
     bmcv_image_vpp_convert_padding(context->bmContext->handle(), 1,
@@ -102,9 +93,8 @@ common::ErrorCode PpocrRecPreProcess::preProcess(
       img_dtype = DATA_TYPE_EXT_1N_BYTE_SIGNED;
     }
     bm_image converto_img;
-    bm_image_create(context->bmNetwork->m_handle, context->net_h,
-                    context->net_w, FORMAT_BGR_PLANAR, img_dtype,
-                    &converto_img);
+    bm_image_create(context->bmNetwork->m_handle, stage_h, stage_w,
+                    FORMAT_BGR_PLANAR, img_dtype, &converto_img);
     bm_device_mem_t input_dev_mem;
     int size_byte = 0;
     bm_image_get_byte_size(converto_img, &size_byte);
@@ -120,6 +110,9 @@ common::ErrorCode PpocrRecPreProcess::preProcess(
 
     bm_image_get_device_mem(
         converto_img, &objMetadata->mInputBMtensors->tensors[0]->device_mem);
+    // 输入shape记录所在的桶，推理时据此选择stage
+    objMetadata->mInputBMtensors->tensors[0]->shape.dims[2] = stage_h;
+    objMetadata->mInputBMtensors->tensors[0]->shape.dims[3] = stage_w;
 
     bm_image_detach(converto_img);
     bm_image_destroy(converto_img);
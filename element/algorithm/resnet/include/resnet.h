@@ -30,6 +30,8 @@ class ResNet : public ::sophon_stream::framework::Element {
 
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   static constexpr const char* CONFIG_INTERNAL_MODEL_PATH_FIELD = "model_path";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_BGR2RGB_FIELD =
       "bgr2rgb";
@@ -47,15 +49,21 @@ class ResNet : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_TASK_TYPE_FIELD = "task_type";
   static constexpr const char* CONFIG_INTERNAL_CLASS_THRESH_FIELD =
       "class_thresh";
+  static constexpr const char* CONFIG_INTERNAL_CROP_CACHE_SIZE_FIELD =
+      "crop_cache_size";
+  static constexpr const char* CONFIG_INTERNAL_HEADS_FIELD = "heads";
 
  private:
   std::shared_ptr<ResNetContext> mContext;      // context对象
+  // 多head模式下所有head的context，第一个为mContext
+  std::vector<std::shared_ptr<ResNetContext>> mHeads;
   std::shared_ptr<ResNetMultiTask> mMultiTask;  // 推理对象
   int mBatch;
 
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
 
-  common::ErrorCode initContext(const std::string& json);
+  common::ErrorCode initContext(const std::string& json,
+                                std::shared_ptr<ResNetContext> context);
   void process(common::ObjectMetadatas& objectMetadatas);
 };
 
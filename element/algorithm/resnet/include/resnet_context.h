@@ -51,6 +51,8 @@ class ResNetContext : public sophon_stream::element::Context {
 
   bmcv_rect_t roi;
   bool roi_predefined = false;
+
+  bool crop_cache = false;  // 是否与其他resnet共享预处理结果
 };
 }  // namespace resnet
 }  // namespace element
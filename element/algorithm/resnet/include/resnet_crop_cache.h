@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_RESNET_CROP_CACHE_H_
+#define SOPHON_STREAM_ELEMENT_RESNET_CROP_CACHE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+#include "bmlib_runtime.h"
+#include "common/no_copyable.h"
+
+namespace sophon_stream {
+namespace element {
+namespace resnet {
+
+/**
+ * @brief 预处理结果的key：同一帧上的同一个框，按相同的网络输入尺寸、格式、
+ * 数据类型、roi和归一化参数预处理，得到的输入tensor完全相同
+ * @brief distributor把同一个框分发到多个端口时，各个子ObjectMetadata的
+ * graphId、channelId、decoderGeneration、frameId、subId相同，用它们和框在原图
+ * 中的位置、大小定位框；不同graph的通道号可以相同，通道重启后帧号从头开始，
+ * 所以都要放进key
+ */
+struct CropKey {
+  int deviceId;
+  int graphId;
+  int channelId;
+  std::uint64_t generation;
+  std::int64_t frameId;
+  int subId;
+  int cropX, cropY;
+  int cropW, cropH;
+  int netW, netH;
+  int format;
+  int dtype;
+  int roiX, roiY, roiW, roiH;
+  float alpha[3], beta[3];
+
+  bool operator<(const CropKey& other) const {
+    auto tie = [](const CropKey& k) {
+      return std::tie(k.deviceId, k.graphId, k.channelId, k.generation,
+                      k.frameId, k.subId, k.cropX, k.cropY, k.cropW, k.cropH,
+                      k.netW, k.netH, k.format, k.dtype, k.roiX, k.roiY,
+                      k.roiW, k.roiH, k.alpha[0], k.alpha[1], k.alpha[2],
+                      k.beta[0], k.beta[1], k.beta[2]);
+    };
+    return tie(*this) < tie(other);
+  }
+};
+
+/**
+ * @brief 进程内共享的resnet预处理结果缓存
+ * @brief 多个resnet分类器(如车辆属性、行人属性)处理同一个框且输入规格一致时，
+ * 只有第一个做crop-resize-normalize，其余直接取缓存的输入显存
+ * @brief 缓存按插入顺序保留最近capacity个结果，capacity取各element配置的最大值，
+ * 为0时不缓存；显存由shared_ptr持有，最后一个使用者释放时归还
+ */
+class ResNetCropCache : public ::sophon_stream::common::NoCopyable {
+ public:
+  using DeviceMemPtr = std::shared_ptr<bm_device_mem_t>;
+
+  static ResNetCropCache& getInstance() {
+    static ResNetCropCache cache;
+    return cache;
+  }
+
+  ResNetCropCache() = default;
+
+  /**
+   * @brief 容量只增不减，保证配置了更大容量的element不被其他element缩小
+   */
+  void reserve(int capacity) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mCapacity = std::max(mCapacity, capacity);
+  }
+
+  int getCapacity() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mCapacity;
+  }
+
+  DeviceMemPtr get(const CropKey& key) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto it = mEntries.find(key);
+    if (it == mEntries.end()) {
+      ++mMisses;
+      return nullptr;
+    }
+    ++mHits;
+    return it->second;
+  }
+
+  void put(const CropKey& key, DeviceMemPtr mem) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mCapacity <= 0) return;
+    if (!mEntries.emplace(key, mem).second) return;
+    mOrder.push_back(key);
+    while (mOrder.size() > static_cast<std::size_t>(mCapacity)) {
+      mEntries.erase(mOrder.front());
+      mOrder.pop_front();
+    }
+  }
+
+  std::uint64_t getHits() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHits;
+  }
+
+  std::uint64_t getMisses() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMisses;
+  }
+
+ private:
+  std::mutex mMutex;
+  int mCapacity = 0;
+  std::map<CropKey, DeviceMemPtr> mEntries;
+  std::deque<CropKey> mOrder;
+  std::uint64_t mHits = 0;
+  std::uint64_t mMisses = 0;
+};
+
+}  // namespace resnet
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_RESNET_CROP_CACHE_H_
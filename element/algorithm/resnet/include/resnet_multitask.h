@@ -11,6 +11,7 @@
 #define SOPHON_STREAM_ELEMENT_RESNET_CLASSIFY_H_
 
 #include "resnet_context.h"
+#include "resnet_crop_cache.h"
 
 namespace sophon_stream {
 namespace element {
@@ -28,6 +29,15 @@ class ResNetMultiTask {
   common::ErrorCode multiTask(std::shared_ptr<ResNetContext> context,
                              common::ObjectMetadatas& objectMetadatas);
 
+  /**
+   * @brief 多head模式：按contexts[0]预处理一次，每个head依次在同一个batch上
+   * 推理和后处理，识别结果按head顺序追加到mRecognizedObjectMetadatas
+   * @param[in] contexts: 各个head的context，输入规格必须一致
+   */
+  common::ErrorCode multiTask(
+      const std::vector<std::shared_ptr<ResNetContext>>& contexts,
+      common::ObjectMetadatas& objectMetadatas);
+
  private:
   // preprocess
   void initTensors(std::shared_ptr<ResNetContext> context,
@@ -36,6 +46,23 @@ class ResNetMultiTask {
   common::ErrorCode pre_process(std::shared_ptr<ResNetContext> context,
                                 common::ObjectMetadatas& objectMetadatas);
 
+  /**
+   * @brief 对一张图做crop-resize-normalize，返回持有输入显存的指针
+   */
+  ResNetCropCache::DeviceMemPtr preprocessImage(
+      std::shared_ptr<ResNetContext> context, const bm_image& image,
+      bm_image_format_ext format);
+
+  CropKey makeCropKey(std::shared_ptr<ResNetContext> context,
+                      std::shared_ptr<common::ObjectMetadata> objMetadata,
+                      const bm_image& image, bm_image_format_ext format);
+
+  /**
+   * @brief 把输入显存挂到ObjectMetadata的输入tensor上，tensor持有显存的引用
+   */
+  void attachInputMem(std::shared_ptr<common::ObjectMetadata> objMetadata,
+                      ResNetCropCache::DeviceMemPtr mem);
+
   static float get_aspect_scaled_ratio(int src_w, int src_h, int dst_w,
                                        int dst_h, bool* alignWidth);
 
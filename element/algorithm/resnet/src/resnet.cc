@@ -25,7 +25,8 @@ ResNet::ResNet() {}
 
 ResNet::~ResNet() {}
 
-common::ErrorCode ResNet::initContext(const std::string& json) {
+common::ErrorCode ResNet::initContext(
+    const std::string& json, std::shared_ptr<ResNetContext> context) {
   common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
   do {
     auto configure = nlohmann::json::parse(json, nullptr, false);
@@ -36,15 +37,15 @@ common::ErrorCode ResNet::initContext(const std::string& json) {
 
     auto modelPathIt = configure.find(CONFIG_INTERNAL_MODEL_PATH_FIELD);
 
-    mContext->bgr2rgb = true;
+    context->bgr2rgb = true;
     auto bgr2rgbIt = configure.find(CONFIG_INTERNAL_THRESHOLD_BGR2RGB_FIELD);
-    mContext->bgr2rgb = bgr2rgbIt->get<bool>();
+    context->bgr2rgb = bgr2rgbIt->get<bool>();
 
     auto bgr2grayIt = configure.find(CONFIG_INTERNAL_THRESHOLD_BGR2GRAY_FIELD);
     if (bgr2grayIt != configure.end()) {
-      mContext->bgr2gray = bgr2grayIt->get<bool>();
+      context->bgr2gray = bgr2grayIt->get<bool>();
     } else {
-      mContext->bgr2gray = false;
+      context->bgr2gray = false;
     }
 
     // 如果没有这个字段，那么默认采用单分类后处理
@@ -54,49 +55,50 @@ common::ErrorCode ResNet::initContext(const std::string& json) {
       // 保证json里的task_type字段必须是预设的值之一
       STREAM_CHECK(taskMap.count(taskName) != 0,
                    "Invalid Task Type in Resnet Config File!");
-      mContext->taskType = taskMap[taskName];
+      context->taskType = taskMap[taskName];
     }
 
     auto meanIt = configure.find(CONFIG_INTERNAL_THRESHOLD_MEAN_FIELD);
-    mContext->mean = meanIt->get<std::vector<float>>();
-    assert(mContext->mean.size() == 3);
+    context->mean = meanIt->get<std::vector<float>>();
+    assert(context->mean.size() == 3);
 
     auto stdIt = configure.find(CONFIG_INTERNAL_THRESHOLD_STD_FIELD);
-    mContext->stdd = stdIt->get<std::vector<float>>();
-    assert(mContext->stdd.size() == 3);
+    context->stdd = stdIt->get<std::vector<float>>();
+    assert(context->stdd.size() == 3);
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
-    mContext->bmNetwork = mContext->bmContext->network(0);
-    mContext->handle = handle->handle();
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(context->deviceId);
+    context->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
+    context->bmNetwork = context->bmContext->network(0);
+    context->handle = handle->handle();
 
     // 2. get input
-    mContext->max_batch = mContext->bmNetwork->maxBatch();
-    auto inputTensor = mContext->bmNetwork->inputTensor(0);
-    mContext->input_num = mContext->bmNetwork->m_netinfo->input_num;
-    mContext->m_net_channel = inputTensor->get_shape()->dims[1];
-    mContext->net_h = inputTensor->get_shape()->dims[2];
-    mContext->net_w = inputTensor->get_shape()->dims[3];
+    context->max_batch = context->bmNetwork->maxBatch();
+    auto inputTensor = context->bmNetwork->inputTensor(0);
+    context->input_num = context->bmNetwork->m_netinfo->input_num;
+    context->m_net_channel = inputTensor->get_shape()->dims[1];
+    context->net_h = inputTensor->get_shape()->dims[2];
+    context->net_w = inputTensor->get_shape()->dims[3];
 
     // 3. get output
-    mContext->output_num = mContext->bmNetwork->outputTensorNum();
-    assert(mContext->output_num > 0);
-    mContext->min_dim =
-        mContext->bmNetwork->outputTensor(0)->get_shape()->num_dims;
-    mContext->class_num =
-        mContext->bmNetwork->outputTensor(0)->get_shape()->dims[1];
-
-    if (mContext->taskType == TaskType::MultiLabel) {
+    context->output_num = context->bmNetwork->outputTensorNum();
+    assert(context->output_num > 0);
+    context->min_dim =
+        context->bmNetwork->outputTensor(0)->get_shape()->num_dims;
+    context->class_num =
+        context->bmNetwork->outputTensor(0)->get_shape()->dims[1];
+
+    if (context->taskType == TaskType::MultiLabel) {
       // 多标签输出的任务下，可以为每个任务配置输出的阈值
       auto class_thresh_it = configure.find(CONFIG_INTERNAL_CLASS_THRESH_FIELD);
       // 如果未配置，则默认全0.5，否则按照配置值设置
       if (class_thresh_it == configure.end()) {
-        mContext->class_thresh = std::vector<float>(mContext->output_num, 0.5);
+        context->class_thresh = std::vector<float>(context->output_num, 0.5);
       } else {
-        mContext->class_thresh = class_thresh_it->get<std::vector<float>>();
-        STREAM_CHECK(mContext->class_thresh.size() == mContext->output_num,
+        context->class_thresh = class_thresh_it->get<std::vector<float>>();
+        STREAM_CHECK(context->class_thresh.size() == context->output_num,
                      "Invalid Model or ClassThresh List!");
       }
     }
@@ -104,26 +106,26 @@ common::ErrorCode ResNet::initContext(const std::string& json) {
     // 4.converto
     float input_scale = inputTensor->get_scale();
     input_scale = input_scale * 1.0 / 255.f;
-    mContext->converto_attr.alpha_0 = input_scale / (mContext->stdd[0]);
-    mContext->converto_attr.beta_0 = -(mContext->mean[0]) / (mContext->stdd[0]);
-    mContext->converto_attr.alpha_1 = input_scale / (mContext->stdd[1]);
-    mContext->converto_attr.beta_1 = -(mContext->mean[1]) / (mContext->stdd[1]);
-    mContext->converto_attr.alpha_2 = input_scale / (mContext->stdd[2]);
-    mContext->converto_attr.beta_2 = -(mContext->mean[2]) / (mContext->stdd[2]);
+    context->converto_attr.alpha_0 = input_scale / (context->stdd[0]);
+    context->converto_attr.beta_0 = -(context->mean[0]) / (context->stdd[0]);
+    context->converto_attr.alpha_1 = input_scale / (context->stdd[1]);
+    context->converto_attr.beta_1 = -(context->mean[1]) / (context->stdd[1]);
+    context->converto_attr.alpha_2 = input_scale / (context->stdd[2]);
+    context->converto_attr.beta_2 = -(context->mean[2]) / (context->stdd[2]);
 
     // 5. roi
     auto roi_it = configure.find(CONFIG_INTERNAL_ROI_FILED);
     if (roi_it == configure.end()) {
-      mContext->roi_predefined = false;
+      context->roi_predefined = false;
     } else {
-      mContext->roi_predefined = true;
-      mContext->roi.start_x =
+      context->roi_predefined = true;
+      context->roi.start_x =
           roi_it->find(CONFIG_INTERNAL_LEFT_FILED)->get<int>();
-      mContext->roi.start_y =
+      context->roi.start_y =
           roi_it->find(CONFIG_INTERNAL_TOP_FILED)->get<int>();
-      mContext->roi.crop_w =
+      context->roi.crop_w =
           roi_it->find(CONFIG_INTERNAL_WIDTH_FILED)->get<int>();
-      mContext->roi.crop_h =
+      context->roi.crop_h =
           roi_it->find(CONFIG_INTERNAL_HEIGHT_FILED)->get<int>();
     }
 
@@ -149,7 +151,51 @@ common::ErrorCode ResNet::initInternal(const std::string& json) {
 
     // 新建context
     mContext->deviceId = getDeviceId();
-    initContext(configure.dump());
+    initContext(configure.dump(), mContext);
+    mHeads.push_back(mContext);
+
+    // 多head模式：head的配置覆盖主配置中的同名字段，一般只需配置model_path、
+    // task_type和class_thresh；所有head都使用主模型的前处理结果
+    auto headsIt = configure.find(CONFIG_INTERNAL_HEADS_FIELD);
+    if (headsIt != configure.end()) {
+      STREAM_CHECK(headsIt->is_array(), "heads must be an array, please check "
+                                        "your resnet config file!");
+      for (auto& head : *headsIt) {
+        auto headConfigure = configure;
+        headConfigure.erase(CONFIG_INTERNAL_HEADS_FIELD);
+        headConfigure.update(head);
+        auto headContext = std::make_shared<ResNetContext>();
+        headContext->deviceId = mContext->deviceId;
+        initContext(headConfigure.dump(), headContext);
+        STREAM_CHECK(headContext->net_h == mContext->net_h &&
+                         headContext->net_w == mContext->net_w &&
+                         headContext->m_net_channel == mContext->m_net_channel,
+                     "Input shape of resnet head ",
+                     headConfigure[CONFIG_INTERNAL_MODEL_PATH_FIELD].dump(),
+                     " differs from the main model!");
+        STREAM_CHECK(headContext->max_batch == mContext->max_batch &&
+                         headContext->bmNetwork->m_netinfo->input_dtypes[0] ==
+                             mContext->bmNetwork->m_netinfo->input_dtypes[0] &&
+                         headContext->bmNetwork->inputTensor(0)->get_scale() ==
+                             mContext->bmNetwork->inputTensor(0)->get_scale(),
+                     "Batch size or input dtype/scale of resnet head ",
+                     headConfigure[CONFIG_INTERNAL_MODEL_PATH_FIELD].dump(),
+                     " differs from the main model!");
+        mHeads.push_back(headContext);
+      }
+    }
+
+    // 共享预处理结果
+    auto cropCacheIt = configure.find(CONFIG_INTERNAL_CROP_CACHE_SIZE_FIELD);
+    if (cropCacheIt != configure.end()) {
+      STREAM_CHECK(cropCacheIt->is_number_integer() &&
+                       cropCacheIt->get<int>() >= 0,
+                   "crop_cache_size must be a non-negative integer, please "
+                   "check your resnet config file!");
+      int cropCacheSize = cropCacheIt->get<int>();
+      mContext->crop_cache = cropCacheSize > 0;
+      ResNetCropCache::getInstance().reserve(cropCacheSize);
+    }
 
     // 推理初始化
     mMultiTask->init(mContext);
@@ -163,7 +209,7 @@ void ResNet::process(common::ObjectMetadatas& objectMetadatas) {
   common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
 
   // 推理
-  errorCode = mMultiTask->multiTask(mContext, objectMetadatas);
+  errorCode = mMultiTask->multiTask(mHeads, objectMetadatas);
   if (common::ErrorCode::SUCCESS != errorCode) {
     for (unsigned i = 0; i < objectMetadatas.size(); i++) {
       objectMetadatas[i]->mErrorCode = errorCode;
@@ -8,6 +8,8 @@
 //===----------------------------------------------------------------------===//
 #include "resnet_multitask.h"
 
+#include "common/batch_tensors.h"
+
 #define USE_ASPECT_RATIO 1
 #define DUMP_FILE 0
 
@@ -22,21 +24,9 @@ void ResNetMultiTask::init(std::shared_ptr<ResNetContext> context) {}
 void ResNetMultiTask::initTensors(std::shared_ptr<ResNetContext> context,
                                   common::ObjectMetadatas& objectMetadatas) {
   for (auto& obj : objectMetadatas) {
+    // 输入显存由各个tensor持有(见attachInputMem)，可能与其他分类器共享，
+    // 这里不释放
     obj->mInputBMtensors = std::make_shared<sophon_stream::common::bmTensors>();
-    int channelId = obj->mFrame->mChannelId;
-    int frameId = obj->mFrame->mFrameId;
-    obj->mInputBMtensors.reset(
-        new sophon_stream::common::bmTensors(),
-        [channelId, frameId](sophon_stream::common::bmTensors* p) {
-          for (int i = 0; i < p->tensors.size(); ++i) {
-            if (p->tensors[i]->device_mem.u.device.device_addr != 0) {
-              bm_free_device(p->handle, p->tensors[i]->device_mem);
-            }
-          }
-
-          delete p;
-          p = nullptr;
-        });
     obj->mInputBMtensors->handle = context->handle;
     obj->mInputBMtensors->tensors.resize(context->input_num);
     for (int i = 0; i < context->input_num; ++i) {
@@ -54,31 +44,45 @@ void ResNetMultiTask::initTensors(std::shared_ptr<ResNetContext> context,
 common::ErrorCode ResNetMultiTask::multiTask(
     std::shared_ptr<ResNetContext> context,
     common::ObjectMetadatas& objectMetadatas) {
+  return multiTask(std::vector<std::shared_ptr<ResNetContext>>{context},
+                   objectMetadatas);
+}
+
+common::ErrorCode ResNetMultiTask::multiTask(
+    const std::vector<std::shared_ptr<ResNetContext>>& contexts,
+    common::ObjectMetadatas& objectMetadatas) {
   common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
-  // 1. preprocess
-  errorCode = pre_process(context, objectMetadatas);
+  // 1. preprocess，所有head共用第一个head的预处理结果
+  errorCode = pre_process(contexts[0], objectMetadatas);
   if (common::ErrorCode::SUCCESS != errorCode) {
     IVS_ERROR("ResNet pre_process error");
     return errorCode;
   }
-  // 2. forward
-  errorCode = predict(context, objectMetadatas);
-  if (common::ErrorCode::SUCCESS != errorCode) {
-    IVS_ERROR("ResNet predict error");
-    return errorCode;
-  }
 
-  if (context->taskType == TaskType::FeatureExtract) {
+  for (auto& context : contexts) {
+    // 2. forward
+    errorCode = predict(context, objectMetadatas);
+    if (common::ErrorCode::SUCCESS != errorCode) {
+      IVS_ERROR("ResNet predict error");
+      break;
+    }
+
     // 3. post process
-    errorCode = post_process_extract(context, objectMetadatas);
-  } else if (context->taskType == TaskType::SingleLabel) {
-    errorCode = post_process_classfy(context, objectMetadatas);
-  } else if (context->taskType == TaskType::MultiLabel) {
-    errorCode = post_process_multilabel(context, objectMetadatas);
+    if (context->taskType == TaskType::FeatureExtract) {
+      errorCode = post_process_extract(context, objectMetadatas);
+    } else if (context->taskType == TaskType::SingleLabel) {
+      errorCode = post_process_classfy(context, objectMetadatas);
+    } else if (context->taskType == TaskType::MultiLabel) {
+      errorCode = post_process_multilabel(context, objectMetadatas);
+    }
+    if (common::ErrorCode::SUCCESS != errorCode) {
+      IVS_ERROR("ResNet post_process error");
+      break;
+    }
   }
-  if (common::ErrorCode::SUCCESS != errorCode) {
-    IVS_ERROR("ResNet post_process error");
-    return errorCode;
+
+  for (auto obj : objectMetadatas) {
+    obj->mInputBMtensors = nullptr;
   }
 
   return errorCode;
@@ -93,145 +97,204 @@ common::ErrorCode ResNetMultiTask::pre_process(
   auto jsonPlanner = context->bgr2rgb ? FORMAT_RGB_PLANAR : FORMAT_BGR_PLANAR;
   jsonPlanner = context->bgr2gray ? FORMAT_GRAY : jsonPlanner;
 
-  int i = 0;
   for (auto& objMetadata : objectMetadatas) {
     if (objMetadata->mFrame->mSpData == nullptr) continue;
-    bm_image resized_img;
-    bm_image converto_img;
-    bm_image image0 = *objMetadata->mFrame->mSpData;
-    bm_image image1;
-    // convert to RGB_PLANAR
-    if (image0.image_format != jsonPlanner) {
-      bm_image_create(context->handle, image0.height, image0.width, jsonPlanner,
-                      image0.data_type, &image1);
-      auto ret = bm_image_alloc_dev_mem(image1, BMCV_IMAGE_FOR_IN);
-      STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
-      bmcv_image_storage_convert(context->handle, 1, &image0, &image1);
-    } else {
-      image1 = image0;
+    const bm_image& image = *objMetadata->mFrame->mSpData;
+    CropKey key;
+    ResNetCropCache::DeviceMemPtr mem = nullptr;
+    if (context->crop_cache) {
+      key = makeCropKey(context, objMetadata, image, jsonPlanner);
+      mem = ResNetCropCache::getInstance().get(key);
     }
-
-    bm_image image_aligned;
-    bool need_copy = image1.width & (64 - 1);
-    if (need_copy) {
-      int stride1[3], stride2[3];
-      bm_image_get_stride(image1, stride1);
-      stride2[0] = FFALIGN(stride1[0], 64);
-      stride2[1] = FFALIGN(stride1[1], 64);
-      stride2[2] = FFALIGN(stride1[2], 64);
-      bm_image_create(context->bmContext->handle(), image1.height, image1.width,
-                      image1.image_format, image1.data_type, &image_aligned,
-                      stride2);
-
-      auto ret = bm_image_alloc_dev_mem(image_aligned, BMCV_IMAGE_FOR_IN);
-      STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
-      bmcv_copy_to_atrr_t copyToAttr;
-      memset(&copyToAttr, 0, sizeof(copyToAttr));
-      copyToAttr.start_x = 0;
-      copyToAttr.start_y = 0;
-      copyToAttr.if_padding = 1;
-      bmcv_image_copy_to(context->bmContext->handle(), copyToAttr, image1,
-                         image_aligned);
-    } else {
-      image_aligned = image1;
+    if (mem == nullptr) {
+      mem = preprocessImage(context, image, jsonPlanner);
+      if (context->crop_cache) ResNetCropCache::getInstance().put(key, mem);
     }
-    // #ifdef USE_ASPECT_RATIO
-    bool isAlignWidth = false;
-    float ratio = context->roi_predefined
-                      ? get_aspect_scaled_ratio(
-                            context->roi.crop_w, context->roi.crop_h,
-                            context->net_w, context->net_h, &isAlignWidth)
-                      : get_aspect_scaled_ratio(image0.width, image0.height,
-                                                context->net_w, context->net_h,
-                                                &isAlignWidth);
-    bmcv_padding_atrr_t padding_attr;
-    memset(&padding_attr, 0, sizeof(padding_attr));
-    padding_attr.dst_crop_sty = 0;
+    attachInputMem(objMetadata, mem);
+  }
+  return common::ErrorCode::SUCCESS;
+}
+
+CropKey ResNetMultiTask::makeCropKey(
+    std::shared_ptr<ResNetContext> context,
+    std::shared_ptr<common::ObjectMetadata> objMetadata, const bm_image& image,
+    bm_image_format_ext format) {
+  CropKey key;
+  key.deviceId = context->deviceId;
+  key.graphId = objMetadata->mGraphId;
+  key.channelId = objMetadata->mFrame->mChannelId;
+  key.generation = objMetadata->mFrame->mDecoderGeneration;
+  key.frameId = objMetadata->mFrame->mFrameId;
+  key.subId = objMetadata->mSubId;
+  key.cropX = objMetadata->mCropX;
+  key.cropY = objMetadata->mCropY;
+  key.cropW = image.width;
+  key.cropH = image.height;
+  key.netW = context->net_w;
+  key.netH = context->net_h;
+  key.format = format;
+  key.dtype = context->bmNetwork->m_netinfo->input_dtypes[0];
+  key.roiX = context->roi_predefined ? context->roi.start_x : -1;
+  key.roiY = context->roi_predefined ? context->roi.start_y : -1;
+  key.roiW = context->roi_predefined ? context->roi.crop_w : -1;
+  key.roiH = context->roi_predefined ? context->roi.crop_h : -1;
+  key.alpha[0] = context->converto_attr.alpha_0;
+  key.alpha[1] = context->converto_attr.alpha_1;
+  key.alpha[2] = context->converto_attr.alpha_2;
+  key.beta[0] = context->converto_attr.beta_0;
+  key.beta[1] = context->converto_attr.beta_1;
+  key.beta[2] = context->converto_attr.beta_2;
+  return key;
+}
+
+void ResNetMultiTask::attachInputMem(
+    std::shared_ptr<common::ObjectMetadata> objMetadata,
+    ResNetCropCache::DeviceMemPtr mem) {
+  auto& tensor = objMetadata->mInputBMtensors->tensors[0];
+  tensor = std::shared_ptr<bm_tensor_t>(
+      new bm_tensor_t(*tensor), [mem](bm_tensor_t* p) { delete p; });
+  tensor->device_mem = *mem;
+}
+
+ResNetCropCache::DeviceMemPtr ResNetMultiTask::preprocessImage(
+    std::shared_ptr<ResNetContext> context, const bm_image& image0,
+    bm_image_format_ext jsonPlanner) {
+  bm_image resized_img;
+  bm_image converto_img;
+  bm_image image1;
+  // convert to RGB_PLANAR
+  if (image0.image_format != jsonPlanner) {
+    bm_image_create(context->handle, image0.height, image0.width, jsonPlanner,
+                    image0.data_type, &image1);
+    auto ret = bm_image_alloc_dev_mem(image1, BMCV_IMAGE_FOR_IN);
+    STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
+    bmcv_image_storage_convert(context->handle, 1, &image0, &image1);
+  } else {
+    image1 = image0;
+  }
+
+  bm_image image_aligned;
+  bool need_copy = image1.width & (64 - 1);
+  if (need_copy) {
+    int stride1[3], stride2[3];
+    bm_image_get_stride(image1, stride1);
+    stride2[0] = FFALIGN(stride1[0], 64);
+    stride2[1] = FFALIGN(stride1[1], 64);
+    stride2[2] = FFALIGN(stride1[2], 64);
+    bm_image_create(context->bmContext->handle(), image1.height, image1.width,
+                    image1.image_format, image1.data_type, &image_aligned,
+                    stride2);
+
+    auto ret = bm_image_alloc_dev_mem(image_aligned, BMCV_IMAGE_FOR_IN);
+    STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
+    bmcv_copy_to_atrr_t copyToAttr;
+    memset(&copyToAttr, 0, sizeof(copyToAttr));
+    copyToAttr.start_x = 0;
+    copyToAttr.start_y = 0;
+    copyToAttr.if_padding = 1;
+    bmcv_image_copy_to(context->bmContext->handle(), copyToAttr, image1,
+                       image_aligned);
+  } else {
+    image_aligned = image1;
+  }
+  // #ifdef USE_ASPECT_RATIO
+  bool isAlignWidth = false;
+  float ratio = context->roi_predefined
+                    ? get_aspect_scaled_ratio(
+                          context->roi.crop_w, context->roi.crop_h,
+                          context->net_w, context->net_h, &isAlignWidth)
+                    : get_aspect_scaled_ratio(image0.width, image0.height,
+                                              context->net_w, context->net_h,
+                                              &isAlignWidth);
+  bmcv_padding_atrr_t padding_attr;
+  memset(&padding_attr, 0, sizeof(padding_attr));
+  padding_attr.dst_crop_sty = 0;
+  padding_attr.dst_crop_stx = 0;
+  padding_attr.padding_b = 114;
+  padding_attr.padding_g = 114;
+  padding_attr.padding_r = 114;
+  padding_attr.if_memset = 1;
+  if (isAlignWidth) {
+    padding_attr.dst_crop_h =
+        (context->roi_predefined ? context->roi.crop_h : image0.height) *
+        ratio;
+    padding_attr.dst_crop_w = context->net_w;
+
+    int ty1 = (int)((context->net_h - padding_attr.dst_crop_h) / 2);
+    padding_attr.dst_crop_sty = ty1;
     padding_attr.dst_crop_stx = 0;
-    padding_attr.padding_b = 114;
-    padding_attr.padding_g = 114;
-    padding_attr.padding_r = 114;
-    padding_attr.if_memset = 1;
-    if (isAlignWidth) {
-      padding_attr.dst_crop_h =
-          (context->roi_predefined ? context->roi.crop_h : image0.height) *
-          ratio;
-      padding_attr.dst_crop_w = context->net_w;
-
-      int ty1 = (int)((context->net_h - padding_attr.dst_crop_h) / 2);
-      padding_attr.dst_crop_sty = ty1;
-      padding_attr.dst_crop_stx = 0;
-    } else {
-      padding_attr.dst_crop_h = context->net_h;
-      padding_attr.dst_crop_w =
-          (context->roi_predefined ? context->roi.crop_w : image0.width) *
-          ratio;
-
-      int tx1 = (int)((context->net_w - padding_attr.dst_crop_w) / 2);
-      padding_attr.dst_crop_sty = 0;
-      padding_attr.dst_crop_stx = tx1;
-    }
+  } else {
+    padding_attr.dst_crop_h = context->net_h;
+    padding_attr.dst_crop_w =
+        (context->roi_predefined ? context->roi.crop_w : image0.width) *
+        ratio;
 
-    int aligned_net_w = FFALIGN(context->net_w, 64);
-    int strides[3] = {aligned_net_w, aligned_net_w, aligned_net_w};
-
-    bm_image_create(context->handle, context->net_h, context->net_w,
-                    jsonPlanner, DATA_TYPE_EXT_1N_BYTE, &resized_img, strides);
-    bmcv_rect_t crop_rect{0, 0, image1.width, image1.height};
-    bm_status_t ret = BM_SUCCESS;
-    if (context->roi_predefined) {
-      if (context->roi.start_x > image1.width ||
-          context->roi.start_y > image1.height ||
-          (context->roi.start_x + context->roi.crop_w) > image1.width ||
-          (context->roi.start_y + context->roi.crop_h) > image1.height) {
-        IVS_CRITICAL("ROI AREA OUT OF RANGE");
-        abort();
-      }
-      ret = bmcv_image_vpp_convert_padding(context->bmContext->handle(), 1,
-                                           image_aligned, &resized_img,
-                                           &padding_attr, &context->roi);
-    } else {
-      ret = bmcv_image_vpp_convert_padding(context->bmContext->handle(), 1,
-                                           image_aligned, &resized_img,
-                                           &padding_attr, &crop_rect);
+    int tx1 = (int)((context->net_w - padding_attr.dst_crop_w) / 2);
+    padding_attr.dst_crop_sty = 0;
+    padding_attr.dst_crop_stx = tx1;
+  }
+
+  int aligned_net_w = FFALIGN(context->net_w, 64);
+  int strides[3] = {aligned_net_w, aligned_net_w, aligned_net_w};
+
+  bm_image_create(context->handle, context->net_h, context->net_w,
+                  jsonPlanner, DATA_TYPE_EXT_1N_BYTE, &resized_img, strides);
+  bmcv_rect_t crop_rect{0, 0, image1.width, image1.height};
+  bm_status_t ret = BM_SUCCESS;
+  if (context->roi_predefined) {
+    if (context->roi.start_x > image1.width ||
+        context->roi.start_y > image1.height ||
+        (context->roi.start_x + context->roi.crop_w) > image1.width ||
+        (context->roi.start_y + context->roi.crop_h) > image1.height) {
+      IVS_CRITICAL("ROI AREA OUT OF RANGE");
+      abort();
     }
+    ret = bmcv_image_vpp_convert_padding(context->bmContext->handle(), 1,
+                                         image_aligned, &resized_img,
+                                         &padding_attr, &context->roi);
+  } else {
+    ret = bmcv_image_vpp_convert_padding(context->bmContext->handle(), 1,
+                                         image_aligned, &resized_img,
+                                         &padding_attr, &crop_rect);
+  }
 
-    STREAM_CHECK(ret == 0, "Vpp Convert Padding Failed! Program Terminated.")
+  STREAM_CHECK(ret == 0, "Vpp Convert Padding Failed! Program Terminated.")
 
-    if (image0.image_format != FORMAT_BGR_PLANAR) {
-      bm_image_destroy(image1);
-    }
-    if (need_copy) bm_image_destroy(image_aligned);
+  if (image0.image_format != FORMAT_BGR_PLANAR) {
+    bm_image_destroy(image1);
+  }
+  if (need_copy) bm_image_destroy(image_aligned);
 
-    bm_image_data_format_ext img_dtype = DATA_TYPE_EXT_FLOAT32;
-    auto tensor = context->bmNetwork->inputTensor(0);
-    if (tensor->get_dtype() == BM_INT8) {
-      img_dtype = DATA_TYPE_EXT_1N_BYTE_SIGNED;
-    }
+  bm_image_data_format_ext img_dtype = DATA_TYPE_EXT_FLOAT32;
+  auto tensor = context->bmNetwork->inputTensor(0);
+  if (tensor->get_dtype() == BM_INT8) {
+    img_dtype = DATA_TYPE_EXT_1N_BYTE_SIGNED;
+  }
 
-    bm_image_create(context->handle, context->net_h, context->net_w,
-                    jsonPlanner, img_dtype, &converto_img);
+  bm_image_create(context->handle, context->net_h, context->net_w,
+                  jsonPlanner, img_dtype, &converto_img);
 
-    bm_device_mem_t mem;
-    int size_byte = 0;
-    bm_image_get_byte_size(converto_img, &size_byte);
-    ret = bm_malloc_device_byte(context->handle, &mem, size_byte);
-    STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
-    bm_image_attach(converto_img, &mem);
+  // 显存可能被缓存并被其他分类器使用，由最后一个持有者释放
+  auto bmContext = context->bmContext;
+  ResNetCropCache::DeviceMemPtr mem(
+      new bm_device_mem_t(), [bmContext](bm_device_mem_t* p) {
+        bm_free_device(bmContext->handle(), *p);
+        delete p;
+      });
+  int size_byte = 0;
+  bm_image_get_byte_size(converto_img, &size_byte);
+  ret = bm_malloc_device_byte(context->handle, mem.get(), size_byte);
+  STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
+  bm_image_attach(converto_img, mem.get());
 
-    bmcv_image_convert_to(context->handle, 1, context->converto_attr,
-                          &resized_img, &converto_img);
+  bmcv_image_convert_to(context->handle, 1, context->converto_attr,
+                        &resized_img, &converto_img);
 
-    bm_image_destroy(resized_img);
+  bm_image_destroy(resized_img);
 
-    bm_image_get_device_mem(
-        converto_img,
-        &objectMetadatas[i]->mInputBMtensors->tensors[0]->device_mem);
-    bm_image_detach(converto_img);
-    bm_image_destroy(converto_img);
-    i++;
-  }
-  return common::ErrorCode::SUCCESS;
+  bm_image_detach(converto_img);
+  bm_image_destroy(converto_img);
+  return mem;
 }
 
 common::ErrorCode ResNetMultiTask::predict(
@@ -255,10 +318,6 @@ common::ErrorCode ResNetMultiTask::predict(
         objectMetadatas[0]->mOutputBMtensors->tensors);
   }
 
-  for (auto obj : objectMetadatas) {
-    obj->mInputBMtensors = nullptr;
-  }
-
   return common::ErrorCode::SUCCESS;
 }
 
@@ -487,55 +546,28 @@ void ResNetMultiTask::splitOutputMemIntoObjectMetadatas(
     std::shared_ptr<ResNetContext> context,
     common::ObjectMetadatas& objectMetadatas,
     std::shared_ptr<sophon_stream::common::bmTensors> outputTensors) {
-  // 把outputTensors的显存拆出来给objectMetadatas
-  for (int i = 0; i < objectMetadatas.size(); ++i) {
-    if (objectMetadatas[i]->mFrame->mEndOfStream) break;
-    objectMetadatas[i]->mOutputBMtensors =
-        std::make_shared<sophon_stream::common::bmTensors>();
-    objectMetadatas[i]->mOutputBMtensors.reset(
-        new sophon_stream::common::bmTensors(),
-        [](sophon_stream::common::bmTensors* p) {
-          for (int i = 0; i < p->tensors.size(); ++i)
-            if (p->tensors[i]->device_mem.u.device.device_addr != 0) {
-              bm_free_device(p->handle, p->tensors[i]->device_mem);
-            }
-          delete p;
-          p = nullptr;
-        });
-    objectMetadatas[i]->mOutputBMtensors->tensors.resize(context->output_num);
-    objectMetadatas[i]->mOutputBMtensors->handle = context->handle;
-    for (int j = 0; j < context->output_num; ++j) {
-      objectMetadatas[i]->mOutputBMtensors->tensors[j] =
-          std::make_shared<bm_tensor_t>();
-      objectMetadatas[i]->mOutputBMtensors->tensors[j]->dtype =
-          context->bmNetwork->m_netinfo->output_dtypes[j];
-      objectMetadatas[i]->mOutputBMtensors->tensors[j]->shape =
-          context->bmNetwork->m_netinfo->stages[0].output_shapes[j];
-      objectMetadatas[i]->mOutputBMtensors->tensors[j]->shape.dims[0] /=
-          context->max_batch;
-      objectMetadatas[i]->mOutputBMtensors->tensors[j]->st_mode = BM_STORE_1N;
-      size_t max_size = 0;
-      for (int s = 0; s < context->bmNetwork->m_netinfo->stage_num; s++) {
-        size_t out_size = bmrt_shape_count(
-            &context->bmNetwork->m_netinfo->stages[s].output_shapes[j]);
-        if (max_size < out_size) {
-          max_size = out_size;
-        }
+  // 多head时每个head推理后都重新拆分，目标的输出换成当前head的
+  std::vector<common::BatchTensorLayout> layouts(context->output_num);
+  for (int j = 0; j < context->output_num; ++j) {
+    size_t max_size = 0;
+    for (int s = 0; s < context->bmNetwork->m_netinfo->stage_num; s++) {
+      size_t out_size = bmrt_shape_count(
+          &context->bmNetwork->m_netinfo->stages[s].output_shapes[j]);
+      if (max_size < out_size) {
+        max_size = out_size;
       }
-      if (BM_FLOAT32 == context->bmNetwork->m_netinfo->output_dtypes[j])
-        max_size *= 4;
-      max_size /= context->max_batch;
-      auto ret = bm_malloc_device_byte(
-          objectMetadatas[i]->mOutputBMtensors->handle,
-          &objectMetadatas[i]->mOutputBMtensors->tensors[j]->device_mem,
-          max_size);
-      STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
-      bm_memcpy_d2d_byte(
-          context->handle,
-          objectMetadatas[i]->mOutputBMtensors->tensors[j]->device_mem, 0,
-          outputTensors->tensors[j]->device_mem, i * max_size, max_size);
     }
+    if (BM_FLOAT32 == context->bmNetwork->m_netinfo->output_dtypes[j])
+      max_size *= 4;
+    layouts[j].dtype = context->bmNetwork->m_netinfo->output_dtypes[j];
+    layouts[j].shape =
+        context->bmNetwork->m_netinfo->stages[0].output_shapes[j];
+    layouts[j].bytes = max_size;
   }
+  common::splitBatchOutputs(context->bmNetwork->tensorPool(), context->handle,
+                            layouts, context->max_batch,
+                            context->bmNetwork->is_soc, objectMetadatas,
+                            outputTensors);
 }
 
 }  // namespace resnet
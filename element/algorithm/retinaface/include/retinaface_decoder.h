@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_RETINAFACE_DECODER_H_
+#define SOPHON_STREAM_ELEMENT_RETINAFACE_DECODER_H_
+
+#include <vector>
+
+namespace sophon_stream {
+namespace element {
+namespace retinaface {
+
+struct anchor_box {
+  float x1;
+  float y1;
+  float x2;
+  float y2;
+};
+
+struct FacePts {
+  float x[5];
+  float y[5];
+};
+
+struct FaceDetectInfo {
+  float score;
+  anchor_box rect;
+  FacePts pts;
+};
+
+/**
+ * @brief 按网络输入尺寸预先生成的anchor表，下标与模型输出的anchor顺序一致，
+ * 坐标和宽高都以网络输入尺寸归一化
+ */
+struct AnchorTable {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> w;
+  std::vector<float> h;
+};
+
+/**
+ * @brief 生成stride为8、16、32三层，每个位置2个anchor的anchor表
+ */
+void buildAnchorTable(int net_w, int net_h, AnchorTable& anchors);
+
+/**
+ * @brief 解码单张图片的模型输出，只依赖host内存，不依赖opencv和bmcv
+ * @param loc_data 框回归输出，每个anchor 4个值
+ * @param cls_data 分类输出，每个anchor 2个值，第二个为人脸置信度
+ * @param land_data 关键点输出，每个anchor 10个值
+ * @param ratio 原图到网络输入的缩放比例
+ * @param faceInfo 输出nms后的人脸，按置信度降序排列
+ */
+void decodeFaces(const AnchorTable& anchors, const float* loc_data,
+                 const float* cls_data, const float* land_data, float ratio,
+                 float threshold, float nms_threshold,
+                 std::vector<FaceDetectInfo>& faceInfo);
+
+/**
+ * @brief 原地做nms，保留的框按分数降序放在bboxes前部
+ */
+void nmsFaces(std::vector<FaceDetectInfo>& bboxes, float threshold);
+
+}  // namespace retinaface
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_RETINAFACE_DECODER_H_
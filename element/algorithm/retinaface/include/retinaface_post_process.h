@@ -14,6 +14,7 @@
 
 #include "algorithmApi/post_process.h"
 #include "retinaface_context.h"
+#include "retinaface_decoder.h"
 
 using namespace std;
 using namespace cv;
@@ -39,24 +40,6 @@ struct anchor_win {
   float h;
 };
 
-struct anchor_box {
-  float x1;
-  float y1;
-  float x2;
-  float y2;
-};
-
-struct FacePts {
-  float x[5];
-  float y[5];
-};
-
-struct FaceDetectInfo {
-  float score;
-  anchor_box rect;
-  FacePts pts;
-};
-
 struct anchor_cfg {
  public:
   int STRIDE;
@@ -86,25 +69,8 @@ class RetinafacePostProcess : public ::sophon_stream::element::PostProcess {
                    common::ObjectMetadatas& objectMetadatas);
 
  private:
-  anchor_box bbox_pred(anchor_box anchor, std::vector<float> regress);
-  std::vector<anchor_box> bbox_pred(std::vector<anchor_box> anchors,
-                                    std::vector<std::vector<float> > regress);
-  std::vector<FacePts> landmark_pred(std::vector<anchor_box> anchors,
-                                     std::vector<FacePts> facePts);
-  FacePts landmark_pred(anchor_box anchor, FacePts facePt);
-  static bool CompareBBox(const FaceDetectInfo& a, const FaceDetectInfo& b);
-  std::vector<FaceDetectInfo> nms(std::vector<FaceDetectInfo>& bboxes,
-                                  float threshold);
-  void get_faceInfo(std::shared_ptr<RetinafaceContext> context,
-                    vector<FaceDetectInfo>& faceInfo, float** preds,
-                    map<string, int>& output_names_map, int img_h, int img_w,
-                    float ratio_, float threshold, float scales = 1.0);
-
-  // std::string network;
-  std::vector<int> _feat_stride_fpn;
-  std::map<std::string, std::vector<anchor_box> > _anchors_fpn;
-  std::map<std::string, std::vector<anchor_box> > _anchors;
-  std::map<std::string, int> _num_anchors;
+  AnchorTable mAnchors;
+  std::vector<int> mOutputSizes;  // 每个输出中单张图片的元素个数
 };
 
 }  // namespace retinaface
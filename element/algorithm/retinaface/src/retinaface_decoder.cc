@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "retinaface_decoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace sophon_stream {
+namespace element {
+namespace retinaface {
+
+namespace {
+
+bool CompareBBox(const FaceDetectInfo& a, const FaceDetectInfo& b) {
+  return a.score > b.score;
+}
+
+}  // namespace
+
+void buildAnchorTable(int ws, int hs, AnchorTable& anchors) {
+  const int num_layer = 3;
+  const size_t steps[] = {8, 16, 32};
+  const int num_anchor = 2;
+  const size_t anchor_sizes[][2] = {{16, 32}, {64, 128}, {256, 512}};
+
+  anchors = AnchorTable();
+  for (int il = 0; il < num_layer; ++il) {
+    int feature_width = (ws + steps[il] - 1) / steps[il];
+    int feature_height = (hs + steps[il] - 1) / steps[il];
+    for (int iy = 0; iy < feature_height; ++iy) {
+      for (int ix = 0; ix < feature_width; ++ix) {
+        for (int ia = 0; ia < num_anchor; ++ia) {
+          size_t min_size = anchor_sizes[il][ia];
+          anchors.x.push_back((ix + 0.5) * steps[il] / ws);
+          anchors.y.push_back((iy + 0.5) * steps[il] / hs);
+          anchors.w.push_back(min_size * 1. / ws);
+          anchors.h.push_back(min_size * 1. / hs);
+        }
+      }
+    }
+  }
+}
+
+void decodeFaces(const AnchorTable& anchors, const float* loc_data,
+                 const float* cls_data, const float* land_data, float ratio_,
+                 float threshold, float nms_threshold,
+                 std::vector<FaceDetectInfo>& faceInfo) {
+  const float variances[] = {0.1, 0.2};
+  const int anchor_num = anchors.x.size();
+
+  // 先只扫描置信度，无分支地把过阈值的anchor下标压缩到前部，
+  // 只对这些anchor解码框和关键点
+  thread_local std::vector<int> survivors;
+  survivors.resize(anchor_num + 1);
+  int survivor_num = 0;
+  for (int index = 0; index < anchor_num; ++index) {
+    survivors[survivor_num] = index;
+    survivor_num += !(cls_data[index * 2 + 1] < threshold);
+  }
+
+  const float *loc, *land;
+  float x, y, w, h;
+  float anchor_w, anchor_h, anchor_x, anchor_y;
+
+  faceInfo.resize(survivor_num);
+  for (int k = 0; k < survivor_num; ++k) {
+    int index = survivors[k];
+    FaceDetectInfo& obj = faceInfo[k];
+    anchor_x = anchors.x[index];
+    anchor_y = anchors.y[index];
+    anchor_w = anchors.w[index];
+    anchor_h = anchors.h[index];
+    obj.score = cls_data[index * 2 + 1];
+    loc = loc_data + index * 4;
+    w = exp(loc[2] * variances[1]) * anchor_w;
+    h = exp(loc[3] * variances[1]) * anchor_h;
+    x = anchor_x + loc[0] * variances[0] * anchor_w;
+    y = anchor_y + loc[1] * variances[0] * anchor_h;
+    obj.rect.x1 = (x - w / 2) * 640 / ratio_;
+    obj.rect.x2 = (x + w / 2) * 640 / ratio_;
+    obj.rect.y1 = (y - h / 2) * 640 / ratio_;
+    obj.rect.y2 = (y + h / 2) * 640 / ratio_;
+    land = land_data + index * 10;
+    for (int i = 0; i < 5; ++i) {
+      obj.pts.x[i] =
+          (anchor_x + land[i * 2] * variances[0] * anchor_w) * 640 / ratio_;
+      obj.pts.y[i] =
+          (anchor_y + land[i * 2 + 1] * variances[0] * anchor_h) * 640 /
+          ratio_;
+    }
+  }
+
+  nmsFaces(faceInfo, nms_threshold);
+}
+
+void nmsFaces(std::vector<FaceDetectInfo>& bboxes, float threshold) {
+  std::sort(bboxes.begin(), bboxes.end(), CompareBBox);
+
+  int32_t select_idx = 0;
+  int32_t num_bbox = static_cast<int32_t>(bboxes.size());
+  int32_t keep_num = 0;
+  thread_local std::vector<char> mask_merged;
+  mask_merged.assign(num_bbox, 0);
+  bool all_merged = false;
+
+  while (!all_merged) {
+    while (select_idx < num_bbox && mask_merged[select_idx] == 1) select_idx++;
+
+    if (select_idx == num_bbox) {
+      all_merged = true;
+      continue;
+    }
+
+    // 保留的框前移，keep_num不超过select_idx，不会覆盖后面还要比较的框
+    bboxes[keep_num++] = bboxes[select_idx];
+    mask_merged[select_idx] = 1;
+
+    anchor_box select_bbox = bboxes[select_idx].rect;
+    float area1 = static_cast<float>((select_bbox.x2 - select_bbox.x1 + 1) *
+                                     (select_bbox.y2 - select_bbox.y1 + 1));
+    float x1 = static_cast<float>(select_bbox.x1);
+    float y1 = static_cast<float>(select_bbox.y1);
+    float x2 = static_cast<float>(select_bbox.x2);
+    float y2 = static_cast<float>(select_bbox.y2);
+
+    select_idx++;
+    for (int32_t i = select_idx; i < num_bbox; i++) {
+      if (mask_merged[i] == 1) {
+        continue;
+      }
+      anchor_box& bbox_i = bboxes[i].rect;
+      float x = std::max<float>(x1, static_cast<float>(bbox_i.x1));
+      float y = std::max<float>(y1, static_cast<float>(bbox_i.y1));
+      float w = std::min<float>(x2, static_cast<float>(bbox_i.x2)) - x + 1;
+      float h = std::min<float>(y2, static_cast<float>(bbox_i.y2)) - y + 1;
+      if (w <= 0 || h <= 0) {
+        continue;
+      }
+      float area2 = static_cast<float>((bbox_i.x2 - bbox_i.x1 + 1) *
+                                       (bbox_i.y2 - bbox_i.y1 + 1));
+      float area_intersect = w * h;
+
+      if (static_cast<float>(area_intersect) /
+              (area1 + area2 - area_intersect) >
+          threshold) {
+        mask_merged[i] = 1;
+      }
+    }
+  }
+  bboxes.resize(keep_num);
+}
+
+}  // namespace retinaface
+}  // namespace element
+}  // namespace sophon_stream
@@ -45,6 +45,8 @@ namespace template {
      */
     common::ErrorCode doWork(int dataPipeId) override;
 
+    bool getMultiDevice() override { return false; }
+
     void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
     void setPreprocess(
         std::shared_ptr<::sophon_stream::element::PreProcess> pre);
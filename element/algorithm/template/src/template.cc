@@ -153,7 +153,8 @@ namespace template {
       int outDataPipeId =
           getSinkElementFlag()
               ? 0
-              : (channel_id_internal % getOutputConnectorCapacity(outputPort));
+              : getOutputDataPipeId(outputPort, channel_id_internal,
+                                    objectMetadata->mFrame->mEndOfStream);
       errorCode =
           pushOutputData(outputPort, outDataPipeId,
                          std::static_pointer_cast<void>(objectMetadata));
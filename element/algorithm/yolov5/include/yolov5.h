@@ -10,6 +10,11 @@
 #ifndef SOPHON_STREAM_ELEMENT_YOLOV5_H_
 #define SOPHON_STREAM_ELEMENT_YOLOV5_H_
 
+#include <mutex>
+#include <unordered_map>
+
+#include "common/inflight_queue.h"
+#include "device_balancer.h"
 #include "element_factory.h"
 #include "group.h"
 #include "yolov5_context.h"
@@ -69,6 +74,8 @@ class Yolov5 : public ::sophon_stream::framework::Element {
       "threshold_nms";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_TPU_KERNEL_FIELD =
       "use_tpu_kernel";
+  static constexpr const char* CONFIG_INTERNAL_TPU_KERNEL_MODULE_PATH_FIELD =
+      "tpu_kernel_module_path";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_BGR2RGB_FIELD =
       "bgr2rgb";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_MEAN_FIELD = "mean";
@@ -82,6 +89,8 @@ class Yolov5 : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_HEIGHT_FILED = "height";
   static constexpr const char* CONFIG_INTERNAL_MAX_DET_FILED = "maxdet";
   static constexpr const char* CONFIG_INTERNAL_MIN_DET_FILED = "mindet";
+  static constexpr const char* CONFIG_INTERNAL_INFER_DEPTH_FIELD =
+      "infer_depth";
 
  private:
   std::shared_ptr<Yolov5Context> mContext;          // context对象
@@ -96,8 +105,39 @@ class Yolov5 : public ::sophon_stream::framework::Element {
   std::string mFpsProfilerName;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
 
-  common::ErrorCode initContext(const std::string& json);
+  /**
+   * @brief 同一设备上的一组数据，ok为false时跳过后续阶段
+   */
+  struct DeviceBatch {
+    Yolov5DeviceUnit unit;
+    common::ObjectMetadatas objects;
+    bool ok = true;
+  };
+
+  common::ErrorCode initContext(const std::string& json,
+                                std::shared_ptr<Yolov5Context> context);
   void process(common::ObjectMetadatas& objectMetadatas, int dataPipeId);
+
+  /**
+   * @brief 按帧所在设备拆分batch，只有一个设备时原样返回
+   */
+  std::vector<DeviceBatch> splitByDevice(
+      common::ObjectMetadatas& objectMetadatas);
+  bool runPreProcess(DeviceBatch& batch);
+  bool runInference(DeviceBatch& batch);
+  void runPostProcess(DeviceBatch& batch, int dataPipeId);
+  void sendData(int outputPort,
+                common::ObjectMetadatas& pendingObjectMetadatas);
+
+  /**
+   * @brief infer_depth大于1时返回dataPipe对应的在途队列，否则返回nullptr
+   */
+  std::shared_ptr<common::InflightQueue> getInflightQueue(int dataPipeId);
+
+  // 放在最后，析构时最先等待在途batch完成，回调中用到的成员此时仍然有效
+  std::mutex mInflightMutex;
+  std::unordered_map<int, std::shared_ptr<common::InflightQueue>>
+      mInflightQueues;
 };
 
 }  // namespace yolov5
@@ -10,6 +10,8 @@
 #ifndef SOPHON_STREAM_ELEMENT_YOLOV5_CONTEXT_H_
 #define SOPHON_STREAM_ELEMENT_YOLOV5_CONTEXT_H_
 
+#include <map>
+
 #include "algorithmApi/context.h"
 
 namespace sophon_stream {
@@ -41,6 +43,21 @@ typedef struct {
 
 #define MAX_BATCH 16
 
+class Yolov5Context;
+class Yolov5PreProcess;
+class Yolov5Inference;
+class Yolov5PostProcess;
+
+/**
+ * @brief 一个设备上的context和前处理、推理、后处理对象
+ */
+struct Yolov5DeviceUnit {
+  std::shared_ptr<Yolov5Context> context;
+  std::shared_ptr<Yolov5PreProcess> pre;
+  std::shared_ptr<Yolov5Inference> infer;
+  std::shared_ptr<Yolov5PostProcess> post;
+};
+
 class Yolov5Context : public ::sophon_stream::element::Context {
  public:
   int deviceId;  // 设备ID
@@ -83,7 +100,12 @@ class Yolov5Context : public ::sophon_stream::element::Context {
   bmcv_rect_t roi;
   bool roi_predefined = false;
   int thread_number;
+  // 同时在途的推理batch数，1为同步推理
+  int infer_depth = 1;
   unsigned int m_max_det = UINT_MAX, m_min_det = 0;
+
+  // device_ids中除deviceId以外的设备，key为设备号
+  std::map<int, Yolov5DeviceUnit> device_units;
 };
 }  // namespace yolov5
 }  // namespace element
@@ -21,7 +21,8 @@ Yolov5::~Yolov5() {}
 
 const std::string Yolov5::elementName = "yolov5";
 
-common::ErrorCode Yolov5::initContext(const std::string& json) {
+common::ErrorCode Yolov5::initContext(
+    const std::string& json, std::shared_ptr<Yolov5Context> context) {
   common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
   do {
     auto configure = nlohmann::json::parse(json, nullptr, false);
@@ -34,19 +35,19 @@ common::ErrorCode Yolov5::initContext(const std::string& json) {
 
     auto threshConfIt = configure.find(CONFIG_INTERNAL_THRESHOLD_CONF_FIELD);
     if (threshConfIt->is_number_float()) {
-      mContext->thresh_conf_min = threshConfIt->get<float>();
+      context->thresh_conf_min = threshConfIt->get<float>();
     } else {
-      mContext->thresh_conf =
+      context->thresh_conf =
           threshConfIt->get<std::unordered_map<std::string, float>>();
     }
 
     if (threshConfIt->is_number_float()) {
-      mContext->class_thresh_valid = false;
+      context->class_thresh_valid = false;
     } else {
       auto classNamesFileIt =
           configure.find(CONFIG_INTERNAL_CLASS_NAMES_FILE_FIELD);
       if (classNamesFileIt->is_string()) {
-        mContext->class_thresh_valid = true;
+        context->class_thresh_valid = true;
         std::string class_names_file = classNamesFileIt->get<std::string>();
         std::ifstream istream;
         istream.open(class_names_file);
@@ -54,37 +55,37 @@ common::ErrorCode Yolov5::initContext(const std::string& json) {
         std::string line;
         while (std::getline(istream, line)) {
           line = line.substr(0, line.length());
-          mContext->class_names.push_back(line);
-          // if (mContext->thresh_conf_min != -1) {
-          //   mContext->thresh_conf.insert({line, mContext->thresh_conf_min});
+          context->class_names.push_back(line);
+          // if (context->thresh_conf_min != -1) {
+          //   context->thresh_conf.insert({line, context->thresh_conf_min});
           // }
         }
         istream.close();
       }
     }
 
-    for (auto thresh_it = mContext->thresh_conf.begin();
-         thresh_it != mContext->thresh_conf.end(); ++thresh_it) {
-      mContext->thresh_conf_min = mContext->thresh_conf_min < thresh_it->second
-                                      ? mContext->thresh_conf_min
-                                      : thresh_it->second;
+    for (auto thresh_it = context->thresh_conf.begin();
+         thresh_it != context->thresh_conf.end(); ++thresh_it) {
+      context->thresh_conf_min = context->thresh_conf_min < thresh_it->second
+                                     ? context->thresh_conf_min
+                                     : thresh_it->second;
     }
-    mContext->log_conf_threshold = -std::log(1 / mContext->thresh_conf_min - 1);
+    context->log_conf_threshold = -std::log(1 / context->thresh_conf_min - 1);
 
     auto threshNmsIt = configure.find(CONFIG_INTERNAL_THRESHOLD_NMS_FIELD);
-    mContext->thresh_nms = threshNmsIt->get<float>();
+    context->thresh_nms = threshNmsIt->get<float>();
 
-    mContext->bgr2rgb = true;
+    context->bgr2rgb = true;
     auto bgr2rgbIt = configure.find(CONFIG_INTERNAL_THRESHOLD_BGR2RGB_FIELD);
-    mContext->bgr2rgb = bgr2rgbIt->get<bool>();
+    context->bgr2rgb = bgr2rgbIt->get<bool>();
 
     auto meanIt = configure.find(CONFIG_INTERNAL_THRESHOLD_MEAN_FIELD);
-    mContext->mean = meanIt->get<std::vector<float>>();
-    assert(mContext->mean.size() == 3);
+    context->mean = meanIt->get<std::vector<float>>();
+    assert(context->mean.size() == 3);
 
     auto stdIt = configure.find(CONFIG_INTERNAL_THRESHOLD_STD_FIELD);
-    mContext->stdd = stdIt->get<std::vector<float>>();
-    assert(mContext->stdd.size() == 3);
+    context->stdd = stdIt->get<std::vector<float>>();
+    assert(context->stdd.size() == 3);
 
     auto tpu_kernelIt =
         configure.find(CONFIG_INTERNAL_THRESHOLD_TPU_KERNEL_FIELD);
@@ -92,63 +93,73 @@ common::ErrorCode Yolov5::initContext(const std::string& json) {
       errorCode = common::ErrorCode::PARSE_CONFIGURE_FAIL;
       break;
     }
-    mContext->use_tpu_kernel = tpu_kernelIt->get<bool>();
+    context->use_tpu_kernel = tpu_kernelIt->get<bool>();
 
     auto max_detIt = configure.find(CONFIG_INTERNAL_MAX_DET_FILED);
     auto min_detIt = configure.find(CONFIG_INTERNAL_MIN_DET_FILED);
     if (configure.end() != max_detIt) {
-      mContext->m_max_det = max_detIt->get<unsigned int>();
+      context->m_max_det = max_detIt->get<unsigned int>();
     }
     if (configure.end() != min_detIt) {
-      mContext->m_min_det = min_detIt->get<unsigned int>();
+      context->m_min_det = min_detIt->get<unsigned int>();
+    }
+
+    auto inferDepthIt = configure.find(CONFIG_INTERNAL_INFER_DEPTH_FIELD);
+    if (configure.end() != inferDepthIt) {
+      STREAM_CHECK(inferDepthIt->is_number_integer() &&
+                       inferDepthIt->get<int>() >= 1,
+                   "infer_depth must be a positive integer, please check your "
+                   "Json files");
+      context->infer_depth = inferDepthIt->get<int>();
     }
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(context->deviceId);
 
     // use_tpu_kernel could only be enable on 1684x
     // check it before load model
     unsigned int chip_id_;
     bm_get_chipid(handle->handle(), &chip_id_);
-    STREAM_CHECK((mContext->use_tpu_kernel && (chip_id_ == 0x1686)) ||
-                     (!mContext->use_tpu_kernel),
+    STREAM_CHECK((context->use_tpu_kernel && (chip_id_ == 0x1686)) ||
+                     (!context->use_tpu_kernel),
                  "TPU KERNEL could only be enabled on 1684X, please check your "
                  "Json files");
 
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
-    mContext->bmNetwork = mContext->bmContext->network(0);
-    mContext->handle = handle->handle();
+    context->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
+    context->bmNetwork = context->bmContext->network(0);
+    context->handle = handle->handle();
 
     // 2. get input
-    mContext->max_batch = mContext->bmNetwork->maxBatch();
-    auto inputTensor = mContext->bmNetwork->inputTensor(0);
-    mContext->input_num = mContext->bmNetwork->m_netinfo->input_num;
-    mContext->m_net_channel = inputTensor->get_shape()->dims[1];
-    mContext->net_h = inputTensor->get_shape()->dims[2];
-    mContext->net_w = inputTensor->get_shape()->dims[3];
+    context->max_batch = context->bmNetwork->maxBatch();
+    auto inputTensor = context->bmNetwork->inputTensor(0);
+    context->input_num = context->bmNetwork->m_netinfo->input_num;
+    context->m_net_channel = inputTensor->get_shape()->dims[1];
+    context->net_h = inputTensor->get_shape()->dims[2];
+    context->net_w = inputTensor->get_shape()->dims[3];
 
     // 3. get output
-    mContext->output_num = mContext->bmNetwork->outputTensorNum();
-    mContext->min_dim =
-        mContext->bmNetwork->outputTensor(0)->get_shape()->num_dims;
-    if (mContext->output_num == 3) {
-      if (mContext->use_tpu_kernel)
-        mContext->class_num =
-            mContext->bmNetwork->outputTensor(0)->get_shape()->dims[1] / 3 - 4 -
+    context->output_num = context->bmNetwork->outputTensorNum();
+    context->min_dim =
+        context->bmNetwork->outputTensor(0)->get_shape()->num_dims;
+    if (context->output_num == 3) {
+      if (context->use_tpu_kernel)
+        context->class_num =
+            context->bmNetwork->outputTensor(0)->get_shape()->dims[1] / 3 - 4 -
             1;  // class_nums + box_4 + conf_1
       else
-        mContext->class_num =
-            mContext->bmNetwork->outputTensor(0)->get_shape()->dims[4] - 4 - 1;
+        context->class_num =
+            context->bmNetwork->outputTensor(0)->get_shape()->dims[4] - 4 - 1;
     } else {
-      mContext->class_num =
-          mContext->bmNetwork->outputTensor(0)->get_shape()->dims[2] - 5;
+      context->class_num =
+          context->bmNetwork->outputTensor(0)->get_shape()->dims[2] - 5;
     }
 
-    if (mContext->class_thresh_valid) {
-      if (mContext->class_num != mContext->class_names.size() ||
-          mContext->class_num != mContext->thresh_conf.size() ||
-          mContext->thresh_conf.size() != mContext->class_names.size()) {
+    if (context->class_thresh_valid) {
+      if (context->class_num != context->class_names.size() ||
+          context->class_num != context->thresh_conf.size() ||
+          context->thresh_conf.size() != context->class_names.size()) {
         IVS_CRITICAL(
             "Class Number Does Not Match The Model! Please Check The Json "
             "File.");
@@ -159,49 +170,49 @@ common::ErrorCode Yolov5::initContext(const std::string& json) {
     // 4.converto
     float input_scale = inputTensor->get_scale();
     // input_scale = input_scale * 1.0 / 255.f;
-    mContext->converto_attr.alpha_0 = input_scale / (mContext->stdd[0]);
-    mContext->converto_attr.beta_0 = -(mContext->mean[0]) / (mContext->stdd[0]);
-    mContext->converto_attr.alpha_1 = input_scale / (mContext->stdd[1]);
-    mContext->converto_attr.beta_1 = -(mContext->mean[1]) / (mContext->stdd[1]);
-    mContext->converto_attr.alpha_2 = input_scale / (mContext->stdd[2]);
-    mContext->converto_attr.beta_2 = -(mContext->mean[2]) / (mContext->stdd[2]);
+    context->converto_attr.alpha_0 = input_scale / (context->stdd[0]);
+    context->converto_attr.beta_0 = -(context->mean[0]) / (context->stdd[0]);
+    context->converto_attr.alpha_1 = input_scale / (context->stdd[1]);
+    context->converto_attr.beta_1 = -(context->mean[1]) / (context->stdd[1]);
+    context->converto_attr.alpha_2 = input_scale / (context->stdd[2]);
+    context->converto_attr.beta_2 = -(context->mean[2]) / (context->stdd[2]);
 
     // 6. tpu_kernel postprocess
-    if (mContext->use_tpu_kernel) {
-      tpu_kernel_module_t tpu_module;
-      std::string tpu_kernel_module_path =
-          "../../3rdparty/tpu_kernel_module/"
-          "libbm1684x_kernel_module.so";
-      std::ifstream file(tpu_kernel_module_path);
-      STREAM_CHECK(file.good(),
-                   "kernel_module.so does not exist, please check your path: ",
-                   tpu_kernel_module_path);
-      file.close();
-      tpu_module = tpu_kernel_load_module_file(mContext->bmContext->handle(),
-                                               tpu_kernel_module_path.c_str());
-      mContext->func_id =
-          tpu_kernel_get_function(mContext->bmContext->handle(), tpu_module,
-                                  "tpu_kernel_api_yolov5_detect_out");
+    if (context->use_tpu_kernel) {
+      // 模块由框架缓存，每个设备只加载一次；json中可指定模块所在目录
+      std::string tpu_kernel_module_path;
+      auto modulePathIt =
+          configure.find(CONFIG_INTERNAL_TPU_KERNEL_MODULE_PATH_FIELD);
+      if (configure.end() != modulePathIt) {
+        STREAM_CHECK(modulePathIt->is_string(),
+                     "tpu_kernel_module_path must be a string, please check "
+                     "your Json files");
+        tpu_kernel_module_path = modulePathIt->get<std::string>();
+      }
+      context->func_id =
+          common::TpuKernelModuleCache::getInstance().getFunction(
+              handle, "tpu_kernel_api_yolov5_detect_out",
+              tpu_kernel_module_path);
       std::cout << "Using tpu_kernel yolo postprocession, kernel funtion id: "
-                << mContext->func_id << std::endl;
+                << context->func_id << std::endl;
     }
 
     // 7. roi
     auto roi_it = configure.find(CONFIG_INTERNAL_ROI_FILED);
     if (roi_it == configure.end()) {
-      mContext->roi_predefined = false;
+      context->roi_predefined = false;
     } else {
-      mContext->roi_predefined = true;
-      mContext->roi.start_x =
+      context->roi_predefined = true;
+      context->roi.start_x =
           roi_it->find(CONFIG_INTERNAL_LEFT_FILED)->get<int>();
-      mContext->roi.start_y =
+      context->roi.start_y =
           roi_it->find(CONFIG_INTERNAL_TOP_FILED)->get<int>();
-      mContext->roi.crop_w =
+      context->roi.crop_w =
           roi_it->find(CONFIG_INTERNAL_WIDTH_FILED)->get<int>();
-      mContext->roi.crop_h =
+      context->roi.crop_h =
           roi_it->find(CONFIG_INTERNAL_HEIGHT_FILED)->get<int>();
     }
-    mContext->thread_number = getThreadNumber();
+    context->thread_number = getThreadNumber();
   } while (false);
   return common::ErrorCode::SUCCESS;
 }
@@ -247,7 +258,7 @@ common::ErrorCode Yolov5::initInternal(const std::string& json) {
     }
 
     mContext->deviceId = getDeviceId();
-    initContext(configure.dump());
+    initContext(configure.dump(), mContext);
     // 前处理初始化
     mPreProcess->init(mContext);
     // 推理初始化
@@ -255,39 +266,140 @@ common::ErrorCode Yolov5::initInternal(const std::string& json) {
     // 后处理初始化
     mPostProcess->init(mContext);
 
+    // 配置了多个设备时在其余设备上各加载一份模型和前后处理对象，
+    // 挂在mContext上，Group中的推理和后处理element也能拿到
+    for (int deviceId : getDeviceIds()) {
+      if (deviceId == mContext->deviceId ||
+          mContext->device_units.count(deviceId))
+        continue;
+      Yolov5DeviceUnit unit;
+      unit.context = std::make_shared<Yolov5Context>();
+      unit.pre = std::make_shared<Yolov5PreProcess>();
+      unit.infer = std::make_shared<Yolov5Inference>();
+      unit.post = std::make_shared<Yolov5PostProcess>();
+      unit.context->deviceId = deviceId;
+      initContext(configure.dump(), unit.context);
+      unit.pre->init(unit.context);
+      unit.infer->init(unit.context);
+      unit.post->init(unit.context);
+      mContext->device_units[deviceId] = unit;
+    }
+
   } while (false);
   return errorCode;
 }
 
-void Yolov5::process(common::ObjectMetadatas& objectMetadatas, int dataPipeId) {
-  common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
-  if (use_pre) {
-    errorCode = mPreProcess->preProcess(mContext, objectMetadatas);
-    if (common::ErrorCode::SUCCESS != errorCode) {
-      for (unsigned i = 0; i < objectMetadatas.size(); i++) {
-        objectMetadatas[i]->mErrorCode = errorCode;
+std::vector<Yolov5::DeviceBatch> Yolov5::splitByDevice(
+    common::ObjectMetadatas& objectMetadatas) {
+  std::vector<DeviceBatch> batches(1);
+  batches[0].unit = {mContext, mPreProcess, mInference, mPostProcess};
+  if (mContext->device_units.empty()) {
+    batches[0].objects = objectMetadatas;
+    return batches;
+  }
+
+  // 帧留在解码时所在的设备上，按帧的设备号找对应的模型
+  std::map<int, std::size_t> indices{{mContext->deviceId, 0}};
+  for (auto& obj : objectMetadatas) {
+    int deviceId = bm_get_devid(obj->mFrame->mHandle);
+    auto it = indices.find(deviceId);
+    if (it == indices.end()) {
+      auto unitIt = mContext->device_units.find(deviceId);
+      if (unitIt == mContext->device_units.end()) {
+        IVS_WARN("Device {0} is not in device_ids of element {1}", deviceId,
+                 getId());
+        it = indices.find(mContext->deviceId);
+      } else {
+        it = indices.emplace(deviceId, batches.size()).first;
+        batches.emplace_back();
+        batches.back().unit = unitIt->second;
       }
-      return;
     }
+    batches[it->second].objects.push_back(obj);
+  }
+  return batches;
+}
+
+bool Yolov5::runPreProcess(DeviceBatch& batch) {
+  common::ErrorCode errorCode =
+      batch.unit.pre->preProcess(batch.unit.context, batch.objects);
+  if (common::ErrorCode::SUCCESS != errorCode) {
+    for (unsigned i = 0; i < batch.objects.size(); i++) {
+      batch.objects[i]->mErrorCode = errorCode;
+    }
+    return false;
   }
-  // 推理
-  if (use_infer) {
-    errorCode = mInference->predict(mContext, objectMetadatas);
+  return true;
+}
+
+bool Yolov5::runInference(DeviceBatch& batch) {
+  auto start = std::chrono::steady_clock::now();
+  common::ErrorCode errorCode =
+      batch.unit.infer->predict(batch.unit.context, batch.objects);
+  if (common::ErrorCode::SUCCESS != errorCode) {
+    for (unsigned i = 0; i < batch.objects.size(); i++) {
+      batch.objects[i]->mErrorCode = errorCode;
+    }
+    return false;
+  }
+  // 多设备时上报每帧推理耗时，decode据此给新通道选择设备
+  if (!mContext->device_units.empty()) {
+    std::chrono::duration<double, std::milli> cost =
+        std::chrono::steady_clock::now() - start;
+    framework::SingletonDeviceBalancer::getInstance().reportLatency(
+        batch.unit.context->deviceId, cost.count(), batch.objects.size());
+  }
+  return true;
+}
+
+void Yolov5::runPostProcess(DeviceBatch& batch, int dataPipeId) {
+  batch.unit.post->postProcess(batch.unit.context, batch.objects, dataPipeId);
+}
+
+void Yolov5::process(common::ObjectMetadatas& objectMetadatas, int dataPipeId) {
+  for (auto& batch : splitByDevice(objectMetadatas)) {
+    if (use_pre && !runPreProcess(batch)) continue;
+    // 推理
+    if (use_infer && !runInference(batch)) continue;
+    // 后处理
+    if (use_post) runPostProcess(batch, dataPipeId);
+  }
+}
+
+std::shared_ptr<common::InflightQueue> Yolov5::getInflightQueue(
+    int dataPipeId) {
+  if (!use_infer || mContext->infer_depth <= 1) return nullptr;
+  // Group中推理element不经过initInternal，在途队列在第一次使用时创建；
+  // 每个dataPipe一个，保证同一通道的数据按顺序发送
+  std::lock_guard<std::mutex> lock(mInflightMutex);
+  auto& queue = mInflightQueues[dataPipeId];
+  if (queue == nullptr)
+    queue = std::make_shared<common::InflightQueue>(mContext->infer_depth);
+  return queue;
+}
+
+void Yolov5::sendData(int outputPort,
+                      common::ObjectMetadatas& pendingObjectMetadatas) {
+  for (auto& objectMetadata : pendingObjectMetadatas) {
+    int channel_id_internal = objectMetadata->mFrame->mChannelIdInternal;
+    int outDataPipeId =
+        getSinkElementFlag()
+            ? 0
+            : getOutputDataPipeId(outputPort, channel_id_internal,
+                                  objectMetadata->mFrame->mEndOfStream);
+    common::ErrorCode errorCode =
+        pushOutputData(outputPort, outDataPipeId,
+                       std::static_pointer_cast<void>(objectMetadata));
     if (common::ErrorCode::SUCCESS != errorCode) {
-      for (unsigned i = 0; i < objectMetadatas.size(); i++) {
-        objectMetadatas[i]->mErrorCode = errorCode;
-      }
-      return;
+      IVS_WARN(
+          "Send data fail, element id: {0:d}, output port: {1:d}, data: "
+          "{2:p}",
+          getId(), outputPort, static_cast<void*>(objectMetadata.get()));
     }
   }
-  // 后处理
-  if (use_post)
-    mPostProcess->postProcess(mContext, objectMetadatas, dataPipeId);
 }
 
 common::ErrorCode Yolov5::doWork(int dataPipeId) {
-  common::ErrorCode errorCode = common::ErrorCode::SUCCESS;
-
   common::ObjectMetadatas objectMetadatas;
   std::vector<int> inputPorts = getInputPorts();
   int inputPort = inputPorts[0];
@@ -298,6 +410,7 @@ common::ErrorCode Yolov5::doWork(int dataPipeId) {
   }
 
   common::ObjectMetadatas pendingObjectMetadatas;
+  auto inflight = getInflightQueue(dataPipeId);
 
   while (objectMetadatas.size() < mContext->max_batch &&
          (getThreadStatus() == ThreadStatus::RUN)) {
@@ -319,24 +432,32 @@ common::ErrorCode Yolov5::doWork(int dataPipeId) {
     }
   }
 
-  process(objectMetadatas, dataPipeId);
-
-  for (auto& objectMetadata : pendingObjectMetadatas) {
-    int channel_id_internal = objectMetadata->mFrame->mChannelIdInternal;
-    int outDataPipeId =
-        getSinkElementFlag()
-            ? 0
-            : (channel_id_internal % getOutputConnectorCapacity(outputPort));
-    errorCode = pushOutputData(outputPort, outDataPipeId,
-                               std::static_pointer_cast<void>(objectMetadata));
-    if (common::ErrorCode::SUCCESS != errorCode) {
-      IVS_WARN(
-          "Send data fail, element id: {0:d}, output port: {1:d}, data: "
-          "{2:p}",
-          getId(), outputPort, static_cast<void*>(objectMetadata.get()));
-    }
+  if (inflight == nullptr) {
+    process(objectMetadatas, dataPipeId);
+    sendData(outputPort, pendingObjectMetadatas);
+    mFpsProfiler.add(objectMetadatas.size());
+    return common::ErrorCode::SUCCESS;
   }
-  mFpsProfiler.add(objectMetadatas.size());
+
+  // 异步推理：本线程做完预处理就回去收下一个batch，推理在在途队列中执行，
+  // 完成后按提交顺序做后处理并发送
+  auto batches = std::make_shared<std::vector<DeviceBatch>>(
+      splitByDevice(objectMetadatas));
+  for (auto& batch : *batches) batch.ok = !use_pre || runPreProcess(batch);
+  inflight->submit(
+      [this, batches]() {
+        for (auto& batch : *batches)
+          if (batch.ok) batch.ok = runInference(batch);
+      },
+      [this, batches, pendingObjectMetadatas, dataPipeId, outputPort,
+       frames = objectMetadatas.size()]() mutable {
+        if (use_post)
+          for (auto& batch : *batches)
+            if (batch.ok) runPostProcess(batch, dataPipeId);
+        sendData(outputPort, pendingObjectMetadatas);
+        mFpsProfiler.add(frames);
+      });
+  if (getThreadStatus() != ThreadStatus::RUN) inflight->drain();
 
   return common::ErrorCode::SUCCESS;
 }
@@ -388,6 +509,8 @@ void Yolov5::listenerSetConfThreshold(const httplib::Request& request,
   common::RequestSingleFloat rsi;
   common::str_to_object(request.body, rsi);
   mContext->thresh_conf_min = rsi.value;
+  for (auto& unit : mContext->device_units)
+    unit.second.context->thresh_conf_min = rsi.value;
   resp.code = 0;
   resp.msg = "success";
   nlohmann::json json_res = resp;
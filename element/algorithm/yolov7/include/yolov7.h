@@ -35,6 +35,8 @@ class Yolov7 : public ::sophon_stream::framework::Element {
 
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   void setContext(std::shared_ptr<::sophon_stream::element::Context> context);
   void setPreprocess(std::shared_ptr<::sophon_stream::element::PreProcess> pre);
   void setInference(std::shared_ptr<::sophon_stream::element::Inference> infer);
@@ -63,6 +65,8 @@ class Yolov7 : public ::sophon_stream::framework::Element {
       "threshold_nms";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_TPU_KERNEL_FIELD =
       "use_tpu_kernel";
+  static constexpr const char* CONFIG_INTERNAL_TPU_KERNEL_MODULE_PATH_FIELD =
+      "tpu_kernel_module_path";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_BGR2RGB_FIELD =
       "bgr2rgb";
   static constexpr const char* CONFIG_INTERNAL_THRESHOLD_MEAN_FIELD = "mean";
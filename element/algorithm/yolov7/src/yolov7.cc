@@ -94,9 +94,10 @@ common::ErrorCode Yolov7::initContext(const std::string& json) {
     mContext->use_tpu_kernel = tpu_kernelIt->get<bool>();
 
     // 1. get network
-    BMNNHandlePtr handle = std::make_shared<BMNNHandle>(mContext->deviceId);
-    mContext->bmContext = std::make_shared<BMNNContext>(
-        handle, modelPathIt->get<std::string>().c_str());
+    BMNNHandlePtr handle =
+        BMNNModelRegistry::getInstance().handle(mContext->deviceId);
+    mContext->bmContext = BMNNModelRegistry::getInstance().context(
+        handle, modelPathIt->get<std::string>());
     mContext->bmNetwork = mContext->bmContext->network(0);
     mContext->handle = handle->handle();
 
@@ -148,20 +149,20 @@ common::ErrorCode Yolov7::initContext(const std::string& json) {
 
     // 6. tpu_kernel postprocess
     if (mContext->use_tpu_kernel) {
-      tpu_kernel_module_t tpu_module;
-      std::string tpu_kernel_module_path =
-          "../../3rdparty/tpu_kernel_module/"
-          "libbm1684x_kernel_module.so";
-      std::ifstream file(tpu_kernel_module_path);
-      STREAM_CHECK(file.good(),
-                   "kernel_module.so does not exist, please check your path: ",
-                   tpu_kernel_module_path);
-      file.close();
-      tpu_module = tpu_kernel_load_module_file(mContext->bmContext->handle(),
-                                               tpu_kernel_module_path.c_str());
+      // 模块由框架缓存，每个设备只加载一次；json中可指定模块所在目录
+      std::string tpu_kernel_module_path;
+      auto modulePathIt =
+          configure.find(CONFIG_INTERNAL_TPU_KERNEL_MODULE_PATH_FIELD);
+      if (configure.end() != modulePathIt) {
+        STREAM_CHECK(modulePathIt->is_string(),
+                     "tpu_kernel_module_path must be a string, please check "
+                     "your Json files");
+        tpu_kernel_module_path = modulePathIt->get<std::string>();
+      }
       mContext->func_id =
-          tpu_kernel_get_function(mContext->bmContext->handle(), tpu_module,
-                                  "tpu_kernel_api_yolov5_detect_out");
+          common::TpuKernelModuleCache::getInstance().getFunction(
+              handle, "tpu_kernel_api_yolov5_detect_out",
+              tpu_kernel_module_path);
       std::cout << "Using tpu_kernel yolo postprocession, kernel funtion id: "
                 << mContext->func_id << std::endl;
     }
@@ -306,7 +307,8 @@ common::ErrorCode Yolov7::doWork(int dataPipeId) {
     int outDataPipeId =
         getSinkElementFlag()
             ? 0
-            : (channel_id_internal % getOutputConnectorCapacity(outputPort));
+            : getOutputDataPipeId(outputPort, channel_id_internal,
+                                  objectMetadata->mFrame->mEndOfStream);
     errorCode = pushOutputData(outputPort, outDataPipeId,
                                std::static_pointer_cast<void>(objectMetadata));
     if (common::ErrorCode::SUCCESS != errorCode) {
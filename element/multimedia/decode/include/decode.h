@@ -14,6 +14,7 @@
 #include <sys/prctl.h>
 
 #include "decoder.h"
+#include "device_balancer.h"
 #include "element_factory.h"
 
 namespace sophon_stream {
@@ -130,6 +131,8 @@ struct ChannelInfo {
   std::shared_ptr<std::mutex> mMtx;
   std::shared_ptr<std::condition_variable> mCv;
   std::shared_ptr<ThreadWrapper> mThreadWrapper;
+  // 配置多个设备时由DeviceBalancer分配的解码设备，未分配时为-1
+  int mDeviceId = -1;
 };
 
 class Decode : public ::sophon_stream::framework::Element {
@@ -173,6 +176,11 @@ class Decode : public ::sophon_stream::framework::Element {
   common::ErrorCode process(const std::shared_ptr<ChannelTask>& channelTask,
                             const std::shared_ptr<ChannelInfo>& channelInfo);
 
+  /**
+   * @brief 通道结束时把分配的设备还给DeviceBalancer，需持有mThreadsPoolMtx
+   */
+  void releaseDevice(ChannelInfo& channelInfo);
+
   common::ErrorCode parse_channel_task(
       std::shared_ptr<ChannelTask>& channelTask);
 
@@ -44,6 +44,7 @@ class Decoder : public ::sophon_stream::common::NoCopyable {
   std::string mUrl;
   int mDeviceId;
   int mGraphId;
+  std::uint64_t mGeneration;
   int mLoopNum;
   int mImgIndex;
   int mFrameCount;
@@ -62,6 +63,9 @@ class Decoder : public ::sophon_stream::common::NoCopyable {
   static std::condition_variable decoder_cv;
   static int numThreadsReady;
   static std::atomic<int> numThreadsTotal;
+
+  // 进程内递增，每次openDec后取一个新值写入Frame::mDecoderGeneration
+  static std::atomic<std::uint64_t> generationCounter;
 };
 }  // namespace decode
 }  // namespace element
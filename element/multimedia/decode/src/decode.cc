@@ -317,8 +317,18 @@ common::ErrorCode Decode::startTask(std::shared_ptr<ChannelTask>& channelTask) {
         IVS_INFO("channel info decoder address: {0:p}",
                  static_cast<void*>(channelInfo->mSpDecoder.get()));
 
-        common::ErrorCode ret =
-            channelInfo->mSpDecoder->init(getDeviceId(), getGraphId(), channelTask->request);
+        // 配置了多个设备时按负载选择解码设备，该通道的帧之后都留在这个设备上
+        int deviceId = getDeviceId();
+        std::vector<int> deviceIds = getDeviceIds();
+        if (deviceIds.size() > 1) {
+          deviceId =
+              framework::SingletonDeviceBalancer::getInstance().acquire(
+                  deviceIds);
+          channelInfo->mDeviceId = deviceId;
+        }
+
+        common::ErrorCode ret = channelInfo->mSpDecoder->init(
+            deviceId, getGraphId(), channelTask->request);
         if (ret != common::ErrorCode::SUCCESS) {
           channelTask->response.errorCode = ret;
           std::string error = "Decoder init failed! channel id is " +
@@ -337,6 +347,7 @@ common::ErrorCode Decode::startTask(std::shared_ptr<ChannelTask>& channelTask) {
         std::lock_guard<std::mutex> lk(mThreadsPoolMtx);
         channelInfo->mThreadWrapper->stop(false);
         channelInfo->mSpDecoder->uninit();
+        releaseDevice(*channelInfo);
         auto iter = mThreadsPool.find(channelTask->request.channelId);
         if (iter != mThreadsPool.end()) {
           mThreadsPool.erase(iter);
@@ -376,6 +387,7 @@ common::ErrorCode Decode::stopTask(std::shared_ptr<ChannelTask>& channelTask) {
   }
   common::ErrorCode errorCode = itTask->second->mThreadWrapper->stop();
   itTask->second->mSpDecoder->uninit();
+  releaseDevice(*itTask->second);
   itTask->second->mThreadWrapper.reset();
   mThreadsPool.erase(itTask);
   channelTask->response.errorCode = errorCode;
@@ -411,6 +423,13 @@ common::ErrorCode Decode::resumeTask(
   return errorCode;
 }
 
+void Decode::releaseDevice(ChannelInfo& channelInfo) {
+  if (channelInfo.mDeviceId < 0) return;
+  framework::SingletonDeviceBalancer::getInstance().release(
+      channelInfo.mDeviceId);
+  channelInfo.mDeviceId = -1;
+}
+
 common::ErrorCode Decode::process(
     const std::shared_ptr<ChannelTask>& channelTask,
     const std::shared_ptr<ChannelInfo>& channelInfo) {
@@ -423,6 +442,7 @@ common::ErrorCode Decode::process(
     channelTask->response.errorCode = ret;
     channelInfo->mThreadWrapper->stop(false);
     channelInfo->mSpDecoder->uninit();
+    releaseDevice(*channelInfo);
     auto iter = mThreadsPool.find(channelTask->request.channelId);
     if (iter != mThreadsPool.end()) {
       mThreadsPool.erase(iter);
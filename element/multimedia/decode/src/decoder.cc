@@ -18,6 +18,7 @@ std::mutex Decoder::decoder_mutex;
 std::condition_variable Decoder::decoder_cv;
 int Decoder::numThreadsReady = 0;
 std::atomic<int> Decoder::numThreadsTotal(0);
+std::atomic<std::uint64_t> Decoder::generationCounter(0);
 
 bool check_path(std::string file_path,
                 std::vector<std::string> correct_postfixes) {
@@ -85,6 +86,7 @@ common::ErrorCode Decoder::init(int deviceId, int graphId,
     int ret = bm_dev_request(&m_handle, deviceId);
     mDeviceId = deviceId;
     mGraphId = graphId;
+    mGeneration = ++generationCounter;
     mSourceType = request.sourceType;
     mImgIndex = 0;
     assert(BM_SUCCESS == ret);
@@ -160,6 +162,7 @@ common::ErrorCode Decoder::process(
     objectMetadata->mFrame->mSpData = spBmImage;
     objectMetadata->mFrame->mTimestamp = pts;
     objectMetadata->mGraphId = mGraphId;
+    objectMetadata->mFrame->mDecoderGeneration = mGeneration;
     if (eof) {
       objectMetadata->mFrame->mEndOfStream = true;
       errorCode = common::ErrorCode::STREAM_END;
@@ -185,12 +188,14 @@ common::ErrorCode Decoder::process(
     objectMetadata->mFrame->mSpData = spBmImage;
     objectMetadata->mFrame->mTimestamp = pts;
     objectMetadata->mGraphId = mGraphId;
+    objectMetadata->mFrame->mDecoderGeneration = mGeneration;
     /* 当mLoopNum > 1，在最后一帧初始化decoder，开始下一个循环 */
     if (mLoopNum > 1 && (mImgIndex++ == mFrameCount - 1)) {
       --mLoopNum;
       mImgIndex = 0;
       decoder.closeDec();
       decoder.openDec(&m_handle, mUrl.c_str());
+      mGeneration = ++generationCounter;
     }
 
     if (eof) {
@@ -215,6 +220,7 @@ common::ErrorCode Decoder::process(
     objectMetadata->mFrame->mFrameId = mImgIndex;
     objectMetadata->mFrame->mSpData = spBmImage;
     objectMetadata->mGraphId = mGraphId;
+    objectMetadata->mFrame->mDecoderGeneration = mGeneration;
 
     if (!mLoopNum) {
       objectMetadata->mFrame->mEndOfStream = true;
@@ -243,6 +249,7 @@ common::ErrorCode Decoder::process(
     objectMetadata->mFrame->mFrameId = mImgIndex++;
     objectMetadata->mFrame->mSpData = spBmImage;
     objectMetadata->mGraphId = mGraphId;
+    objectMetadata->mFrame->mDecoderGeneration = mGeneration;
     if (spBmImage != nullptr)
       bm_image2Frame(objectMetadata->mFrame, *spBmImage);
     if (common::ErrorCode::SUCCESS != errorCode) {
@@ -287,6 +294,7 @@ common::ErrorCode Decoder::process(
     objectMetadata->mFrame->mSpData = spBmImage;
     objectMetadata->mFrame->mTimestamp = pts;
     objectMetadata->mGraphId = mGraphId;
+    objectMetadata->mFrame->mDecoderGeneration = mGeneration;
 
     if (eof) {
       objectMetadata->mFrame->mEndOfStream = true;
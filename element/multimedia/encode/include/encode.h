@@ -29,6 +29,8 @@ class Encode : public ::sophon_stream::framework::Element {
 
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   static constexpr const char* CONFIG_INTERNAL_ENCODE_TYPE_FIELD =
       "encode_type";
   static constexpr const char* CONFIG_INTERNAL_RTSP_PORT_FIELD = "rtsp_port";
@@ -44,11 +46,25 @@ class Encode : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_WSENCTYPE_FIELD = "ws_enc_type";
   static constexpr const char* CONFIG_INTERNAL_IP_FIELD = "ip";
 
+  // for SEGMENT
+  static constexpr const char* CONFIG_INTERNAL_SEGMENT_FORMAT_FIELD =
+      "segment_format";
+  static constexpr const char* CONFIG_INTERNAL_SEGMENT_DURATION_FIELD =
+      "segment_duration";
+  static constexpr const char* CONFIG_INTERNAL_SEGMENT_WINDOW_FIELD =
+      "segment_window";
+  static constexpr const char* CONFIG_INTERNAL_FSYNC_POLICY_FIELD =
+      "fsync_policy";
+  static constexpr const char* CONFIG_INTERNAL_CLIP_DIR_FIELD = "clip_dir";
+
+  void registListenFunc(
+      sophon_stream::framework::ListenThread* listener) override;
+
  private:
   std::map<int, std::shared_ptr<Encoder>> mEncoderMap;
   bm_handle_t m_handle;
   std::map<int, std::string> mChannelOutputPath;
-  enum class EncodeType { RTSP, RTMP, VIDEO, IMG_DIR, WS, UNKNOWN };
+  enum class EncodeType { RTSP, RTMP, VIDEO, IMG_DIR, WS, SEGMENT, UNKNOWN };
   EncodeType mEncodeType;
   std::string mRtspPort;
   std::string mRtmpPort;
@@ -59,7 +75,7 @@ class Encode : public ::sophon_stream::framework::Element {
   int width = -1;
   int height = -1;
 
-  enum class WSencType {IMG_ONLY, SERIALIZED};
+  enum class WSencType {IMG_ONLY, IMG_BINARY, SERIALIZED};
   WSencType mWsEncType = WSencType::IMG_ONLY;
 
   std::string ip = "localhost";
@@ -69,7 +85,17 @@ class Encode : public ::sophon_stream::framework::Element {
   std::mutex mWSSThreadsMutex;
   std::string mWSSPort;
 
-  // 处理RTSP、RTMP、VIDEO
+  SegmentOptions mSegmentOptions;
+  // SEGMENT模式下channel_id到编码器的映射，供导出片段的http请求查找
+  std::map<int, std::shared_ptr<Encoder>> mChannelEncoderMap;
+  std::mutex mChannelEncoderMutex;
+  // 导出的片段只能写到该目录下，请求中的output是目录内的相对路径
+  std::string mClipDir = "./results/clips";
+  std::string postNameExtractClip = "/encode/ExtractClip";
+  void listenerExtractClip(const httplib::Request& request,
+                           httplib::Response& response);
+
+  // 处理RTSP、RTMP、VIDEO、SEGMENT
   void processVideoStream(
       int dataPipeId, std::shared_ptr<common::ObjectMetadata> objectMetadata);
   // 处理IMG_DIR
@@ -32,6 +32,7 @@ extern "C" {
 #include <libswscale/swscale.h>
 }
 #include "common/common_defs.h"
+#include "segment_writer.h"
 
 namespace sophon_stream {
 namespace element {
@@ -47,10 +48,22 @@ class Encoder {
   void set_output_path(const std::string& output_path);
   void set_enc_params_width(int width);
   void set_enc_params_height(int height);
+  /**
+   * @brief 设置后init_writer将output_path视为目录，按分片写入
+   */
+  void set_segment_options(const SegmentOptions& options);
   void init_writer();
   bool is_opened();
 
-  int video_write(bm_image& image);
+  /**
+   * @param timestampMs 帧时间戳，分片模式下用于建立时间索引
+   */
+  int video_write(bm_image& image, std::int64_t timestampMs = 0);
+  /**
+   * @brief 分片模式下从已写完的分片导出[startMs, endMs]的片段，不重新编码
+   */
+  int extract_clip(std::int64_t startMs, std::int64_t endMs,
+                   const std::string& outPath);
   void release();
 
  private:
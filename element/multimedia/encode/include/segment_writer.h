@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_SEGMENT_WRITER_H_
+#define SOPHON_STREAM_ELEMENT_SEGMENT_WRITER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+namespace sophon_stream {
+namespace element {
+namespace encode {
+
+/**
+ * @brief 分片录像参数
+ */
+struct SegmentOptions {
+  enum class Format { FMP4, TS };
+  enum class FsyncPolicy { NONE, SEGMENT };
+
+  Format format = Format::FMP4;
+  FsyncPolicy fsyncPolicy = FsyncPolicy::NONE;
+  // 单个分片的目标时长，分片只在关键帧处切换，实际时长会略长
+  int durationMs = 10000;
+  // 磁盘上保留的分片个数，0表示不删除
+  int window = 6;
+};
+
+/**
+ * @brief 将编码后的码流按时间切成独立可播放的fMP4或TS分片，滚动保留最近window个
+ * @brief 每个分片在索引文件中记录起止时间戳(毫秒，取自Frame::mTimestamp)，
+ * 可以按时间段直接拷贝码流导出告警前后的片段，不需要重新编码
+ * @brief write由编码器的发送线程调用；关闭分片后的fsync和过期分片的删除在
+ * 内部的后台线程完成，不阻塞写入
+ */
+class SegmentWriter {
+ public:
+  /**
+   * @param dir 分片输出目录，需已存在
+   * @param codecpar 编码器参数，fMP4需要其中的extradata
+   * @param timeBase 写入packet的时间基
+   */
+  SegmentWriter(const std::string& dir, const SegmentOptions& options,
+                const AVCodecParameters* codecpar, AVRational timeBase);
+  ~SegmentWriter();
+
+  /**
+   * @brief 写入一个packet，timestampMs为该帧的时间戳
+   * @brief 在第一个关键帧之前的packet会被丢弃
+   */
+  int write(AVPacket* pkt, std::int64_t timestampMs);
+
+  /**
+   * @brief 结束当前分片并等待后台线程处理完所有已关闭的分片
+   */
+  void close();
+
+  /**
+   * @brief 从已关闭的分片中导出[startMs, endMs]范围的片段到outPath
+   * @brief 导出从startMs之前最近的关键帧开始，只拷贝码流，不重新编码
+   * @return 0表示成功，负数为错误码；范围内没有已关闭的分片时返回AVERROR(ENOENT)
+   */
+  int extractClip(std::int64_t startMs, std::int64_t endMs,
+                  const std::string& outPath);
+
+  static constexpr const char* INDEX_FILE_NAME = "index.json";
+  static constexpr const char* PLAYLIST_FILE_NAME = "index.m3u8";
+
+ private:
+  struct Segment {
+    std::string file;
+    std::int64_t startMs;
+    std::int64_t endMs;
+    std::uint64_t sequence;
+  };
+
+  int openSegment(std::int64_t timestampMs);
+  void closeSegment();
+  void writeIndex();
+  void writePlaylist();
+  void backgroundFunc();
+
+  std::string mDir;
+  SegmentOptions mOptions;
+  AVCodecParameters* mCodecpar = nullptr;
+  AVRational mTimeBase;
+
+  AVFormatContext* mFormatCtx = nullptr;
+  Segment mCurrent;
+  std::int64_t mFirstPts = AV_NOPTS_VALUE;
+  std::int64_t mLastTimestampMs = 0;
+  std::uint64_t mSequence = 0;
+
+  // 已关闭、仍在磁盘上的分片，由mMutex保护，extractClip会并发读取
+  std::deque<Segment> mSegments;
+  std::mutex mMutex;
+
+  // 后台线程：对关闭的分片fsync，删除滑出窗口的分片
+  std::deque<std::string> mSyncQueue;
+  std::deque<std::string> mRemoveQueue;
+  std::condition_variable mCond;
+  std::thread mBackground;
+  bool mStopping = false;
+};
+
+}  // namespace encode
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_SEGMENT_WRITER_H_
@@ -13,7 +13,9 @@
 #include <sys/time.h>
 
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <websocketpp/server.hpp>
@@ -35,6 +37,25 @@ typedef std::set<connection_hdl, std::owner_less<connection_hdl>> con_list;
 
 static const std::string WS_STOP_FLAG = "ws_stop_flag";
 
+/**
+ * @brief IMG_BINARY模式下每条二进制消息的头部，小端，紧跟JPEG码流
+ */
+#pragma pack(push, 1)
+struct WSFrameHeader {
+  char magic[4] = {'S', 'S', 'W', 'S'};
+  std::uint16_t version = 1;
+  std::uint16_t headerSize = sizeof(WSFrameHeader);
+  std::uint32_t channelId = 0;
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  std::int64_t frameId = 0;
+  // 帧时间戳，与Frame::mTimestamp相同，单位微秒
+  std::int64_t timestamp = 0;
+  float fps = 0;
+};
+#pragma pack(pop)
+static_assert(sizeof(WSFrameHeader) == 40, "WSFrameHeader must be 40 bytes");
+
 class WSS {
  public:
   WSS();
@@ -52,18 +73,43 @@ class WSS {
 
   void stop();
 
+  // 文本消息，IMG_ONLY和SERIALIZED模式使用
   void pushImgDataQueue(const std::string& data);
 
-  std::string popImgDataQueue();
+  // 二进制消息，IMG_BINARY模式使用
+  void pushBinaryDataQueue(const std::string& data);
 
  private:
+  /**
+   * @brief 每个连接只保留最新一帧待发送的消息；连接的发送缓冲未清空时，
+   * 新帧覆盖旧帧，慢客户端只会丢帧，不会拖慢其他连接
+   */
+  struct Client {
+    message_ptr pending;
+  };
+
+  /**
+   * @brief 消息只组帧一次，所有连接共享同一个不可变的message，不按连接拷贝
+   */
+  message_ptr makeMessage(const std::string& data,
+                          websocketpp::frame::opcode::value opcode);
+
+  void pushMessage(message_ptr msg);
+
+  message_ptr popMessage();
+
+  // 把pending发给发送缓冲已清空(get_buffered_amount为0)的连接
+  void flushClients();
+
   server m_server;
-  con_list m_connections;
+  std::map<connection_hdl, Client, std::owner_less<connection_hdl>>
+      m_connections;
+  std::mutex m_connections_mtx;
   struct timeval m_last_send_time;
   struct timeval m_current_send_time;
   double m_fps;
   double m_frame_interval;
-  std::queue<std::string> mImgDataQueue;
+  std::queue<message_ptr> mImgDataQueue;
   std::mutex mQueueMtx;
 
   static constexpr int WSS_MAX_QUEUE_LEN = 5;
@@ -20,7 +20,7 @@ Encode::Encode() {}
 
 Encode::~Encode() {
   if (mEncodeType == EncodeType::RTSP || mEncodeType == EncodeType::RTMP ||
-      mEncodeType == EncodeType::VIDEO) {
+      mEncodeType == EncodeType::VIDEO || mEncodeType == EncodeType::SEGMENT) {
     for (auto it = mEncoderMap.begin(); it != mEncoderMap.end(); ++it) {
       it->second->release();
     }
@@ -49,6 +49,7 @@ common::ErrorCode Encode::initInternal(const std::string& json) {
       if (encodeType == "VIDEO") mEncodeType = EncodeType::VIDEO;
       if (encodeType == "IMG_DIR") mEncodeType = EncodeType::IMG_DIR;
       if (encodeType == "WS") mEncodeType = EncodeType::WS;
+      if (encodeType == "SEGMENT") mEncodeType = EncodeType::SEGMENT;
       IVS_DEBUG("EncodeType is {0}", encodeType);
     } else {
       errorCode = common::ErrorCode::PARSE_CONFIGURE_FAIL;
@@ -111,11 +112,51 @@ common::ErrorCode Encode::initInternal(const std::string& json) {
     if (wsTypeIt != configure.end()) {
       std::string wsEncType = wsTypeIt->get<std::string>();
       if (wsEncType == "IMG_ONLY") mWsEncType = WSencType::IMG_ONLY;
+      if (wsEncType == "IMG_BINARY") mWsEncType = WSencType::IMG_BINARY;
       if (wsEncType == "SERIALIZED") mWsEncType = WSencType::SERIALIZED;
     }
 
+    if (mEncodeType == EncodeType::SEGMENT) {
+      auto segmentFormatIt =
+          configure.find(CONFIG_INTERNAL_SEGMENT_FORMAT_FIELD);
+      if (configure.end() != segmentFormatIt) {
+        std::string segmentFormat = segmentFormatIt->get<std::string>();
+        if (segmentFormat == "FMP4") {
+          mSegmentOptions.format = SegmentOptions::Format::FMP4;
+        } else if (segmentFormat == "TS") {
+          mSegmentOptions.format = SegmentOptions::Format::TS;
+        } else {
+          IVS_ERROR("Segment format error, please input FMP4 or TS");
+        }
+      }
+      auto segmentDurationIt =
+          configure.find(CONFIG_INTERNAL_SEGMENT_DURATION_FIELD);
+      if (configure.end() != segmentDurationIt)
+        mSegmentOptions.durationMs =
+            static_cast<int>(segmentDurationIt->get<double>() * 1000);
+      auto segmentWindowIt =
+          configure.find(CONFIG_INTERNAL_SEGMENT_WINDOW_FIELD);
+      if (configure.end() != segmentWindowIt)
+        mSegmentOptions.window = segmentWindowIt->get<int>();
+      auto fsyncPolicyIt = configure.find(CONFIG_INTERNAL_FSYNC_POLICY_FIELD);
+      if (configure.end() != fsyncPolicyIt) {
+        std::string fsyncPolicy = fsyncPolicyIt->get<std::string>();
+        if (fsyncPolicy == "NONE") {
+          mSegmentOptions.fsyncPolicy = SegmentOptions::FsyncPolicy::NONE;
+        } else if (fsyncPolicy == "SEGMENT") {
+          mSegmentOptions.fsyncPolicy = SegmentOptions::FsyncPolicy::SEGMENT;
+        } else {
+          IVS_ERROR("Fsync policy error, please input NONE or SEGMENT");
+        }
+      }
+      auto clipDirIt = configure.find(CONFIG_INTERNAL_CLIP_DIR_FIELD);
+      if (configure.end() != clipDirIt && clipDirIt->is_string())
+        mClipDir = clipDirIt->get<std::string>();
+    }
+
     if (mEncodeType == EncodeType::RTSP || mEncodeType == EncodeType::RTMP ||
-        mEncodeType == EncodeType::VIDEO) {
+        mEncodeType == EncodeType::VIDEO ||
+        mEncodeType == EncodeType::SEGMENT) {
       auto encFmtIt = configure.find(CONFIG_INTERNAL_ENC_FMT_FIELD);
       if (configure.end() != encFmtIt) {
         encFmt = encFmtIt->get<std::string>();
@@ -162,6 +203,8 @@ common::ErrorCode Encode::initInternal(const std::string& json) {
       for (int i = 0; i < threadNumber; ++i) {
         mEncoderMap[i] =
             std::make_shared<Encoder>(dev_id, encFmt, pixFmt, mEncodeParams, i);
+        if (mEncodeType == EncodeType::SEGMENT)
+          mEncoderMap[i]->set_segment_options(mSegmentOptions);
       }
     } else if (mEncodeType == EncodeType::IMG_DIR) {
       const char* dir_path = "./results";
@@ -241,7 +284,8 @@ common::ErrorCode Encode::doWork(int dataPipeId) {
                 objectMetadata->mSkipElements.end(),
                 getId()) == objectMetadata->mSkipElements.end()) {
     if (mEncodeType == EncodeType::RTSP || mEncodeType == EncodeType::RTMP ||
-        mEncodeType == EncodeType::VIDEO) {
+        mEncodeType == EncodeType::VIDEO ||
+        mEncodeType == EncodeType::SEGMENT) {
       processVideoStream(dataPipeId, objectMetadata);
     } else if (mEncodeType == EncodeType::IMG_DIR) {
       processImgDir(dataPipeId, objectMetadata);
@@ -273,7 +317,7 @@ common::ErrorCode Encode::doWork(int dataPipeId) {
   return common::ErrorCode::SUCCESS;
 }
 
-// 处理RTSP、RTMP、VIDEO
+// 处理RTSP、RTMP、VIDEO、SEGMENT
 void Encode::processVideoStream(
     int dataPipeId, std::shared_ptr<common::ObjectMetadata> objectMetadata) {
   auto encodeIt = mEncoderMap.find(dataPipeId);
@@ -308,8 +352,24 @@ void Encode::processVideoStream(
                         "_" + std::to_string(channel_id) +
                         (encFmt == "h265_bm" ? ".mp4" : ".avi");
         } break;
+        case EncodeType::SEGMENT: {
+          // 每路一个目录，分片和索引文件都写在其中
+          output_path = "./results/" +
+                        std::to_string(objectMetadata->mGraphId) + "_" +
+                        std::to_string(channel_id);
+          mkdir("./results", 0777);
+          struct stat info;
+          if (!(stat(output_path.c_str(), &info) == 0 &&
+                S_ISDIR(info.st_mode)) &&
+              mkdir(output_path.c_str(), 0777) != 0) {
+            IVS_ERROR("Error creating segment directory {0}", output_path);
+          }
+          std::lock_guard<std::mutex> lk(mChannelEncoderMutex);
+          mChannelEncoderMap[channel_id] = encodeIt->second;
+        } break;
         default:
-          IVS_ERROR("Encode type error, please input RTSP, RTMP or VIDEO");
+          IVS_ERROR(
+              "Encode type error, please input RTSP, RTMP, VIDEO or SEGMENT");
       }
 
       mChannelOutputPath[channel_id] = output_path;
@@ -320,10 +380,14 @@ void Encode::processVideoStream(
           height == -1 ? objectMetadata->mFrame->mHeight : height);
       encodeIt->second->init_writer();
     }
+    // mTimestamp单位为微秒
+    std::int64_t timestampMs = objectMetadata->mFrame->mTimestamp / 1000;
     if (objectMetadata->mFrame->mSpDataOsd) {
-      encodeIt->second->video_write(*(objectMetadata->mFrame->mSpDataOsd));
+      encodeIt->second->video_write(*(objectMetadata->mFrame->mSpDataOsd),
+                                    timestampMs);
     } else {
-      encodeIt->second->video_write(*(objectMetadata->mFrame->mSpData));
+      encodeIt->second->video_write(*(objectMetadata->mFrame->mSpData),
+                                    timestampMs);
     }
   }
 }
@@ -391,7 +455,8 @@ void Encode::processWS(int dataPipeId,
     serverIt = mWSSMap.find(dataPipeId);
   }
   std::string data;
-  if (mWsEncType == WSencType::IMG_ONLY) {
+  if (mWsEncType == WSencType::IMG_ONLY ||
+      mWsEncType == WSencType::IMG_BINARY) {
     void* jpeg_data = NULL;
     size_t out_size = 0;
     std::shared_ptr<bm_image> img = objectMetadata->mFrame->mSpDataOsd
@@ -421,8 +486,24 @@ void Encode::processWS(int dataPipeId,
 
     bmcv_image_jpeg_enc(objectMetadata->mFrame->mHandle, 1, img_to_enc.get(),
                         &jpeg_data, &out_size);
-    data =
-        websocketpp::base64_encode((const unsigned char*)jpeg_data, out_size);
+    if (mWsEncType == WSencType::IMG_ONLY) {
+      data =
+          websocketpp::base64_encode((const unsigned char*)jpeg_data, out_size);
+    } else {
+      // 头部和JPEG码流拼成一条二进制消息，省去base64带来的1/3膨胀
+      WSFrameHeader header;
+      header.channelId = objectMetadata->mFrame->mChannelId;
+      header.width = img_to_enc->width;
+      header.height = img_to_enc->height;
+      header.frameId = objectMetadata->mFrame->mFrameId;
+      header.timestamp = objectMetadata->mFrame->mTimestamp;
+      header.fps =
+          mFpsProfilers[objectMetadata->mFrame->mChannelIdInternal]
+              ->getTmpFps();
+      data.reserve(sizeof(header) + out_size);
+      data.append(reinterpret_cast<const char*>(&header), sizeof(header));
+      data.append(static_cast<const char*>(jpeg_data), out_size);
+    }
     free(jpeg_data);
   }
   if (mWsEncType == WSencType::SERIALIZED) {
@@ -432,7 +513,10 @@ void Encode::processWS(int dataPipeId,
     data = serializedObj.dump();
   }
   // base64 img 存入队列
-  serverIt->second->pushImgDataQueue(data);
+  if (mWsEncType == WSencType::IMG_BINARY)
+    serverIt->second->pushBinaryDataQueue(data);
+  else
+    serverIt->second->pushImgDataQueue(data);
 }
 
 // WS发送停止标识
@@ -443,6 +527,61 @@ void Encode::stopWS(int dataPipeId) {
   serverIt->second->pushImgDataQueue(WS_STOP_FLAG);
 }
 
+void Encode::registListenFunc(
+    sophon_stream::framework::ListenThread* listener) {
+  if (mEncodeType != EncodeType::SEGMENT) return;
+  std::string handlerName = postNameExtractClip + "/" + std::to_string(getId());
+  listener->setHandler(handlerName.c_str(),
+                       sophon_stream::framework::RequestType::POST,
+                       std::bind(&Encode::listenerExtractClip, this,
+                                 std::placeholders::_1, std::placeholders::_2));
+}
+
+// 请求体：{"channel_id": 0, "start_ms": ..., "end_ms": ..., "output": "x.mp4"}
+// output是clip_dir下的相对路径，不允许绝对路径和".."
+void Encode::listenerExtractClip(const httplib::Request& request,
+                                 httplib::Response& response) {
+  common::Response resp;
+  resp.code = -1;
+  auto body = nlohmann::json::parse(request.body, nullptr, false);
+  auto isInteger = [&body](const char* name) {
+    auto it = body.find(name);
+    return it != body.end() && it->is_number_integer();
+  };
+  auto outputIt = body.find("output");
+  if (!body.is_object() || !isInteger("channel_id") ||
+      !isInteger("start_ms") || !isInteger("end_ms") ||
+      body.end() == outputIt || !outputIt->is_string()) {
+    resp.msg =
+        "channel_id, start_ms, end_ms (integers) and output (string) are "
+        "required";
+  } else {
+    std::string output = outputIt->get<std::string>();
+    if (output.empty() || output[0] == '/' ||
+        output.find("..") != std::string::npos) {
+      resp.msg = "output must be a relative path inside clip_dir";
+    } else {
+      std::shared_ptr<Encoder> encoder;
+      {
+        std::lock_guard<std::mutex> lk(mChannelEncoderMutex);
+        auto it = mChannelEncoderMap.find(body["channel_id"].get<int>());
+        if (it != mChannelEncoderMap.end()) encoder = it->second;
+      }
+      struct stat info;
+      if (stat(mClipDir.c_str(), &info) != 0) mkdir(mClipDir.c_str(), 0777);
+      int ret = encoder ? encoder->extract_clip(
+                              body["start_ms"].get<std::int64_t>(),
+                              body["end_ms"].get<std::int64_t>(),
+                              mClipDir + "/" + output)
+                        : -1;
+      resp.code = ret;
+      resp.msg = ret == 0 ? "success" : "extract clip failed";
+    }
+  }
+  nlohmann::json json_res = resp;
+  response.set_content(json_res.dump(), "application/json");
+}
+
 REGISTER_WORKER("encode", Encode)
 
 }  // namespace encode
@@ -9,6 +9,8 @@
 
 #include "encoder.h"
 
+#include <algorithm>
+
 namespace sophon_stream {
 namespace element {
 namespace encode {
@@ -50,10 +52,13 @@ class Encoder::Encoder_CC {
   void set_output_path(const std::string& output_path);
   void init_writer();
   bool is_opened();
-  int video_write(bm_image& image);
+  int video_write(bm_image& image, std::int64_t timestampMs);
+  int extract_clip(std::int64_t startMs, std::int64_t endMs,
+                   const std::string& outPath);
   void release();
   void set_enc_params_width(int width);
   void set_enc_params_height(int height);
+  void set_segment_options(const SegmentOptions& options);
 
  private:
   int index;
@@ -69,6 +74,7 @@ class Encoder::Encoder_CC {
   bool is_video_file_;
   bool is_rtsp_;
   bool is_rtmp_;
+  bool is_segment_;
   bool opened_;
 
   int channel_idx;
@@ -90,6 +96,18 @@ class Encoder::Encoder_CC {
   AVStream* out_stream_;
   AVPacket* pkt_;
 
+  SegmentOptions segment_options_;
+  std::unique_ptr<SegmentWriter> segment_writer_;
+  // 分片模式下编码器pts到帧时间戳的映射，packet输出时取回
+  std::map<int64_t, int64_t> pts_timestamp_;
+  int64_t last_timestamp_ms_ = -1;
+
+  struct SegmentPacket {
+    std::shared_ptr<AVPacket> pkt;
+    int64_t timestampMs;
+  };
+  int64_t take_timestamp(int64_t pts);
+
   void enc_params_prase();
   int map_bmformat_to_avformat(int bmformat);
   int bm_image_to_avframe(bm_handle_t& handle, bm_image* image, AVFrame* frame);
@@ -120,7 +138,14 @@ Encoder::~Encoder() { delete _impl; }
 
 bool Encoder::is_opened() { return _impl->is_opened(); }
 
-int Encoder::video_write(bm_image& image) { return _impl->video_write(image); }
+int Encoder::video_write(bm_image& image, std::int64_t timestampMs) {
+  return _impl->video_write(image, timestampMs);
+}
+
+int Encoder::extract_clip(std::int64_t startMs, std::int64_t endMs,
+                          const std::string& outPath) {
+  return _impl->extract_clip(startMs, endMs, outPath);
+}
 
 void Encoder::set_output_path(const std::string& output_path) {
   return _impl->set_output_path(output_path);
@@ -134,6 +159,9 @@ void Encoder::set_enc_params_width(int width) {
 void Encoder::set_enc_params_height(int height) {
   return _impl->set_enc_params_height(height);
 }
+void Encoder::set_segment_options(const SegmentOptions& options) {
+  return _impl->set_segment_options(options);
+}
 
 int Encoder::Encoder_CC::map_bmformat_to_avformat(int bmformat) {
   int format = 0;
@@ -198,6 +226,7 @@ Encoder::Encoder_CC::Encoder_CC(int dev_id, const std::string& enc_fmt,
       is_rtsp_(false),
       is_rtmp_(false),
       is_video_file_(false),
+      is_segment_(false),
       opened_(false),
       enc_ctx_(nullptr),
       enc_dict_(nullptr),
@@ -238,7 +267,10 @@ void Encoder::Encoder_CC::init_writer() {
     }
     opened_ = true;
   } else {
-    if (output_path_.compare(0, 7, "rtsp://") == 0) {
+    if (is_segment_) {
+      // 分片模式由SegmentWriter为每个分片单独创建输出上下文
+      enc_format_ctx_ = nullptr;
+    } else if (output_path_.compare(0, 7, "rtsp://") == 0) {
       is_rtsp_ = true;
       avformat_alloc_output_context2(&enc_format_ctx_, NULL, "rtsp",
                                      output_path_.c_str());
@@ -286,6 +318,23 @@ void Encoder::Encoder_CC::init_writer() {
       av_dict_set_int(&enc_dict_, "qp", params_map_["qp"], 0);
     }
 
+    if (is_segment_) {
+      if (segment_options_.format == SegmentOptions::Format::FMP4)
+        enc_ctx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+      int ret = avcodec_open2(enc_ctx_, encoder_, &enc_dict_);
+      if (ret < 0) {
+        IVS_ERROR("avcodec_open2 failed!");
+        abort();
+      }
+      AVCodecParameters* codecpar = avcodec_parameters_alloc();
+      avcodec_parameters_from_context(codecpar, enc_ctx_);
+      segment_writer_.reset(new SegmentWriter(output_path_, segment_options_,
+                                              codecpar, enc_ctx_->time_base));
+      avcodec_parameters_free(&codecpar);
+      opened_ = true;
+      return;
+    }
+
     out_stream_ = avformat_new_stream(enc_format_ctx_, encoder_);
 
     out_stream_->time_base = enc_ctx_->time_base;
@@ -334,7 +383,7 @@ int Encoder::Encoder_CC::bm_image_to_avframe(bm_handle_t& handle,
   bm_image_format_info info;
   int encode_stride = ((params_map_["width"] + 31) >> 5) << 5;
 
-  if (is_rtsp_ || is_video_file_) {
+  if (is_rtsp_ || is_video_file_ || is_segment_) {
     if (pix_fmt_ == AV_PIX_FMT_YUV420P) {
       plane = 3;
       int stride_bmi[3] = {encode_stride, encode_stride / 2, encode_stride / 2};
@@ -482,7 +531,11 @@ void Encoder::Encoder_CC::flowControlFunc() {
       continue;
     }
 
-    if (is_rtsp_ || is_video_file_) {
+    if (is_segment_) {
+      std::shared_ptr<SegmentPacket> pp =
+          std::static_pointer_cast<SegmentPacket>(p);
+      segment_writer_->write(pp->pkt.get(), pp->timestampMs);
+    } else if (is_rtsp_ || is_video_file_) {
       std::shared_ptr<AVPacket> pp = std::static_pointer_cast<AVPacket>(p);
       auto ret = av_interleaved_write_frame(enc_format_ctx_, pp.get());
     } else if (is_rtmp_) {
@@ -493,8 +546,15 @@ void Encoder::Encoder_CC::flowControlFunc() {
   return;
 }
 
-int Encoder::Encoder_CC::video_write(bm_image& image) {
-  if (is_rtsp_ || is_video_file_) {
+int64_t Encoder::Encoder_CC::take_timestamp(int64_t pts) {
+  auto it = pts_timestamp_.find(pts);
+  int64_t timestampMs = it != pts_timestamp_.end() ? it->second : -1;
+  pts_timestamp_.erase(pts_timestamp_.begin(), pts_timestamp_.upper_bound(pts));
+  return timestampMs;
+}
+
+int Encoder::Encoder_CC::video_write(bm_image& image, int64_t timestampMs) {
+  if (is_rtsp_ || is_video_file_ || is_segment_) {
     // auto _start_time = std::chrono::high_resolution_clock::now();
 
     int ret = 0;
@@ -515,6 +575,15 @@ int Encoder::Encoder_CC::video_write(bm_image& image) {
 
     ret = bm_image_to_avframe(handle_, &image, frame_.get());
     if (ret < 0) return -1;
+    if (is_segment_) {
+      // 时间戳缺失或回退(如图片源)时按帧率递推，保证索引单调
+      if (timestampMs <= last_timestamp_ms_)
+        timestampMs =
+            last_timestamp_ms_ + 1000 / std::max(params_map_["framerate"], 1);
+      last_timestamp_ms_ = timestampMs;
+      frame_->pts = index++;
+      pts_timestamp_[frame_->pts] = timestampMs;
+    }
     test_enc_pkt->data = NULL;
     test_enc_pkt->size = 0;
     av_init_packet(test_enc_pkt.get());
@@ -525,6 +594,23 @@ int Encoder::Encoder_CC::video_write(bm_image& image) {
     if (got_output == 0) {
       return -1;
     }
+    if (is_segment_) {
+      auto segment_pkt = std::make_shared<SegmentPacket>();
+      segment_pkt->pkt = test_enc_pkt;
+      segment_pkt->timestampMs = take_timestamp(test_enc_pkt->pts);
+      if (segment_pkt->timestampMs < 0)
+        segment_pkt->timestampMs = last_timestamp_ms_;
+      // 归档不能丢帧：队列满时等发送线程写出，而不是像推流那样丢弃
+      while (!pushQueue(std::static_pointer_cast<void>(segment_pkt))) {
+        if (!isRunning) {
+          segment_writer_->write(segment_pkt->pkt.get(),
+                                 segment_pkt->timestampMs);
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+      return ret;
+    }
     av_packet_rescale_ts(test_enc_pkt.get(), enc_ctx_->time_base,
                          out_stream_->time_base);
     pushQueue(std::static_pointer_cast<void>(test_enc_pkt));
@@ -564,6 +650,15 @@ int Encoder::Encoder_CC::flush_encoder() {
 
     if (!got_frame) break;
 
+    if (is_segment_) {
+      int64_t timestampMs = take_timestamp(temp_enc_pkt.pts);
+      ret = segment_writer_->write(
+          &temp_enc_pkt, timestampMs < 0 ? last_timestamp_ms_ : timestampMs);
+      av_packet_unref(&temp_enc_pkt);
+      if (ret < 0) break;
+      continue;
+    }
+
     av_packet_rescale_ts(&temp_enc_pkt, this->enc_ctx_->time_base,
                          this->out_stream_->time_base);
     /* mux encoded frame */
@@ -577,9 +672,19 @@ int Encoder::Encoder_CC::flush_encoder() {
 void Encoder::Encoder_CC::release() {
   isRunning = false;
   flow_control.join();
+  if (is_segment_ && segment_writer_) {
+    // 归档不能丢帧，发送线程退出后把队列中剩余的packet写完
+    while (auto p = popQueue()) {
+      auto pp = std::static_pointer_cast<SegmentPacket>(p);
+      segment_writer_->write(pp->pkt.get(), pp->timestampMs);
+    }
+  }
   if (enc_ctx_) {
     flush_encoder();
-    av_write_trailer(enc_format_ctx_);
+    if (segment_writer_)
+      segment_writer_->close();
+    else
+      av_write_trailer(enc_format_ctx_);
   }
 
   if (enc_dict_) av_dict_free(&enc_dict_);
@@ -600,6 +705,17 @@ void Encoder::Encoder_CC::set_enc_params_height(int height) {
   params_map_["height"] = height;
 }
 
+void Encoder::Encoder_CC::set_segment_options(const SegmentOptions& options) {
+  is_segment_ = true;
+  segment_options_ = options;
+}
+
+int Encoder::Encoder_CC::extract_clip(int64_t startMs, int64_t endMs,
+                                      const std::string& outPath) {
+  if (!opened_ || !segment_writer_) return AVERROR(EINVAL);
+  return segment_writer_->extractClip(startMs, endMs, outPath);
+}
+
 }  // namespace encode
 }  // namespace element
 }  // namespace sophon_stream
@@ -0,0 +1,374 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "segment_writer.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+
+namespace sophon_stream {
+namespace element {
+namespace encode {
+
+namespace {
+
+void syncPath(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  ::fsync(fd);
+  ::close(fd);
+}
+
+// 先写临时文件再rename，读者不会看到写了一半的索引
+void replaceFile(const std::string& path, const std::string& content) {
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream ofs(tmp, std::ios::trunc);
+    ofs << content;
+  }
+  std::rename(tmp.c_str(), path.c_str());
+}
+
+}  // namespace
+
+SegmentWriter::SegmentWriter(const std::string& dir,
+                             const SegmentOptions& options,
+                             const AVCodecParameters* codecpar,
+                             AVRational timeBase)
+    : mDir(dir), mOptions(options), mTimeBase(timeBase) {
+  mCodecpar = avcodec_parameters_alloc();
+  avcodec_parameters_copy(mCodecpar, codecpar);
+  mBackground = std::thread(&SegmentWriter::backgroundFunc, this);
+}
+
+SegmentWriter::~SegmentWriter() {
+  close();
+  avcodec_parameters_free(&mCodecpar);
+}
+
+int SegmentWriter::openSegment(std::int64_t timestampMs) {
+  mCurrent.sequence = mSequence++;
+  char name[64];
+  snprintf(name, sizeof(name), "segment_%06llu.%s",
+           static_cast<unsigned long long>(mCurrent.sequence),
+           mOptions.format == SegmentOptions::Format::FMP4 ? "mp4" : "ts");
+  mCurrent.file = name;
+  mCurrent.startMs = timestampMs;
+  mCurrent.endMs = timestampMs;
+  mFirstPts = AV_NOPTS_VALUE;
+
+  std::string path = mDir + "/" + mCurrent.file;
+  const char* formatName =
+      mOptions.format == SegmentOptions::Format::FMP4 ? "mp4" : "mpegts";
+  int ret = avformat_alloc_output_context2(&mFormatCtx, NULL, formatName,
+                                           path.c_str());
+  if (ret < 0 || !mFormatCtx) {
+    IVS_ERROR("Alloc segment output context failed, path: {0}", path);
+    mFormatCtx = nullptr;
+    return ret < 0 ? ret : AVERROR(ENOMEM);
+  }
+  AVStream* stream = avformat_new_stream(mFormatCtx, NULL);
+  avcodec_parameters_copy(stream->codecpar, mCodecpar);
+  stream->codecpar->codec_tag = 0;
+  stream->time_base = mTimeBase;
+
+  ret = avio_open(&mFormatCtx->pb, path.c_str(), AVIO_FLAG_WRITE);
+  if (ret < 0) {
+    IVS_ERROR("Open segment file failed, path: {0}", path);
+    avformat_free_context(mFormatCtx);
+    mFormatCtx = nullptr;
+    return ret;
+  }
+
+  AVDictionary* opts = NULL;
+  if (mOptions.format == SegmentOptions::Format::FMP4) {
+    // 每个关键帧一个moof，moov不含样本表，进程异常退出时已写入的fragment仍可播放
+    av_dict_set(&opts, "movflags", "frag_keyframe+empty_moov+default_base_moof",
+                0);
+  }
+  ret = avformat_write_header(mFormatCtx, &opts);
+  av_dict_free(&opts);
+  if (ret < 0) {
+    IVS_ERROR("Write segment header failed, path: {0}", path);
+    avio_closep(&mFormatCtx->pb);
+    avformat_free_context(mFormatCtx);
+    mFormatCtx = nullptr;
+  }
+  return ret;
+}
+
+void SegmentWriter::closeSegment() {
+  if (!mFormatCtx) return;
+  av_write_trailer(mFormatCtx);
+  avio_closep(&mFormatCtx->pb);
+  avformat_free_context(mFormatCtx);
+  mFormatCtx = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSegments.push_back(mCurrent);
+    while (mOptions.window > 0 &&
+           mSegments.size() > static_cast<std::size_t>(mOptions.window)) {
+      mRemoveQueue.push_back(mSegments.front().file);
+      mSegments.pop_front();
+    }
+    writeIndex();
+    if (mOptions.format == SegmentOptions::Format::TS) writePlaylist();
+    if (mOptions.fsyncPolicy == SegmentOptions::FsyncPolicy::SEGMENT) {
+      mSyncQueue.push_back(mCurrent.file);
+      mSyncQueue.push_back(INDEX_FILE_NAME);
+    }
+  }
+  mCond.notify_one();
+}
+
+void SegmentWriter::writeIndex() {
+  nlohmann::json segments = nlohmann::json::array();
+  for (auto& segment : mSegments) {
+    segments.push_back({{"file", segment.file},
+                        {"sequence", segment.sequence},
+                        {"start_ms", segment.startMs},
+                        {"end_ms", segment.endMs}});
+  }
+  nlohmann::json index = {{"segments", segments}};
+  replaceFile(mDir + "/" + INDEX_FILE_NAME, index.dump());
+}
+
+void SegmentWriter::writePlaylist() {
+  double targetDuration = mOptions.durationMs / 1000.0;
+  for (auto& segment : mSegments)
+    targetDuration =
+        std::max(targetDuration, (segment.endMs - segment.startMs) / 1000.0);
+
+  std::string playlist = "#EXTM3U\n#EXT-X-VERSION:3\n";
+  playlist += "#EXT-X-TARGETDURATION:" +
+              std::to_string(static_cast<int>(std::ceil(targetDuration))) +
+              "\n";
+  playlist += "#EXT-X-MEDIA-SEQUENCE:" +
+              std::to_string(mSegments.empty() ? 0
+                                               : mSegments.front().sequence) +
+              "\n";
+  char extinf[64];
+  for (auto& segment : mSegments) {
+    snprintf(extinf, sizeof(extinf), "#EXTINF:%.3f,\n",
+             (segment.endMs - segment.startMs) / 1000.0);
+    playlist += extinf;
+    playlist += segment.file + "\n";
+  }
+  replaceFile(mDir + "/" + PLAYLIST_FILE_NAME, playlist);
+}
+
+int SegmentWriter::write(AVPacket* pkt, std::int64_t timestampMs) {
+  bool isKey = pkt->flags & AV_PKT_FLAG_KEY;
+  if (!mFormatCtx) {
+    // 分片必须以关键帧开头，才能单独播放和拷贝导出
+    if (!isKey) return 0;
+    int ret = openSegment(timestampMs);
+    if (ret < 0) return ret;
+  } else if (isKey && timestampMs - mCurrent.startMs >= mOptions.durationMs) {
+    mCurrent.endMs = timestampMs;
+    closeSegment();
+    int ret = openSegment(timestampMs);
+    if (ret < 0) return ret;
+  }
+
+  AVPacket* out = av_packet_clone(pkt);
+  if (!out) return AVERROR(ENOMEM);
+  // 每个分片的时间戳从0开始，绝对时间记录在索引中
+  if (mFirstPts == AV_NOPTS_VALUE)
+    mFirstPts = out->dts != AV_NOPTS_VALUE ? out->dts : out->pts;
+  if (mFirstPts != AV_NOPTS_VALUE) {
+    if (out->pts != AV_NOPTS_VALUE) out->pts -= mFirstPts;
+    if (out->dts != AV_NOPTS_VALUE) out->dts -= mFirstPts;
+  }
+  out->stream_index = 0;
+  av_packet_rescale_ts(out, mTimeBase, mFormatCtx->streams[0]->time_base);
+  int ret = av_interleaved_write_frame(mFormatCtx, out);
+  av_packet_free(&out);
+
+  mLastTimestampMs = timestampMs;
+  mCurrent.endMs = timestampMs;
+  return ret;
+}
+
+void SegmentWriter::close() {
+  if (mFormatCtx) {
+    mCurrent.endMs = mLastTimestampMs;
+    closeSegment();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mCond.notify_one();
+  if (mBackground.joinable()) mBackground.join();
+}
+
+void SegmentWriter::backgroundFunc() {
+  while (true) {
+    std::string syncFile;
+    std::string removeFile;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCond.wait(lock, [this] {
+        return mStopping || !mSyncQueue.empty() || !mRemoveQueue.empty();
+      });
+      if (mSyncQueue.empty() && mRemoveQueue.empty()) break;
+      if (!mSyncQueue.empty()) {
+        syncFile = mSyncQueue.front();
+        mSyncQueue.pop_front();
+      }
+      if (!mRemoveQueue.empty()) {
+        removeFile = mRemoveQueue.front();
+        mRemoveQueue.pop_front();
+      }
+    }
+    if (!syncFile.empty()) {
+      syncPath(mDir + "/" + syncFile);
+      // 新文件和rename后的索引需要同步目录项才能保证掉电后可见
+      if (syncFile == INDEX_FILE_NAME) syncPath(mDir);
+    }
+    if (!removeFile.empty()) ::unlink((mDir + "/" + removeFile).c_str());
+  }
+}
+
+int SegmentWriter::extractClip(std::int64_t startMs, std::int64_t endMs,
+                               const std::string& outPath) {
+  std::vector<Segment> segments;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    for (auto& segment : mSegments) {
+      if (segment.endMs >= startMs && segment.startMs <= endMs)
+        segments.push_back(segment);
+    }
+  }
+  if (segments.empty()) return AVERROR(ENOENT);
+
+  AVFormatContext* outCtx = nullptr;
+  int ret =
+      avformat_alloc_output_context2(&outCtx, NULL, NULL, outPath.c_str());
+  if (ret < 0 || !outCtx) return ret < 0 ? ret : AVERROR(EINVAL);
+
+  AVStream* outStream = nullptr;
+  bool headerWritten = false;
+  bool finished = false;
+  std::int64_t clipStartMs = 0;
+  // startMs之前最近一个关键帧起的packet，找到startMs后一起写出
+  std::vector<std::pair<AVPacket*, std::int64_t>> pending;
+
+  for (auto& segment : segments) {
+    if (finished || ret < 0) break;
+    AVFormatContext* inCtx = nullptr;
+    std::string path = mDir + "/" + segment.file;
+    // 分片可能刚好滑出窗口被删除，跳过即可
+    if (avformat_open_input(&inCtx, path.c_str(), NULL, NULL) < 0) continue;
+    if (avformat_find_stream_info(inCtx, NULL) < 0 || inCtx->nb_streams < 1) {
+      avformat_close_input(&inCtx);
+      continue;
+    }
+    AVStream* inStream = inCtx->streams[0];
+    AVRational inTimeBase = inStream->time_base;
+
+    if (!outStream) {
+      outStream = avformat_new_stream(outCtx, NULL);
+      avcodec_parameters_copy(outStream->codecpar, inStream->codecpar);
+      outStream->codecpar->codec_tag = 0;
+      outStream->time_base = inTimeBase;
+    }
+
+    std::int64_t segmentFirstTs = AV_NOPTS_VALUE;
+    auto writeOut = [&](AVPacket* p, std::int64_t ms) {
+      // 以clip起点为0重新排列时间戳，跨分片保持连续
+      std::int64_t shift =
+          av_rescale_q(segment.startMs - clipStartMs, {1, 1000}, inTimeBase) -
+          segmentFirstTs;
+      if (p->pts != AV_NOPTS_VALUE) p->pts += shift;
+      if (p->dts != AV_NOPTS_VALUE) p->dts += shift;
+      av_packet_rescale_ts(p, inTimeBase, outStream->time_base);
+      p->stream_index = 0;
+      p->pos = -1;
+      return av_interleaved_write_frame(outCtx, p);
+    };
+
+    AVPacket* pkt = av_packet_alloc();
+    while (ret >= 0 && av_read_frame(inCtx, pkt) >= 0) {
+      if (pkt->stream_index != 0) {
+        av_packet_unref(pkt);
+        continue;
+      }
+      std::int64_t ts = pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts;
+      if (segmentFirstTs == AV_NOPTS_VALUE) segmentFirstTs = ts;
+      std::int64_t ms = segment.startMs +
+                        av_rescale_q(ts - segmentFirstTs, inTimeBase,
+                                     {1, 1000});
+      if (ms > endMs) {
+        av_packet_unref(pkt);
+        finished = true;
+        break;
+      }
+      if (!headerWritten) {
+        bool isKey = pkt->flags & AV_PKT_FLAG_KEY;
+        if (isKey) {
+          for (auto& p : pending) av_packet_free(&p.first);
+          pending.clear();
+        }
+        if (!isKey && pending.empty()) {
+          av_packet_unref(pkt);
+          continue;
+        }
+        pending.emplace_back(av_packet_clone(pkt), ms);
+        av_packet_unref(pkt);
+        if (ms < startMs) continue;
+
+        if (!(outCtx->oformat->flags & AVFMT_NOFILE)) {
+          ret = avio_open(&outCtx->pb, outPath.c_str(), AVIO_FLAG_WRITE);
+          if (ret < 0) break;
+        }
+        ret = avformat_write_header(outCtx, NULL);
+        if (ret < 0) break;
+        headerWritten = true;
+        clipStartMs = pending.front().second;
+        for (auto& p : pending) {
+          if (ret >= 0) ret = writeOut(p.first, p.second);
+          av_packet_free(&p.first);
+        }
+        pending.clear();
+        continue;
+      }
+      ret = writeOut(pkt, ms);
+      av_packet_unref(pkt);
+    }
+    av_packet_free(&pkt);
+    avformat_close_input(&inCtx);
+  }
+
+  for (auto& p : pending) av_packet_free(&p.first);
+  if (headerWritten) {
+    av_write_trailer(outCtx);
+  } else if (ret >= 0) {
+    ret = AVERROR(ENOENT);
+  }
+  if (outCtx->pb) avio_closep(&outCtx->pb);
+  avformat_free_context(outCtx);
+  return ret < 0 ? ret : 0;
+}
+
+}  // namespace encode
+}  // namespace element
+}  // namespace sophon_stream
@@ -8,9 +8,15 @@ WSS::WSS() {}
 
 WSS::~WSS() {}
 
-void WSS::on_open(connection_hdl hdl) { m_connections.insert(hdl); }
+void WSS::on_open(connection_hdl hdl) {
+  std::lock_guard<std::mutex> lock(m_connections_mtx);
+  m_connections[hdl] = Client();
+}
 
-void WSS::on_close(connection_hdl hdl) { m_connections.erase(hdl); }
+void WSS::on_close(connection_hdl hdl) {
+  std::lock_guard<std::mutex> lock(m_connections_mtx);
+  m_connections.erase(hdl);
+}
 
 void WSS::init(int port, double fps) {
   try {
@@ -47,13 +53,15 @@ void WSS::init(int port, double fps) {
 // 从队列中取数据发送
 void WSS::send() {
   while (1) {
-    // 队列为空，停止5ms
+    // 队列为空时继续尝试给之前发送缓冲未清空的连接补发最新一帧
     if (mImgDataQueue.empty()) {
+      flushClients();
       std::this_thread::sleep_for(std::chrono::milliseconds(5));
       continue;
     }
-    auto data = popImgDataQueue();
-    if (WS_STOP_FLAG == data) {
+    auto msg = popMessage();
+    if (msg->get_opcode() == websocketpp::frame::opcode::text &&
+        WS_STOP_FLAG == msg->get_payload()) {
       IVS_DEBUG(
           "WSS recieve flag: {0}, demo will stop after closing the browser",
           WS_STOP_FLAG);
@@ -70,28 +78,67 @@ void WSS::send() {
     if (time_to_sleep > 0)
       std::this_thread::sleep_for(std::chrono::milliseconds(time_to_sleep));
     gettimeofday(&m_last_send_time, NULL);
-    for (auto it : m_connections) {
-      m_server.send(it, data, websocketpp::frame::opcode::text);
+    {
+      std::lock_guard<std::mutex> lock(m_connections_mtx);
+      for (auto& it : m_connections) it.second.pending = msg;
     }
+    flushClients();
+  }
+}
+
+void WSS::flushClients() {
+  std::lock_guard<std::mutex> lock(m_connections_mtx);
+  for (auto& it : m_connections) {
+    if (!it.second.pending) continue;
+    websocketpp::lib::error_code ec;
+    server::connection_ptr con = m_server.get_con_from_hdl(it.first, ec);
+    if (ec || con->get_buffered_amount() > 0) continue;
+    ec = con->send(it.second.pending);
+    if (ec) IVS_DEBUG("wss send error: {}", ec.message());
+    it.second.pending.reset();
   }
 }
 
 void WSS::stop() { m_server.stop_listening(); }
 
+message_ptr WSS::makeMessage(const std::string& data,
+                             websocketpp::frame::opcode::value opcode) {
+  // 服务端发出的帧不加掩码，组帧结果对所有连接都相同，标记为prepared后
+  // websocketpp直接写出header和payload，不再按连接重新组帧和拷贝
+  using message_type = message_ptr::element_type;
+  auto msg = websocketpp::lib::make_shared<message_type>(
+      message_type::con_msg_man_ptr(), opcode, 0);
+  msg->set_payload(data);
+  websocketpp::frame::basic_header header(opcode, data.size(), true, false);
+  websocketpp::frame::extended_header extHeader(data.size());
+  msg->set_header(websocketpp::frame::prepare_header(header, extHeader));
+  msg->set_prepared(true);
+  return msg;
+}
+
 void WSS::pushImgDataQueue(const std::string& data) {
+  pushMessage(makeMessage(data, websocketpp::frame::opcode::text));
+}
+
+void WSS::pushBinaryDataQueue(const std::string& data) {
+  pushMessage(makeMessage(data, websocketpp::frame::opcode::binary));
+}
+
+void WSS::pushMessage(message_ptr msg) {
   std::lock_guard<std::mutex> lock(mQueueMtx);
-  if (mImgDataQueue.size() < WSS_MAX_QUEUE_LEN)
-    mImgDataQueue.push(data);
+  // 队列满时丢弃最旧的一帧，保证发出去的总是最新画面；停止标识必须入队
+  if (mImgDataQueue.size() >= WSS_MAX_QUEUE_LEN) mImgDataQueue.pop();
+  mImgDataQueue.push(msg);
 }
 
-std::string WSS::popImgDataQueue() {
-  IVS_DEBUG("WSS::popImgDataQueue, queue size: {}", mImgDataQueue.size());
+message_ptr WSS::popMessage() {
+  IVS_DEBUG("WSS::popMessage, queue size: {}", mImgDataQueue.size());
   std::lock_guard<std::mutex> lock(mQueueMtx);
-  auto data = mImgDataQueue.front();
+  auto msg = mImgDataQueue.front();
   mImgDataQueue.pop();
-  return data;
+  return msg;
 }
 
 }  // namespace encode
 }  // namespace element
-}  // namespace sophon_stream
\ No newline at end of file
+}  // namespace sophon_stream
@@ -21,6 +21,8 @@
 #include "common/logger.h"
 #include "common/posed_object_metadata.h"
 #include "element_factory.h"
+#include "glyph_cache.h"
+#include "yuv_painter.h"
 
 namespace sophon_stream {
 namespace element {
@@ -376,6 +378,128 @@ void draw_bmcv_areas(std::shared_ptr<common::ObjectMetadata> objectMetadata,bm_i
   }
   
 }
+
+void draw_yuv_det_result(std::shared_ptr<common::ObjectMetadata> objectMetadata,
+                         std::vector<std::string>& class_names,
+                         YuvPainter& painter, const GlyphCache& glyphCache,
+                         bool put_text_flag, bool draw_interval) {
+  int colors_num = colors.size();
+  int thickness = 2;
+  std::shared_ptr<common::ObjectMetadata> objData;
+  {
+    std::lock_guard<std::mutex> lk(mLastObjectMetaDataMtx);
+    objData = (objectMetadata->mFilter && draw_interval)
+                  ? lastObjectMetadataMap[objectMetadata->mFrame->mChannelId]
+                  : objectMetadata;
+    lastObjectMetadataMap[objectMetadata->mFrame->mChannelId] = objData;
+  }
+  for (auto detObj : objData->mDetectedObjectMetadatas) {
+    int classId = detObj->mClassify;
+    YuvColor color = YuvColor::fromRGB(colors[classId % colors_num][0],
+                                       colors[classId % colors_num][1],
+                                       colors[classId % colors_num][2]);
+    painter.drawRectangle(detObj->mBox.mX, detObj->mBox.mY,
+                          detObj->mBox.mWidth, detObj->mBox.mHeight, thickness,
+                          color);
+
+    if (put_text_flag) {
+      std::string label = class_names[classId] + ":" +
+                          cv::format("%.2f", detObj->mScores[0]);
+      painter.drawGlyphs(
+          detObj->mBox.mX,
+          std::max(detObj->mBox.mY, glyphCache.lineHeight()) - 5,
+          glyphCache.lookup(label), color);
+    }
+  }
+}
+
+void draw_yuv_track_result(
+    std::shared_ptr<common::ObjectMetadata> objectMetadata,
+    std::vector<std::string>& class_names, YuvPainter& painter,
+    const GlyphCache& glyphCache, bool put_text_flag, bool draw_interval) {
+  int colors_num = colors.size();
+  int thickness = 2;
+  int idx = 0;
+  std::shared_ptr<common::ObjectMetadata> objData;
+  {
+    std::lock_guard<std::mutex> lk(mLastObjectMetaDataMtx);
+    objData = (objectMetadata->mFilter && draw_interval)
+                  ? lastObjectMetadataMap[objectMetadata->mFrame->mChannelId]
+                  : objectMetadata;
+    lastObjectMetadataMap[objectMetadata->mFrame->mChannelId] = objData;
+  }
+
+  for (auto detObj : objData->mDetectedObjectMetadatas) {
+    int track_id = objData->mTrackedObjectMetadatas[idx]->mTrackId;
+    YuvColor color = YuvColor::fromRGB(colors[track_id % colors_num][0],
+                                       colors[track_id % colors_num][1],
+                                       colors[track_id % colors_num][2]);
+    painter.drawRectangle(detObj->mBox.mX, detObj->mBox.mY,
+                          detObj->mBox.mWidth, detObj->mBox.mHeight, thickness,
+                          color);
+
+    if (put_text_flag) {
+      painter.drawGlyphs(
+          detObj->mBox.mX,
+          std::max(detObj->mBox.mY, glyphCache.lineHeight()) - 5,
+          glyphCache.lookup(std::to_string(track_id)), color);
+    }
+    ++idx;
+  }
+}
+
+void draw_yuv_pose_result(
+    std::shared_ptr<common::ObjectMetadata> objectMetadata,
+    YuvPainter& painter, bool draw_interval) {
+  const auto numberColors = pose_colors.size();
+  const float threshold = 0.05;
+  const auto thicknessLine = 2;
+
+  std::shared_ptr<common::ObjectMetadata> objData;
+  {
+    std::lock_guard<std::mutex> lk(mLastObjectMetaDataMtx);
+    objData = (objectMetadata->mFilter && draw_interval)
+                  ? lastObjectMetadataMap[objectMetadata->mFrame->mChannelId]
+                  : objectMetadata;
+    lastObjectMetadataMap[objectMetadata->mFrame->mChannelId] = objData;
+  }
+
+  for (auto poseObj : objData->mPosedObjectMetadatas) {
+    const std::vector<float>& poseKeypoints = poseObj->keypoints;
+    const auto& pairs = getPosePairs(poseObj->modeltype);
+
+    for (auto pair = 0u; pair < pairs.size(); pair += 2) {
+      const auto index1 = (pairs[pair]) * 3;
+      const auto index2 = (pairs[pair + 1]) * 3;
+      if (poseKeypoints[index1 + 2] > threshold &&
+          poseKeypoints[index2 + 2] > threshold) {
+        const auto colorIndex = pairs[pair + 1] * 3;
+        YuvColor color =
+            YuvColor::fromRGB(pose_colors[(colorIndex + 2) % numberColors],
+                              pose_colors[(colorIndex + 1) % numberColors],
+                              pose_colors[(colorIndex + 0) % numberColors]);
+        painter.drawLine(intRound(poseKeypoints[index1]),
+                         intRound(poseKeypoints[index1 + 1]),
+                         intRound(poseKeypoints[index2]),
+                         intRound(poseKeypoints[index2 + 1]), thicknessLine,
+                         color);
+      }
+    }
+  }
+}
+
+void draw_yuv_areas(std::shared_ptr<common::ObjectMetadata> objectMetadata,
+                    YuvPainter& painter) {
+  const YuvColor color = YuvColor::fromRGB(255, 0, 0);
+  for (int i = 0; i < objectMetadata->areas.size(); i++) {
+    if (objectMetadata->areas[i].size() == 2) {
+      painter.drawLine(objectMetadata->areas[i][0].mY,
+                       objectMetadata->areas[i][0].mX,
+                       objectMetadata->areas[i][1].mY,
+                       objectMetadata->areas[i][1].mX, 3, color);
+    }
+  }
+}
 }  // namespace osd
 }  // namespace element
 }  // namespace sophon_stream
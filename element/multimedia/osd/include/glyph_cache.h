@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_OSD_GLYPH_CACHE_H_
+#define SOPHON_STREAM_ELEMENT_OSD_GLYPH_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "common/glyph_atlas.h"
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+
+/**
+ * @brief OpenCV Hershey字体在共享字形图集上的封装
+ * @brief 字形按需光栅化一次后写入common::GlyphAtlas，多个osd实例和线程共用
+ */
+class GlyphCache {
+ public:
+  GlyphCache(double fontScale, int thickness);
+
+  /**
+   * @brief 将文本映射为字形序列，Hershey字体不支持的字符返回nullptr
+   */
+  std::vector<const common::Glyph*> lookup(const std::string& text) const;
+
+  int lineHeight() const { return mLineHeight; }
+
+ private:
+  bool rasterize(char32_t codepoint, common::GlyphBitmap& out) const;
+
+  double mFontScale;
+  int mThickness;
+  std::string mFontName;
+  int mFontSize = 0;
+  int mLineHeight = 0;
+};
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_OSD_GLYPH_CACHE_H_
@@ -15,6 +15,8 @@
 #include "common/object_metadata.h"
 #include "common/profiler.h"
 #include "element.h"
+#include "glyph_cache.h"
+#include "yuv_image_pool.h"
 
 namespace sophon_stream {
 namespace element {
@@ -23,7 +25,7 @@ namespace osd {
 class Osd : public ::sophon_stream::framework::Element {
  public:
   enum class OsdType { DET, TRACK, REC, POSE, AREA, UNKNOWN };
-  enum class DrawUtils { OPENCV, BMCV, UNKNOWN };
+  enum class DrawUtils { OPENCV, BMCV, YUV, UNKNOWN };
   Osd();
   ~Osd() override;
   common::ErrorCode initInternal(const std::string& json) override;
@@ -45,7 +47,20 @@ class Osd : public ::sophon_stream::framework::Element {
   bool mDrawInterval;
   bool mPutText;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
+  /**
+   * @brief YUV模式下复用的输出图像和预先光栅化的字形
+   */
+  std::shared_ptr<YuvImagePool> mImagePool;
+  std::unique_ptr<GlyphCache> mGlyphCache;
+  std::once_flag mSocFlag;
+  bool mIsSoc = false;
   void draw(std::shared_ptr<common::ObjectMetadata> objectMetadata);
+  /**
+   * @brief 转换为复用的YUV420P图像后，在host侧直接修改Y/U/V平面
+   * @brief SoC模式下整幅图mmap一次，PCIe模式下经由线程内复用的host缓存；
+   * 任一步骤失败时不设置mSpDataOsd，下游使用原图
+   */
+  void drawYuv(std::shared_ptr<common::ObjectMetadata> objectMetadata);
 };
 
 }  // namespace osd
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_OSD_YUV_IMAGE_POOL_H_
+#define SOPHON_STREAM_ELEMENT_OSD_YUV_IMAGE_POOL_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+#include "common/common_defs.h"
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+
+/**
+ * @brief 按(handle, 宽, 高)缓存已分配设备内存的YUV420P bm_image
+ * @brief acquire返回的shared_ptr释放时，图像会归还到空闲列表而不是销毁，
+ * 下游(如encode)持有mSpDataOsd期间该图像不会被复用
+ */
+class YuvImagePool : public std::enable_shared_from_this<YuvImagePool> {
+ public:
+  explicit YuvImagePool(int maxFreePerShape = 8)
+      : mMaxFreePerShape(maxFreePerShape) {}
+  ~YuvImagePool();
+
+  std::shared_ptr<bm_image> acquire(bm_handle_t handle, int width, int height);
+
+ private:
+  using Key = std::tuple<bm_handle_t, int, int>;
+
+  void release(const Key& key, bm_image* image);
+
+  std::mutex mMutex;
+  std::map<Key, std::vector<bm_image*>> mFreeImages;
+  int mMaxFreePerShape;
+};
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_OSD_YUV_IMAGE_POOL_H_
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_OSD_YUV_PAINTER_H_
+#define SOPHON_STREAM_ELEMENT_OSD_YUV_PAINTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "common/glyph_atlas.h"
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+
+/**
+ * @brief BT.601 limited range颜色，由RGB转换一次后在整帧内复用
+ */
+struct YuvColor {
+  std::uint8_t y;
+  std::uint8_t u;
+  std::uint8_t v;
+
+  static YuvColor fromRGB(int r, int g, int b);
+};
+
+/**
+ * @brief YUV420P三个平面在host侧的视图，不持有内存
+ */
+struct YuvPlanes {
+  std::uint8_t* data[3] = {nullptr, nullptr, nullptr};
+  int stride[3] = {0, 0, 0};
+  int width = 0;
+  int height = 0;
+};
+
+/**
+ * @brief 直接在YUV420P平面上画框、画线和贴字，不依赖bmcv，可在纯CPU环境下使用
+ * @brief 所有坐标均为亮度平面坐标，越界部分会被裁剪
+ */
+class YuvPainter {
+ public:
+  explicit YuvPainter(const YuvPlanes& planes) : mPlanes(planes) {}
+
+  void fillRect(int x, int y, int w, int h, const YuvColor& color);
+
+  /**
+   * @brief 画空心矩形，边框向矩形内侧延伸thickness个像素
+   */
+  void drawRectangle(int x, int y, int w, int h, int thickness,
+                     const YuvColor& color);
+
+  void drawLine(int x0, int y0, int x1, int y1, int thickness,
+                const YuvColor& color);
+
+  /**
+   * @brief 将alpha位图按color混合到(x, y)处，(x, y)为位图左上角
+   */
+  void drawMask(int x, int y, const common::Glyph& mask,
+                const YuvColor& color);
+
+  /**
+   * @brief 依次绘制一组字形，org为第一个字形的基线起点
+   */
+  void drawGlyphs(int org_x, int org_y,
+                  const std::vector<const common::Glyph*>& glyphs,
+                  const YuvColor& color);
+
+ private:
+  YuvPlanes mPlanes;
+};
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_OSD_YUV_PAINTER_H_
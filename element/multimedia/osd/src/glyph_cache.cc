@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "glyph_cache.h"
+
+#include <opencv2/imgproc.hpp>
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+
+GlyphCache::GlyphCache(double fontScale, int thickness)
+    : mFontScale(fontScale), mThickness(thickness) {
+  int baseLine = 0;
+  cv::Size size = cv::getTextSize("0", cv::FONT_HERSHEY_SIMPLEX, fontScale,
+                                  thickness, &baseLine);
+  mFontSize = size.height;
+  mLineHeight = size.height + baseLine;
+  // 缩放和线宽都会改变字形位图，需要作为字体标识的一部分
+  mFontName = "hershey_simplex/" + std::to_string(fontScale) + "/" +
+              std::to_string(thickness);
+}
+
+std::vector<const common::Glyph*> GlyphCache::lookup(
+    const std::string& text) const {
+  auto& atlas = common::GlyphAtlas::getInstance();
+  auto rasterizer = [this](char32_t codepoint, common::GlyphBitmap& out) {
+    return rasterize(codepoint, out);
+  };
+  std::vector<const common::Glyph*> glyphs;
+  glyphs.reserve(text.size());
+  for (char ch : text) {
+    glyphs.push_back(atlas.lookup(mFontName, mFontSize,
+                                  static_cast<unsigned char>(ch), rasterizer));
+  }
+  return glyphs;
+}
+
+bool GlyphCache::rasterize(char32_t codepoint,
+                           common::GlyphBitmap& out) const {
+  if (codepoint < 32 || codepoint > 126) return false;
+
+  std::string text(1, static_cast<char>(codepoint));
+  int baseLine = 0;
+  cv::Size size = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, mFontScale,
+                                  mThickness, &baseLine);
+  out.advance = size.width;
+  if (codepoint == ' ') return true;
+
+  // 四周留出thickness的边距，避免笔画被裁掉
+  int pad = mThickness;
+  cv::Mat canvas = cv::Mat::zeros(size.height + baseLine + 2 * pad,
+                                  size.width + 2 * pad, CV_8UC1);
+  cv::putText(canvas, text, cv::Point(pad, pad + size.height),
+              cv::FONT_HERSHEY_SIMPLEX, mFontScale, cv::Scalar(255),
+              mThickness, cv::LINE_AA);
+
+  out.width = canvas.cols;
+  out.height = canvas.rows;
+  out.left = -pad;
+  out.top = pad + size.height;
+  out.alpha.assign(canvas.data, canvas.data + canvas.total());
+  return true;
+}
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
@@ -66,6 +66,7 @@ common::ErrorCode Osd::initInternal(const std::string& json) {
       auto drawUtils = drawUtilsIt->get<std::string>();
       if (drawUtils == "OPENCV") mDrawUtils = DrawUtils::OPENCV;
       if (drawUtils == "BMCV") mDrawUtils = DrawUtils::BMCV;
+      if (drawUtils == "YUV") mDrawUtils = DrawUtils::YUV;
       IVS_DEBUG("drawUtils is {0}", drawUtils);
     } else {
       IVS_ERROR(
@@ -98,6 +99,11 @@ common::ErrorCode Osd::initInternal(const std::string& json) {
           CONFIG_INTERNAL_PUT_TEXT_FIELD, json);
     }
 
+    if (mDrawUtils == DrawUtils::YUV) {
+      mImagePool = std::make_shared<YuvImagePool>();
+      mGlyphCache.reset(new GlyphCache(1, 2));
+    }
+
   } while (false);
   return errorCode;
 }
@@ -151,6 +157,10 @@ common::ErrorCode Osd::doWork(int dataPipeId) {
   return common::ErrorCode::SUCCESS;
 }
 void Osd::draw(std::shared_ptr<common::ObjectMetadata> objectMetadata) {
+  if (mDrawUtils == DrawUtils::YUV) {
+    drawYuv(objectMetadata);
+    return;
+  }
   std::shared_ptr<bm_image> imageStorage;
   imageStorage.reset(new bm_image,
                      [&](bm_image* img) { bm_image_destroy(*img); delete img; img = nullptr;});
@@ -232,6 +242,133 @@ void Osd::draw(std::shared_ptr<common::ObjectMetadata> objectMetadata) {
   objectMetadata->mFrame->mSpDataOsd = imageStorage;
 }
 
+void Osd::drawYuv(std::shared_ptr<common::ObjectMetadata> objectMetadata) {
+  bm_handle_t handle = objectMetadata->mFrame->mHandle;
+  std::call_once(mSocFlag, [&]() {
+    struct bm_misc_info misc_info;
+    if (BM_SUCCESS == bm_get_misc_info(handle, &misc_info))
+      mIsSoc = misc_info.pcie_soc_mode == 1;
+  });
+
+  std::shared_ptr<bm_image> imageStorage =
+      mImagePool->acquire(handle, objectMetadata->mFrame->mWidth,
+                          objectMetadata->mFrame->mHeight);
+  bm_status_t ret = bmcv_image_storage_convert(
+      handle, 1, objectMetadata->mFrame->mSpData.get(), imageStorage.get());
+  if (BM_SUCCESS != ret) {
+    IVS_ERROR("bmcv_image_storage_convert failed, ret: {0}, element id: {1}",
+              static_cast<int>(ret), getId());
+    return;
+  }
+
+  bm_device_mem_t mems[3];
+  int strides[3];
+  if (BM_SUCCESS != bm_image_get_device_mem(*imageStorage, mems) ||
+      BM_SUCCESS != bm_image_get_stride(*imageStorage, strides)) {
+    IVS_ERROR("Get device memory of osd image failed, element id: {0}",
+              getId());
+    return;
+  }
+
+  YuvPlanes planes;
+  planes.width = imageStorage->width;
+  planes.height = imageStorage->height;
+  for (int i = 0; i < 3; ++i) planes.stride[i] = strides[i];
+
+  // SoC：三个平面在同一块连续显存中，整体映射一次后按偏移得到各平面指针；
+  // 平面不连续或映射失败时和PCIe一样经由host缓存
+  bm_device_mem_t whole = mems[0];
+  bool mapped = false;
+  if (mIsSoc) {
+    unsigned long long base = bm_mem_get_device_addr(mems[0]);
+    unsigned int size = 0;
+    bool contiguous = true;
+    for (int i = 0; i < 3; ++i) {
+      if (bm_mem_get_device_addr(mems[i]) != base + size) contiguous = false;
+      size += bm_mem_get_device_size(mems[i]);
+    }
+    unsigned long long addr = 0;
+    if (contiguous) {
+      bm_mem_set_device_size(&whole, size);
+      mapped = BM_SUCCESS == bm_mem_mmap_device_mem(handle, &whole, &addr);
+    }
+    if (mapped && BM_SUCCESS != bm_mem_invalidate_device_mem(handle, &whole)) {
+      bm_mem_unmap_device_mem(handle, reinterpret_cast<void*>(addr), size);
+      mapped = false;
+    }
+    if (mapped) {
+      std::uint8_t* ptr = reinterpret_cast<std::uint8_t*>(addr);
+      for (int i = 0; i < 3; ++i) {
+        planes.data[i] = ptr;
+        ptr += bm_mem_get_device_size(mems[i]);
+      }
+    } else {
+      IVS_DEBUG("mmap osd image failed, fall back to copy, element id: {0}",
+                getId());
+    }
+  }
+
+  thread_local std::vector<std::uint8_t> hostBuffer;
+  if (!mapped) {
+    std::size_t total = 0;
+    for (int i = 0; i < 3; ++i) total += bm_mem_get_device_size(mems[i]);
+    if (hostBuffer.size() < total) hostBuffer.resize(total);
+    std::uint8_t* ptr = hostBuffer.data();
+    for (int i = 0; i < 3; ++i) {
+      planes.data[i] = ptr;
+      ptr += bm_mem_get_device_size(mems[i]);
+    }
+    ret = bm_image_copy_device_to_host(*imageStorage,
+                                       reinterpret_cast<void**>(planes.data));
+    if (BM_SUCCESS != ret) {
+      IVS_ERROR("Copy osd image to host failed, ret: {0}, element id: {1}",
+                static_cast<int>(ret), getId());
+      return;
+    }
+  }
+
+  YuvPainter painter(planes);
+  switch (mOsdType) {
+    case OsdType::DET:
+      draw_yuv_det_result(objectMetadata, mClassNames, painter, *mGlyphCache,
+                          mPutText, mDrawInterval);
+      break;
+
+    case OsdType::TRACK:
+      draw_yuv_track_result(objectMetadata, mClassNames, painter,
+                            *mGlyphCache, mPutText, mDrawInterval);
+      break;
+
+    case OsdType::POSE:
+      draw_yuv_pose_result(objectMetadata, painter, mDrawInterval);
+      break;
+
+    case OsdType::AREA:
+      draw_yuv_areas(objectMetadata, painter);
+      break;
+
+    default:
+      IVS_WARN("osd_type not support");
+  }
+
+  if (mapped) {
+    ret = bm_mem_flush_device_mem(handle, &whole);
+    if (BM_SUCCESS != bm_mem_unmap_device_mem(handle, planes.data[0],
+                                              bm_mem_get_device_size(whole)))
+      IVS_WARN("Unmap osd image failed, element id: {0}", getId());
+  } else {
+    ret = bm_image_copy_host_to_device(*imageStorage,
+                                       reinterpret_cast<void**>(planes.data));
+  }
+  if (BM_SUCCESS != ret) {
+    IVS_ERROR("Write back osd image failed, ret: {0}, element id: {1}",
+              static_cast<int>(ret), getId());
+    return;
+  }
+
+  objectMetadata->mFrame->mSpDataOsd = imageStorage;
+}
+
 REGISTER_WORKER("osd", Osd)
 
 }  // namespace osd
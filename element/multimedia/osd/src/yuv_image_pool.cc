@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "yuv_image_pool.h"
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+
+YuvImagePool::~YuvImagePool() {
+  for (auto& it : mFreeImages) {
+    for (auto image : it.second) {
+      bm_image_destroy(*image);
+      delete image;
+    }
+  }
+  mFreeImages.clear();
+}
+
+std::shared_ptr<bm_image> YuvImagePool::acquire(bm_handle_t handle, int width,
+                                                int height) {
+  Key key = std::make_tuple(handle, width, height);
+  bm_image* image = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& freeList = mFreeImages[key];
+    if (!freeList.empty()) {
+      image = freeList.back();
+      freeList.pop_back();
+    }
+  }
+
+  if (image == nullptr) {
+    image = new bm_image;
+    bm_image_create(handle, height, width, FORMAT_YUV420P,
+                    DATA_TYPE_EXT_1N_BYTE, image);
+    auto ret = bm_image_alloc_dev_mem_heap_mask(*image, STREAM_VPP_HEAP_MASK);
+    STREAM_CHECK(ret == 0, "Alloc Device Memory Failed! Program Terminated.")
+  }
+
+  std::weak_ptr<YuvImagePool> weakPool = shared_from_this();
+  return std::shared_ptr<bm_image>(image, [weakPool, key](bm_image* img) {
+    auto pool = weakPool.lock();
+    if (pool) {
+      pool->release(key, img);
+    } else {
+      bm_image_destroy(*img);
+      delete img;
+    }
+  });
+}
+
+void YuvImagePool::release(const Key& key, bm_image* image) {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& freeList = mFreeImages[key];
+    if (freeList.size() < static_cast<std::size_t>(mMaxFreePerShape)) {
+      freeList.push_back(image);
+      return;
+    }
+  }
+  bm_image_destroy(*image);
+  delete image;
+}
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
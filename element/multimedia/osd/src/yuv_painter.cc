@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "yuv_painter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OSD_USE_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define OSD_USE_SSE2 1
+#endif
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+
+namespace {
+
+inline std::uint8_t clampU8(int v) {
+  return static_cast<std::uint8_t>(std::min(255, std::max(0, v)));
+}
+
+/**
+ * @brief dst = (dst * (255 - a) + c * a) / 255，四舍五入
+ * @brief 除以255使用(t + (t >> 8)) >> 8近似，向量与标量路径结果逐像素一致
+ */
+inline std::uint8_t blendPixel(std::uint8_t dst, std::uint8_t a,
+                               std::uint8_t c) {
+  unsigned t = dst * (255u - a) + c * static_cast<unsigned>(a) + 128u;
+  return static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+}
+
+void blendRow(std::uint8_t* dst, const std::uint8_t* alpha, int n,
+              std::uint8_t c) {
+  int i = 0;
+#if defined(OSD_USE_NEON)
+  const uint8x8_t vc = vdup_n_u8(c);
+  const uint8x8_t v255 = vdup_n_u8(255);
+  const uint16x8_t v128 = vdupq_n_u16(128);
+  for (; i + 8 <= n; i += 8) {
+    uint8x8_t a = vld1_u8(alpha + i);
+    uint8x8_t d = vld1_u8(dst + i);
+    uint16x8_t t = vmull_u8(d, vsub_u8(v255, a));
+    t = vmlal_u8(t, vc, a);
+    t = vaddq_u16(t, v128);
+    vst1_u8(dst + i, vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8));
+  }
+#elif defined(OSD_USE_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i vc = _mm_set1_epi16(c);
+  const __m128i v255 = _mm_set1_epi16(255);
+  const __m128i v128 = _mm_set1_epi16(128);
+  for (; i + 8 <= n; i += 8) {
+    __m128i a = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(alpha + i)), zero);
+    __m128i d = _mm_unpacklo_epi8(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst + i)), zero);
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(d, _mm_sub_epi16(v255, a)),
+                              _mm_mullo_epi16(vc, a));
+    t = _mm_add_epi16(t, v128);
+    t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packus_epi16(t, zero));
+  }
+#endif
+  for (; i < n; ++i) dst[i] = blendPixel(dst[i], alpha[i], c);
+}
+
+}  // namespace
+
+YuvColor YuvColor::fromRGB(int r, int g, int b) {
+  YuvColor color;
+  color.y = clampU8(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+  color.u = clampU8(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+  color.v = clampU8(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+  return color;
+}
+
+void YuvPainter::fillRect(int x, int y, int w, int h, const YuvColor& color) {
+  int x0 = std::max(x, 0);
+  int y0 = std::max(y, 0);
+  int x1 = std::min(x + w, mPlanes.width);
+  int y1 = std::min(y + h, mPlanes.height);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  for (int row = y0; row < y1; ++row) {
+    std::memset(mPlanes.data[0] + row * mPlanes.stride[0] + x0, color.y,
+                x1 - x0);
+  }
+
+  int cx0 = x0 >> 1;
+  int cx1 = (x1 + 1) >> 1;
+  int cy0 = y0 >> 1;
+  int cy1 = (y1 + 1) >> 1;
+  for (int row = cy0; row < cy1; ++row) {
+    std::memset(mPlanes.data[1] + row * mPlanes.stride[1] + cx0, color.u,
+                cx1 - cx0);
+    std::memset(mPlanes.data[2] + row * mPlanes.stride[2] + cx0, color.v,
+                cx1 - cx0);
+  }
+}
+
+void YuvPainter::drawRectangle(int x, int y, int w, int h, int thickness,
+                               const YuvColor& color) {
+  if (w <= 0 || h <= 0 || thickness <= 0) return;
+  int t = std::min(thickness, std::min(w, h));
+  fillRect(x, y, w, t, color);
+  fillRect(x, y + h - t, w, t, color);
+  fillRect(x, y + t, t, h - 2 * t, color);
+  fillRect(x + w - t, y + t, t, h - 2 * t, color);
+}
+
+void YuvPainter::drawLine(int x0, int y0, int x1, int y1, int thickness,
+                          const YuvColor& color) {
+  if (thickness <= 0) return;
+  if (x0 == x1 || y0 == y1) {
+    int half = thickness / 2;
+    fillRect(std::min(x0, x1) - half, std::min(y0, y1) - half,
+             std::abs(x1 - x0) + thickness, std::abs(y1 - y0) + thickness,
+             color);
+    return;
+  }
+
+  // Bresenham，在主方向的每一步画一段与主方向垂直、长度为thickness的跨度
+  int dx = std::abs(x1 - x0);
+  int dy = -std::abs(y1 - y0);
+  int sx = x0 < x1 ? 1 : -1;
+  int sy = y0 < y1 ? 1 : -1;
+  bool steep = -dy > dx;
+  int half = thickness / 2;
+  int err = dx + dy;
+  int x = x0;
+  int y = y0;
+  while (true) {
+    if (steep)
+      fillRect(x - half, y, thickness, 1, color);
+    else
+      fillRect(x, y - half, 1, thickness, color);
+    if (x == x1 && y == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y += sy;
+    }
+  }
+}
+
+void YuvPainter::drawMask(int x, int y, const common::Glyph& mask,
+                          const YuvColor& color) {
+  if (mask.width <= 0 || mask.height <= 0 || !mask.alpha) return;
+  int x0 = std::max(x, 0);
+  int y0 = std::max(y, 0);
+  int x1 = std::min(x + mask.width, mPlanes.width);
+  int y1 = std::min(y + mask.height, mPlanes.height);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  for (int row = y0; row < y1; ++row) {
+    blendRow(mPlanes.data[0] + row * mPlanes.stride[0] + x0,
+             mask.alpha + (row - y) * mask.stride + (x0 - x), x1 - x0,
+             color.y);
+  }
+
+  // 色度平面为2x2下采样，alpha取对应4个亮度位置的均值，位图外部按0处理
+  auto maskAt = [&](int mx, int my) -> int {
+    if (mx < 0 || my < 0 || mx >= mask.width || my >= mask.height) return 0;
+    return mask.alpha[my * mask.stride + mx];
+  };
+  int cx0 = x0 >> 1;
+  int cx1 = (x1 + 1) >> 1;
+  int cy0 = y0 >> 1;
+  int cy1 = (y1 + 1) >> 1;
+  std::vector<std::uint8_t> chromaAlpha(cx1 - cx0);
+  for (int row = cy0; row < cy1; ++row) {
+    int my = 2 * row - y;
+    for (int col = cx0; col < cx1; ++col) {
+      int mx = 2 * col - x;
+      int sum = maskAt(mx, my) + maskAt(mx + 1, my) + maskAt(mx, my + 1) +
+                maskAt(mx + 1, my + 1);
+      chromaAlpha[col - cx0] = static_cast<std::uint8_t>((sum + 2) >> 2);
+    }
+    blendRow(mPlanes.data[1] + row * mPlanes.stride[1] + cx0,
+             chromaAlpha.data(), cx1 - cx0, color.u);
+    blendRow(mPlanes.data[2] + row * mPlanes.stride[2] + cx0,
+             chromaAlpha.data(), cx1 - cx0, color.v);
+  }
+}
+
+void YuvPainter::drawGlyphs(int org_x, int org_y,
+                            const std::vector<const common::Glyph*>& glyphs,
+                            const YuvColor& color) {
+  int pen_x = org_x;
+  for (auto glyph : glyphs) {
+    if (!glyph) continue;
+    drawMask(pen_x + glyph->left, org_y - glyph->top, *glyph, color);
+    pen_x += glyph->advance;
+  }
+}
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
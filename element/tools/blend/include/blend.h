@@ -12,6 +12,7 @@
 
 #include "common/object_metadata.h"
 #include "element.h"
+#include "input_synchronizer.h"
 #include "common/profiler.h"
 void bm_read_bin(bm_image src, const char* input_name);
 void bm_dem_read_bin(bm_handle_t handle, bm_device_mem_t* dmem,
@@ -32,6 +33,8 @@ class Blend : public ::sophon_stream::framework::Element {
 
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   common::ErrorCode blend_work(
       std::shared_ptr<common::ObjectMetadata> leftObj,
       std::shared_ptr<common::ObjectMetadata> rightObj,
@@ -70,6 +73,10 @@ class Blend : public ::sophon_stream::framework::Element {
       sophon_stream::framework::ListenThread* listener) override;
 
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
+
+  framework::SyncOptions mSyncOptions;
+  // 每个dataPipe一个，只由对应的工作线程访问
+  std::vector<std::shared_ptr<framework::InputSynchronizer>> mSynchronizers;
 };
 
 }  // namespace blend
@@ -103,6 +103,8 @@ common::ErrorCode Blend::initInternal(const std::string& json) {
     errorCode = common::ErrorCode::PARSE_CONFIGURE_FAIL;
   }
   mFpsProfiler.config("fps_blend:", 100);
+  mSyncOptions = framework::SyncOptions::fromJson(configure);
+  mSynchronizers.resize(getThreadNumber());
   bm_status_t ret = bm_dev_request(&handle, dev_id);
 
   src_h = configure.find(CONFIG_INTERNAL_HEIGHT_FILED)->get<int>();
@@ -274,23 +276,14 @@ common::ErrorCode Blend::doWork(int dataPipeId) {
     outputPort = outputPorts[0];
   }
 
-  common::ObjectMetadatas inputs;
+  auto& synchronizer = mSynchronizers[dataPipeId];
+  if (synchronizer == nullptr)
+    synchronizer = std::make_shared<framework::InputSynchronizer>(
+        inputPorts.size(), mSyncOptions);
 
-  for (auto inputPort : inputPorts) {
-    auto data = popInputData(inputPort, dataPipeId);
-    while (!data && (getThreadStatus() == ThreadStatus::RUN)) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      data = popInputData(inputPort, dataPipeId);
-    }
-    if (data == nullptr) return common::ErrorCode::SUCCESS;
-
-    auto objectMetadata =
-        std::static_pointer_cast<common::ObjectMetadata>(data);
-    inputs.emplace_back(objectMetadata);
-    IVS_INFO("Got Input, port id = {0}, channel_id = {1}, frame_id = {2}",
-             inputPort, objectMetadata->mFrame->mChannelId,
-             objectMetadata->mFrame->mFrameId);
-  }
+  common::ObjectMetadatas inputs;
+  if (!popSynchronizedInputs(dataPipeId, *synchronizer, inputs))
+    return common::ErrorCode::SUCCESS;
 
   if (inputs[0]->mFrame->mSpData != nullptr &&
       inputs[1]->mFrame->mSpData != nullptr) {
@@ -175,6 +175,8 @@ void Distributor::makeSubObjectMetadata(
     // STREAM_CHECK(ret == 0, "Bmcv Crop Failed! Program Terminated.")
 
     subObj->mFrame->mSpData = cropped;
+    subObj->mCropX = rect.start_x;
+    subObj->mCropY = rect.start_y;
   } else {
     subObj->mFrame->mSpData = obj->mFrame->mSpData;
   }
@@ -183,6 +185,8 @@ void Distributor::makeSubObjectMetadata(
   subObj->mFrame->mFrameId = obj->mFrame->mFrameId;
   subObj->mFrame->mChannelId = obj->mFrame->mChannelId;
   subObj->mFrame->mChannelIdInternal = obj->mFrame->mChannelIdInternal;
+  subObj->mFrame->mDecoderGeneration = obj->mFrame->mDecoderGeneration;
+  subObj->mGraphId = obj->mGraphId;
   subObj->mSubId = subId;
   subObj->mFrame->mEndOfStream = obj->mFrame->mEndOfStream;
 }
@@ -241,6 +245,8 @@ void Distributor::makeSubFaceObjectMetadata(
     rect.start_y = faceObj->top;
     rect.crop_w = faceObj->right - faceObj->left + 1;
     rect.crop_h = faceObj->bottom - faceObj->top + 1;
+    subObj->mCropX = faceObj->left;
+    subObj->mCropY = faceObj->top;
   }
   subObj->mFrame = std::make_shared<common::Frame>();
   // crop or not,faceObj != nullptr
@@ -420,6 +426,8 @@ void Distributor::makeSubFaceObjectMetadata(
   subObj->mFrame->mFrameId = obj->mFrame->mFrameId;
   subObj->mFrame->mChannelId = obj->mFrame->mChannelId;
   subObj->mFrame->mChannelIdInternal = obj->mFrame->mChannelIdInternal;
+  subObj->mFrame->mDecoderGeneration = obj->mFrame->mDecoderGeneration;
+  subObj->mGraphId = obj->mGraphId;
   subObj->mSubId = subId;
 }
 
@@ -433,6 +441,10 @@ void Distributor::makeSubOcrObjectMetadata(
       box.push_back({keyPoint->mPoint.mX, keyPoint->mPoint.mY});
     }
   }
+  if (!box.empty()) {
+    subObj->mCropX = box[0][0];
+    subObj->mCropY = box[0][1];
+  }
 
   subObj->mFrame = std::make_shared<common::Frame>();
 
@@ -469,6 +481,8 @@ void Distributor::makeSubOcrObjectMetadata(
   subObj->mFrame->mFrameId = obj->mFrame->mFrameId;
   subObj->mFrame->mChannelId = obj->mFrame->mChannelId;
   subObj->mFrame->mChannelIdInternal = obj->mFrame->mChannelIdInternal;
+  subObj->mFrame->mDecoderGeneration = obj->mFrame->mDecoderGeneration;
+  subObj->mGraphId = obj->mGraphId;
   subObj->mSubId = subId;
 }
 
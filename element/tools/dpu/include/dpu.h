@@ -13,6 +13,7 @@
 #include "common/object_metadata.h"
 #include "common/profiler.h"
 #include "element.h"
+#include "input_synchronizer.h"
 #define MAP_TABLE_SIZE 256
 extern "C" {
 extern bm_status_t bm_ive_image_calc_stride(bm_handle_t handle, int img_h,
@@ -102,6 +103,10 @@ class Dpu : public ::sophon_stream::framework::Element {
   std::mutex mtx;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
 
+  framework::SyncOptions mSyncOptions;
+  // 每个dataPipe一个，只由对应的工作线程访问
+  std::vector<std::shared_ptr<framework::InputSynchronizer>> mSynchronizers;
+
   std::unordered_map<std::string, DpuType> dpu_type_map = {
       {"DPU_ONLINE", DpuType::DPU_ONLINE},
       {"DPU_FGS", DpuType::DPU_FGS},
@@ -403,6 +403,8 @@ common::ErrorCode Dpu::initInternal(const std::string& json) {
     errorCode = common::ErrorCode::PARSE_CONFIGURE_FAIL;
   }
   mFpsProfiler.config("fps_dpu:", 100);
+  mSyncOptions = framework::SyncOptions::fromJson(configure);
+  mSynchronizers.resize(getThreadNumber());
 
   dpu_online_mode = DPU_ONLINE_MUX0;
   dpu_sgbm_mode = DPU_SGBM_MUX2;
@@ -532,27 +534,17 @@ common::ErrorCode Dpu::doWork(int dataPipeId) {
     outputPort = outputPorts[0];
   }
 
-  common::ObjectMetadatas inputs;
+  auto& synchronizer = mSynchronizers[dataPipeId];
+  if (synchronizer == nullptr)
+    synchronizer = std::make_shared<framework::InputSynchronizer>(
+        inputPorts.size(), mSyncOptions);
 
-  for (auto inputPort : inputPorts) {
-    auto data = popInputData(inputPort, dataPipeId);
-    while (!data && (getThreadStatus() == ThreadStatus::RUN)) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      data = popInputData(inputPort, dataPipeId);
-    }
-    if (data == nullptr) return common::ErrorCode::SUCCESS;
-
-    auto objectMetadata =
-        std::static_pointer_cast<common::ObjectMetadata>(data);
-    inputs.emplace_back(objectMetadata);
-    IVS_DEBUG("Got Input, port id = {0}, channel_id = {1}, frame_id = {2}",
-              inputPort, objectMetadata->mFrame->mChannelId,
-              objectMetadata->mFrame->mFrameId);
-  }
+  common::ObjectMetadatas inputs;
+  if (!popSynchronizedInputs(dataPipeId, *synchronizer, inputs))
+    return common::ErrorCode::SUCCESS;
 
   if (inputs[0]->mFrame->mSpData != nullptr &&
-      inputs[1]->mFrame->mSpData != nullptr &&
-      inputs[0]->mFrame->mFrameId == inputs[1]->mFrame->mFrameId) {
+      inputs[1]->mFrame->mSpData != nullptr) {
     std::shared_ptr<common::ObjectMetadata> dpuObj =
         std::make_shared<common::ObjectMetadata>();
     dpuObj->mFrame = std::make_shared<sophon_stream::common::Frame>();
@@ -29,6 +29,8 @@ class Faiss : public ::sophon_stream::framework::Element {
 
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   static constexpr const char* CONFIG_INTERNAL_DEFAULT_PORT_FILED =
       "default_port";
   static constexpr const char* CONFIG_INTERNAL_DB_DATA_PATH_FILED = "db_path";
@@ -18,28 +18,54 @@
 #include "common/profiler.h"
 #include "element.h"
 #include "httplib.h"
+#include "result_codec.h"
 
 namespace sophon_stream {
 namespace element {
 namespace http_push {
 
+/**
+ * @brief 推送格式和批量参数，所有通道共用
+ */
+struct PushOptions {
+  enum class Format { JSON, BINARY };
+  Format format = Format::JSON;
+  // 攒够batchSize帧或最早一帧等待超过batchTimeoutMs时发送一次
+  int batchSize = 1;
+  int batchTimeoutMs = 100;
+  // 默认每个请求新建连接，需要复用连接时在配置中打开keep_alive
+  bool keepAlive = false;
+  bool compress = false;
+};
+
+/**
+ * @brief 队列中的一帧结果，JSON格式在发送线程里dump，二进制格式已编码好
+ */
+struct PushItem {
+  std::shared_ptr<nlohmann::json> json;
+  std::shared_ptr<std::string> binary;
+};
+
 class HttpPushImpl_ {
  public:
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
   HttpPushImpl_(std::string& scheme, std::string& ip, int port, std::string cert, std::string key,
-		  std::string cacert_, bool verify_, std::string path_, int channel);
+		  std::string cacert_, bool verify_, std::string path_, int channel,
+		  const PushOptions& options);
 #else
-  HttpPushImpl_(std::string& ip, int port, std::string path, int channel);
+  HttpPushImpl_(std::string& ip, int port, std::string path, int channel,
+                const PushOptions& options);
 #endif
-  bool pushQueue(std::shared_ptr<nlohmann::json> j);
+  bool pushQueue(std::shared_ptr<PushItem> item);
   void release();
 
  private:
-  std::queue<std::shared_ptr<nlohmann::json>> objQueue;
+  std::queue<std::shared_ptr<PushItem>> objQueue;
   std::thread workThread;
   void postFunc();
+  void postBatch(const std::vector<std::shared_ptr<PushItem>>& batch);
   bool isRunning = true;
-  std::shared_ptr<nlohmann::json> popQueue();
+  std::shared_ptr<PushItem> popQueue();
   size_t getQueueSize();
   std::mutex mtx;
   constexpr static int maxQueueLen = 20;
@@ -52,6 +78,7 @@ class HttpPushImpl_ {
   bool verify;
 #endif
   std::string path;
+  PushOptions mOptions;
 
   std::string mFpsProfilerName;
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
@@ -69,6 +96,13 @@ class HttpPush : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_IP_FILED = "ip";
   static constexpr const char* CONFIG_INTERNAL_PORT_FILED = "port";
   static constexpr const char* CONFIG_INTERNAL_PATH_FILED = "path";
+  static constexpr const char* CONFIG_INTERNAL_FORMAT_FILED = "format";
+  static constexpr const char* CONFIG_INTERNAL_WITH_IMAGE_FILED = "with_image";
+  static constexpr const char* CONFIG_INTERNAL_BATCH_SIZE_FILED = "batch_size";
+  static constexpr const char* CONFIG_INTERNAL_BATCH_TIMEOUT_FILED =
+      "batch_timeout_ms";
+  static constexpr const char* CONFIG_INTERNAL_KEEP_ALIVE_FILED = "keep_alive";
+  static constexpr const char* CONFIG_INTERNAL_COMPRESS_FILED = "compress";
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
   static constexpr const char* CONFIG_INTERNAL_SCHEME_FILED = "scheme";
   static constexpr const char* CONFIG_INTERNAL_CERT_FILED = "cert";
@@ -83,6 +117,11 @@ class HttpPush : public ::sophon_stream::framework::Element {
   std::string ip_;
   int port_;
   std::string path_;
+  PushOptions options_;
+  // 二进制格式下是否附带JPEG原图
+  bool withImage_ = false;
+  std::shared_ptr<PushItem> makeItem(
+      const std::shared_ptr<common::ObjectMetadata>& objectMetadata);
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
   std::string scheme_;
   std::string cert_;
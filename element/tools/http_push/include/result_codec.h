@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_ELEMENT_HTTP_PUSH_RESULT_CODEC_H_
+#define SOPHON_STREAM_ELEMENT_HTTP_PUSH_RESULT_CODEC_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace element {
+namespace http_push {
+
+/**
+ * @brief ObjectMetadata的紧凑二进制编码，所有整数和浮点数均为小端
+ *
+ * 一个请求体是一个batch：
+ *   char[4] "SSRB" | u16 version | u16 frameCount | frame * frameCount
+ * 每个frame以u32 frameSize开头(不含自身)，解析端可以跳过不认识的尾部字段：
+ *   i32 channelId | i64 frameId | i64 timestamp | i32 width | i32 height
+ *   f32 fps | i32 graphId | i32 subId
+ *   u32 n | detection * n     : i32 x,y,w,h | i32 classify | u32 k | f32 * k
+ *   u32 n | track * n         : i64 trackId
+ *   u32 n | recognition * n   : u32 len | char * len | u32 k | f32 * k
+ *                               | u32 m | i32 * m
+ *   u32 n | pose * n          : u32 k | f32 * k
+ *   u32 n | face * n          : i32 top,bottom,left,right | f32 * 5 x
+ *                               | f32 * 5 y | f32 score
+ *   u32 jpegSize | jpeg
+ * 字段与serialize.h的JSON输出一一对应，JSON里的base64图片在这里是原始JPEG
+ */
+class ResultCodec {
+ public:
+  static constexpr std::uint16_t VERSION = 2;
+  static constexpr const char* CONTENT_TYPE =
+      "application/x-sophon-stream-result";
+
+  /**
+   * @brief 编码单帧，jpeg为空表示不带图片
+   */
+  static std::string encodeFrame(
+      const std::shared_ptr<common::ObjectMetadata>& obj,
+      const std::string& jpeg);
+
+  /**
+   * @brief 把若干个已编码的帧拼成一个batch
+   */
+  static std::string encodeBatch(
+      const std::vector<std::shared_ptr<std::string>>& frames);
+};
+
+}  // namespace http_push
+}  // namespace element
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_ELEMENT_HTTP_PUSH_RESULT_CODEC_H_
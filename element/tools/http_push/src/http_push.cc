@@ -48,6 +48,48 @@ common::ErrorCode HttpPush::initInternal(const std::string& json) {
                  "Port must be string, please check your http_push element "
                  "configuration file");
     path_ = pathIt->get<std::string>();
+
+    auto formatIt = configure.find(CONFIG_INTERNAL_FORMAT_FILED);
+    if (formatIt != configure.end()) {
+      STREAM_CHECK((formatIt->is_string() &&
+                    (*formatIt == "JSON" || *formatIt == "BINARY")),
+                   "Format must be JSON or BINARY, please check your "
+                   "http_push element configuration file");
+      options_.format = *formatIt == "BINARY" ? PushOptions::Format::BINARY
+                                              : PushOptions::Format::JSON;
+    }
+    auto withImageIt = configure.find(CONFIG_INTERNAL_WITH_IMAGE_FILED);
+    if (withImageIt != configure.end()) withImage_ = withImageIt->get<bool>();
+
+    auto batchSizeIt = configure.find(CONFIG_INTERNAL_BATCH_SIZE_FILED);
+    if (batchSizeIt != configure.end()) {
+      STREAM_CHECK((batchSizeIt->is_number_integer() && *batchSizeIt >= 1 &&
+                    *batchSizeIt <= 65535),
+                   "Batch size must be an integer in [1, 65535], please check "
+                   "your http_push element configuration file");
+      options_.batchSize = batchSizeIt->get<int>();
+    }
+    auto batchTimeoutIt = configure.find(CONFIG_INTERNAL_BATCH_TIMEOUT_FILED);
+    if (batchTimeoutIt != configure.end()) {
+      STREAM_CHECK((batchTimeoutIt->is_number_integer() &&
+                    *batchTimeoutIt >= 0),
+                   "Batch timeout must be a non-negative integer, please "
+                   "check your http_push element configuration file");
+      options_.batchTimeoutMs = batchTimeoutIt->get<int>();
+    }
+    auto keepAliveIt = configure.find(CONFIG_INTERNAL_KEEP_ALIVE_FILED);
+    if (keepAliveIt != configure.end())
+      options_.keepAlive = keepAliveIt->get<bool>();
+    auto compressIt = configure.find(CONFIG_INTERNAL_COMPRESS_FILED);
+    if (compressIt != configure.end()) {
+      options_.compress = compressIt->get<bool>();
+#ifndef CPPHTTPLIB_ZLIB_SUPPORT
+      if (options_.compress) {
+        IVS_WARN("http_push is built without zlib, compress is ignored");
+        options_.compress = false;
+      }
+#endif
+    }
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
     auto schemeIt = configure.find(CONFIG_INTERNAL_SCHEME_FILED);
     if (schemeIt == configure.end()) {
@@ -103,18 +145,25 @@ common::ErrorCode HttpPush::initInternal(const std::string& json) {
 
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
 HttpPushImpl_::HttpPushImpl_(std::string& scheme, std::string& ip, int port, std::string cert, std::string key,
-		std::string cacert_, bool verify_, std::string path_, int channel)
-    : cli(scheme + "://" + ip + ":" + std::to_string(port), cert, key), cacert(cacert_), verify(verify_), path(path_) {
+		std::string cacert_, bool verify_, std::string path_, int channel,
+		const PushOptions& options)
+    : cli(scheme + "://" + ip + ":" + std::to_string(port), cert, key), cacert(cacert_), verify(verify_), path(path_),
+      mOptions(options) {
   cli.set_ca_cert_path(cacert);
   cli.enable_server_certificate_verification(verify);
+  cli.set_keep_alive(mOptions.keepAlive);
+  cli.set_compress(mOptions.compress);
   workThread = std::thread(&HttpPushImpl_::postFunc, this);
   mFpsProfilerName = "http_push_" + std::to_string(channel) + "_fps";
   mFpsProfiler.config(mFpsProfilerName, 100);
 }
 #else
 HttpPushImpl_::HttpPushImpl_(std::string& ip, int port, std::string path_,
-                             int channel)
-    : cli(ip, port), path(path_) {
+                             int channel, const PushOptions& options)
+    : cli(ip, port), path(path_), mOptions(options) {
+  // keep_alive打开时复用同一条TCP连接，避免每个请求都重新握手
+  cli.set_keep_alive(mOptions.keepAlive);
+  cli.set_compress(mOptions.compress);
   workThread = std::thread(&HttpPushImpl_::postFunc, this);
   mFpsProfilerName = "http_push_" + std::to_string(channel) + "_fps";
   mFpsProfiler.config(mFpsProfilerName, 100);
@@ -127,34 +176,65 @@ void HttpPushImpl_::release() {
 }
 
 void HttpPushImpl_::postFunc() {
+  std::vector<std::shared_ptr<PushItem>> batch;
+  auto batchStart = std::chrono::steady_clock::now();
   while (isRunning) {
     auto ptr = popQueue();
-    if (ptr == nullptr) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    if (ptr != nullptr) {
+      if (batch.empty()) batchStart = std::chrono::steady_clock::now();
+      batch.push_back(ptr);
+    }
+    bool timeout =
+        !batch.empty() &&
+        std::chrono::steady_clock::now() - batchStart >=
+            std::chrono::milliseconds(mOptions.batchTimeoutMs);
+    if (batch.size() >= static_cast<size_t>(mOptions.batchSize) || timeout) {
+      postBatch(batch);
+      batch.clear();
       continue;
     }
-    mFpsProfiler.add(1);
-    cli.Post(path.c_str(), ptr->dump(), "application/json");
+    if (ptr == nullptr)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  if (!batch.empty()) postBatch(batch);
+}
+
+void HttpPushImpl_::postBatch(
+    const std::vector<std::shared_ptr<PushItem>>& batch) {
+  mFpsProfiler.add(batch.size());
+  if (mOptions.format == PushOptions::Format::BINARY) {
+    std::vector<std::shared_ptr<std::string>> frames;
+    frames.reserve(batch.size());
+    for (auto& item : batch) frames.push_back(item->binary);
+    cli.Post(path.c_str(), ResultCodec::encodeBatch(frames),
+             ResultCodec::CONTENT_TYPE);
+  } else if (mOptions.batchSize == 1) {
+    // 保持原有的单个JSON对象格式
+    cli.Post(path.c_str(), batch.front()->json->dump(), "application/json");
+  } else {
+    nlohmann::json array = nlohmann::json::array();
+    for (auto& item : batch) array.push_back(std::move(*item->json));
+    cli.Post(path.c_str(), array.dump(), "application/json");
   }
 }
 
-bool HttpPushImpl_::pushQueue(std::shared_ptr<nlohmann::json> j) {
+bool HttpPushImpl_::pushQueue(std::shared_ptr<PushItem> item) {
   int len = getQueueSize();
   if (len >= maxQueueLen) return false;
   {
     std::lock_guard<std::mutex> lock(mtx);
-    objQueue.push(j);
+    objQueue.push(item);
   }
   return true;
 }
 
-std::shared_ptr<nlohmann::json> HttpPushImpl_::popQueue() {
+std::shared_ptr<PushItem> HttpPushImpl_::popQueue() {
   std::lock_guard<std::mutex> lock(mtx);
-  std::shared_ptr<nlohmann::json> j = nullptr;
-  if (objQueue.empty()) return j;
-  j = objQueue.front();
+  std::shared_ptr<PushItem> item = nullptr;
+  if (objQueue.empty()) return item;
+  item = objQueue.front();
   objQueue.pop();
-  return j;
+  return item;
 }
 
 size_t HttpPushImpl_::getQueueSize() {
@@ -166,6 +246,21 @@ size_t HttpPushImpl_::getQueueSize() {
   return len;
 }
 
+std::shared_ptr<PushItem> HttpPush::makeItem(
+    const std::shared_ptr<common::ObjectMetadata>& objectMetadata) {
+  auto item = std::make_shared<PushItem>();
+  if (options_.format == PushOptions::Format::BINARY) {
+    std::string jpeg;
+    // 编码失败时frame_to_jpeg返回空，这一帧不带图片发送
+    if (withImage_) jpeg = common::frame_to_jpeg(*objectMetadata->mFrame);
+    item->binary = std::make_shared<std::string>(
+        ResultCodec::encodeFrame(objectMetadata, jpeg));
+  } else {
+    item->json = std::make_shared<nlohmann::json>(objectMetadata);
+  }
+  return item;
+}
+
 common::ErrorCode HttpPush::doWork(int dataPipeId) {
   std::vector<int> inputPorts = getInputPorts();
   int inputPort = inputPorts[0];
@@ -185,7 +280,7 @@ common::ErrorCode HttpPush::doWork(int dataPipeId) {
   auto objectMetadata = std::static_pointer_cast<common::ObjectMetadata>(data);
 
   if (!objectMetadata->mFrame->mEndOfStream) {
-    nlohmann::json serializedObj = objectMetadata;
+    auto item = makeItem(objectMetadata);
 
     int channel_id = objectMetadata->mFrame->mChannelId;
     auto implIt = mapImpl_.find(channel_id);
@@ -193,17 +288,15 @@ common::ErrorCode HttpPush::doWork(int dataPipeId) {
       std::lock_guard<std::mutex> lock(mapMtx);
 #ifdef CPPHTTPLIB_OPENSSL_SUPPORT
       auto httpImpl = std::make_shared<HttpPushImpl_>(scheme_, ip_, port_, cert_, key_,
-		      cacert_, verify_, path_, channel_id);
+		      cacert_, verify_, path_, channel_id, options_);
 #else
-      auto httpImpl =
-          std::make_shared<HttpPushImpl_>(ip_, port_, path_, channel_id);
+      auto httpImpl = std::make_shared<HttpPushImpl_>(ip_, port_, path_,
+                                                      channel_id, options_);
 #endif
       mapImpl_[channel_id] = httpImpl;
-      mapImpl_[channel_id]->pushQueue(
-          std::make_shared<nlohmann::json>(serializedObj));
+      mapImpl_[channel_id]->pushQueue(item);
     } else
-      implIt->second->pushQueue(
-          std::make_shared<nlohmann::json>(serializedObj));
+      implIt->second->pushQueue(item);
   }
 
   int channel_id_internal = objectMetadata->mFrame->mChannelIdInternal;
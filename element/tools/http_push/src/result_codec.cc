@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "result_codec.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace sophon_stream {
+namespace element {
+namespace http_push {
+
+namespace {
+
+// 目标平台(x86_64/aarch64)均为小端，直接按内存布局追加
+class Writer {
+ public:
+  explicit Writer(std::string& out) : mOut(out) {}
+
+  template <typename T>
+  void put(T value) {
+    static_assert(std::is_arithmetic<T>::value, "arithmetic only");
+    mOut.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void putBytes(const void* data, std::size_t size) {
+    mOut.append(static_cast<const char*>(data), size);
+  }
+
+  // 列表和字符串长度统一用u32前缀，帧大小本身也是u32，不会出现截断
+  template <typename Vec>
+  std::size_t putCount(const Vec& vec) {
+    put<std::uint32_t>(static_cast<std::uint32_t>(vec.size()));
+    return vec.size();
+  }
+
+  void putFloats(const std::vector<float>& values) {
+    putBytes(values.data(), putCount(values) * sizeof(float));
+  }
+
+  std::size_t size() const { return mOut.size(); }
+
+  void patchU32(std::size_t offset, std::uint32_t value) {
+    std::memcpy(&mOut[offset], &value, sizeof(value));
+  }
+
+ private:
+  std::string& mOut;
+};
+
+}  // namespace
+
+std::string ResultCodec::encodeFrame(
+    const std::shared_ptr<common::ObjectMetadata>& obj,
+    const std::string& jpeg) {
+  std::string out;
+  out.reserve(128 + 32 * obj->mDetectedObjectMetadatas.size() + jpeg.size());
+  Writer w(out);
+  w.put<std::uint32_t>(0);  // frameSize，写完后回填
+
+  const auto& frame = obj->mFrame;
+  w.put<std::int32_t>(frame->mChannelId);
+  w.put<std::int64_t>(frame->mFrameId);
+  w.put<std::int64_t>(frame->mTimestamp);
+  w.put<std::int32_t>(frame->mWidth);
+  w.put<std::int32_t>(frame->mHeight);
+  w.put<float>(obj->fps);
+  w.put<std::int32_t>(obj->mGraphId);
+  w.put<std::int32_t>(obj->mSubId);
+
+  std::size_t n = w.putCount(obj->mDetectedObjectMetadatas);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto& det = obj->mDetectedObjectMetadatas[i];
+    w.put<std::int32_t>(det->mBox.mX);
+    w.put<std::int32_t>(det->mBox.mY);
+    w.put<std::int32_t>(det->mBox.mWidth);
+    w.put<std::int32_t>(det->mBox.mHeight);
+    w.put<std::int32_t>(det->mClassify);
+    w.putFloats(det->mScores);
+  }
+
+  n = w.putCount(obj->mTrackedObjectMetadatas);
+  for (std::size_t i = 0; i < n; ++i)
+    w.put<std::int64_t>(obj->mTrackedObjectMetadatas[i]->mTrackId);
+
+  n = w.putCount(obj->mRecognizedObjectMetadatas);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto& recog = obj->mRecognizedObjectMetadatas[i];
+    std::size_t len = w.putCount(recog->mLabelName);
+    w.putBytes(recog->mLabelName.data(), len);
+    w.putFloats(recog->mScores);
+    std::size_t k = w.putCount(recog->mTopKLabels);
+    for (std::size_t j = 0; j < k; ++j)
+      w.put<std::int32_t>(recog->mTopKLabels[j]);
+  }
+
+  n = w.putCount(obj->mPosedObjectMetadatas);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto& keypoints = obj->mPosedObjectMetadatas[i]->keypoints;
+    std::size_t k = w.putCount(keypoints);
+    w.putBytes(keypoints.data(), k * sizeof(float));
+  }
+
+  n = w.putCount(obj->mFaceObjectMetadatas);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto& face = obj->mFaceObjectMetadatas[i];
+    w.put<std::int32_t>(face->top);
+    w.put<std::int32_t>(face->bottom);
+    w.put<std::int32_t>(face->left);
+    w.put<std::int32_t>(face->right);
+    w.putBytes(face->points_x, sizeof(face->points_x));
+    w.putBytes(face->points_y, sizeof(face->points_y));
+    w.put<float>(face->score);
+  }
+
+  w.put<std::uint32_t>(static_cast<std::uint32_t>(jpeg.size()));
+  w.putBytes(jpeg.data(), jpeg.size());
+
+  w.patchU32(0, static_cast<std::uint32_t>(w.size() - sizeof(std::uint32_t)));
+  return out;
+}
+
+std::string ResultCodec::encodeBatch(
+    const std::vector<std::shared_ptr<std::string>>& frames) {
+  std::size_t total = 8;
+  for (auto& frame : frames) total += frame->size();
+  std::string out;
+  out.reserve(total);
+  Writer w(out);
+  w.putBytes("SSRB", 4);
+  w.put<std::uint16_t>(VERSION);
+  w.put<std::uint16_t>(static_cast<std::uint16_t>(frames.size()));
+  for (auto& frame : frames) w.putBytes(frame->data(), frame->size());
+  return out;
+}
+
+}  // namespace http_push
+}  // namespace element
+}  // namespace sophon_stream
@@ -36,6 +36,8 @@ class Ive : public ::sophon_stream::framework::Element {
 
   common::ErrorCode doWork(int dataPipeId) override;
 
+  bool getMultiDevice() override { return false; }
+
   common::ErrorCode ive_work(std::shared_ptr<common::ObjectMetadata> iveObj);
   void dpu_ive_map(bm_image& dpu_image, bm_image& dpu_image_map,
                    int ive_src_stride[]);
@@ -12,6 +12,7 @@
 
 #include "common/object_metadata.h"
 #include "element.h"
+#include "input_synchronizer.h"
 #include "common/profiler.h"
 
 namespace sophon_stream {
@@ -40,6 +41,10 @@ class Stitch : public ::sophon_stream::framework::Element {
   std::string stitch_mode;
 
   ::sophon_stream::common::FpsProfiler mFpsProfiler;
+
+  framework::SyncOptions mSyncOptions;
+  // 每个dataPipe一个，只由对应的工作线程访问
+  std::vector<std::shared_ptr<framework::InputSynchronizer>> mSynchronizers;
 };
 
 }  // namespace dpu
@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_COMMON_BATCH_TENSORS_H_
+#define SOPHON_STREAM_COMMON_BATCH_TENSORS_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "bmruntime_interface.h"
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace common {
+
+// SoC模式下bm_mem_mmap_device_mem要求的地址对齐
+constexpr std::size_t kMmapAlignBytes = 4096;
+
+/**
+ * @brief 直接调用bmlib申请、释放和拷贝显存
+ */
+struct BmDeviceOps {
+  static bm_status_t alloc(bm_handle_t handle, bm_device_mem_t* mem,
+                           int heapId, unsigned int bytes) {
+    return bm_malloc_device_byte_heap(handle, mem, heapId, bytes);
+  }
+  static void free(bm_handle_t handle, bm_device_mem_t mem) {
+    bm_free_device(handle, mem);
+  }
+  static bm_status_t copy(bm_handle_t handle, bm_device_mem_t dst,
+                          std::size_t dstOffset, bm_device_mem_t src,
+                          std::size_t srcOffset, std::size_t bytes) {
+    return bm_memcpy_d2d_byte(handle, dst, dstOffset, src, srcOffset, bytes);
+  }
+};
+
+/**
+ * @brief batch输入或输出中一个tensor的布局
+ */
+struct BatchTensorLayout {
+  bm_data_type_t dtype;
+  bm_shape_t shape;   // dims[0]为max batch
+  std::size_t bytes;  // 整个batch的字节数，每个目标占bytes / maxBatch
+};
+
+/**
+ * @brief 从pool取一块连续的batch输入，第j个目标的输入tensor是其中第j个槽位的
+ * 视图；目标释放时只释放被预处理换成自己申请的显存，槽位随batch还给pool
+ * @tparam Ops 提供alloc、free、copy，见BmDeviceOps
+ * @tparam Pool 见BasicDeviceMemPool
+ * @return batch输入，目标数不能超过maxBatch
+ */
+template <typename Ops = BmDeviceOps, typename Pool>
+std::shared_ptr<bmTensors> stageBatchInputs(
+    const std::shared_ptr<Pool>& pool, bm_handle_t handle,
+    const std::vector<BatchTensorLayout>& layouts, int maxBatch,
+    ObjectMetadatas& objectMetadatas) {
+  auto batch = pool->makeTensors(handle, layouts.size());
+  std::vector<std::size_t> slotBytes(layouts.size());
+  for (std::size_t i = 0; i < layouts.size(); ++i) {
+    auto& tensor = batch->tensors[i];
+    tensor->dtype = layouts[i].dtype;
+    tensor->shape = layouts[i].shape;
+    tensor->st_mode = BM_STORE_1N;
+    slotBytes[i] = layouts[i].bytes / maxBatch;
+    bool ok = pool->acquire(layouts[i].bytes, &tensor->device_mem);
+    STREAM_CHECK(ok, "Alloc Device Memory Failed! Program Terminated.")
+  }
+
+  for (std::size_t j = 0; j < objectMetadatas.size(); ++j) {
+    std::vector<unsigned long long> slots(layouts.size());
+    for (std::size_t i = 0; i < layouts.size(); ++i)
+      slots[i] = bm_mem_get_device_addr(batch->tensors[i]->device_mem) +
+                 j * slotBytes[i];
+    auto& obj = objectMetadatas[j];
+    obj->mInputBMtensors.reset(new bmTensors(), [slots](bmTensors* p) {
+      for (std::size_t i = 0; i < p->tensors.size(); ++i) {
+        auto addr = p->tensors[i]->device_mem.u.device.device_addr;
+        if (addr != 0 && addr != slots[i])
+          Ops::free(p->handle, p->tensors[i]->device_mem);
+      }
+      delete p;
+    });
+    obj->mInputBMtensors->handle = handle;
+    obj->mInputBMtensors->batch = batch;
+    obj->mInputBMtensors->batchIndex = j;
+    obj->mInputBMtensors->tensors.resize(layouts.size());
+    for (std::size_t i = 0; i < layouts.size(); ++i) {
+      auto& tensor = obj->mInputBMtensors->tensors[i];
+      tensor = std::make_shared<bm_tensor_t>();
+      tensor->dtype = batch->tensors[i]->dtype;
+      tensor->shape = batch->tensors[i]->shape;
+      tensor->shape.dims[0] = 1;
+      tensor->st_mode = BM_STORE_1N;
+      tensor->device_mem = bm_mem_from_device(slots[i], slotBytes[i]);
+    }
+  }
+  return batch;
+}
+
+/**
+ * @brief 取预处理结果的显存：目标有batch槽位且放得下时直接用槽位，
+ * 否则在STREAM_NPU_HEAP上单独申请
+ * @return Ops::alloc的返回值，使用槽位时为BM_SUCCESS
+ */
+template <typename Ops = BmDeviceOps>
+bm_status_t acquireSlotOrAlloc(const bmTensors& inputs, int sizeByte,
+                               bm_device_mem_t* mem) {
+  if (inputs.batch != nullptr) {
+    const bm_device_mem_t& slot = inputs.tensors[0]->device_mem;
+    if (bm_mem_get_device_size(slot) >= static_cast<unsigned int>(sizeByte)) {
+      *mem = slot;
+      return BM_SUCCESS;
+    }
+  }
+  return Ops::alloc(inputs.handle, mem, STREAM_NPU_HEAP, sizeByte);
+}
+
+/**
+ * @brief 各目标的输入是否是同一个连续batch缓冲中按顺序排列的槽位
+ * @return 是则返回该batch缓冲，否则返回nullptr，此时需要逐个拷贝
+ */
+inline std::shared_ptr<bmTensors> getStagedBatch(
+    ObjectMetadatas& objectMetadatas, int maxBatch) {
+  if (objectMetadatas.empty() || !objectMetadatas[0]->mInputBMtensors)
+    return nullptr;
+  auto batch = objectMetadatas[0]->mInputBMtensors->batch;
+  if (batch == nullptr) return nullptr;
+  for (std::size_t j = 0; j < objectMetadatas.size(); ++j) {
+    if (objectMetadatas[j]->mFrame->mEndOfStream) break;
+    auto& inputs = objectMetadatas[j]->mInputBMtensors;
+    if (!inputs || inputs->batch != batch ||
+        inputs->batchIndex != static_cast<int>(j))
+      return nullptr;
+    for (std::size_t i = 0; i < inputs->tensors.size(); ++i) {
+      const bm_device_mem_t& batchMem = batch->tensors[i]->device_mem;
+      unsigned long long slot =
+          bm_mem_get_device_addr(batchMem) +
+          static_cast<unsigned long long>(j) *
+              (bm_mem_get_device_size(batchMem) / maxBatch);
+      if (bm_mem_get_device_addr(inputs->tensors[i]->device_mem) != slot)
+        return nullptr;
+    }
+  }
+  return batch;
+}
+
+/**
+ * @brief 合并各目标的输入：预处理已经按顺序写进同一个batch缓冲时直接返回它，
+ * 否则(目标来自不同的batch、换成了自己申请的显存等)从pool取新的batch逐个拷贝
+ */
+template <typename Ops = BmDeviceOps, typename Pool>
+std::shared_ptr<bmTensors> mergeBatchInputs(
+    const std::shared_ptr<Pool>& pool, bm_handle_t handle,
+    const std::vector<BatchTensorLayout>& layouts, int maxBatch,
+    ObjectMetadatas& objectMetadatas) {
+  auto staged = getStagedBatch(objectMetadatas, maxBatch);
+  if (staged != nullptr) return staged;
+
+  auto inputTensors = pool->makeTensors(handle, layouts.size());
+  for (std::size_t i = 0; i < layouts.size(); ++i) {
+    auto& tensor = inputTensors->tensors[i];
+    tensor->dtype = layouts[i].dtype;
+    tensor->shape = layouts[i].shape;
+    tensor->st_mode = BM_STORE_1N;
+    bool ok = pool->acquire(layouts[i].bytes, &tensor->device_mem);
+    STREAM_CHECK(ok, "Alloc Device Memory Failed! Program Terminated.")
+    std::size_t slotBytes = layouts[i].bytes / maxBatch;
+    for (std::size_t j = 0; j < objectMetadatas.size(); ++j) {
+      if (objectMetadatas[j]->mFrame->mEndOfStream) break;
+      Ops::copy(handle, tensor->device_mem, j * slotBytes,
+                objectMetadatas[j]->mInputBMtensors->tensors[i]->device_mem, 0,
+                slotBytes);
+    }
+  }
+  return inputTensors;
+}
+
+/**
+ * @brief 把batch输出拆给各目标：能用视图时每个目标直接引用batch输出中的一段，
+ * batch输出在最后一个目标释放后还给pool；SoC模式下后处理会mmap输出显存，
+ * 每段的起始地址需要按kMmapAlignBytes对齐，否则从pool另取显存拷贝
+ */
+template <typename Ops = BmDeviceOps, typename Pool>
+void splitBatchOutputs(const std::shared_ptr<Pool>& pool, bm_handle_t handle,
+                       const std::vector<BatchTensorLayout>& layouts,
+                       int maxBatch, bool isSoc,
+                       ObjectMetadatas& objectMetadatas,
+                       std::shared_ptr<bmTensors> outputTensors) {
+  std::vector<std::size_t> sliceBytes(layouts.size());
+  bool useViews = true;
+  for (std::size_t j = 0; j < layouts.size(); ++j) {
+    sliceBytes[j] = layouts[j].bytes / maxBatch;
+    if (isSoc && sliceBytes[j] % kMmapAlignBytes != 0) useViews = false;
+  }
+
+  for (std::size_t i = 0; i < objectMetadatas.size(); ++i) {
+    if (objectMetadatas[i]->mFrame->mEndOfStream) break;
+    auto& outputs = objectMetadatas[i]->mOutputBMtensors;
+    if (useViews) {
+      outputs = std::make_shared<bmTensors>();
+      outputs->handle = handle;
+      outputs->batch = outputTensors;
+      outputs->batchIndex = i;
+      outputs->tensors.resize(layouts.size());
+      for (auto& tensor : outputs->tensors)
+        tensor = std::make_shared<bm_tensor_t>();
+    } else {
+      outputs = pool->makeTensors(handle, layouts.size());
+    }
+    for (std::size_t j = 0; j < layouts.size(); ++j) {
+      auto& tensor = outputs->tensors[j];
+      tensor->dtype = layouts[j].dtype;
+      tensor->shape = layouts[j].shape;
+      tensor->shape.dims[0] /= maxBatch;
+      tensor->st_mode = BM_STORE_1N;
+      if (useViews) {
+        tensor->device_mem = bm_mem_from_device(
+            bm_mem_get_device_addr(outputTensors->tensors[j]->device_mem) +
+                i * sliceBytes[j],
+            sliceBytes[j]);
+        continue;
+      }
+      bool ok = pool->acquire(sliceBytes[j], &tensor->device_mem);
+      STREAM_CHECK(ok, "Alloc Device Memory Failed! Program Terminated.")
+      Ops::copy(handle, tensor->device_mem, 0,
+                outputTensors->tensors[j]->device_mem, i * sliceBytes[j],
+                sliceBytes[j]);
+    }
+  }
+}
+
+}  // namespace common
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_COMMON_BATCH_TENSORS_H_
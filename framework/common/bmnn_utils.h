@@ -2,14 +2,20 @@
 
 #include <assert.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <unordered_map>
 
 #include "bmruntime_interface.h"
+#include "common_defs.h"
+#include "device_mem_pool.h"
 #include "no_copyable.h"
 
 extern "C" {
@@ -261,10 +267,15 @@ class BMNNNetwork : public ::sophon_stream::common::NoCopyable {
   std::unordered_map<std::string, bm_tensor_t*> m_mapInputs;
   std::unordered_map<std::string, bm_tensor_t*> m_mapOutputs;
 
+  // 推理输入输出的显存池，按字节数复用各stage的batch缓冲
+  std::shared_ptr<::sophon_stream::common::DeviceMemPool> m_tensorPool;
+
  public:
   BMNNNetwork(void* bmrt, const std::string& name) : m_bmrt(bmrt) {
     m_handle = static_cast<bm_handle_t>(bmrt_get_bm_handle(bmrt));
     m_netinfo = bmrt_get_network_info(bmrt, name.c_str());
+    m_tensorPool = std::make_shared<::sophon_stream::common::DeviceMemPool>(
+        ::sophon_stream::common::BmDeviceAllocator{m_handle, STREAM_NPU_HEAP});
     m_max_batch = -1;
     std::vector<int> batches;
     for (int i = 0; i < m_netinfo->stage_num; i++) {
@@ -307,8 +318,9 @@ class BMNNNetwork : public ::sophon_stream::common::NoCopyable {
       if (BM_FLOAT32 == m_netinfo->output_dtypes[i]) max_size *= 4;
       // auto ret =  bm_malloc_device_byte(m_handle,
       // &m_outputTensors[i].device_mem, max_size);
-      auto ret = bm_malloc_device_byte_heap(
-          m_handle, &m_outputTensors[i]->device_mem, 0, max_size);
+      auto ret = bm_malloc_device_byte_heap(m_handle,
+                                            &m_outputTensors[i]->device_mem,
+                                            STREAM_NPU_HEAP, max_size);
       assert(BM_SUCCESS == ret);
     }
     struct bm_misc_info misc_info;
@@ -340,6 +352,13 @@ class BMNNNetwork : public ::sophon_stream::common::NoCopyable {
   }
 
   int maxBatch() const { return m_max_batch; }
+
+  /**
+   * @brief 推理输入输出显存池，getStats()可查看复用情况
+   */
+  std::shared_ptr<::sophon_stream::common::DeviceMemPool> tensorPool() {
+    return m_tensorPool;
+  }
   int get_nearest_batch(int real_batch) {
     for (auto batch : m_batches) {
       if (batch >= real_batch) {
@@ -369,6 +388,63 @@ class BMNNNetwork : public ::sophon_stream::common::NoCopyable {
         m_netinfo->output_scales[index], m_outputTensors[index].get(), is_soc);
   }
 
+  /**
+   * @brief 预热：每个stage(即每种batch)用全0输入推理一次
+   * @brief 第一次forward时bmruntime才真正准备该stage，首帧会多出几百毫秒；
+   * 输入输出显存的大小与推理时一致(Inference::mergeInputDeviceMem、
+   * getOutputDeviceMem按各stage的最大值申请)，所有stage共用一组，结束后
+   * 留在tensorPool里供正式推理复用；max batch为1时推理不从池里取输入显存，
+   * 预热用的输入显存从临时的池里取，预热结束即释放
+   * @brief tpu_kernel后处理的模块加载和函数查找在element初始化时完成，
+   * 第一次tpu_kernel_launch的参数依赖各element的配置，不在这里预热
+   * @return 所有stage都推理成功时返回0
+   */
+  int warmUp() {
+    auto inputPool =
+        m_max_batch > 1
+            ? m_tensorPool
+            : std::make_shared<::sophon_stream::common::DeviceMemPool>(
+                  ::sophon_stream::common::BmDeviceAllocator{m_handle,
+                                                           STREAM_NPU_HEAP});
+    auto inputs = inputPool->makeTensors(m_handle, m_netinfo->input_num);
+    for (int i = 0; i < m_netinfo->input_num; ++i) {
+      auto& tensor = inputs->tensors[i];
+      tensor->dtype = m_netinfo->input_dtypes[i];
+      tensor->st_mode = BM_STORE_1N;
+      std::size_t count = 0;
+      for (int s = 0; s < m_netinfo->stage_num; ++s)
+        count = std::max<std::size_t>(
+            count, bmrt_shape_count(&m_netinfo->stages[s].input_shapes[i]));
+      if (!inputPool->acquire(count * bmrt_data_type_size(tensor->dtype),
+                              &tensor->device_mem))
+        return -1;
+      bm_memset_device(m_handle, 0, tensor->device_mem);
+    }
+    auto outputs = m_tensorPool->makeTensors(m_handle, m_netinfo->output_num);
+    for (int i = 0; i < m_netinfo->output_num; ++i) {
+      auto& tensor = outputs->tensors[i];
+      tensor->dtype = m_netinfo->output_dtypes[i];
+      tensor->st_mode = BM_STORE_1N;
+      std::size_t count = 0;
+      for (int s = 0; s < m_netinfo->stage_num; ++s)
+        count = std::max<std::size_t>(
+            count, bmrt_shape_count(&m_netinfo->stages[s].output_shapes[i]));
+      if (!m_tensorPool->acquire(count * bmrt_data_type_size(tensor->dtype),
+                                 &tensor->device_mem))
+        return -1;
+    }
+
+    int result = 0;
+    for (int s = 0; s < m_netinfo->stage_num; ++s) {
+      for (int i = 0; i < m_netinfo->input_num; ++i)
+        inputs->tensors[i]->shape = m_netinfo->stages[s].input_shapes[i];
+      for (int i = 0; i < m_netinfo->output_num; ++i)
+        outputs->tensors[i]->shape = m_netinfo->stages[s].output_shapes[i];
+      if (forward(inputs->tensors, outputs->tensors) != 0) result = -1;
+    }
+    return result;
+  }
+
   template <bool dual_core = false>
   int forward(std::vector<std::shared_ptr<bm_tensor_t>>& inputTensors,
               std::vector<std::shared_ptr<bm_tensor_t>>& outputTensors) {
@@ -479,6 +555,9 @@ class BMNNContext : public ::sophon_stream::common::NoCopyable {
   BMNNHandlePtr m_handlePtr;
   void* m_bmrt;
   std::vector<std::string> m_network_names;
+  // 同一个网络只创建一次，共享该context的element拿到的是同一个网络对象
+  std::mutex m_networks_mutex;
+  std::unordered_map<std::string, std::shared_ptr<BMNNNetwork>> m_networks;
 
  public:
   BMNNContext(BMNNHandlePtr handle, const char* bmodel_file)
@@ -529,11 +608,147 @@ class BMNNContext : public ::sophon_stream::common::NoCopyable {
   }
 
   std::shared_ptr<BMNNNetwork> network(const std::string& net_name) {
-    return std::make_shared<BMNNNetwork>(m_bmrt, net_name);
+    std::lock_guard<std::mutex> lock(m_networks_mutex);
+    auto& net = m_networks[net_name];
+    if (net == nullptr) net = std::make_shared<BMNNNetwork>(m_bmrt, net_name);
+    return net;
   }
 
   std::shared_ptr<BMNNNetwork> network(int net_index) {
     assert(net_index < (int)m_network_names.size());
-    return std::make_shared<BMNNNetwork>(m_bmrt, m_network_names[net_index]);
+    return network(m_network_names[net_index]);
+  }
+
+  /**
+   * @brief 预热是否已经完成
+   */
+  bool warmed() const { return m_warmed; }
+
+  /**
+   * @brief 预热bmodel中的所有网络，同一个context只预热一次
+   * @brief 多个线程同时调用时只有一个线程执行预热，其它线程等它完成后返回
+   * 同样的结果
+   * @return 所有网络都预热成功时返回0
+   */
+  int warmUp() {
+    std::call_once(m_warmOnce, [this] {
+      int result = 0;
+      for (auto& name : m_network_names)
+        if (network(name)->warmUp() != 0) result = -1;
+      m_warmResult = result;
+      m_warmed = true;
+    });
+    return m_warmResult;
+  }
+
+ private:
+  std::once_flag m_warmOnce;
+  int m_warmResult = 0;
+  std::atomic<bool> m_warmed{false};
+};
+
+using BMNNContextPtr = std::shared_ptr<BMNNContext>;
+
+/**
+ * @brief 打开设备句柄和在设备上加载bmodel
+ */
+struct BmModelLoader {
+  using Handle = BMNNHandle;
+  using Context = BMNNContext;
+
+  BMNNHandlePtr openHandle(int dev_id) {
+    return std::make_shared<BMNNHandle>(dev_id);
+  }
+  BMNNContextPtr loadContext(BMNNHandlePtr handle,
+                             const std::string& bmodel_file) {
+    return std::make_shared<BMNNContext>(handle, bmodel_file.c_str());
+  }
+};
+
+/**
+ * @brief 进程内共享的设备句柄和模型表
+ * @brief 按设备号复用BMNNHandle，按(bmodel路径, 设备号)复用BMNNContext：
+ * 多个graph或同一设备上的多个element使用同一个bmodel时只加载一次，
+ * 网络对象、输入输出显存池也随之共享；表中只保存weak_ptr，
+ * 最后一个使用者释放后对象随之析构
+ * @brief 网络的forward不保存单次调用的状态，输入输出由调用者提供，
+ * 共享同一网络的各element线程可以并发调用
+ * @tparam Loader 提供Handle、Context类型以及openHandle(int)和
+ * loadContext(handle, bmodel_file)，可以换成不访问设备的实现来验证引用计数
+ */
+template <typename Loader>
+class BasicModelRegistry : public ::sophon_stream::common::NoCopyable {
+ public:
+  using HandlePtr = std::shared_ptr<typename Loader::Handle>;
+  using ContextPtr = std::shared_ptr<typename Loader::Context>;
+
+  static BasicModelRegistry& getInstance() {
+    static BasicModelRegistry registry;
+    return registry;
   }
-};
\ No newline at end of file
+
+  explicit BasicModelRegistry(Loader loader = Loader()) : m_loader(loader) {}
+
+  HandlePtr handle(int dev_id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& weak = m_handles[dev_id];
+    HandlePtr handle = weak.lock();
+    if (handle == nullptr) {
+      handle = m_loader.openHandle(dev_id);
+      weak = handle;
+    }
+    return handle;
+  }
+
+  /**
+   * @brief 取已加载的模型，没有时在handle所在设备上加载；
+   * 加载在锁内进行，多个element同时初始化时也只加载一次
+   */
+  ContextPtr context(HandlePtr handle, const std::string& bmodel_file) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& weak = m_contexts[std::make_pair(bmodel_file, handle->dev_id())];
+    ContextPtr ctx = weak.lock();
+    if (ctx == nullptr) {
+      ctx = m_loader.loadContext(handle, bmodel_file);
+      weak = ctx;
+    } else {
+      std::cout << "reuse bmodel(" << bmodel_file << ") on device "
+                << handle->dev_id() << std::endl;
+    }
+    return ctx;
+  }
+
+  /**
+   * @brief 预热当前已加载的所有模型，已预热过的模型直接跳过
+   * @return 新预热的模型数
+   */
+  int warmUp() {
+    std::vector<std::pair<std::string, ContextPtr>> contexts;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (auto& pair : m_contexts) {
+        ContextPtr ctx = pair.second.lock();
+        if (ctx != nullptr) contexts.emplace_back(pair.first.first, ctx);
+      }
+    }
+    // 预热在锁外进行，不阻塞其他graph加载模型
+    int warmed = 0;
+    for (auto& pair : contexts) {
+      if (pair.second->warmed()) continue;
+      if (pair.second->warmUp() != 0)
+        std::cout << "warm up bmodel(" << pair.first << ") failed" << std::endl;
+      ++warmed;
+    }
+    return warmed;
+  }
+
+ private:
+  Loader m_loader;
+  std::mutex m_mutex;
+  std::map<int, std::weak_ptr<typename Loader::Handle>> m_handles;
+  std::map<std::pair<std::string, int>,
+           std::weak_ptr<typename Loader::Context>>
+      m_contexts;
+};
+
+using BMNNModelRegistry = BasicModelRegistry<BmModelLoader>;
\ No newline at end of file
@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_COMMON_DEVICE_MEM_POOL_H_
+#define SOPHON_STREAM_COMMON_DEVICE_MEM_POOL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "bmruntime_interface.h"
+#include "common/no_copyable.h"
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace common {
+
+/**
+ * @brief 在指定heap上申请和释放设备内存
+ */
+struct BmDeviceAllocator {
+  bm_handle_t handle;
+  int heapId;
+
+  bool alloc(std::size_t bytes, bm_device_mem_t* mem) {
+    return bm_malloc_device_byte_heap(handle, mem, heapId, bytes) ==
+           BM_SUCCESS;
+  }
+  void free(bm_device_mem_t mem) { bm_free_device(handle, mem); }
+};
+
+/**
+ * @brief 推理输入输出显存的复用池
+ * @brief 同一个网络每个stage的输入输出shape是固定的，字节数相同的显存放在同一个
+ * 空闲链表里，释放时挂回链表，下一帧直接取用，不再每个batch申请和释放；
+ * 每种大小最多缓存maxCachedPerSize块，多余的直接释放
+ * @brief 线程安全；必须通过std::make_shared创建，makeTensors返回的bmTensors
+ * 持有内存池的引用
+ * @tparam Allocator 提供bool alloc(std::size_t, bm_device_mem_t*)和
+ * void free(bm_device_mem_t)，可以换成在主机内存上分配的实现来验证池的逻辑
+ */
+template <typename Allocator>
+class BasicDeviceMemPool
+    : public ::sophon_stream::common::NoCopyable,
+      public std::enable_shared_from_this<BasicDeviceMemPool<Allocator>> {
+ public:
+  struct Stats {
+    std::uint64_t acquired = 0;   // acquire调用次数
+    std::uint64_t reused = 0;     // 其中从空闲链表取到的次数
+    std::uint64_t allocated = 0;  // 实际向allocator申请的次数
+    std::uint64_t freed = 0;      // 实际还给allocator的次数
+    std::size_t inUseBytes = 0;   // 已借出未归还的字节数
+    std::size_t cachedBytes = 0;  // 空闲链表中的字节数
+  };
+
+  explicit BasicDeviceMemPool(Allocator allocator, int maxCachedPerSize = 16)
+      : mAllocator(allocator), mMaxCachedPerSize(maxCachedPerSize) {}
+
+  ~BasicDeviceMemPool() {
+    for (auto& freeList : mFreeLists)
+      for (auto& mem : freeList.second) mAllocator.free(mem);
+  }
+
+  /**
+   * @brief 取一块bytes字节的显存，优先复用空闲链表
+   * @return allocator申请失败时返回false
+   */
+  bool acquire(std::size_t bytes, bm_device_mem_t* mem) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      ++mStats.acquired;
+      auto it = mFreeLists.find(bytes);
+      if (it != mFreeLists.end() && !it->second.empty()) {
+        *mem = it->second.back();
+        it->second.pop_back();
+        ++mStats.reused;
+        mStats.cachedBytes -= bytes;
+        mStats.inUseBytes += bytes;
+        return true;
+      }
+    }
+    if (!mAllocator.alloc(bytes, mem)) return false;
+    std::lock_guard<std::mutex> lock(mMutex);
+    ++mStats.allocated;
+    mStats.inUseBytes += bytes;
+    return true;
+  }
+
+  /**
+   * @brief 归还acquire取到的显存，大小取自mem.size
+   */
+  void release(const bm_device_mem_t& mem) {
+    std::size_t bytes = mem.size;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStats.inUseBytes -= std::min(mStats.inUseBytes, bytes);
+      auto& freeList = mFreeLists[bytes];
+      if (freeList.size() < static_cast<std::size_t>(mMaxCachedPerSize)) {
+        freeList.push_back(mem);
+        mStats.cachedBytes += bytes;
+        return;
+      }
+      ++mStats.freed;
+    }
+    mAllocator.free(mem);
+  }
+
+  /**
+   * @brief 创建num个空tensor，调用者填写dtype、shape后用acquire申请device_mem；
+   * 析构时把其中非空的device_mem还给内存池
+   */
+  std::shared_ptr<bmTensors> makeTensors(bm_handle_t handle, int num) {
+    auto self = this->shared_from_this();
+    auto deleter = [self](bmTensors* p) {
+      for (auto& tensor : p->tensors)
+        if (tensor->device_mem.u.device.device_addr != 0)
+          self->release(tensor->device_mem);
+      delete p;
+    };
+    std::shared_ptr<bmTensors> tensors(new bmTensors(), deleter);
+    tensors->handle = handle;
+    tensors->tensors.resize(num);
+    for (auto& tensor : tensors->tensors)
+      tensor = std::make_shared<bm_tensor_t>();
+    return tensors;
+  }
+
+  Stats getStats() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+  }
+
+ private:
+  Allocator mAllocator;
+  int mMaxCachedPerSize;
+  std::mutex mMutex;
+  std::unordered_map<std::size_t, std::vector<bm_device_mem_t>> mFreeLists;
+  Stats mStats;
+};
+
+using DeviceMemPool = BasicDeviceMemPool<BmDeviceAllocator>;
+
+}  // namespace common
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_COMMON_DEVICE_MEM_POOL_H_
@@ -10,6 +10,7 @@
 #ifndef SOPHON_STREAM_COMMON_FRAME_H_
 #define SOPHON_STREAM_COMMON_FRAME_H_
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -44,7 +45,9 @@ struct Frame {
         mWidthStep(0),
         mHeight(0),
         mHeightStep(0),
-        mDataSize(0) {}
+        mDataSize(0),
+        mDecoderGeneration(0),
+        mCreateTime(std::chrono::steady_clock::now()) {}
 
   bool empty() const {
     return 0 == mChannel || 0 == mChannelStep || 0 == mWidth ||
@@ -76,6 +79,13 @@ struct Frame {
   std::shared_ptr<bm_image> mSpDataOsd;
   std::shared_ptr<bm_image> mSpDataDwa;
   std::shared_ptr<bm_image> mSpDataDpu;
+
+  // 解码器每次打开码流时分配的序号，通道重启或循环播放后帧号会从头开始，
+  // 与mChannelId、mFrameId一起才能唯一确定一帧
+  std::uint64_t mDecoderGeneration;
+
+  // 创建Frame的时刻，sink处据此统计端到端时延
+  std::chrono::steady_clock::time_point mCreateTime;
 };
 
 }  // namespace common
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "glyph_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sophon_stream {
+namespace common {
+
+GlyphAtlas& GlyphAtlas::getInstance() {
+  static GlyphAtlas atlas;
+  return atlas;
+}
+
+const Glyph* GlyphAtlas::lookup(const std::string& font, int size,
+                                char32_t codepoint,
+                                const Rasterizer& rasterizer) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  Key key = std::make_tuple(font, size, codepoint);
+  auto it = mGlyphs.find(key);
+  if (it != mGlyphs.end()) return &it->second;
+
+  GlyphBitmap bitmap;
+  if (!rasterizer || !rasterizer(codepoint, bitmap)) return nullptr;
+
+  Glyph glyph;
+  glyph.width = bitmap.width;
+  glyph.height = bitmap.height;
+  glyph.left = bitmap.left;
+  glyph.top = bitmap.top;
+  glyph.advance = bitmap.advance;
+  if (glyph.width > 0 && glyph.height > 0)
+    glyph.alpha = store(bitmap, glyph.stride);
+
+  // std::map的节点地址稳定，返回的指针在图集生命周期内一直有效
+  return &mGlyphs.emplace(key, glyph).first->second;
+}
+
+std::size_t GlyphAtlas::glyphCount() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mGlyphs.size();
+}
+
+std::size_t GlyphAtlas::pageCount() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mPages.size();
+}
+
+const std::uint8_t* GlyphAtlas::store(const GlyphBitmap& bitmap, int& stride) {
+  // 按行(shelf)装箱：当前行放不下则换行，当前页放不下则新开一页，
+  // 超过页大小的字形单独占一页
+  Page* page = mPages.empty() ? nullptr : &mPages.back();
+  bool oversize = bitmap.width > kPageSize || bitmap.height > kPageSize;
+  if (page && !oversize) {
+    if (page->cursorX + bitmap.width > page->width) {
+      page->shelfY += page->shelfHeight;
+      page->cursorX = 0;
+      page->shelfHeight = 0;
+    }
+    if (page->shelfY + bitmap.height > page->height) page = nullptr;
+  }
+  if (!page || oversize) {
+    Page newPage;
+    newPage.width = std::max(kPageSize, bitmap.width);
+    newPage.height = std::max(kPageSize, bitmap.height);
+    newPage.pixels.reset(new std::uint8_t[newPage.width * newPage.height]());
+    mPages.push_back(std::move(newPage));
+    page = &mPages.back();
+  }
+
+  std::uint8_t* dst =
+      page->pixels.get() + page->shelfY * page->width + page->cursorX;
+  for (int row = 0; row < bitmap.height; ++row) {
+    std::memcpy(dst + row * page->width,
+                bitmap.alpha.data() + row * bitmap.width, bitmap.width);
+  }
+  page->cursorX += bitmap.width;
+  page->shelfHeight = std::max(page->shelfHeight, bitmap.height);
+
+  stride = page->width;
+  return dst;
+}
+
+}  // namespace common
+}  // namespace sophon_stream
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_COMMON_GLYPH_ATLAS_H_
+#define SOPHON_STREAM_COMMON_GLYPH_ATLAS_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace sophon_stream {
+namespace common {
+
+/**
+ * @brief 字形在图集中的位置和度量，alpha指向图集页内存，生命周期与进程相同
+ * @brief left/top为位图左上角相对于基线起点的偏移(与FreeType一致，top向上为正)
+ */
+struct Glyph {
+  int width = 0;
+  int height = 0;
+  int left = 0;
+  int top = 0;
+  int advance = 0;
+  int stride = 0;
+  const std::uint8_t* alpha = nullptr;
+};
+
+/**
+ * @brief 光栅化回调输出的8bit alpha位图，由调用者填写
+ */
+struct GlyphBitmap {
+  int width = 0;
+  int height = 0;
+  int left = 0;
+  int top = 0;
+  int advance = 0;
+  std::vector<std::uint8_t> alpha;
+};
+
+/**
+ * @brief 进程内共享的字形图集，按(字体, 字号, 码点)缓存预渲染的alpha位图
+ * @brief 同一个字形只在第一次出现时调用一次光栅化回调，之后直接返回图集内的位图，
+ * osd插件和samples的画图函数共用同一个实例
+ */
+class GlyphAtlas {
+ public:
+  using Rasterizer = std::function<bool(char32_t codepoint, GlyphBitmap& out)>;
+
+  static GlyphAtlas& getInstance();
+
+  /**
+   * @brief 查找字形，未命中时调用rasterizer生成并写入图集
+   * @param font 字体标识，如字体文件路径
+   * @param size 像素字号
+   * @return 光栅化失败时返回nullptr
+   */
+  const Glyph* lookup(const std::string& font, int size, char32_t codepoint,
+                      const Rasterizer& rasterizer);
+
+  std::size_t glyphCount();
+
+  std::size_t pageCount();
+
+  static constexpr int kPageSize = 512;
+
+ private:
+  GlyphAtlas() = default;
+
+  struct Page {
+    int width;
+    int height;
+    int cursorX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    std::unique_ptr<std::uint8_t[]> pixels;
+  };
+
+  using Key = std::tuple<std::string, int, char32_t>;
+
+  const std::uint8_t* store(const GlyphBitmap& bitmap, int& stride);
+
+  std::mutex mMutex;
+  std::map<Key, Glyph> mGlyphs;
+  std::vector<Page> mPages;
+};
+
+}  // namespace common
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_COMMON_GLYPH_ATLAS_H_
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_COMMON_INFLIGHT_QUEUE_H_
+#define SOPHON_STREAM_COMMON_INFLIGHT_QUEUE_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/no_copyable.h"
+
+namespace sophon_stream {
+namespace common {
+
+/**
+ * @brief 推理在途队列：调用线程提交一个batch后立即返回，继续收集和预处理下一个
+ * batch，最多depth个batch同时在推理；前一个batch在TPU上收尾时后一个batch已经
+ * launch，TPU不会因为收发数据而空闲
+ * @brief 每个batch的run在内部线程上执行，run结束后按提交顺序执行done，
+ * 后处理和发送数据放在done里即可保证输出顺序
+ * @brief run只是一个函数，换成sleep模拟延迟的假推理就可以在CPU上验证流水逻辑，
+ * 见tests/framework/inflight_queue_test.cc
+ * @brief 目前只有yolov5(infer_depth)接入，yolox、yolov7、yolov8等其它检测
+ * element仍在工作线程上同步推理
+ */
+class InflightQueue : public ::sophon_stream::common::NoCopyable {
+ public:
+  /**
+   * @param depth 最多同时在途的batch数，即内部线程数
+   */
+  explicit InflightQueue(int depth) : mDepth(depth < 1 ? 1 : depth) {
+    for (int i = 0; i < mDepth; ++i)
+      mWorkers.emplace_back(&InflightQueue::workerFunc, this);
+  }
+
+  /**
+   * @brief 等待已提交的batch全部完成后回收线程
+   */
+  ~InflightQueue() {
+    drain();
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mCond.notify_all();
+    for (auto& worker : mWorkers) worker.join();
+  }
+
+  int getDepth() const { return mDepth; }
+
+  /**
+   * @brief 提交一个batch，在途batch已满时阻塞到最早的一个完成
+   */
+  void submit(std::function<void()> run, std::function<void()> done) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCond.wait(lock, [this] { return mInflight < mDepth; });
+    ++mInflight;
+    mJobs.push_back({mNextTicket++, std::move(run), std::move(done)});
+    lock.unlock();
+    mCond.notify_all();
+  }
+
+  /**
+   * @brief 阻塞到已提交的batch全部执行完done
+   */
+  void drain() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCond.wait(lock, [this] { return mInflight == 0; });
+  }
+
+ private:
+  struct Job {
+    std::uint64_t ticket;
+    std::function<void()> run;
+    std::function<void()> done;
+  };
+
+  void workerFunc() {
+    while (true) {
+      Job job;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+        if (mJobs.empty()) return;
+        job = std::move(mJobs.front());
+        mJobs.pop_front();
+      }
+
+      job.run();
+
+      // 按提交顺序执行完成回调
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this, &job] { return mTurn == job.ticket; });
+      }
+      job.done();
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mTurn;
+        --mInflight;
+      }
+      mCond.notify_all();
+    }
+  }
+
+  int mDepth;
+  std::vector<std::thread> mWorkers;
+  std::deque<Job> mJobs;
+  std::mutex mMutex;
+  std::condition_variable mCond;
+  std::uint64_t mNextTicket = 0;
+  std::uint64_t mTurn = 0;
+  int mInflight = 0;
+  bool mStopping = false;
+};
+
+}  // namespace common
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_COMMON_INFLIGHT_QUEUE_H_
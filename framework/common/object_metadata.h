@@ -54,6 +54,9 @@ typedef struct bmTensors_ {
   bm_handle_t handle;
   // cpu data is used to sync dev mem and host mem
   std::vector<float*> cpu_data;
+  // 非空时各tensor是batch中第batchIndex个槽位的显存视图，显存归batch所有
+  std::shared_ptr<bmTensors_> batch;
+  int batchIndex = -1;
 } bmTensors;
 
 typedef struct bmSubTensors_ {
@@ -127,6 +130,9 @@ struct ObjectMetadata {
   float fps;
   int numBranches;
   int mSubId;
+  // distributor裁剪出的子图在原图中的左上角，未裁剪时为0
+  int mCropX = 0;
+  int mCropY = 0;
   int mGraphId;
   /**
    * @brief
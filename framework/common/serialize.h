@@ -22,6 +22,7 @@
 // #include "face_object_metadata.h"
 #include "frame.h"
 #include "graphics.h"
+#include "logger.h"
 #include "object_metadata.h"
 // #include "posed_object_metadata.h"
 // #include "recognized_object_metadata.h"
@@ -129,13 +130,11 @@ std::string base64_encode(unsigned char const* input, size_t len) {
   return ret;
 }
 
-std::string frame_to_base64(Frame& frame) {
-#if ENABLE_TIME_LOG
-  timeval time1, time2, time3, time4, time5;
-  gettimeofday(&time1, NULL);
-#endif
-  unsigned char* jpegData = nullptr;
-  size_t nBytes = 0;
+/**
+ * @brief 把帧(有osd结果时用osd后的图)编码成JPEG
+ * @return JPEG数据，任何一步失败时打印错误并返回空字符串
+ */
+std::string frame_to_jpeg(Frame& frame) {
   bm_image bgr_;
   if(frame.mSpDataOsd!=nullptr){
     bgr_ = *(frame.mSpDataOsd);
@@ -145,60 +144,81 @@ std::string frame_to_base64(Frame& frame) {
   bm_handle_t handle_ = bm_image_get_handle(&bgr_);
 
   bm_image yuv_;
-
-  bm_image_create(handle_, bgr_.height, bgr_.width, FORMAT_YUV420P,
-                  bgr_.data_type, &yuv_);
-  bm_image_alloc_dev_mem_heap_mask(yuv_, STREAM_VPU_HEAP_MASK);
-#if ENABLE_TIME_LOG
-  gettimeofday(&time2, NULL);
-#endif
+  bm_status_t ret = bm_image_create(handle_, bgr_.height, bgr_.width,
+                                    FORMAT_YUV420P, bgr_.data_type, &yuv_);
+  if (ret != BM_SUCCESS) {
+    IVS_ERROR("bm_image_create failed, ret = {0}", ret);
+    return std::string();
+  }
+  ret = bm_image_alloc_dev_mem_heap_mask(yuv_, STREAM_VPU_HEAP_MASK);
+  if (ret != BM_SUCCESS) {
+    IVS_ERROR("bm_image_alloc_dev_mem_heap_mask failed, ret = {0}", ret);
+    bm_image_destroy(yuv_);
+    return std::string();
+  }
   // bmcv_image_storage_convert(handle_, 1, &bgr_, &yuv_);
   bmcv_rect_t rect_{0, 0, bgr_.width, bgr_.height};
-  bmcv_image_vpp_convert(handle_, 1, bgr_, &yuv_, &rect_);
+  ret = bmcv_image_vpp_convert(handle_, 1, bgr_, &yuv_, &rect_);
+  if (ret != BM_SUCCESS) {
+    IVS_ERROR("bmcv_image_vpp_convert failed, ret = {0}", ret);
+    bm_image_destroy(yuv_);
+    return std::string();
+  }
+  void* jpegData = nullptr;
+  size_t nBytes = 0;
+  ret = bmcv_image_jpeg_enc(handle_, 1, &yuv_, &jpegData, &nBytes);
+  bm_image_destroy(yuv_);
+  if (ret != BM_SUCCESS || jpegData == nullptr) {
+    IVS_ERROR("bmcv_image_jpeg_enc failed, ret = {0}", ret);
+    free(jpegData);
+    return std::string();
+  }
+  std::string jpeg(static_cast<const char*>(jpegData), nBytes);
+  free(jpegData);
+  return jpeg;
+}
+
+std::string frame_to_base64(Frame& frame) {
 #if ENABLE_TIME_LOG
-  gettimeofday(&time3, NULL);
+  timeval time1, time2, time3;
+  gettimeofday(&time1, NULL);
 #endif
-  bmcv_image_jpeg_enc(handle_, 1, &yuv_, (void**)&jpegData, &nBytes);
+  std::string jpeg = frame_to_jpeg(frame);
 #if ENABLE_TIME_LOG
-  gettimeofday(&time4, NULL);
+  gettimeofday(&time2, NULL);
 #endif
-  bm_image_destroy(yuv_);
 
 #if BASE64_CPU
   // for cpu
-  std::string res = base64_encode(jpegData, nBytes);
+  std::string res = base64_encode(
+      reinterpret_cast<const unsigned char*>(jpeg.data()), jpeg.size());
 #else
   // for bmcv
-  unsigned long origin_len[2] = {nBytes, 0};
+  bm_handle_t handle_ = bm_image_get_handle(
+      frame.mSpDataOsd != nullptr ? frame.mSpDataOsd.get()
+                                  : frame.mSpData.get());
+  unsigned long origin_len[2] = {jpeg.size(), 0};
   unsigned long encode_len[2] = {(origin_len[0] + 2) / 3 * 4, 0};
   std::string res(encode_len[0], '\0');
-  bmcv_base64_enc(handle_, bm_mem_from_system(jpegData),
+  bmcv_base64_enc(handle_,
+                  bm_mem_from_system(const_cast<char*>(jpeg.data())),
                   bm_mem_from_system(const_cast<char*>(res.c_str())),
                   origin_len);
 #endif
 
 #if ENABLE_TIME_LOG
-  gettimeofday(&time5, NULL);
+  gettimeofday(&time3, NULL);
   double time_delta1 =
-      1000 * ((time5.tv_sec - time1.tv_sec) +
-              (double)(time5.tv_usec - time1.tv_usec) / 1000000.0);
+      1000 * ((time2.tv_sec - time1.tv_sec) +
+              (double)(time2.tv_usec - time1.tv_usec) / 1000000.0);
   double time_delta2 =
       1000 * ((time3.tv_sec - time2.tv_sec) +
               (double)(time3.tv_usec - time2.tv_usec) / 1000000.0);
-  double time_delta3 =
-      1000 * ((time4.tv_sec - time3.tv_sec) +
-              (double)(time4.tv_usec - time3.tv_usec) / 1000000.0);
-  double time_delta4 =
-      1000 * ((time5.tv_sec - time4.tv_sec) +
-              (double)(time5.tv_usec - time4.tv_usec) / 1000000.0);
-
-  IVS_INFO(
-      "storage convert time = {0}, jpeg_enc time = {1}, base64_enc time = {2}, "
-      "total time = {3}",
-      time_delta2, time_delta3, time_delta4, time_delta1);
+
+  IVS_INFO("jpeg_enc time = {0}, base64_enc time = {1}, total time = {2}",
+           time_delta1, time_delta2, time_delta1 + time_delta2);
 #endif
 
-  delete jpegData;
   return res;
 }
 
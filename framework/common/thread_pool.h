@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_COMMON_THREAD_POOL_H_
+#define SOPHON_STREAM_COMMON_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/no_copyable.h"
+
+namespace sophon_stream {
+namespace common {
+
+/**
+ * @brief 常驻线程池，用于后处理中按通道、按目标切分的数据并行计算
+ * @brief 线程在构造时创建、析构时回收，避免每帧创建和join线程的开销；
+ * parallelFor可以被多个element工作线程同时调用，调用线程自身也参与计算
+ */
+class ThreadPool : public ::sophon_stream::common::NoCopyable {
+ public:
+  /**
+   * @param threadNum 并行度(含调用线程)，小于等于1时parallelFor直接串行执行
+   */
+  explicit ThreadPool(int threadNum) : mThreadNum(threadNum) {
+    for (int i = 1; i < threadNum; ++i)
+      mWorkers.emplace_back(&ThreadPool::workerFunc, this);
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mCond.notify_all();
+    for (auto& worker : mWorkers) worker.join();
+  }
+
+  int getThreadNum() const { return mThreadNum; }
+
+  /**
+   * @brief 对[0, count)中的每个i调用func(i)，全部完成后返回
+   */
+  void parallelFor(int count, const std::function<void(int)>& func) {
+    if (count <= 0) return;
+    if (mWorkers.empty() || count == 1) {
+      for (int i = 0; i < count; ++i) func(i);
+      return;
+    }
+
+    auto job = std::make_shared<Job>(count, func);
+    int helpers = std::min<int>(mWorkers.size(), count - 1);
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (int i = 0; i < helpers; ++i) mJobs.push_back(job);
+    }
+    if (helpers == 1)
+      mCond.notify_one();
+    else
+      mCond.notify_all();
+
+    job->run();
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->cond.wait(lock, [&job] { return job->done == job->count; });
+  }
+
+ private:
+  struct Job {
+    Job(int n, const std::function<void(int)>& f) : count(n), func(f) {}
+
+    // 不断领取下一个下标执行，直到全部领完
+    void run() {
+      int finished = 0;
+      for (int i = next++; i < count; i = next++) {
+        func(i);
+        ++finished;
+      }
+      if (finished == 0) return;
+      std::lock_guard<std::mutex> lock(mutex);
+      done += finished;
+      if (done == count) cond.notify_all();
+    }
+
+    const int count;
+    const std::function<void(int)>& func;
+    std::atomic<int> next{0};
+    int done = 0;
+    std::mutex mutex;
+    std::condition_variable cond;
+  };
+
+  void workerFunc() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCond.wait(lock, [this] { return mStopping || !mJobs.empty(); });
+        if (mStopping) return;
+        job = std::move(mJobs.front());
+        mJobs.pop_front();
+      }
+      job->run();
+    }
+  }
+
+  int mThreadNum;
+  std::vector<std::thread> mWorkers;
+  std::deque<std::shared_ptr<Job>> mJobs;
+  std::mutex mMutex;
+  std::condition_variable mCond;
+  bool mStopping = false;
+};
+
+}  // namespace common
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_COMMON_THREAD_POOL_H_
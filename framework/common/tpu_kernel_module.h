@@ -0,0 +1,122 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_COMMON_TPU_KERNEL_MODULE_H_
+#define SOPHON_STREAM_COMMON_TPU_KERNEL_MODULE_H_
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "common/bmnn_utils.h"
+#include "common/common_defs.h"
+#include "common/no_copyable.h"
+
+namespace sophon_stream {
+namespace common {
+
+/**
+ * @brief 进程内共享的tpu_kernel模块缓存
+ * @brief 每个设备上每个模块文件只加载一次，每个kernel函数id只查找一次；
+ * 使用tpu_kernel后处理的element都从这里取函数id，不再各自加载模块
+ * @brief 模块文件按搜索目录依次查找：element配置的目录、addSearchPath添加的目录、
+ * 默认目录../../3rdparty/tpu_kernel_module
+ */
+class TpuKernelModuleCache : public ::sophon_stream::common::NoCopyable {
+ public:
+  static constexpr const char* kDefaultModuleName =
+      "libbm1684x_kernel_module.so";
+
+  static TpuKernelModuleCache& getInstance() {
+    static TpuKernelModuleCache cache;
+    return cache;
+  }
+
+  /**
+   * @brief 添加搜索目录，后添加的目录优先
+   */
+  void addSearchPath(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mSearchPaths.insert(mSearchPaths.begin(), dir);
+  }
+
+  /**
+   * @brief 取kernel函数id，模块在handle所在设备上第一次使用时加载
+   * @param handle 共享的设备句柄，缓存持有它，保证模块所在句柄一直有效
+   * @param searchPath 非空时先在该目录下查找模块文件
+   */
+  tpu_kernel_function_t getFunction(
+      BMNNHandlePtr handle, const std::string& function,
+      const std::string& searchPath = "",
+      const std::string& moduleName = kDefaultModuleName) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::string moduleFile = findModule(moduleName, searchPath);
+    auto functionKey = std::make_tuple(handle->dev_id(), moduleFile, function);
+    auto functionIt = mFunctions.find(functionKey);
+    if (functionIt != mFunctions.end()) return functionIt->second;
+
+    auto moduleKey = std::make_pair(handle->dev_id(), moduleFile);
+    auto moduleIt = mModules.find(moduleKey);
+    if (moduleIt == mModules.end()) {
+      tpu_kernel_module_t module =
+          tpu_kernel_load_module_file(handle->handle(), moduleFile.c_str());
+      STREAM_CHECK(module != nullptr, "load tpu_kernel module failed: ",
+                   moduleFile);
+      moduleIt = mModules.emplace(moduleKey, Module{handle, module}).first;
+      std::cout << "Load tpu_kernel module " << moduleFile << " on device "
+                << handle->dev_id() << std::endl;
+    }
+
+    tpu_kernel_function_t func_id = tpu_kernel_get_function(
+        moduleIt->second.handle->handle(), moduleIt->second.module,
+        function.c_str());
+    mFunctions.emplace(functionKey, func_id);
+    return func_id;
+  }
+
+ private:
+  TpuKernelModuleCache() = default;
+
+  struct Module {
+    BMNNHandlePtr handle;
+    tpu_kernel_module_t module;
+  };
+
+  std::string findModule(const std::string& moduleName,
+                         const std::string& searchPath) {
+    std::vector<std::string> dirs;
+    if (!searchPath.empty()) dirs.push_back(searchPath);
+    dirs.insert(dirs.end(), mSearchPaths.begin(), mSearchPaths.end());
+    for (auto& dir : dirs) {
+      std::string path = dir.back() == '/' ? dir + moduleName
+                                           : dir + "/" + moduleName;
+      if (std::ifstream(path).good()) return path;
+    }
+    std::string tried;
+    for (auto& dir : dirs) tried += dir + " ";
+    STREAM_CHECK(false, moduleName,
+                 " does not exist, please check your path: ", tried);
+    return "";
+  }
+
+  std::mutex mMutex;
+  std::vector<std::string> mSearchPaths{"../../3rdparty/tpu_kernel_module"};
+  std::map<std::pair<int, std::string>, Module> mModules;
+  std::map<std::tuple<int, std::string, std::string>, tpu_kernel_function_t>
+      mFunctions;
+};
+
+}  // namespace common
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_COMMON_TPU_KERNEL_MODULE_H_
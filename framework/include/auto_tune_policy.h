@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_FRAMEWORK_AUTO_TUNE_POLICY_H_
+#define SOPHON_STREAM_FRAMEWORK_AUTO_TUNE_POLICY_H_
+
+#include <cstdint>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace sophon_stream {
+namespace framework {
+
+struct AutoTuneOptions {
+  int trialSeconds = 20;         // 每组配置的运行时长
+  int warmUpSeconds = 3;         // 每组配置开始统计之前丢弃的时长
+  int maxTrials = 12;            // 包括初始配置在内最多运行的配置数
+  int maxThreadNumber = 8;       // 单个element或group阶段的线程数上限
+  int maxQueueCapacity = 80;     // 单个dataPipe的队列长度上限
+  int sampleIntervalMs = 100;    // 采样队列占用的间隔
+  double minGain = 0.03;         // 接受新配置需要的最小改进比例
+  std::set<int> frozenElements;  // 不参与调优的element id
+};
+
+struct AutoTuneTrial {
+  int index = 0;
+  std::string change;  // 相对上一组被接受的配置做的修改
+  nlohmann::json graph;
+  bool accepted = false;
+  std::uint64_t frames = 0;
+  double fps = 0.;
+  double p50Ms = 0.;
+  double p99Ms = 0.;
+  std::map<int, double> queueFill;  // elementId -> 输入队列平均占用率
+};
+
+struct AutoTuneCandidate {
+  std::string change;
+  nlohmann::json graph;
+};
+
+/**
+ * @brief 自动调优中只依赖graph json和统计结果的部分，不运行graph
+ */
+namespace auto_tune {
+
+/**
+ * @brief 在graph json中找到elementId对应的配置：普通element返回它在elements中
+ * 的下标，stage为空；group的inner element返回group的下标和所在阶段
+ * (pre/infer/post)；找不到返回-1
+ */
+int findElement(const nlohmann::json& graph, int elementId,
+                std::string& stage);
+
+/**
+ * @brief group配置中configure.<field>.<stage>的值，没有或不是整数时返回
+ * defaultValue
+ */
+int getStageValue(const nlohmann::json& element, const std::string& stage,
+                  const char* field, int defaultValue);
+
+int getThreadNumber(const nlohmann::json& element, const std::string& stage);
+
+void setThreadNumber(nlohmann::json& element, const std::string& stage,
+                     int threadNumber);
+
+/**
+ * @brief 没有配置或不大于0时返回DataPipe的默认队列长度
+ */
+int getQueueCapacity(const nlohmann::json& element, const std::string& stage);
+
+void setQueueCapacity(nlohmann::json& element, const std::string& stage,
+                      int capacity);
+
+/**
+ * @brief 第ratio分位的值(向下取到样本)，会重排values；没有样本时返回0
+ */
+double percentile(std::vector<double>& values, double ratio);
+
+/**
+ * @brief 按best的队列占用找瓶颈，生成下一轮要试的配置，按优先级排列
+ */
+std::vector<AutoTuneCandidate> propose(const AutoTuneOptions& options,
+                                       const AutoTuneTrial& best);
+
+/**
+ * @brief trial是否优于best：吞吐提升超过minGain，或吞吐持平而p99下降超过minGain
+ */
+bool better(const AutoTuneOptions& options, const AutoTuneTrial& trial,
+            const AutoTuneTrial& best);
+
+}  // namespace auto_tune
+
+}  // namespace framework
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_FRAMEWORK_AUTO_TUNE_POLICY_H_
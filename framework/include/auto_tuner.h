@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_FRAMEWORK_AUTO_TUNER_H_
+#define SOPHON_STREAM_FRAMEWORK_AUTO_TUNER_H_
+
+#include <functional>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <utility>
+#include <vector>
+
+#include "auto_tune_policy.h"
+#include "common/error_code.h"
+#include "common/no_copyable.h"
+#include "graph.h"
+
+namespace sophon_stream {
+namespace framework {
+
+/**
+ * @brief graph线程数、队列长度、凑batch超时的自动调优
+ * @brief 用同一份输入反复运行graph，每组配置运行固定时长，统计sink处的吞吐、
+ * 端到端时延(p50/p99)以及每个element输入队列的平均占用率；
+ * 占用率最高的element视为瓶颈，依次尝试给它加线程、加长队列、调整
+ * batch_timeout_ms，吞吐提升超过minGain(或吞吐持平而p99下降超过minGain)
+ * 就接受，直到没有改进或用完试验次数
+ * @brief 可调的配置项：
+ * 普通element的thread_number、queue_capacity、configure.batch_timeout_ms；
+ * group的configure.stage_thread_number、configure.stage_queue_capacity
+ * 中对应阶段的值以及configure.batch_timeout_ms
+ * @brief 每组配置使用一个新的Graph，试验结束后stop并释放；找瓶颈、生成候选
+ * 配置和比较结果的逻辑在auto_tune_policy.h中
+ */
+class AutoTuner : public ::sophon_stream::common::NoCopyable {
+ public:
+  using Options = AutoTuneOptions;
+  using Trial = AutoTuneTrial;
+
+  /**
+   * @brief graph启动后调用，负责向graph推入输入(一般是decode的启动任务)；
+   * 输入需要足够运行trialSeconds，例如把loop_num设大
+   */
+  using InputHandler = std::function<void(Graph&)>;
+
+  AutoTuner(const Options& options, ListenThread* listener);
+
+  /**
+   * @brief 统计吞吐和时延的sink，对应graph中is_sink的element与端口；
+   * sink是group时填它的post element id
+   */
+  void addSink(int elementId, int outputPort);
+
+  void setInputHandler(InputHandler handler);
+
+  /**
+   * @brief 从graph json(与Engine::addGraph的格式相同)开始调优
+   */
+  common::ErrorCode tune(const nlohmann::json& graph);
+
+  /**
+   * @brief 调优得到的graph json，可直接传给Engine::addGraph
+   */
+  const nlohmann::json& getBestGraph() const;
+
+  /**
+   * @brief 每组配置的修改内容、吞吐、时延和队列占用
+   */
+  nlohmann::json getReport() const;
+
+  const std::vector<Trial>& getTrials() const { return mTrials; }
+
+ private:
+  common::ErrorCode runTrial(Trial& trial);
+
+  Options mOptions;
+  ListenThread* mListener;
+  InputHandler mInputHandler;
+  std::vector<std::pair<int, int> > mSinks;
+
+  std::vector<Trial> mTrials;
+  int mBestIndex = -1;
+};
+
+}  // namespace framework
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_FRAMEWORK_AUTO_TUNER_H_
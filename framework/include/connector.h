@@ -10,6 +10,10 @@
 #ifndef SOPHON_STREAM_FRAMEWORK_CONNECTOR_H_
 #define SOPHON_STREAM_FRAMEWORK_CONNECTOR_H_
 
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include "common/no_copyable.h"
 #include "datapipe.h"
 
@@ -18,7 +22,11 @@ namespace framework {
 
 class Connector : public ::sophon_stream::common::NoCopyable {
  public:
-  Connector(int dataPipeCount);
+  /**
+   * @param dataPipeCount dataPipe的数量，即下游element的线程数
+   * @param dataPipeCapacity 每个dataPipe的队列长度，不大于0时使用默认值
+   */
+  Connector(int dataPipeCount, int dataPipeCapacity = 0);
 
   std::shared_ptr<void> popData(int id);
   common::ErrorCode pushData(int id, std::shared_ptr<void> data);
@@ -30,10 +38,29 @@ class Connector : public ::sophon_stream::common::NoCopyable {
 
   std::shared_ptr<DataPipe> getDataPipe(int id) const;
 
+  /**
+   * @brief 设置是否按负载给通道分配dataPipe
+   * @brief 默认按channel_id % capacity分配，与下游按同一规则认领通道的element
+   * (如converger)保持一致；开启后每个通道第一次出现时分到当前通道数最少的
+   * dataPipe，之后一直使用该dataPipe以保证通道内有序，EOS之后释放。
+   * 用于group内部前后阶段线程数不同的连接，避免通道号分布不均时个别线程过载
+   */
+  void setBalanced(bool balanced);
+
+  /**
+   * @brief 取通道应当推入的dataPipe
+   * @param endOfStream 为true时，返回分配结果后释放该通道
+   */
+  int getDataPipeId(int channelId, bool endOfStream = false);
 
  private:
   std::vector<std::shared_ptr<DataPipe>> mDataPipes;
   int mCapacity = 0;
+
+  bool mBalanced = false;
+  std::mutex mRouteMutex;
+  std::map<int, int> mRoutes;        // channelId到dataPipe id的映射
+  std::vector<int> mChannelCounts;  // 每个dataPipe上的通道数
 };
 
 }  // namespace framework
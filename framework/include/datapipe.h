@@ -31,6 +31,11 @@ class DataPipe : public ::sophon_stream::common::NoCopyable {
 
   DataPipe();
 
+  /**
+   * @param capacity 队列最多缓存的数据个数
+   */
+  explicit DataPipe(std::size_t capacity);
+
   ~DataPipe();
 
   /**
@@ -51,6 +56,11 @@ class DataPipe : public ::sophon_stream::common::NoCopyable {
    */
   int getSize();
 
+  /**
+   * @brief 获取队列最多缓存的数据个数
+   */
+  std::size_t getCapacity() const { return mCapacity; }
+
  private:
   std::deque<std::shared_ptr<void> > mDataQueue;
   mutable std::mutex mDataQueueMutex;
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_FRAMEWORK_DEVICE_BALANCER_H_
+#define SOPHON_STREAM_FRAMEWORK_DEVICE_BALANCER_H_
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "common/no_copyable.h"
+#include "common/singleton.h"
+
+namespace sophon_stream {
+namespace framework {
+
+/**
+ * @brief 多设备之间按负载分配通道
+ * @brief decode element配置了多个设备时，每路新通道从这里选择解码设备，
+ * 该通道之后的帧都留在这个设备上处理，不在设备之间搬运；
+ * 算法element按设备上报每帧推理耗时，设备的负载估计为
+ * (通道数 + 1) * 每帧耗时，新通道分给负载最小的设备
+ * @brief 线程安全，进程内所有graph共用一个实例
+ */
+class DeviceBalancer : public ::sophon_stream::common::NoCopyable {
+ public:
+  DeviceBalancer() = default;
+
+  /**
+   * @brief 从devices中选出负载最小的设备，并把它的通道数加一
+   */
+  int acquire(const std::vector<int>& devices);
+
+  /**
+   * @brief 通道结束时调用，与acquire成对使用
+   */
+  void release(int device);
+
+  /**
+   * @brief 上报device上处理frames帧用去的毫秒数，按指数滑动平均更新每帧耗时
+   */
+  void reportLatency(int device, double ms, int frames);
+
+  int getChannels(int device);
+
+  /**
+   * @brief 每帧耗时，尚未上报过的设备返回已上报设备的平均值，都没有上报时返回1
+   */
+  double getLatency(int device);
+
+ private:
+  struct DeviceLoad {
+    int channels = 0;
+    double latencyMs = 0.;
+    bool measured = false;
+  };
+
+  double getLatencyLocked(int device);
+
+  // 新的耗时样本在滑动平均中的权重
+  static constexpr double kLatencyAlpha = 0.1;
+
+  std::mutex mMutex;
+  std::map<int, DeviceLoad> mLoads;
+};
+
+using SingletonDeviceBalancer = common::Singleton<DeviceBalancer>;
+
+}  // namespace framework
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_FRAMEWORK_DEVICE_BALANCER_H_
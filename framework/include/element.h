@@ -32,6 +32,7 @@
 #include "common/no_copyable.h"
 #include "connector.h"
 #include "datapipe.h"
+#include "input_synchronizer.h"
 #include "listen_thread.h"
 
 namespace sophon_stream {
@@ -118,6 +119,14 @@ class Element : public ::sophon_stream::common::NoCopyable {
 
   virtual bool getGroup() { return false; }
 
+  /**
+   * @brief 能否处理解码在不同设备上的帧
+   * @brief 只通过mFrame->mHandle访问帧的element默认支持；
+   * 加载了模型、编码器或设备内存等绑定单个设备资源的element需重写并返回false，
+   * decode配置了多个device_ids时，其下游出现这类element则graph初始化失败
+   */
+  virtual bool getMultiDevice() { return true; }
+
   /**
    * @brief 仅group element重写，用于向graph的elementMap注册内部各个element
    * @param mapPtr graph的elementMap
@@ -134,6 +143,13 @@ class Element : public ::sophon_stream::common::NoCopyable {
 
   int getDeviceId() const { return mDeviceId; }
 
+  /**
+   * @brief 配置了device_ids时返回该列表，否则只包含device_id
+   */
+  std::vector<int> getDeviceIds() const {
+    return mDeviceIds.empty() ? std::vector<int>{mDeviceId} : mDeviceIds;
+  }
+
   int getThreadNumber() const { return mThreadNumber; }
 
   ThreadStatus getThreadStatus() const { return mThreadStatus; }
@@ -151,14 +167,33 @@ class Element : public ::sophon_stream::common::NoCopyable {
   inline void setSide(const std::string side) { mSide = side; }
   inline void setSinkFlag(const bool flag) { mSinkElementFlag = flag; }
   inline void setDeviceId(const int id) { mDeviceId = id; }
+  inline void setDeviceIds(const std::vector<int>& ids) { mDeviceIds = ids; }
   inline void setThreadNumber(const int num) { mThreadNumber = num; }
 
+  /**
+   * @brief 设置输入connector中每个dataPipe的队列长度，需在connect之前设置；
+   * 不大于0时使用默认值
+   */
+  inline void setInputQueueCapacity(const int capacity) {
+    mInputQueueCapacity = capacity;
+  }
+  int getInputQueueCapacity() const { return mInputQueueCapacity; }
+
+  /**
+   * @brief 所有输入dataPipe中当前缓存的数据总数与队列总长度，
+   * 缓存长期接近队列总长度说明该element跟不上上游
+   * @brief 统计start时记录的输入connector，可在element运行时从其它线程调用
+   */
+  std::pair<int, int> getInputQueueUsage();
+
   virtual void registListenFunc(ListenThread* listener) {}
 
   static constexpr const char* JSON_ID_FIELD = "id";
   static constexpr const char* JSON_SIDE_FIELD = "side";
   static constexpr const char* JSON_DEVICE_ID_FIELD = "device_id";
+  static constexpr const char* JSON_DEVICE_IDS_FIELD = "device_ids";
   static constexpr const char* JSON_THREAD_NUMBER_FIELD = "thread_number";
+  static constexpr const char* JSON_QUEUE_CAPACITY_FIELD = "queue_capacity";
   static constexpr const char* JSON_CONFIGURE_FIELD = "configure";
   static constexpr const char* JSON_IS_SINK_FILED = "is_sink";
   static constexpr const char* JSON_INNER_ELEMENTS_ID = "inner_elements_id";
@@ -221,6 +256,21 @@ class Element : public ::sophon_stream::common::NoCopyable {
    */
   int getInputConnectorCapacity(int inputPort);
 
+  /**
+   * @brief 取某个通道的数据在outputPort上应当推入的dataPipe，
+   * 分配规则见Connector::getDataPipeId
+   */
+  int getOutputDataPipeId(int outputPort, int channelId,
+                          bool endOfStream = false);
+
+  /**
+   * @brief 依次从各输入端口取数据交给synchronizer，直到对齐出一组，
+   * 按输入端口顺序填入inputs；供blend、stitch、dpu等多输入element使用
+   * @return 取到一组时返回true；线程已停止且没有数据时返回false
+   */
+  bool popSynchronizedInputs(int dataPipeId, InputSynchronizer& synchronizer,
+                             common::ObjectMetadatas& inputs);
+
  private:
   int mId;
 
@@ -230,8 +280,16 @@ class Element : public ::sophon_stream::common::NoCopyable {
 
   int mDeviceId;
 
+  /**
+   * @brief 可用设备列表，decode按负载把通道分到其中的设备上，
+   * 算法element在每个设备上加载模型，按帧所在设备处理
+   */
+  std::vector<int> mDeviceIds;
+
   int mThreadNumber;
 
+  int mInputQueueCapacity = 0;
+
   std::vector<std::shared_ptr<std::thread>> mThreads;
 
   std::atomic<ThreadStatus> mThreadStatus;
@@ -241,6 +299,12 @@ class Element : public ::sophon_stream::common::NoCopyable {
    * @brief inputConnector的生命周期由当前element管理
    */
   std::map<int, std::shared_ptr<framework::Connector>> mInputConnectorMap;
+  /**
+   * @brief start时拷贝的输入connector，只在start中写入
+   * @brief 工作线程会按端口懒创建connector并写mInputConnectorMap，
+   * getInputQueueUsage只读这份拷贝，不与之竞争
+   */
+  std::vector<std::shared_ptr<framework::Connector>> mInputConnectorSnapshot;
   /**
    * @brief outputPort到outputConnector的映射
    * @brief outputConnector的生命周期由下一个element管理
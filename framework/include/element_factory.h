@@ -38,6 +38,13 @@ class ElementFactory : public ::sophon_stream::common::NoCopyable {
   common::ErrorCode addElementMaker(const std::string& elementName,
                                     ElementMaker elementMaker);
 
+  /**
+   * @brief 删除名为elementName的ElementMaker
+   * @brief element所在的动态库卸载时调用，ElementMaker的代码在该库中，
+   * 不能留到库卸载之后再析构
+   */
+  void removeElementMaker(const std::string& elementName);
+
   /**
    * @brief 根据elementName查找并调用对应的ElementMaker，生产element
    * @param elementName element名，需要和注册的名称一致
@@ -68,6 +75,10 @@ using SingletonElementFactory = common::Singleton<ElementFactory>;
       elementFactory.addElementMaker(                                         \
           elementName, []() { return std::make_shared<ElementClass>(); });    \
     }                                                                         \
+    ~ElementClass##Register() {                                               \
+      ::sophon_stream::framework::SingletonElementFactory::getInstance()      \
+          .removeElementMaker(elementName);                                   \
+    }                                                                         \
   };                                                                          \
   static ElementClass##Register g##ElementClass##Register;
 
@@ -80,6 +91,10 @@ using SingletonElementFactory = common::Singleton<ElementFactory>;
       elementFactory.addElementMaker(                                         \
           elementName, []() { return std::make_shared<GroupElement>(); });    \
     }                                                                         \
+    ~Group##ElementClass##Register() {                                        \
+      ::sophon_stream::framework::SingletonElementFactory::getInstance()      \
+          .removeElementMaker(elementName);                                   \
+    }                                                                         \
   };                                                                          \
   static Group##ElementClass##Register g##Group##ElementClass##Register;
 
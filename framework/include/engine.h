@@ -45,6 +45,11 @@ class Engine : public ::sophon_stream::common::NoCopyable {
 
   bool graphExist(int graphId);
 
+  /**
+   * @brief graph已启动且预热完成时返回true
+   */
+  bool graphReady(int graphId);
+
   /**
    * @brief 向指定graph的指定element推入数据，用于向decode
    * element发送启动任务的信号
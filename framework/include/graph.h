@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/error_code.h"
 #include "common/logger.h"
@@ -64,8 +65,24 @@ class Graph : public ::sophon_stream::common::NoCopyable {
 
   std::pair<std::string, int> getSideAndDeviceId(int elementId);
 
+  /**
+   * @brief 各element输入队列的占用情况，elementId -> {缓存数据数, 队列总长度}
+   * @brief group与其pre element共用输入队列，只按inner element统计
+   */
+  std::map<int, std::pair<int, int> > getInputQueueUsage();
+
   int getId() const;
 
+  /**
+   * @brief start完成(配置了warm_up时包括预热)后为true，stop后为false
+   */
+  bool isReady() const { return mReady; }
+
+  /**
+   * @brief 最近一次start的预热耗时，单位ms；未配置warm_up时为0
+   */
+  double getWarmUpTime() const { return mWarmUpMs; }
+
   inline ListenThread* getListener() { return listenThreadPtr; }
 
   inline void setListener(ListenThread* p) { listenThreadPtr = p; }
@@ -73,6 +90,7 @@ class Graph : public ::sophon_stream::common::NoCopyable {
   static constexpr const char* JSON_GRAPH_ID_FIELD = "graph_id";
   static constexpr const char* JSON_WORKERS_FIELD = "elements";
   static constexpr const char* JSON_CONNECTIONS_FIELD = "connections";
+  static constexpr const char* JSON_WARM_UP_FIELD = "warm_up";
   static constexpr const char* JSON_MODEL_SHARED_OBJECT_FIELD = "shared_object";
   static constexpr const char* JSON_WORKER_NAME_FIELD = "name";
   static constexpr const char* JSON_CONNECTION_SRC_ID_FIELD = "src_id";
@@ -84,15 +102,25 @@ class Graph : public ::sophon_stream::common::NoCopyable {
   common::ErrorCode initElements(const std::string& json);
   common::ErrorCode initConnections(const std::string& json);
   common::ErrorCode connect(int srcId, int srcPort, int dstId, int dstPort);
+  /**
+   * @brief 配置了多个device_ids的element，其下游不能有绑定单个设备的element
+   */
+  common::ErrorCode checkMultiDevice();
 
   int mId;
 
   std::atomic<ThreadStatus> mThreadStatus;
 
+  // start时先预热所有已加载的模型，再启动element线程
+  bool mWarmUp = false;
+  std::atomic<bool> mReady{false};
+  std::atomic<double> mWarmUpMs{0.};
+
   std::vector<std::shared_ptr<void> > mSharedObjectHandles;
 
   std::map<int /* elementId */, std::shared_ptr<framework::Element> >
       mElementMap;
+  std::map<int /* srcId */, std::vector<int> /* dstIds */> mDownstream;
 
   // friend class ListenThread;
   ListenThread* listenThreadPtr;
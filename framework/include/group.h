@@ -13,6 +13,7 @@
 #include <chrono>
 #include <memory>
 
+#include "common/common_defs.h"
 #include "element_factory.h"
 
 namespace sophon_stream {
@@ -65,6 +66,10 @@ class Group : public ::sophon_stream::framework::Element {
 
   bool getGroup() override { return true; }
 
+  bool getMultiDevice() override {
+    return preElement && preElement->getMultiDevice();
+  }
+
   void groupInsert(
       std::map<int, std::shared_ptr<framework::Element>>& mapPtr) override {
     auto preElement = this->getPreElement();
@@ -132,6 +137,10 @@ class Group : public ::sophon_stream::framework::Element {
   static constexpr const char* CONFIG_INTERNAL_ELEMENT_NAME_FIELD =
       "element_name";
   static constexpr const char* JSON_INNER_ELEMENTS_ID = "inner_elements_id";
+  static constexpr const char* CONFIG_INTERNAL_STAGE_THREAD_NUMBER_FIELD =
+      "stage_thread_number";
+  static constexpr const char* CONFIG_INTERNAL_STAGE_QUEUE_CAPACITY_FIELD =
+      "stage_queue_capacity";
 
  private:
   std::vector<int> inner_elements_id;
@@ -163,10 +172,39 @@ class Group : public ::sophon_stream::framework::Element {
     inferElement->setDeviceId(dev_id);
     postElement->setDeviceId(dev_id);
 
+    std::vector<int> dev_ids = this->getDeviceIds();
+    preElement->setDeviceIds(dev_ids);
+    inferElement->setDeviceIds(dev_ids);
+    postElement->setDeviceIds(dev_ids);
+
+    // 各阶段的线程数和输入队列长度，未配置的阶段沿用group的thread_number
+    // 和默认队列长度
+    auto configure = nlohmann::json::parse(json, nullptr, false);
     int threadNum = this->getThreadNumber();
-    preElement->setThreadNumber(threadNum);
-    inferElement->setThreadNumber(threadNum);
-    postElement->setThreadNumber(threadNum);
+    int preThreads =
+        getStageValue(configure, CONFIG_INTERNAL_STAGE_THREAD_NUMBER_FIELD,
+                      "pre", threadNum);
+    int inferThreads =
+        getStageValue(configure, CONFIG_INTERNAL_STAGE_THREAD_NUMBER_FIELD,
+                      "infer", threadNum);
+    int postThreads =
+        getStageValue(configure, CONFIG_INTERNAL_STAGE_THREAD_NUMBER_FIELD,
+                      "post", threadNum);
+    preElement->setThreadNumber(preThreads);
+    inferElement->setThreadNumber(inferThreads);
+    postElement->setThreadNumber(postThreads);
+    // group的输入connector就是pre的输入，dataPipe数必须与pre的线程数一致
+    this->setThreadNumber(preThreads);
+
+    this->setInputQueueCapacity(
+        getStageValue(configure, CONFIG_INTERNAL_STAGE_QUEUE_CAPACITY_FIELD,
+                      "pre", 0));
+    inferElement->setInputQueueCapacity(
+        getStageValue(configure, CONFIG_INTERNAL_STAGE_QUEUE_CAPACITY_FIELD,
+                      "infer", 0));
+    postElement->setInputQueueCapacity(
+        getStageValue(configure, CONFIG_INTERNAL_STAGE_QUEUE_CAPACITY_FIELD,
+                      "post", 0));
 
     preElement->initInternal(json);
     preElement->setStage(true, false, false);
@@ -193,9 +231,38 @@ class Group : public ::sophon_stream::framework::Element {
 
     connect(*preElement, 0, *inferElement, 0);
     connect(*inferElement, 0, *postElement, 0);
+    // 内部连接两端线程数可能不同，按负载分配通道
+    inferElement->getInputConnector(0).lock()->setBalanced(true);
+    postElement->getInputConnector(0).lock()->setBalanced(true);
+
+    IVS_INFO(
+        "Group {0} threads, pre: {1:d}, infer: {2:d}, post: {3:d}, element "
+        "id: {4:d}",
+        elementName, preThreads, inferThreads, postThreads, this->getId());
 
     return common::ErrorCode::SUCCESS;
   }
+
+  /**
+   * @brief 读取configure[field][stage]，未配置时返回defaultValue
+   */
+  static int getStageValue(const nlohmann::json& configure,
+                           const std::string& field, const std::string& stage,
+                           int defaultValue) {
+    if (!configure.is_object()) return defaultValue;
+    auto fieldIt = configure.find(field);
+    if (fieldIt == configure.end()) return defaultValue;
+    STREAM_CHECK(fieldIt->is_object(), field,
+                 " must be a map like {\"pre\": 1, \"infer\": 1, "
+                 "\"post\": 1}, please check your group config file!");
+    auto stageIt = fieldIt->find(stage);
+    if (stageIt == fieldIt->end()) return defaultValue;
+    STREAM_CHECK(stageIt->is_number_integer() && stageIt->get<int>() > 0,
+                 field, ".", stage,
+                 " must be a positive integer, please check your group "
+                 "config file!");
+    return stageIt->get<int>();
+  }
 };
 
 }  // namespace framework
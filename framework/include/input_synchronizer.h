@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_FRAMEWORK_INPUT_SYNCHRONIZER_H_
+#define SOPHON_STREAM_FRAMEWORK_INPUT_SYNCHRONIZER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace framework {
+
+/**
+ * @brief 多输入对齐参数
+ */
+struct SyncOptions {
+  /**
+   * @brief 对齐依据：帧号或Frame::mTimestamp
+   */
+  enum class Key { FRAME_ID, TIMESTAMP };
+  /**
+   * @brief 某个输入缺帧时的处理：丢弃其它输入的对应帧，或重复该输入上一次的帧
+   */
+  enum class MissingPolicy { DROP, REPEAT };
+
+  Key key = Key::FRAME_ID;
+  MissingPolicy policy = MissingPolicy::DROP;
+  // 容忍的偏差，FRAME_ID为帧数，TIMESTAMP为毫秒
+  std::int64_t tolerance = 0;
+  // 单个输入积压超过该帧数而其它输入仍为空时，认为其它输入丢了这一帧
+  int queueSize = 8;
+
+  static constexpr const char* CONFIG_SYNC_KEY_FIELD = "sync_key";
+  static constexpr const char* CONFIG_SYNC_POLICY_FIELD = "sync_policy";
+  static constexpr const char* CONFIG_SYNC_TOLERANCE_FIELD = "sync_tolerance";
+  static constexpr const char* CONFIG_SYNC_QUEUE_SIZE_FIELD =
+      "sync_queue_size";
+
+  /**
+   * @brief 从element的configure中解析上面四个可选字段，缺省时保持默认值
+   */
+  static SyncOptions fromJson(const nlohmann::json& configure);
+};
+
+/**
+ * @brief 将多个输入端口的数据按帧号或时间戳对齐后成组输出
+ * @brief 每个端口一个缓冲队列，所有队首落在容忍范围内时输出一组；
+ * 某个端口缺帧(队首落后于其它端口，或长时间没有数据)时按MissingPolicy处理：
+ * DROP丢弃其它端口的对应帧，REPEAT用缺帧端口上一次输出的数据补齐；
+ * 单路相机的卡顿不会让后续所有帧错位
+ * @brief 不加锁，每个dataPipe(工作线程)各持有一个实例
+ */
+class InputSynchronizer {
+ public:
+  InputSynchronizer(int inputNum, const SyncOptions& options);
+
+  /**
+   * @brief 将第index个输入端口收到的数据放入缓冲
+   */
+  void push(int index, std::shared_ptr<common::ObjectMetadata> obj);
+
+  /**
+   * @brief 取出一组对齐的数据，按端口顺序填入inputs
+   * @return 没有可以输出的组时返回false
+   */
+  bool pop(common::ObjectMetadatas& inputs);
+
+  /**
+   * @brief 从第index个输入端口取一个数据，没有数据时返回nullptr
+   */
+  using PullFunc =
+      std::function<std::shared_ptr<common::ObjectMetadata>(int index)>;
+
+  /**
+   * @brief 轮询所有输入端口并push，直到可以pop出一组对齐的数据
+   * @brief 一轮下来所有端口都没有数据时检查running，仍在运行则等待后重试
+   * @return 取到一组时返回true；running返回false时返回false
+   */
+  bool poll(const PullFunc& pull, const std::function<bool()>& running,
+            common::ObjectMetadatas& inputs);
+
+  void clear();
+
+  std::uint64_t getDropped() const { return mDropped; }
+  std::uint64_t getRepeated() const { return mRepeated; }
+
+ private:
+  std::int64_t keyOf(const std::shared_ptr<common::ObjectMetadata>& obj) const;
+  void emit(common::ObjectMetadatas& inputs);
+  /**
+   * @brief 取出所有键值不超过limit的队首，其余端口按MissingPolicy处理
+   * @return REPEAT且每个端口都有数据时组成一组填入inputs并返回true，
+   * 否则丢弃取出的帧并返回false
+   */
+  bool takeOldest(std::int64_t limit, common::ObjectMetadatas& inputs);
+
+  SyncOptions mOptions;
+  std::int64_t mTolerance;
+  std::vector<std::deque<std::shared_ptr<common::ObjectMetadata>>> mQueues;
+  // REPEAT策略下每个端口最近一次输出的数据
+  std::vector<std::shared_ptr<common::ObjectMetadata>> mLast;
+  std::uint64_t mDropped = 0;
+  std::uint64_t mRepeated = 0;
+};
+
+}  // namespace framework
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_FRAMEWORK_INPUT_SYNCHRONIZER_H_
@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_FRAMEWORK_KEYPOINT_WINDOW_H_
+#define SOPHON_STREAM_FRAMEWORK_KEYPOINT_WINDOW_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace framework {
+
+/**
+ * @brief 一帧的关键点结果，只保留时序模型需要的数据，不引用解码图像
+ */
+struct KeypointFrame {
+  std::int64_t frameId = -1;
+  int width = 0;
+  int height = 0;
+  // 每人一组，与PosedObjectMetadata中的keypoints和scores一一对应
+  std::vector<std::vector<float>> keypoints;
+  std::vector<std::vector<float>> scores;
+
+  /**
+   * @brief 从ObjectMetadata的mPosedObjectMetadatas中拷贝出关键点
+   */
+  static std::shared_ptr<const KeypointFrame> fromObjectMetadata(
+      const common::ObjectMetadata& obj);
+};
+
+/**
+ * @brief 按时间顺序排列的一段连续帧，相邻clip之间共享重叠部分的KeypointFrame
+ */
+using KeypointClip = std::vector<std::shared_ptr<const KeypointFrame>>;
+
+/**
+ * @brief 按通道维护的关键点滑动窗口
+ * @brief 每个通道一个长度为windowSize的环形缓冲，窗口填满后每stride帧输出一个
+ * clip；缓冲中只有关键点，上游的帧可以直接向下游发送而不必等待整个clip
+ * @brief 不加锁，多个工作线程共用时需要调用方加锁
+ */
+class KeypointWindow {
+ public:
+  KeypointWindow(int windowSize, int stride);
+
+  /**
+   * @brief 记录channelId的一帧
+   * @return 这一帧使窗口满足输出条件时返回true，并将窗口内的帧按时间顺序填入clip
+   */
+  bool push(int channelId, std::shared_ptr<const KeypointFrame> frame,
+            KeypointClip& clip);
+
+  /**
+   * @brief 丢弃channelId已缓存的帧，码流结束或重连时调用
+   */
+  void reset(int channelId);
+
+ private:
+  struct Ring {
+    std::vector<std::shared_ptr<const KeypointFrame>> frames;
+    int head = 0;
+    int count = 0;
+    int sinceEmit = 0;
+    bool emitted = false;
+  };
+
+  int mWindowSize;
+  int mStride;
+  std::unordered_map<int, Ring> mRings;
+};
+
+}  // namespace framework
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_FRAMEWORK_KEYPOINT_WINDOW_H_
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_FRAMEWORK_MICRO_BATCHER_H_
+#define SOPHON_STREAM_FRAMEWORK_MICRO_BATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "common/no_copyable.h"
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace framework {
+
+/**
+ * @brief 跨dataPipe组batch，用于车牌、文字识别这类每帧只有零星几个小图的element
+ * @brief 各工作线程把自己dataPipe里取到的数据按到达顺序放进同一个队列，
+ * 任一线程在凑满maxBatch、遇到EOS或最早的数据等待超过timeoutMs时取走一个batch；
+ * 每个batch带一个递增的序号，结果按序号依次发送，单个通道内的数据不会乱序
+ * @brief 线程安全，一个element的所有工作线程共享一个实例
+ */
+class MicroBatcher : public ::sophon_stream::common::NoCopyable {
+ public:
+  /**
+   * @param statInterval 每取出多少个非空batch让pop提示打印一次占用率，0为不提示
+   */
+  MicroBatcher(int maxBatch, int timeoutMs, int statInterval = 0);
+
+  /**
+   * @brief 放入一个从dataPipe中取到的数据，mFilter或EOS的数据也要放入以保持顺序
+   */
+  void push(std::shared_ptr<common::ObjectMetadata> obj);
+
+  /**
+   * @brief 取出一个batch
+   * @param pending 按到达顺序取出的全部数据，发送时使用
+   * @param objects pending中需要推理的部分，最多maxBatch个
+   * @param ticket 该batch的序号，发送前后分别传给waitTurn和finish
+   * @param logStats 该batch是第statInterval整数倍个非空batch时为true，
+   * 与计数在同一把锁内判断，多个线程中只有一个会得到true
+   * @param flush 为true时不再等待，直接取出已有数据，线程退出时使用
+   * @return 没有可以取出的batch时返回false
+   */
+  bool pop(common::ObjectMetadatas& pending, common::ObjectMetadatas& objects,
+           std::uint64_t& ticket, bool& logStats, bool flush = false);
+
+  /**
+   * @brief 阻塞直到序号更小的batch都已发送完
+   */
+  void waitTurn(std::uint64_t ticket);
+
+  /**
+   * @brief 标记该batch已发送，唤醒等待下一个序号的线程
+   */
+  void finish(std::uint64_t ticket);
+
+  std::size_t size();
+
+  /**
+   * @brief 已取出的非空batch数与其中的目标数，平均占用率为
+   * objects / (batches * maxBatch)
+   */
+  std::uint64_t getBatches();
+  std::uint64_t getObjects();
+  double getOccupancy();
+
+ private:
+  struct Item {
+    std::shared_ptr<common::ObjectMetadata> obj;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+  int mMaxBatch;
+  std::chrono::milliseconds mTimeout;
+  int mStatInterval;
+
+  std::mutex mMutex;
+  std::deque<Item> mQueue;
+  // 队列中需要推理的数据个数和EOS个数
+  int mReady = 0;
+  int mEos = 0;
+  std::uint64_t mNextTicket = 0;
+  std::uint64_t mBatches = 0;
+  std::uint64_t mObjects = 0;
+
+  std::mutex mTurnMutex;
+  std::condition_variable mTurnCond;
+  std::uint64_t mTurn = 0;
+};
+
+}  // namespace framework
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_FRAMEWORK_MICRO_BATCHER_H_
@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "auto_tune_policy.h"
+
+#include <algorithm>
+
+#include "graph.h"
+
+namespace sophon_stream {
+namespace framework {
+namespace auto_tune {
+
+namespace {
+
+// 与Group中的配置项一致
+constexpr const char* kStageThreadNumberField = "stage_thread_number";
+constexpr const char* kStageQueueCapacityField = "stage_queue_capacity";
+constexpr const char* kBatchTimeoutField = "batch_timeout_ms";
+const char* const kStages[] = {"pre", "infer", "post"};
+
+// 与DataPipe的默认队列长度一致
+constexpr int kDefaultQueueCapacity = 20;
+// 输入队列平均占用低于该值的element不视为瓶颈
+constexpr double kMinBottleneckFill = 0.1;
+// 队列平均占用高于该值时尝试加长队列
+constexpr double kFullQueueFill = 0.8;
+// 瓶颈element按占用率排序后，每轮只尝试前几个
+constexpr std::size_t kBottleneckCount = 2;
+constexpr int kMaxBatchTimeoutMs = 100;
+
+std::string describe(int elementId, const std::string& stage) {
+  std::string name = "element " + std::to_string(elementId);
+  if (!stage.empty()) name += " (group stage " + stage + ")";
+  return name;
+}
+
+}  // namespace
+
+int findElement(const nlohmann::json& graph, int elementId,
+                std::string& stage) {
+  const auto& elements = graph[Graph::JSON_WORKERS_FIELD];
+  for (std::size_t i = 0; i < elements.size(); ++i) {
+    const auto& element = elements[i];
+    auto innerIt = element.find(Element::JSON_INNER_ELEMENTS_ID);
+    if (element.end() != innerIt && innerIt->is_array()) {
+      auto inner = innerIt->get<std::vector<int>>();
+      for (std::size_t k = 0; k < inner.size() && k < 3; ++k) {
+        if (inner[k] == elementId) {
+          stage = kStages[k];
+          return i;
+        }
+      }
+      continue;
+    }
+    auto idIt = element.find(Element::JSON_ID_FIELD);
+    if (element.end() != idIt && idIt->get<int>() == elementId) {
+      stage.clear();
+      return i;
+    }
+  }
+  return -1;
+}
+
+int getStageValue(const nlohmann::json& element, const std::string& stage,
+                  const char* field, int defaultValue) {
+  auto configureIt = element.find(Element::JSON_CONFIGURE_FIELD);
+  if (element.end() == configureIt) return defaultValue;
+  auto fieldIt = configureIt->find(field);
+  if (configureIt->end() == fieldIt) return defaultValue;
+  auto stageIt = fieldIt->find(stage);
+  if (fieldIt->end() == stageIt || !stageIt->is_number_integer())
+    return defaultValue;
+  return stageIt->get<int>();
+}
+
+int getThreadNumber(const nlohmann::json& element, const std::string& stage) {
+  int threadNumber = element.value(Element::JSON_THREAD_NUMBER_FIELD, 1);
+  if (stage.empty()) return threadNumber;
+  return getStageValue(element, stage, kStageThreadNumberField, threadNumber);
+}
+
+void setThreadNumber(nlohmann::json& element, const std::string& stage,
+                     int threadNumber) {
+  if (stage.empty())
+    element[Element::JSON_THREAD_NUMBER_FIELD] = threadNumber;
+  else
+    element[Element::JSON_CONFIGURE_FIELD][kStageThreadNumberField][stage] =
+        threadNumber;
+}
+
+int getQueueCapacity(const nlohmann::json& element, const std::string& stage) {
+  if (stage.empty()) {
+    int capacity = element.value(Element::JSON_QUEUE_CAPACITY_FIELD, 0);
+    return capacity > 0 ? capacity : kDefaultQueueCapacity;
+  }
+  int capacity = getStageValue(element, stage, kStageQueueCapacityField, 0);
+  return capacity > 0 ? capacity : kDefaultQueueCapacity;
+}
+
+void setQueueCapacity(nlohmann::json& element, const std::string& stage,
+                      int capacity) {
+  if (stage.empty())
+    element[Element::JSON_QUEUE_CAPACITY_FIELD] = capacity;
+  else
+    element[Element::JSON_CONFIGURE_FIELD][kStageQueueCapacityField][stage] =
+        capacity;
+}
+
+double percentile(std::vector<double>& values, double ratio) {
+  if (values.empty()) return 0.;
+  std::size_t n = static_cast<std::size_t>(ratio * (values.size() - 1));
+  std::nth_element(values.begin(), values.begin() + n, values.end());
+  return values[n];
+}
+
+std::vector<AutoTuneCandidate> propose(const AutoTuneOptions& options,
+                                       const AutoTuneTrial& best) {
+  std::vector<std::pair<double, int>> bottlenecks;
+  for (const auto& fill : best.queueFill) {
+    if (fill.second < kMinBottleneckFill) continue;
+    if (options.frozenElements.count(fill.first)) continue;
+    bottlenecks.push_back({fill.second, fill.first});
+  }
+  std::sort(bottlenecks.rbegin(), bottlenecks.rend());
+  if (bottlenecks.size() > kBottleneckCount)
+    bottlenecks.resize(kBottleneckCount);
+
+  std::vector<AutoTuneCandidate> candidates;
+  for (const auto& bottleneck : bottlenecks) {
+    double fill = bottleneck.first;
+    int elementId = bottleneck.second;
+    std::string stage;
+    int index = findElement(best.graph, elementId, stage);
+    if (index < 0) continue;
+    const auto& element = best.graph[Graph::JSON_WORKERS_FIELD][index];
+    std::string name = describe(elementId, stage);
+
+    // 队列积压说明处理跟不上，先加线程
+    int threadNumber = getThreadNumber(element, stage);
+    if (threadNumber < options.maxThreadNumber) {
+      AutoTuneCandidate candidate{name + " thread_number " +
+                              std::to_string(threadNumber) + " -> " +
+                              std::to_string(threadNumber + 1),
+                          best.graph};
+      setThreadNumber(candidate.graph[Graph::JSON_WORKERS_FIELD][index], stage,
+                      threadNumber + 1);
+      candidates.push_back(candidate);
+    }
+
+    // 队列经常是满的，上游会被阻塞，加长队列吸收突发
+    int capacity = getQueueCapacity(element, stage);
+    if (fill >= kFullQueueFill && capacity < options.maxQueueCapacity) {
+      int newCapacity = std::min(capacity * 2, options.maxQueueCapacity);
+      AutoTuneCandidate candidate{name + " queue_capacity " + std::to_string(capacity) +
+                              " -> " + std::to_string(newCapacity),
+                          best.graph};
+      setQueueCapacity(candidate.graph[Graph::JSON_WORKERS_FIELD][index], stage,
+                       newCapacity);
+      candidates.push_back(candidate);
+    }
+
+    // 跨通道凑batch的element：等得久batch更满，等得短时延更低，两个方向都试
+    auto configureIt = element.find(Element::JSON_CONFIGURE_FIELD);
+    if (element.end() == configureIt) continue;
+    auto timeoutIt = configureIt->find(kBatchTimeoutField);
+    if (configureIt->end() == timeoutIt || !timeoutIt->is_number_integer())
+      continue;
+    int timeout = timeoutIt->get<int>();
+    for (int newTimeout : {std::min(timeout * 2, kMaxBatchTimeoutMs),
+                           std::max(timeout / 2, 1)}) {
+      if (newTimeout == timeout) continue;
+      AutoTuneCandidate candidate{name + " batch_timeout_ms " +
+                              std::to_string(timeout) + " -> " +
+                              std::to_string(newTimeout),
+                          best.graph};
+      candidate.graph[Graph::JSON_WORKERS_FIELD][index]
+                     [Element::JSON_CONFIGURE_FIELD][kBatchTimeoutField] =
+          newTimeout;
+      candidates.push_back(candidate);
+    }
+  }
+  return candidates;
+}
+
+bool better(const AutoTuneOptions& options, const AutoTuneTrial& trial,
+            const AutoTuneTrial& best) {
+  if (trial.fps > best.fps * (1. + options.minGain)) return true;
+  return trial.fps >= best.fps * (1. - options.minGain) &&
+         trial.p99Ms < best.p99Ms * (1. - options.minGain);
+}
+
+}  // namespace auto_tune
+}  // namespace framework
+}  // namespace sophon_stream
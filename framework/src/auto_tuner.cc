@@ -0,0 +1,207 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "auto_tuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include "common/logger.h"
+#include "common/object_metadata.h"
+
+namespace sophon_stream {
+namespace framework {
+
+namespace {
+
+struct SinkStats {
+  std::mutex mutex;
+  bool recording = false;
+  std::uint64_t frames = 0;
+  std::vector<double> latencies;
+};
+
+}  // namespace
+
+AutoTuner::AutoTuner(const Options& options, ListenThread* listener)
+    : mOptions(options), mListener(listener) {}
+
+void AutoTuner::addSink(int elementId, int outputPort) {
+  mSinks.push_back({elementId, outputPort});
+}
+
+void AutoTuner::setInputHandler(InputHandler handler) {
+  mInputHandler = handler;
+}
+
+common::ErrorCode AutoTuner::tune(const nlohmann::json& graph) {
+  mTrials.clear();
+  mBestIndex = -1;
+  if (mListener == nullptr) {
+    IVS_ERROR("Auto tune needs a listener, elements report full queues to it");
+    return common::ErrorCode::UNKNOWN;
+  }
+
+  Trial baseline;
+  baseline.change = "baseline";
+  baseline.graph = graph;
+  common::ErrorCode errorCode = runTrial(baseline);
+  if (common::ErrorCode::SUCCESS != errorCode) {
+    IVS_ERROR("Auto tune baseline trial fail, json: {0}", graph.dump());
+    return errorCode;
+  }
+  baseline.accepted = true;
+  mTrials.push_back(baseline);
+  mBestIndex = 0;
+
+  const auto maxTrials = static_cast<std::size_t>(mOptions.maxTrials);
+  bool improved = true;
+  while (improved && mTrials.size() < maxTrials) {
+    improved = false;
+    for (auto& candidate :
+         auto_tune::propose(mOptions, mTrials[mBestIndex])) {
+      if (mTrials.size() >= maxTrials) break;
+      Trial trial;
+      trial.index = mTrials.size();
+      trial.change = candidate.change;
+      trial.graph = candidate.graph;
+      if (common::ErrorCode::SUCCESS != runTrial(trial)) {
+        IVS_WARN("Auto tune trial {0:d} fail, change: {1}", trial.index,
+                 trial.change);
+      } else {
+        trial.accepted =
+            auto_tune::better(mOptions, trial, mTrials[mBestIndex]);
+      }
+      mTrials.push_back(trial);
+      if (trial.accepted) {
+        mBestIndex = trial.index;
+        improved = true;
+        break;
+      }
+    }
+  }
+
+  const auto& best = mTrials[mBestIndex];
+  IVS_INFO(
+      "Auto tune finish, trials: {0:d}, best trial: {1:d}, fps: {2:.2f} -> "
+      "{3:.2f}, p99: {4:.2f} ms -> {5:.2f} ms",
+      mTrials.size(), mBestIndex, mTrials[0].fps, best.fps, mTrials[0].p99Ms,
+      best.p99Ms);
+  return common::ErrorCode::SUCCESS;
+}
+
+const nlohmann::json& AutoTuner::getBestGraph() const {
+  static const nlohmann::json empty;
+  return mBestIndex < 0 ? empty : mTrials[mBestIndex].graph;
+}
+
+nlohmann::json AutoTuner::getReport() const {
+  nlohmann::json report;
+  report["best_trial"] = mBestIndex;
+  report["trials"] = nlohmann::json::array();
+  for (const auto& trial : mTrials) {
+    nlohmann::json item;
+    item["trial"] = trial.index;
+    item["change"] = trial.change;
+    item["accepted"] = trial.accepted;
+    item["frames"] = trial.frames;
+    item["fps"] = trial.fps;
+    item["p50_ms"] = trial.p50Ms;
+    item["p99_ms"] = trial.p99Ms;
+    for (const auto& fill : trial.queueFill)
+      item["queue_fill"][std::to_string(fill.first)] = fill.second;
+    item["graph"] = trial.graph;
+    report["trials"].push_back(item);
+  }
+  return report;
+}
+
+common::ErrorCode AutoTuner::runTrial(Trial& trial) {
+  IVS_INFO("Auto tune trial {0:d} start, change: {1}", trial.index,
+           trial.change);
+
+  auto graph = std::make_shared<Graph>();
+  graph->setListener(mListener);
+  common::ErrorCode errorCode = graph->init(trial.graph.dump());
+  if (common::ErrorCode::SUCCESS != errorCode) return errorCode;
+
+  auto stats = std::make_shared<SinkStats>();
+  for (auto& sink : mSinks) {
+    graph->setSinkHandler(
+        sink.first, sink.second, [stats](std::shared_ptr<void> data) {
+          auto objectMetadata =
+              std::static_pointer_cast<common::ObjectMetadata>(data);
+          if (objectMetadata == nullptr || !objectMetadata->mFrame ||
+              objectMetadata->mFrame->mEndOfStream || objectMetadata->mFilter)
+            return;
+          double ms = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() -
+                          objectMetadata->mFrame->mCreateTime)
+                          .count();
+          std::lock_guard<std::mutex> lock(stats->mutex);
+          if (!stats->recording) return;
+          ++stats->frames;
+          stats->latencies.push_back(ms);
+        });
+  }
+
+  errorCode = graph->start();
+  if (common::ErrorCode::SUCCESS != errorCode) return errorCode;
+  if (mInputHandler) mInputHandler(*graph);
+
+  std::this_thread::sleep_for(std::chrono::seconds(mOptions.warmUpSeconds));
+  {
+    std::lock_guard<std::mutex> lock(stats->mutex);
+    stats->recording = true;
+  }
+  auto begin = std::chrono::steady_clock::now();
+  auto end = begin + std::chrono::seconds(mOptions.trialSeconds);
+
+  std::map<int, double> fillSum;
+  int samples = 0;
+  while (std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(
+        std::chrono::milliseconds(mOptions.sampleIntervalMs));
+    for (auto& usage : graph->getInputQueueUsage()) {
+      if (usage.second.second <= 0) continue;
+      fillSum[usage.first] +=
+          static_cast<double>(usage.second.first) / usage.second.second;
+    }
+    ++samples;
+  }
+
+  std::vector<double> latencies;
+  {
+    std::lock_guard<std::mutex> lock(stats->mutex);
+    stats->recording = false;
+    trial.frames = stats->frames;
+    latencies.swap(stats->latencies);
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+  graph->stop();
+
+  trial.fps = seconds > 0. ? trial.frames / seconds : 0.;
+  trial.p50Ms = auto_tune::percentile(latencies, 0.5);
+  trial.p99Ms = auto_tune::percentile(latencies, 0.99);
+  for (auto& fill : fillSum)
+    trial.queueFill[fill.first] = samples > 0 ? fill.second / samples : 0.;
+
+  IVS_INFO(
+      "Auto tune trial {0:d} finish, frames: {1:d}, fps: {2:.2f}, p50: "
+      "{3:.2f} ms, p99: {4:.2f} ms",
+      trial.index, trial.frames, trial.fps, trial.p50Ms, trial.p99Ms);
+  return common::ErrorCode::SUCCESS;
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -9,16 +9,19 @@
 
 #include "connector.h"
 
+#include <algorithm>
+
 namespace sophon_stream {
 namespace framework {
 
-Connector::Connector(int dataPipeCount) {
+Connector::Connector(int dataPipeCount, int dataPipeCapacity) {
   mCapacity = dataPipeCount;
   mDataPipes.reserve(mCapacity);
   for (int i = 0; i < mCapacity; ++i) {
-    auto datapipe = std::make_shared<DataPipe>();
+    auto datapipe = std::make_shared<DataPipe>(std::max(dataPipeCapacity, 0));
     mDataPipes.push_back(datapipe);
   }
+  mChannelCounts.assign(mCapacity, 0);
 }
 
 std::shared_ptr<void> Connector::popData(int id) {
@@ -33,6 +36,29 @@ common::ErrorCode Connector::pushData(
 
 int Connector::getCapacity() const { return mCapacity; }
 
+void Connector::setBalanced(bool balanced) { mBalanced = balanced; }
+
+int Connector::getDataPipeId(int channelId, bool endOfStream) {
+  if (!mBalanced) return channelId % mCapacity;
+
+  std::lock_guard<std::mutex> lock(mRouteMutex);
+  int id;
+  auto routeIt = mRoutes.find(channelId);
+  if (routeIt != mRoutes.end()) {
+    id = routeIt->second;
+  } else {
+    id = std::min_element(mChannelCounts.begin(), mChannelCounts.end()) -
+         mChannelCounts.begin();
+    mRoutes[channelId] = id;
+    ++mChannelCounts[id];
+  }
+  if (endOfStream) {
+    mRoutes.erase(channelId);
+    --mChannelCounts[id];
+  }
+  return id;
+}
+
 std::shared_ptr<DataPipe> Connector::getDataPipe(int id) const {
   if (id < 0 || id > mDataPipes.size()) {
     IVS_ERROR("Error DataPipe Id!");
@@ -16,6 +16,9 @@ namespace framework {
 
 DataPipe::DataPipe() : mCapacity(DEFAULT_DATA_PIPE_CAPACITY) {}
 
+DataPipe::DataPipe(std::size_t capacity)
+    : mCapacity(capacity > 0 ? capacity : DEFAULT_DATA_PIPE_CAPACITY) {}
+
 DataPipe::~DataPipe() {}
 
 common::ErrorCode DataPipe::pushData(std::shared_ptr<void> data) {
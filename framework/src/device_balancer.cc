@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "device_balancer.h"
+
+#include "common/logger.h"
+
+namespace sophon_stream {
+namespace framework {
+
+int DeviceBalancer::acquire(const std::vector<int>& devices) {
+  if (devices.empty()) return -1;
+  std::lock_guard<std::mutex> lock(mMutex);
+  int best = devices[0];
+  double bestScore = 0.;
+  for (std::size_t i = 0; i < devices.size(); ++i) {
+    int device = devices[i];
+    double score = (mLoads[device].channels + 1) * getLatencyLocked(device);
+    if (i == 0 || score < bestScore) {
+      best = device;
+      bestScore = score;
+    }
+  }
+  ++mLoads[best].channels;
+  IVS_INFO("Assign channel to device {0}, channels: {1}, latency: {2:.2f} ms",
+           best, mLoads[best].channels, getLatencyLocked(best));
+  return best;
+}
+
+void DeviceBalancer::release(int device) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto it = mLoads.find(device);
+  if (it != mLoads.end() && it->second.channels > 0) --it->second.channels;
+}
+
+void DeviceBalancer::reportLatency(int device, double ms, int frames) {
+  if (frames <= 0) return;
+  double perFrame = ms / frames;
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto& load = mLoads[device];
+  if (!load.measured) {
+    load.latencyMs = perFrame;
+    load.measured = true;
+  } else {
+    load.latencyMs += kLatencyAlpha * (perFrame - load.latencyMs);
+  }
+}
+
+int DeviceBalancer::getChannels(int device) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mLoads[device].channels;
+}
+
+double DeviceBalancer::getLatency(int device) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return getLatencyLocked(device);
+}
+
+double DeviceBalancer::getLatencyLocked(int device) {
+  auto it = mLoads.find(device);
+  if (it != mLoads.end() && it->second.measured) return it->second.latencyMs;
+  // 没有测量值的设备按平均水平估计，避免新设备因为耗时为0被一直选中
+  double sum = 0.;
+  int count = 0;
+  for (auto& load : mLoads) {
+    if (!load.second.measured) continue;
+    sum += load.second.latencyMs;
+    ++count;
+  }
+  return count == 0 ? 1. : sum / count;
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -7,8 +7,8 @@ void Element::connect(Element& srcElement, int srcElementPort,
                       Element& dstElement, int dstElementPort) {
   auto& inputConnector = dstElement.mInputConnectorMap[dstElementPort];
   if (!inputConnector) {
-    inputConnector =
-        std::make_shared<framework::Connector>(dstElement.getThreadNumber());
+    inputConnector = std::make_shared<framework::Connector>(
+        dstElement.getThreadNumber(), dstElement.getInputQueueCapacity());
     IVS_DEBUG(
         "InputConnector initialized, mId = {0}, inputPort = {1}, dataPipeNum = "
         "{2}",
@@ -67,12 +67,25 @@ common::ErrorCode Element::init(const std::string& json) {
       mDeviceId = deviceIdIt->get<int>();
     }
 
+    auto deviceIdsIt = configure.find(JSON_DEVICE_IDS_FIELD);
+    if (configure.end() != deviceIdsIt && deviceIdsIt->is_array() &&
+        !deviceIdsIt->empty()) {
+      mDeviceIds = deviceIdsIt->get<std::vector<int>>();
+      if (configure.end() == deviceIdIt) mDeviceId = mDeviceIds[0];
+    }
+
     auto threadNumberIt = configure.find(JSON_THREAD_NUMBER_FIELD);
     if (configure.end() != threadNumberIt &&
         threadNumberIt->is_number_integer()) {
       mThreadNumber = threadNumberIt->get<int>();
     }
 
+    auto queueCapacityIt = configure.find(JSON_QUEUE_CAPACITY_FIELD);
+    if (configure.end() != queueCapacityIt &&
+        queueCapacityIt->is_number_integer()) {
+      mInputQueueCapacity = queueCapacityIt->get<int>();
+    }
+
     std::vector<int> inner_elements_id;
     bool is_group = false;
     auto innerIdsIt = configure.find(JSON_INNER_ELEMENTS_ID);
@@ -108,6 +121,10 @@ common::ErrorCode Element::start() {
     return common::ErrorCode::THREAD_STATUS_ERROR;
   }
 
+  mInputConnectorSnapshot.clear();
+  for (auto& pair : mInputConnectorMap)
+    if (pair.second) mInputConnectorSnapshot.push_back(pair.second);
+
   mThreadStatus = ThreadStatus::RUN;
 
   mThreads.reserve(mThreadNumber);
@@ -187,7 +204,8 @@ common::ErrorCode Element::pushInputData(int inputPort, int dataPipeId,
 
   auto& inputConnector = mInputConnectorMap[inputPort];
   if (!inputConnector) {
-    inputConnector = std::make_shared<framework::Connector>(mThreadNumber);
+    inputConnector = std::make_shared<framework::Connector>(
+        mThreadNumber, mInputQueueCapacity);
     IVS_DEBUG(
         "InputConnector initialized, mId = {0}, inputPort = {1}, dataPipeNum = "
         "{2}",
@@ -204,11 +222,28 @@ common::ErrorCode Element::pushInputData(int inputPort, int dataPipeId,
 
 std::shared_ptr<void> Element::popInputData(int inputPort, int dataPipeId) {
   if (mInputConnectorMap[inputPort] == nullptr)
-    mInputConnectorMap[inputPort] =
-        std::make_shared<framework::Connector>(mThreadNumber);
+    mInputConnectorMap[inputPort] = std::make_shared<framework::Connector>(
+        mThreadNumber, mInputQueueCapacity);
   return mInputConnectorMap[inputPort]->popData(dataPipeId);
 }
 
+bool Element::popSynchronizedInputs(int dataPipeId,
+                                    InputSynchronizer& synchronizer,
+                                    common::ObjectMetadatas& inputs) {
+  std::vector<int> inputPorts = getInputPorts();
+  auto pull = [&](int index) {
+    auto objectMetadata = std::static_pointer_cast<common::ObjectMetadata>(
+        popInputData(inputPorts[index], dataPipeId));
+    if (objectMetadata != nullptr)
+      IVS_DEBUG("Got Input, port id = {0}, channel_id = {1}, frame_id = {2}",
+                inputPorts[index], objectMetadata->mFrame->mChannelId,
+                objectMetadata->mFrame->mFrameId);
+    return objectMetadata;
+  };
+  return synchronizer.poll(
+      pull, [this] { return getThreadStatus() == ThreadStatus::RUN; }, inputs);
+}
+
 void Element::setSinkHandler(int outputPort, SinkHandler dataHandler) {
   IVS_INFO("Set data handler, element id: {0:d}, output port: {1:d}", mId,
            outputPort);
@@ -255,6 +290,25 @@ int Element::getInputConnectorCapacity(int inputPort) {
   return mInputConnectorMap[inputPort]->getCapacity();
 }
 
+std::pair<int, int> Element::getInputQueueUsage() {
+  int size = 0;
+  int capacity = 0;
+  for (auto& connector : mInputConnectorSnapshot) {
+    for (int i = 0; i < connector->getCapacity(); ++i) {
+      auto dataPipe = connector->getDataPipe(i);
+      size += dataPipe->getSize();
+      capacity += dataPipe->getCapacity();
+    }
+  }
+  return {size, capacity};
+}
+
+int Element::getOutputDataPipeId(int outputPort, int channelId,
+                                 bool endOfStream) {
+  return mOutputConnectorMap[outputPort].lock()->getDataPipeId(channelId,
+                                                               endOfStream);
+}
+
 void Element::addInputPort(int port) { mInputPorts.push_back(port); }
 void Element::addOutputPort(int port) { mOutputPorts.push_back(port); }
 
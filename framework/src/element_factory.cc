@@ -35,6 +35,10 @@ common::ErrorCode ElementFactory::addElementMaker(
   return common::ErrorCode::SUCCESS;
 }
 
+void ElementFactory::removeElementMaker(const std::string& elementName) {
+  mElementMakerMap.erase(elementName);
+}
+
 std::shared_ptr<framework::Element> ElementFactory::make(
     const std::string& elementName) {
   auto elementMakerIt = mElementMakerMap.find(elementName);
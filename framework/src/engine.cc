@@ -139,6 +139,16 @@ bool Engine::graphExist(int graphId) {
   return false;
 }
 
+bool Engine::graphReady(int graphId) {
+  std::lock_guard<std::mutex> lk(mGraphMapLock);
+
+  auto graphIt = mGraphMap.find(graphId);
+  if (mGraphMap.end() == graphIt || !graphIt->second) {
+    return false;
+  }
+  return graphIt->second->isReady();
+}
+
 void Engine::setSinkHandler(int graphId, int elementId, int outputPort,
                             SinkHandler sinkHandler) {
   IVS_INFO(
@@ -11,10 +11,12 @@
 
 #include <dlfcn.h>
 
+#include <chrono>
 #include <nlohmann/json.hpp>
 #include <set>
 #include <string>
 
+#include "common/bmnn_utils.h"
 #include "common/logger.h"
 #include "element_factory.h"
 
@@ -24,8 +26,6 @@ namespace framework {
 Graph::Graph() : mId(-1), mThreadStatus(ThreadStatus::STOP) {}
 
 Graph::~Graph() {
-  auto& elementFactory = framework::SingletonElementFactory::getInstance();
-  elementFactory.~ElementFactory();
   // uninit();
 }
 
@@ -54,6 +54,18 @@ common::ErrorCode Graph::init(const std::string& json) {
 
     mId = graphIdIt->get<int>();
 
+    auto warmUpIt = configure.find(JSON_WARM_UP_FIELD);
+    if (configure.end() != warmUpIt) {
+      if (!warmUpIt->is_boolean()) {
+        IVS_ERROR(
+            "{0} must be boolean in graph json configure, graph id: {1:d}",
+            JSON_WARM_UP_FIELD, mId);
+        errorCode = common::ErrorCode::PARSE_CONFIGURE_FAIL;
+        break;
+      }
+      mWarmUp = warmUpIt->get<bool>();
+    }
+
     auto elementsIt = configure.find(JSON_WORKERS_FIELD);
     if (configure.end() != elementsIt) {
       errorCode = initElements(elementsIt->dump());
@@ -70,6 +82,11 @@ common::ErrorCode Graph::init(const std::string& json) {
       }
     }
 
+    errorCode = checkMultiDevice();
+    if (common::ErrorCode::SUCCESS != errorCode) {
+      break;
+    }
+
   } while (false);
 
   if (common::ErrorCode::SUCCESS != errorCode) {
@@ -87,6 +104,7 @@ void Graph::uninit() {
   stop();
 
   mElementMap.clear();
+  mDownstream.clear();
   mId = -1;
 
   mSharedObjectHandles.clear();
@@ -104,6 +122,17 @@ common::ErrorCode Graph::start() {
     return common::ErrorCode::THREAD_STATUS_ERROR;
   }
 
+  // 模型在element初始化时已经加载，这里在数据进来之前把它们各跑一遍
+  if (mWarmUp) {
+    auto begin = std::chrono::steady_clock::now();
+    int warmed = BMNNModelRegistry::getInstance().warmUp();
+    mWarmUpMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - begin)
+                    .count();
+    IVS_INFO("Warm up finish, graph id: {0:d}, models: {1:d}, cost: {2} ms",
+             mId, warmed, mWarmUpMs.load());
+  }
+
   for (auto pair : mElementMap) {
     auto element = pair.second;
     if (!element) {
@@ -114,6 +143,7 @@ common::ErrorCode Graph::start() {
   }
 
   mThreadStatus = ThreadStatus::RUN;
+  mReady = true;
 
   IVS_INFO("Start graph thread finish, graph id: {0:d}", mId);
   return common::ErrorCode::SUCCESS;
@@ -137,6 +167,7 @@ common::ErrorCode Graph::stop() {
   }
 
   mThreadStatus = ThreadStatus::STOP;
+  mReady = false;
 
   IVS_INFO("Stop graph thread finish, graph id: {0:d}", mId);
   return common::ErrorCode::SUCCESS;
@@ -408,6 +439,7 @@ common::ErrorCode Graph::connect(int srcId, int srcPort, int dstId,
   }
 
   framework::Element::connect(*srcElement, srcPort, *dstElement, dstPort);
+  mDownstream[srcId].push_back(dstId);
 
   srcElement->afterConnect(false, true);
   dstElement->afterConnect(true, false);
@@ -417,6 +449,34 @@ common::ErrorCode Graph::connect(int srcId, int srcPort, int dstId,
   return common::ErrorCode::SUCCESS;
 }
 
+common::ErrorCode Graph::checkMultiDevice() {
+  for (auto& pair : mElementMap) {
+    auto element = pair.second;
+    if (!element || element->getDeviceIds().size() <= 1) continue;
+
+    std::vector<int> pending{pair.first};
+    std::set<int> visited{pair.first};
+    while (!pending.empty()) {
+      int id = pending.back();
+      pending.pop_back();
+      auto elementIt = mElementMap.find(id);
+      if (mElementMap.end() == elementIt || !elementIt->second) continue;
+      if (!elementIt->second->getMultiDevice()) {
+        IVS_ERROR(
+            "Element {0:d} receives frames from multiple devices (device_ids "
+            "of element {1:d}) but holds resources on a single device, graph "
+            "id: {2:d}",
+            id, pair.first, mId);
+        return common::ErrorCode::PARSE_CONFIGURE_FAIL;
+      }
+      for (int dstId : mDownstream[id]) {
+        if (visited.insert(dstId).second) pending.push_back(dstId);
+      }
+    }
+  }
+  return common::ErrorCode::SUCCESS;
+}
+
 void Graph::setSinkHandler(int elementId, int outputPort,
                            SinkHandler sinkHandler) {
   IVS_INFO(
@@ -486,6 +546,16 @@ std::pair<std::string, int> Graph::getSideAndDeviceId(int elementId) {
   return std::make_pair(element->getSide(), element->getId());
 }
 
+std::map<int, std::pair<int, int> > Graph::getInputQueueUsage() {
+  std::map<int, std::pair<int, int> > usage;
+  for (auto& pair : mElementMap) {
+    auto element = pair.second;
+    if (!element || element->getGroup()) continue;
+    usage[pair.first] = element->getInputQueueUsage();
+  }
+  return usage;
+}
+
 int Graph::getId() const { return mId; }
 }  // namespace framework
 }  // namespace sophon_stream
@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "input_synchronizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <thread>
+
+namespace sophon_stream {
+namespace framework {
+
+SyncOptions SyncOptions::fromJson(const nlohmann::json& configure) {
+  SyncOptions options;
+  auto keyIt = configure.find(CONFIG_SYNC_KEY_FIELD);
+  if (keyIt != configure.end()) {
+    STREAM_CHECK((keyIt->is_string() &&
+                  (*keyIt == "FRAME_ID" || *keyIt == "TIMESTAMP")),
+                 "sync_key must be FRAME_ID or TIMESTAMP, please check your "
+                 "element configuration file");
+    options.key = *keyIt == "TIMESTAMP" ? Key::TIMESTAMP : Key::FRAME_ID;
+  }
+  auto policyIt = configure.find(CONFIG_SYNC_POLICY_FIELD);
+  if (policyIt != configure.end()) {
+    STREAM_CHECK((policyIt->is_string() &&
+                  (*policyIt == "DROP" || *policyIt == "REPEAT")),
+                 "sync_policy must be DROP or REPEAT, please check your "
+                 "element configuration file");
+    options.policy = *policyIt == "REPEAT" ? MissingPolicy::REPEAT
+                                           : MissingPolicy::DROP;
+  }
+  auto toleranceIt = configure.find(CONFIG_SYNC_TOLERANCE_FIELD);
+  if (toleranceIt != configure.end()) {
+    STREAM_CHECK((toleranceIt->is_number_integer() && *toleranceIt >= 0),
+                 "sync_tolerance must be a non-negative integer, please check "
+                 "your element configuration file");
+    options.tolerance = toleranceIt->get<std::int64_t>();
+  }
+  auto queueSizeIt = configure.find(CONFIG_SYNC_QUEUE_SIZE_FIELD);
+  if (queueSizeIt != configure.end()) {
+    STREAM_CHECK((queueSizeIt->is_number_integer() && *queueSizeIt >= 1),
+                 "sync_queue_size must be a positive integer, please check "
+                 "your element configuration file");
+    options.queueSize = queueSizeIt->get<int>();
+  }
+  return options;
+}
+
+InputSynchronizer::InputSynchronizer(int inputNum, const SyncOptions& options)
+    : mOptions(options), mQueues(inputNum), mLast(inputNum) {
+  // Frame::mTimestamp的单位是微秒
+  mTolerance = mOptions.key == SyncOptions::Key::TIMESTAMP
+                   ? mOptions.tolerance * 1000
+                   : mOptions.tolerance;
+}
+
+std::int64_t InputSynchronizer::keyOf(
+    const std::shared_ptr<common::ObjectMetadata>& obj) const {
+  return mOptions.key == SyncOptions::Key::TIMESTAMP ? obj->mFrame->mTimestamp
+                                                     : obj->mFrame->mFrameId;
+}
+
+void InputSynchronizer::push(int index,
+                             std::shared_ptr<common::ObjectMetadata> obj) {
+  mQueues[index].push_back(std::move(obj));
+}
+
+void InputSynchronizer::emit(common::ObjectMetadatas& inputs) {
+  inputs.clear();
+  for (std::size_t i = 0; i < mQueues.size(); ++i) {
+    inputs.push_back(mQueues[i].front());
+    mQueues[i].pop_front();
+    if (mOptions.policy == SyncOptions::MissingPolicy::REPEAT)
+      mLast[i] = inputs.back();
+  }
+}
+
+bool InputSynchronizer::pop(common::ObjectMetadatas& inputs) {
+  while (true) {
+    bool allReady = true;
+    std::int64_t newest = std::numeric_limits<std::int64_t>::min();
+    for (auto& queue : mQueues) {
+      if (queue.empty()) {
+        allReady = false;
+        continue;
+      }
+      newest = std::max(newest, keyOf(queue.front()));
+    }
+
+    if (allReady) {
+      // REPEAT：落后的端口有帧而其它端口缺了这些帧，与其它端口上一次的数据组成一组
+      if (mOptions.policy == SyncOptions::MissingPolicy::REPEAT) {
+        std::int64_t oldest = std::numeric_limits<std::int64_t>::max();
+        for (auto& queue : mQueues)
+          oldest = std::min(oldest, keyOf(queue.front()));
+        if (oldest < newest - mTolerance) {
+          if (takeOldest(std::min(oldest + mTolerance, newest - mTolerance - 1),
+                         inputs))
+            return true;
+          continue;
+        }
+      }
+      // 以最新的队首为基准，丢弃落后超过容忍范围的帧
+      bool aligned = true;
+      for (auto& queue : mQueues) {
+        while (!queue.empty() && keyOf(queue.front()) < newest - mTolerance) {
+          queue.pop_front();
+          ++mDropped;
+        }
+        // 丢帧后新的队首可能比基准更新，需要重新选基准
+        if (queue.empty() || keyOf(queue.front()) > newest) aligned = false;
+      }
+      if (aligned) {
+        emit(inputs);
+        return true;
+      }
+      continue;
+    }
+
+    // 有端口为空：其它端口积压不多时继续等待，否则认为空端口丢了最旧的那一帧
+    std::size_t backlog = 0;
+    std::int64_t oldest = std::numeric_limits<std::int64_t>::max();
+    for (auto& queue : mQueues) {
+      backlog = std::max(backlog, queue.size());
+      if (!queue.empty()) oldest = std::min(oldest, keyOf(queue.front()));
+    }
+    if (backlog <= static_cast<std::size_t>(mOptions.queueSize)) return false;
+    if (takeOldest(oldest + mTolerance, inputs)) return true;
+  }
+}
+
+bool InputSynchronizer::takeOldest(std::int64_t limit,
+                                   common::ObjectMetadatas& inputs) {
+  common::ObjectMetadatas tuple(mQueues.size());
+  bool complete = true;
+  std::uint64_t taken = 0;
+  std::uint64_t repeated = 0;
+  for (std::size_t i = 0; i < mQueues.size(); ++i) {
+    auto& queue = mQueues[i];
+    if (!queue.empty() && keyOf(queue.front()) <= limit) {
+      tuple[i] = queue.front();
+      queue.pop_front();
+      ++taken;
+    } else if (mOptions.policy == SyncOptions::MissingPolicy::REPEAT &&
+               mLast[i] != nullptr) {
+      tuple[i] = mLast[i];
+      ++repeated;
+    } else {
+      complete = false;
+    }
+  }
+  if (complete && mOptions.policy == SyncOptions::MissingPolicy::REPEAT) {
+    mLast = tuple;
+    mRepeated += repeated;
+    inputs = std::move(tuple);
+    return true;
+  }
+  mDropped += taken;
+  return false;
+}
+
+bool InputSynchronizer::poll(const PullFunc& pull,
+                             const std::function<bool()>& running,
+                             common::ObjectMetadatas& inputs) {
+  while (!pop(inputs)) {
+    bool received = false;
+    for (std::size_t i = 0; i < mQueues.size(); ++i) {
+      auto obj = pull(i);
+      if (obj == nullptr) continue;
+      push(i, obj);
+      received = true;
+    }
+    if (received) continue;
+    if (!running()) return false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+void InputSynchronizer::clear() {
+  for (auto& queue : mQueues) queue.clear();
+  for (auto& last : mLast) last = nullptr;
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "keypoint_window.h"
+
+#include <string>
+
+namespace sophon_stream {
+namespace framework {
+
+std::shared_ptr<const KeypointFrame> KeypointFrame::fromObjectMetadata(
+    const common::ObjectMetadata& obj) {
+  auto frame = std::make_shared<KeypointFrame>();
+  frame->frameId = obj.mFrame->mFrameId;
+  if (obj.mFrame->mSpData) {
+    frame->width = obj.mFrame->mSpData->width;
+    frame->height = obj.mFrame->mSpData->height;
+  } else {
+    frame->width = obj.mFrame->mWidth;
+    frame->height = obj.mFrame->mHeight;
+  }
+  frame->keypoints.reserve(obj.mPosedObjectMetadatas.size());
+  frame->scores.reserve(obj.mPosedObjectMetadatas.size());
+  for (auto& poseObj : obj.mPosedObjectMetadatas) {
+    frame->keypoints.push_back(poseObj->keypoints);
+    frame->scores.push_back(poseObj->scores);
+  }
+  return frame;
+}
+
+KeypointWindow::KeypointWindow(int windowSize, int stride)
+    : mWindowSize(windowSize), mStride(stride) {
+  STREAM_CHECK(windowSize > 0, "window size must be positive, got ",
+               std::to_string(windowSize));
+  STREAM_CHECK(stride > 0, "window stride must be positive, got ",
+               std::to_string(stride));
+}
+
+bool KeypointWindow::push(int channelId,
+                          std::shared_ptr<const KeypointFrame> frame,
+                          KeypointClip& clip) {
+  auto& ring = mRings[channelId];
+  if (ring.frames.empty()) ring.frames.resize(mWindowSize);
+  ring.frames[ring.head] = std::move(frame);
+  ring.head = (ring.head + 1) % mWindowSize;
+  if (ring.count < mWindowSize) ++ring.count;
+  ++ring.sinceEmit;
+
+  if (ring.count < mWindowSize) return false;
+  if (ring.emitted && ring.sinceEmit < mStride) return false;
+
+  // head指向最旧的一帧
+  clip.clear();
+  clip.reserve(mWindowSize);
+  for (int i = 0; i < mWindowSize; ++i)
+    clip.push_back(ring.frames[(ring.head + i) % mWindowSize]);
+  ring.sinceEmit = 0;
+  ring.emitted = true;
+  return true;
+}
+
+void KeypointWindow::reset(int channelId) { mRings.erase(channelId); }
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "micro_batcher.h"
+
+#include <algorithm>
+
+namespace sophon_stream {
+namespace framework {
+
+namespace {
+
+inline bool isEos(const std::shared_ptr<common::ObjectMetadata>& obj) {
+  return obj->mFrame != nullptr && obj->mFrame->mEndOfStream;
+}
+
+inline bool needInfer(const std::shared_ptr<common::ObjectMetadata>& obj) {
+  return !obj->mFilter && !isEos(obj);
+}
+
+}  // namespace
+
+MicroBatcher::MicroBatcher(int maxBatch, int timeoutMs, int statInterval)
+    : mMaxBatch(std::max(1, maxBatch)),
+      mTimeout(std::max(0, timeoutMs)),
+      mStatInterval(std::max(0, statInterval)) {}
+
+void MicroBatcher::push(std::shared_ptr<common::ObjectMetadata> obj) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (needInfer(obj)) ++mReady;
+  if (isEos(obj)) ++mEos;
+  mQueue.push_back({std::move(obj), std::chrono::steady_clock::now()});
+}
+
+bool MicroBatcher::pop(common::ObjectMetadatas& pending,
+                       common::ObjectMetadatas& objects, std::uint64_t& ticket,
+                       bool& logStats, bool flush) {
+  pending.clear();
+  objects.clear();
+  logStats = false;
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mQueue.empty()) return false;
+  bool ready = flush || mReady >= mMaxBatch || mEos > 0 ||
+               std::chrono::steady_clock::now() - mQueue.front().arrival >=
+                   mTimeout;
+  if (!ready) return false;
+
+  // 与原先单个dataPipe组batch的规则一致：凑满maxBatch或遇到EOS为止
+  while (!mQueue.empty()) {
+    auto& obj = mQueue.front().obj;
+    bool infer = needInfer(obj);
+    if (infer && objects.size() == static_cast<std::size_t>(mMaxBatch)) break;
+    bool eos = isEos(obj);
+    if (infer) {
+      objects.push_back(obj);
+      --mReady;
+    }
+    pending.push_back(std::move(obj));
+    mQueue.pop_front();
+    if (eos) {
+      --mEos;
+      break;
+    }
+  }
+
+  ticket = mNextTicket++;
+  if (!objects.empty()) {
+    ++mBatches;
+    mObjects += objects.size();
+    logStats = mStatInterval > 0 && mBatches % mStatInterval == 0;
+  }
+  return true;
+}
+
+void MicroBatcher::waitTurn(std::uint64_t ticket) {
+  std::unique_lock<std::mutex> lock(mTurnMutex);
+  mTurnCond.wait(lock, [this, ticket] { return mTurn == ticket; });
+}
+
+void MicroBatcher::finish(std::uint64_t ticket) {
+  {
+    std::lock_guard<std::mutex> lock(mTurnMutex);
+    mTurn = ticket + 1;
+  }
+  mTurnCond.notify_all();
+}
+
+std::size_t MicroBatcher::size() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mQueue.size();
+}
+
+std::uint64_t MicroBatcher::getBatches() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mBatches;
+}
+
+std::uint64_t MicroBatcher::getObjects() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mObjects;
+}
+
+double MicroBatcher::getOccupancy() {
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mBatches == 0) return 0.;
+  return static_cast<double>(mObjects) / (mBatches * mMaxBatch);
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -527,7 +527,8 @@ void draw_license_plate_recognition_results(
     std::string& out_dir) {
   bm_image imageStorage;
   _gen_storage_image(objectMetadata, imageStorage);
-  uni_text::UniText uniText(
+  // 字形位图缓存在共享图集中，每个线程只需打开一次字体
+  static thread_local uni_text::UniText uniText(
       "../license_plate_recognition/data/wqy-microhei.ttc", 22);
   cv::Mat img;
   cv::bmcv::toMAT(&imageStorage, img);
@@ -937,7 +938,8 @@ void draw_ppocr_results(
     std::string& out_dir) {
   bm_image imageStorage;
   _gen_storage_image(objectMetadata, imageStorage);
-  uni_text::UniText uniText("../ppocr/data/wqy-microhei.ttc", 30);
+  static thread_local uni_text::UniText uniText(
+      "../ppocr/data/wqy-microhei.ttc", 30);
   cv::Mat img;
   cv::bmcv::toMAT(&imageStorage, img);
   // draw words
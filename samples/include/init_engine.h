@@ -18,6 +18,7 @@ constexpr const char* JSON_CONFIG_GRAPH_ID_FILED = "graph_id";
 constexpr const char* JSON_CONFIG_DEVICE_ID_FILED = "device_id";
 constexpr const char* JSON_CONFIG_ELEMENTS_FILED = "elements";
 constexpr const char* JSON_CONFIG_CONNECTION_FILED = "connections";
+constexpr const char* JSON_CONFIG_WARM_UP_FILED = "warm_up";
 constexpr const char* JSON_CONFIG_ELEMENT_CONFIG_FILED = "element_config";
 constexpr const char* JSON_CONFIG_ELEMENT_ID_FILED = "element_id";
 constexpr const char* JSON_CONFIG_PORTS_CONFIG_FILED = "ports";
@@ -113,24 +114,42 @@ void parse_connection_json(
   }
 }
 
+/**
+ * @brief 把engine.json中的一个graph展开成Engine::addGraph使用的graph json
+ * @return graph_id
+ */
+int build_graph_json(nlohmann::json& graph_it, nlohmann::json& graphConfigure,
+                     std::vector<std::pair<int, int>>& src_id_port,
+                     std::pair<int, int>& sink_id_port) {
+  nlohmann::json elementsConfigure;
+  sink_id_port = {-1, -1};
+
+  int graph_id = graph_it.find(JSON_CONFIG_GRAPH_ID_FILED)->get<int>();
+  graphConfigure["graph_id"] = graph_id;
+  auto warm_up_it = graph_it.find(JSON_CONFIG_WARM_UP_FILED);
+  if (warm_up_it != graph_it.end())
+    graphConfigure["warm_up"] = warm_up_it->get<bool>();
+  int device_id = graph_it.find(JSON_CONFIG_DEVICE_ID_FILED)->get<int>();
+  auto elements_it = graph_it.find(JSON_CONFIG_ELEMENTS_FILED);
+  parse_element_json(elements_it, elementsConfigure, device_id, src_id_port,
+                     sink_id_port);
+  graphConfigure["elements"] = elementsConfigure;
+  auto connect_it = graph_it.find(JSON_CONFIG_CONNECTION_FILED);
+  parse_connection_json(connect_it, graphConfigure);
+  return graph_id;
+}
+
 void init_engine(
     sophon_stream::framework::Engine& engine, nlohmann::json& engine_json,
     const sophon_stream::framework::Engine::SinkHandler& sinkHandler,
     std::map<int, std::vector<std::pair<int, int>>>& graph_src_id_port_map) {
   for (auto& graph_it : engine_json) {
-    nlohmann::json graphConfigure, elementsConfigure;
-    std::vector<std::pair<int, int>> src_id_port;;   // src_port
-    std::pair<int, int> sink_id_port = {-1, -1};  // sink_port
+    nlohmann::json graphConfigure;
+    std::vector<std::pair<int, int>> src_id_port;  // src_port
+    std::pair<int, int> sink_id_port;              // sink_port
 
-    int graph_id = graph_it.find(JSON_CONFIG_GRAPH_ID_FILED)->get<int>();
-    graphConfigure["graph_id"] = graph_id;
-    int device_id = graph_it.find(JSON_CONFIG_DEVICE_ID_FILED)->get<int>();
-    auto elements_it = graph_it.find(JSON_CONFIG_ELEMENTS_FILED);
-    parse_element_json(elements_it, elementsConfigure, device_id, src_id_port,
-                       sink_id_port);
-    graphConfigure["elements"] = elementsConfigure;
-    auto connect_it = graph_it.find(JSON_CONFIG_CONNECTION_FILED);
-    parse_connection_json(connect_it, graphConfigure);
+    int graph_id =
+        build_graph_json(graph_it, graphConfigure, src_id_port, sink_id_port);
 
     engine.addGraph(graphConfigure.dump());
     engine.setSinkHandler(graph_id, sink_id_port.first, sink_id_port.second,
@@ -1,6 +1,9 @@
 #include "cvUniText.h"
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include "utf8.h"
+#include "common/glyph_atlas.h"
 #include <ft2build.h>
 #include <freetype/freetype.h>
 
@@ -27,6 +30,7 @@ namespace uni_text {
 
         FT_Library m_library;
         FT_Face m_face;
+        std::string m_fontFace;
         int m_fontType;
         cv::Scalar m_fontSize;
         float m_fontDiaphaneity;
@@ -59,6 +63,7 @@ Impl::Impl(const std::string& font_face, int font_size) {
         abort();
     }
 
+    m_fontFace = font_face;
     m_fontType = 0;
     m_fontSize[0] = font_size; //FontSize
     m_fontSize[1] = 0.5; //whitechar ratio, such like ' '
@@ -84,16 +89,6 @@ void Impl::SetParam(int font_size, float interval_ratio, float whitespace_ratio,
 double Impl::_cvPutUniChar(cv::Mat& img, char16_t wc,
                            const cv::Point& pos, const cv::Scalar& color, bool calc_size) {
     // generate font bitmap from unicode
-    FT_GlyphSlot ft_slot;
-//    int ft_ascender;
-    int ft_bmp_height;
-    int ft_bmp_width;//0 when ' '
-    int ft_bmp_step;
-    int ft_bmp_left;
-    int ft_bmp_top;
-    unsigned char *ft_bmp_buffer;
-
-
     double whitespace_width;
     double interval_width;
     double horizontal_offset;
@@ -132,18 +127,37 @@ double Impl::_cvPutUniChar(cv::Mat& img, char16_t wc,
     //get font_id from database of char
 //    ft_ascender = m_face->size->metrics.ascender / 64;
 
-    FT_UInt glyph_index = FT_Get_Char_Index(m_face, wc);
-    //load bitmap font to slot
-    FT_Load_Glyph(m_face, glyph_index, FT_LOAD_DEFAULT);
-    //render to 8bits
-    FT_Render_Glyph(m_face->glyph, FT_RENDER_MODE_NORMAL);
-    ft_slot = m_face->glyph;
-    ft_bmp_width = ft_slot->bitmap.width;
-    ft_bmp_height = ft_slot->bitmap.rows;
-    ft_bmp_step = ft_slot->bitmap.pitch;
-    ft_bmp_buffer = ft_slot->bitmap.buffer;
-    ft_bmp_left = ft_slot->bitmap_left;
-    ft_bmp_top = ft_slot->bitmap_top;
+    // glyph bitmaps are cached in the shared atlas, FreeType only renders
+    // a (font, size, char) the first time it is drawn
+    auto rasterizer = [this](char32_t codepoint, sophon_stream::common::GlyphBitmap &out) {
+        FT_UInt glyph_index = FT_Get_Char_Index(m_face, codepoint);
+        //load bitmap font to slot
+        if (FT_Load_Glyph(m_face, glyph_index, FT_LOAD_DEFAULT) != 0) {
+            return false;
+        }
+        //render to 8bits
+        if (FT_Render_Glyph(m_face->glyph, FT_RENDER_MODE_NORMAL) != 0) {
+            return false;
+        }
+        FT_GlyphSlot ft_slot = m_face->glyph;
+        out.width = ft_slot->bitmap.width;
+        out.height = ft_slot->bitmap.rows;
+        out.left = ft_slot->bitmap_left;
+        out.top = ft_slot->bitmap_top;
+        out.advance = ft_slot->advance.x / 64;
+        out.alpha.resize(out.width * out.height);
+        for (int row = 0; row < out.height; ++row) {
+            memcpy(out.alpha.data() + row * out.width,
+                   ft_slot->bitmap.buffer + row * ft_slot->bitmap.pitch, out.width);
+        }
+        return true;
+    };
+    const sophon_stream::common::Glyph *glyph =
+            sophon_stream::common::GlyphAtlas::getInstance().lookup(
+                    m_fontFace, (int) m_fontSize[0], wc, rasterizer);
+
+    int ft_bmp_width = glyph ? glyph->width : 0;//0 when ' '
+    int ft_bmp_height = glyph ? glyph->height : 0;
 
 #ifdef CVUNITEXT_DEBUG
     if (wc < 256) {
@@ -152,8 +166,10 @@ double Impl::_cvPutUniChar(cv::Mat& img, char16_t wc,
         printf(" 0x%02x%02x: ", ((char*)&wc)[1] & 0xFF, ((char*)&wc)[0] & 0xFF);
     }
     printf("width %4d, height %4d, ", ft_bmp_width,  ft_bmp_height);
-    printf("left %4d, ", ft_bmp_left);
-    printf("top %4d, ", ft_bmp_top);
+    if (glyph) {
+        printf("left %4d, ", glyph->left);
+        printf("top %4d, ", glyph->top);
+    }
     printf("\n");
 #endif
 
@@ -166,37 +182,35 @@ double Impl::_cvPutUniChar(cv::Mat& img, char16_t wc,
         horizontal_offset = whitespace_width;
     }
 
-    int loc_x = pos.x + ft_bmp_left;
-    int loc_y = pos.y + ft_bmp_height - ft_bmp_top;
-
-    if (calc_size) {
+    if (calc_size || ft_bmp_width == 0 || ft_bmp_height == 0) {
         return horizontal_offset;
     }
 
-    //draw font bitmap to opencv image
-    //(bmp_j,bmp_i) is freetype bitmap location
+    //draw font bitmap to opencv image, row by row from the atlas
+    //  alpha = font_bitmap_val / 255;
+    //  pixel = alpha * color + (1 - alpha) * pixel;
+    int loc_x = pos.x + glyph->left;
+    int loc_y = pos.y + 1 - glyph->top;
+    int channels = img.channels();
+    int bmp_j0 = std::max(0, -loc_x);
+    int bmp_j1 = std::min(ft_bmp_width, img.cols - loc_x);
     for (int bmp_i = 0; bmp_i < ft_bmp_height; ++bmp_i) {
-        for (int bmp_j = 0; bmp_j < ft_bmp_width; ++bmp_j) {
-            int bmp_valoff = bmp_i * ft_bmp_step + bmp_j;
-            unsigned int bmp_val = ft_bmp_buffer[bmp_valoff];
-            float bmp_valf = (float) bmp_val / 255 * m_fontDiaphaneity;
+        int img_y = loc_y + bmp_i;
+        if (img_y < 0 || img_y >= img.rows) {
+            continue;
+        }
+        const unsigned char *alpha_row = glyph->alpha + bmp_i * glyph->stride;
+        unsigned char *data = img.ptr<unsigned char>(img_y);
+        for (int bmp_j = bmp_j0; bmp_j < bmp_j1; ++bmp_j) {
+            unsigned int bmp_val = alpha_row[bmp_j];
             if (bmp_val == 0) {
                 continue;
             }
-            //(img_x,img_y) is opencv bitmap location
-            int img_y = loc_y - (ft_bmp_height - 1 - bmp_i);
-            int img_x = loc_x + bmp_j;
-
-            //update pixel when location is valid
-            //  alpha = font_bitmap_val / 255;
-            //  pixel = alpha * color + (1 - alpha) * pixel;
-            if ((0 <= img_y) && (img_y < img.rows) && (0 <= img_x) && (img_x < img.cols)) {
-                unsigned char *data = img.ptr<unsigned char>(img_y);
-                for (int img_channel = 0; img_channel < img.channels(); img_channel++) {
-                    data[img_x * img.channels() + img_channel] =
-                            (1 - bmp_valf) * data[img_x * img.channels() + img_channel] +
-                            bmp_valf * color[img_channel];
-                }
+            float bmp_valf = (float) bmp_val / 255 * m_fontDiaphaneity;
+            unsigned char *pixel = data + (loc_x + bmp_j) * channels;
+            for (int img_channel = 0; img_channel < channels; img_channel++) {
+                pixel[img_channel] = (1 - bmp_valf) * pixel[img_channel] +
+                                     bmp_valf * color[img_channel];
             }
         }
     }
@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 #include <functional>
 
+#include "auto_tuner.h"
 #include "draw_funcs.h"
 
 typedef struct demo_config_ {
@@ -16,6 +17,7 @@ typedef struct demo_config_ {
   std::vector<nlohmann::json> channel_configs;
   nlohmann::json report_config;
   nlohmann::json listen_config;
+  nlohmann::json auto_tune_config;
   bool download_image;
   std::string engine_config_file;
   std::vector<std::string> class_names;
@@ -56,6 +58,20 @@ constexpr const char* JSON_CONFIG_HTTP_LISTEN_CONFIG_FILED = "http_listen";
 constexpr const char* JSON_CONFIG_HTTP_CONFIG_IP_FILED = "ip";
 constexpr const char* JSON_CONFIG_HTTP_CONFIG_PORT_FILED = "port";
 constexpr const char* JSON_CONFIG_HTTP_CONFIG_PATH_FILED = "path";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_CONFIG_FILED = "auto_tune";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_TRIAL_SECONDS_FILED =
+    "trial_seconds";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_WARM_UP_SECONDS_FILED =
+    "warm_up_seconds";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_MAX_TRIALS_FILED = "max_trials";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_MAX_THREAD_NUMBER_FILED =
+    "max_thread_number";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_MAX_QUEUE_CAPACITY_FILED =
+    "max_queue_capacity";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_MIN_GAIN_FILED = "min_gain";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_FROZEN_ELEMENTS_FILED =
+    "frozen_elements";
+constexpr const char* JSON_CONFIG_AUTO_TUNE_OUTPUT_DIR_FILED = "output_dir";
 
 demo_config parse_demo_json(std::string& json_path) {
   std::ifstream istream;
@@ -225,9 +241,123 @@ demo_config parse_demo_json(std::string& json_path) {
         http_listen_it->find(JSON_CONFIG_HTTP_CONFIG_PATH_FILED)
             ->get<std::string>();
   }
+  if (demo_json.contains(JSON_CONFIG_AUTO_TUNE_CONFIG_FILED)) {
+    config.auto_tune_config =
+        *demo_json.find(JSON_CONFIG_AUTO_TUNE_CONFIG_FILED);
+    STREAM_CHECK(config.auto_tune_config.is_object(),
+                 "auto_tune must be an object, please check ", json_path);
+  }
   return config;
 }
 
+using ChannelTaskPtr =
+    std::shared_ptr<sophon_stream::element::decode::ChannelTask>;
+
+// 把属于graph_id的码流的启动任务推给对应的decode element
+void push_channel_tasks(
+    demo_config& config, int graph_id,
+    const std::vector<std::pair<int, int>>& src_id_port_vec,
+    const std::function<void(int, int, ChannelTaskPtr)>& push) {
+  for (auto& channel_config : config.channel_configs) {
+    if (channel_config["graph_id"] != graph_id) continue;
+    auto channelTask =
+        std::make_shared<sophon_stream::element::decode::ChannelTask>();
+    channelTask->request.operation = sophon_stream::element::decode::
+        ChannelOperateRequest::ChannelOperate::START;
+    channelTask->request.channelId = channel_config["channel_id"];
+    channelTask->request.json = channel_config.dump();
+    int decode_id = channel_config["decode_id"];
+
+    for (auto& src_id_port : src_id_port_vec) {
+      // decode_id == -1为默认情况，即只有一个解码器
+      // decode_id != -1，即有多个解码器，要求每个都写清参数
+      if ((decode_id == -1 && src_id_port_vec.size() == 1) ||
+          src_id_port.first == decode_id) {
+        push(src_id_port.first, src_id_port.second, channelTask);
+      }
+    }
+  }
+}
+
+/**
+ * @brief 对engine.json中的每个graph做自动调优，用demo.json中的码流作为输入，
+ * 把调优后的graph json和每组配置的吞吐、时延报告写到output_dir
+ */
+int run_auto_tune(demo_config& config, nlohmann::json& engine_json,
+                  sophon_stream::framework::ListenThread* listener) {
+  auto& tune_json = config.auto_tune_config;
+  sophon_stream::framework::AutoTuner::Options options;
+  options.trialSeconds =
+      tune_json.value(JSON_CONFIG_AUTO_TUNE_TRIAL_SECONDS_FILED,
+                      options.trialSeconds);
+  options.warmUpSeconds =
+      tune_json.value(JSON_CONFIG_AUTO_TUNE_WARM_UP_SECONDS_FILED,
+                      options.warmUpSeconds);
+  options.maxTrials = tune_json.value(JSON_CONFIG_AUTO_TUNE_MAX_TRIALS_FILED,
+                                      options.maxTrials);
+  options.maxThreadNumber =
+      tune_json.value(JSON_CONFIG_AUTO_TUNE_MAX_THREAD_NUMBER_FILED,
+                      options.maxThreadNumber);
+  options.maxQueueCapacity =
+      tune_json.value(JSON_CONFIG_AUTO_TUNE_MAX_QUEUE_CAPACITY_FILED,
+                      options.maxQueueCapacity);
+  options.minGain =
+      tune_json.value(JSON_CONFIG_AUTO_TUNE_MIN_GAIN_FILED, options.minGain);
+  if (tune_json.contains(JSON_CONFIG_AUTO_TUNE_FROZEN_ELEMENTS_FILED)) {
+    auto frozen = tune_json.find(JSON_CONFIG_AUTO_TUNE_FROZEN_ELEMENTS_FILED)
+                      ->get<std::vector<int>>();
+    options.frozenElements.insert(frozen.begin(), frozen.end());
+  }
+  std::string output_dir = tune_json.value(
+      JSON_CONFIG_AUTO_TUNE_OUTPUT_DIR_FILED, std::string("./auto_tune"));
+  struct stat info;
+  if (stat(output_dir.c_str(), &info) != 0)
+    STREAM_CHECK(mkdir(output_dir.c_str(), 0777) == 0,
+                 "Create auto tune output dir ", output_dir, " failed.");
+
+  for (auto& graph_it : engine_json) {
+    nlohmann::json graphConfigure;
+    std::vector<std::pair<int, int>> src_id_port;
+    std::pair<int, int> sink_id_port;
+    int graph_id =
+        build_graph_json(graph_it, graphConfigure, src_id_port, sink_id_port);
+
+    auto tuner =
+        std::make_shared<sophon_stream::framework::AutoTuner>(options, listener);
+    tuner->addSink(sink_id_port.first, sink_id_port.second);
+    tuner->setInputHandler([&config, graph_id, src_id_port](
+                               sophon_stream::framework::Graph& graph) {
+      push_channel_tasks(
+          config, graph_id, src_id_port,
+          [&graph](int element_id, int port, ChannelTaskPtr channelTask) {
+            graph.pushSourceData(element_id, port,
+                                 std::static_pointer_cast<void>(channelTask));
+          });
+    });
+    if (tuner->tune(graphConfigure) !=
+        sophon_stream::common::ErrorCode::SUCCESS)
+      return -1;
+
+    std::string prefix = output_dir + "/graph_" + std::to_string(graph_id);
+    std::ofstream ostream(prefix + "_tuned.json");
+    ostream << tuner->getBestGraph().dump(2);
+    ostream.close();
+    ostream.open(prefix + "_report.json");
+    ostream << tuner->getReport().dump(2);
+    ostream.close();
+
+    for (auto& trial : tuner->getTrials()) {
+      std::cout << "graph " << graph_id << " trial " << trial.index << " | "
+                << trial.change << " | fps " << trial.fps << " | p99 "
+                << trial.p99Ms << " ms" << (trial.accepted ? " | accepted" : "")
+                << std::endl;
+    }
+    std::cout << "tuned graph is written to " << prefix << "_tuned.json"
+              << std::endl;
+  }
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
   const char* keys =
       "{demo_config_path | "
@@ -350,37 +480,25 @@ int main(int argc, char* argv[]) {
       sophon_stream::framework::ListenThread::getInstance();
   listenthread->init(demo_json.report_config, demo_json.listen_config);
   engine.setListener(listenthread);
+  // 配置了auto_tune时只做调优，不按正常流程运行
+  if (!demo_json.auto_tune_config.empty())
+    return run_auto_tune(demo_json, engine_json, listenthread);
   std::map<int, std::vector<std::pair<int, int>>> graph_src_id_port_map;
   init_engine(engine, engine_json, sinkHandler, graph_src_id_port_map);
 
-  for (auto& channel_config : demo_json.channel_configs) {
-    int graph_id = channel_config["graph_id"]; // 默认是graph0
-    auto channelTask =
-        std::make_shared<sophon_stream::element::decode::ChannelTask>();
-    channelTask->request.operation = sophon_stream::element::decode::
-        ChannelOperateRequest::ChannelOperate::START;
-    channelTask->request.channelId = channel_config["channel_id"];
-    channelTask->request.json = channel_config.dump();
-    int decode_id = channel_config["decode_id"];
-    // std::pair<int, int> src_id_port =
-    // graph_src_id_port_map[graph_id][decode_id];
-
-    auto src_id_port_vec = graph_src_id_port_map[graph_id];
-    for (auto& src_id_port : src_id_port_vec) {
-      // decode_id == -1为默认情况，即只有一个解码器
-      // decode_id != -1，即有多个解码器，要求每个都写清参数
-      if ((decode_id == -1 && src_id_port_vec.size() == 1) ||
-          src_id_port.first == decode_id) {
-        sophon_stream::common::ErrorCode errorCode = engine.pushSourceData(
-            graph_id, src_id_port.first, src_id_port.second,
-            std::static_pointer_cast<void>(channelTask));
-        IVS_DEBUG(
-            "Push Source Data, GraphId = {0}, ElementId = {1}, ElementPort = "
-            "{2}, ChannelId = {3}",
-            graph_id, src_id_port.first, src_id_port.second,
-            channelTask->request.channelId);
-      }
-    }
+  for (auto& graph_src_id_port : graph_src_id_port_map) {
+    int graph_id = graph_src_id_port.first;
+    push_channel_tasks(
+        demo_json, graph_id, graph_src_id_port.second,
+        [&](int element_id, int port, ChannelTaskPtr channelTask) {
+          sophon_stream::common::ErrorCode errorCode = engine.pushSourceData(
+              graph_id, element_id, port,
+              std::static_pointer_cast<void>(channelTask));
+          IVS_DEBUG(
+              "Push Source Data, GraphId = {0}, ElementId = {1}, ElementPort = "
+              "{2}, ChannelId = {3}",
+              graph_id, element_id, port, channelTask->request.channelId);
+        });
   }
 
   {
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+// FastPose姿态NMS的性能对比：poseNMS与原先每轮对所有姿态计算关键点距离的实现
+// 场景为1920x1080画面中的人群，每人2个重复检测
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "../element/fastpose_pose_nms_reference.h"
+#include "fastpose_pose_nms.h"
+
+namespace {
+
+template <typename F>
+double millisecondsPerCall(int iterations, F&& call) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) call();
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+}  // namespace
+
+int main() {
+  using namespace sophon_stream;
+  std::mt19937 rng(1);
+  const int iterations = 20;
+
+  for (int num_joints : {17, 133}) {
+    bool full_body = num_joints == 133;
+    auto params = tests::poseNMSParams(full_body);
+    tests::LegacyPoseNMS legacy(params);
+    for (int persons : {5, 20, 50}) {
+      tests::CrowdScene crowd(rng, persons, 2, num_joints, 1080.f);
+      int num_samples = crowd.poses.size();
+      // 拷贝姿态的开销两边都有，单独计时以便扣除
+      double cloneMs =
+          millisecondsPerCall(iterations, [&] { crowd.clonePoses(); });
+      double legacyMs = millisecondsPerCall(iterations, [&] {
+        auto poses = crowd.clonePoses();
+        std::vector<int> ids;
+        legacy.poseNMS(crowd.dets, num_samples, num_joints, 0.f, poses, ids);
+      });
+      double currentMs = millisecondsPerCall(iterations, [&] {
+        auto poses = crowd.clonePoses();
+        std::vector<int> ids;
+        element::fastpose::poseNMS(params, crowd.dets, num_samples,
+                                   num_joints, 0.f, poses, ids);
+      });
+      std::cout << num_joints << " joints, " << num_samples
+                << " poses: legacy " << legacyMs << " ms/frame, poseNMS "
+                << currentMs << " ms/frame (pose clone " << cloneMs << " ms)"
+                << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+// PoseC3D预处理中heatmap生成的性能对比：generatePoseHeatmap与原先逐帧逐像素
+// 计算exp/pow的实现
+// 与element的默认配置相同：10个clip，每个48帧，17个关键点，64x64
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "../element/posec3d_heatmap_reference.h"
+#include "posec3d_heatmap.h"
+
+namespace {
+
+template <typename F>
+double millisecondsPerCall(int iterations, F&& call) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) call();
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+}  // namespace
+
+int main() {
+  using namespace sophon_stream;
+  const int num_clips = 10, clip_len = 48, num_c = 17, size = 64;
+  const int out_num = 2 * num_clips * num_c * clip_len * size * size;
+  std::vector<float> heatmap(out_num);
+  std::mt19937 rng(1);
+  const int iterations = 10;
+
+  for (int persons : {1, 2, 5}) {
+    tests::SampledClips clips(rng, 100, persons, num_c, num_clips, clip_len,
+                              size);
+    // memset整个输出两边都有，单独计时以便扣除
+    double memsetMs = millisecondsPerCall(iterations, [&] {
+      std::fill(heatmap.begin(), heatmap.end(), 0.f);
+    });
+    double legacy = millisecondsPerCall(iterations, [&] {
+      tests::legacyPoseHeatmap(clips.keypoints, clips.scores, size, size,
+                               num_c, 1.f, heatmap.data(), out_num, 0.6f, 1.f,
+                               clip_len);
+    });
+    double current = millisecondsPerCall(iterations, [&] {
+      element::posec3d::generatePoseHeatmap(clips.keypoints, clips.scores,
+                                            size, size, num_c, 1.f,
+                                            heatmap.data(), out_num, 0.6f,
+                                            1.f, clip_len);
+    });
+    std::cout << persons << " persons: legacy " << legacy
+              << " ms/inference, generatePoseHeatmap " << current
+              << " ms/inference (output memset " << memsetMs << " ms)" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+// PP-OCR识别beam search后处理的性能对比：CtcBeamDecoder与原先逐步全排序词表、
+// 复制前缀的实现
+// 用法：ppocr_rec_beam_decoder_bench [logits.bin timeSteps numClasses]
+// logits.bin为rec模型输出的float32 softmax，按行(timeSteps * numClasses)连续存放；
+// 不指定时用随机生成的尖峰分布(40 * 6625)
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ppocr_rec_beam_decoder.h"
+
+namespace {
+
+using sophon_stream::element::ppocr_rec::CtcBeamDecoder;
+
+struct LegacyCandidate {
+  std::vector<int> prefix;
+  float score;
+  std::vector<float> confs;
+};
+
+// 原PpocrRecPostProcess::postProcess中beam_search分支的解码部分
+void legacyDecode(const float* probs, int timeSteps, int numClasses, int k,
+                  std::vector<int>& labels, std::vector<float>& confs) {
+  std::vector<LegacyCandidate> beams;
+  beams.push_back({{}, 1.0f, {}});
+  for (int t = 0; t < timeSteps; t++) {
+    std::vector<LegacyCandidate> newBeams;
+    std::vector<float> nextCharProbs;
+    for (int c = 0; c < numClasses; c++)
+      nextCharProbs.push_back(probs[t * numClasses + c]);
+    std::vector<int> top(nextCharProbs.size());
+    std::iota(top.begin(), top.end(), 0);
+    std::sort(top.begin(), top.end(), [&](int i, int j) {
+      return nextCharProbs[i] > nextCharProbs[j];
+    });
+    top.resize(k);
+    for (const LegacyCandidate& beam : beams) {
+      for (int c = 0; c < top.size(); c++) {
+        std::vector<int> prefix = beam.prefix;
+        prefix.push_back(top[c]);
+        std::vector<float> beamConfs = beam.confs;
+        beamConfs.push_back(nextCharProbs[top[c]]);
+        newBeams.push_back(
+            {prefix, beam.score * nextCharProbs[top[c]], beamConfs});
+      }
+    }
+    std::sort(newBeams.begin(), newBeams.end(),
+              [](const LegacyCandidate& a, const LegacyCandidate& b) {
+                return a.score > b.score;
+              });
+    newBeams.resize(k);
+    beams = newBeams;
+  }
+  labels.clear();
+  confs.clear();
+  const LegacyCandidate& best = beams[0];
+  int last = 0;
+  for (int i = 0; i < best.prefix.size(); ++i) {
+    if (best.prefix[i] != 0 && best.prefix[i] != last) {
+      labels.push_back(best.prefix[i]);
+      confs.push_back(best.confs[i]);
+    }
+    last = best.prefix[i];
+  }
+}
+
+std::vector<float> makeLogits(int rows, int timeSteps, int numClasses) {
+  // 每步一个类别占大部分概率，其余为小的随机值，接近真实rec输出
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> label(0, numClasses - 1);
+  std::uniform_real_distribution<float> noise(0.f, 1.f);
+  std::vector<float> probs(static_cast<std::size_t>(rows) * timeSteps *
+                           numClasses);
+  for (int r = 0; r < rows * timeSteps; ++r) {
+    float* row = probs.data() + static_cast<std::size_t>(r) * numClasses;
+    float sum = 0.f;
+    for (int c = 0; c < numClasses; ++c) sum += row[c] = noise(rng);
+    int peak = noise(rng) < 0.5f ? 0 : label(rng);
+    row[peak] += sum * 9.f;
+    sum *= 10.f;
+    for (int c = 0; c < numClasses; ++c) row[c] /= sum;
+  }
+  return probs;
+}
+
+template <typename F>
+double millisecondsPerRow(int rows, F&& decodeRow) {
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rows; ++r) decodeRow(r);
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / rows;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int timeSteps = 40, numClasses = 6625, rows = 50;
+  std::vector<float> probs;
+  if (argc == 4) {
+    timeSteps = std::atoi(argv[2]);
+    numClasses = std::atoi(argv[3]);
+    std::ifstream file(argv[1], std::ios::binary | std::ios::ate);
+    if (!file || timeSteps <= 0 || numClasses <= 0) {
+      std::cerr << "can not read " << argv[1] << std::endl;
+      return 1;
+    }
+    std::size_t count = file.tellg() / sizeof(float);
+    rows = count / (static_cast<std::size_t>(timeSteps) * numClasses);
+    if (rows == 0) {
+      std::cerr << argv[1] << " holds less than one row" << std::endl;
+      return 1;
+    }
+    probs.resize(static_cast<std::size_t>(rows) * timeSteps * numClasses);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(probs.data()),
+              probs.size() * sizeof(float));
+  } else if (argc == 1) {
+    probs = makeLogits(rows, timeSteps, numClasses);
+  } else {
+    std::cerr << "usage: " << argv[0] << " [logits.bin timeSteps numClasses]"
+              << std::endl;
+    return 1;
+  }
+
+  const std::size_t rowSize = static_cast<std::size_t>(timeSteps) * numClasses;
+  std::cout << rows << " rows, " << timeSteps << " steps, " << numClasses
+            << " classes" << std::endl;
+  for (int beamWidth : {3, 5, 10}) {
+    std::vector<int> labels;
+    std::vector<float> confs;
+    double legacy = millisecondsPerRow(rows, [&](int r) {
+      legacyDecode(probs.data() + r * rowSize, timeSteps, numClasses,
+                   beamWidth, labels, confs);
+    });
+    CtcBeamDecoder decoder(beamWidth, numClasses);
+    double current = millisecondsPerRow(rows, [&](int r) {
+      decoder.decode(probs.data() + r * rowSize, timeSteps, labels, confs);
+    });
+    std::cout << "beam_width " << beamWidth << ": legacy " << legacy
+              << " ms/row, CtcBeamDecoder " << current << " ms/row, speedup "
+              << legacy / current << "x" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "fastpose_pose_nms.h"
+
+#include <gtest/gtest.h>
+
+#include "fastpose_pose_nms_reference.h"
+
+namespace sophon_stream {
+namespace element {
+namespace fastpose {
+namespace {
+
+using tests::CrowdScene;
+using tests::LegacyPoseNMS;
+using tests::poseNMSParams;
+
+using Dets = std::vector<std::shared_ptr<common::DetectedObjectMetadata>>;
+using Poses = std::vector<std::shared_ptr<common::PosedObjectMetadata>>;
+
+std::shared_ptr<common::PosedObjectMetadata> makePose(int num_joints, float x,
+                                                      float y, float score) {
+  auto pose = std::make_shared<common::PosedObjectMetadata>();
+  for (int j = 0; j < num_joints; ++j) {
+    pose->keypoints.push_back(x + (j % 4) * 5.f);
+    pose->keypoints.push_back(y + (j / 4) * 10.f);
+    pose->scores.push_back(score);
+  }
+  return pose;
+}
+
+std::shared_ptr<common::DetectedObjectMetadata> makeDet(int w, int h) {
+  auto det = std::make_shared<common::DetectedObjectMetadata>();
+  det->mBox.mWidth = w;
+  det->mBox.mHeight = h;
+  return det;
+}
+
+/**
+ * @brief 在随机场景上比较poseNMS与原实现，保留的序号和改写后的关键点都要逐位相同
+ */
+void expectMatchesLegacy(int num_joints, int rounds, unsigned seed) {
+  bool full_body = num_joints == 136 || num_joints == 133;
+  PoseNMSParams params = poseNMSParams(full_body);
+  LegacyPoseNMS legacy(params);
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> persons(1, 12);
+  std::uniform_real_distribution<float> scene(100.f, 2000.f);
+  int kept = 0, suppressed = 0;
+  for (int round = 0; round < rounds; ++round) {
+    CrowdScene crowd(rng, persons(rng), 4, num_joints, scene(rng));
+    float area_thresh = round % 3 == 0 ? 0.f : 2000.f;
+    int num_samples = crowd.poses.size();
+
+    Poses expectedPoses = crowd.clonePoses();
+    std::vector<int> expectedIds;
+    legacy.poseNMS(crowd.dets, num_samples, num_joints, area_thresh,
+                   expectedPoses, expectedIds);
+
+    Poses poses = crowd.clonePoses();
+    std::vector<int> ids;
+    poseNMS(params, crowd.dets, num_samples, num_joints, area_thresh, poses,
+            ids);
+
+    ASSERT_EQ(ids, expectedIds) << "round " << round;
+    for (int i = 0; i < num_samples; ++i) {
+      ASSERT_EQ(poses[i]->keypoints, expectedPoses[i]->keypoints)
+          << "round " << round << " pose " << i;
+      ASSERT_EQ(poses[i]->scores, expectedPoses[i]->scores)
+          << "round " << round << " pose " << i;
+    }
+    kept += ids.size();
+    suppressed += num_samples - ids.size();
+  }
+  // 随机场景要同时覆盖保留和抑制
+  EXPECT_GT(kept, rounds);
+  EXPECT_GT(suppressed, rounds);
+}
+
+}  // namespace
+
+TEST(FastposePoseNMSTest, BodyMatchesLegacy) {
+  expectMatchesLegacy(17, 300, 1);
+}
+
+TEST(FastposePoseNMSTest, FullBody133MatchesLegacy) {
+  expectMatchesLegacy(133, 100, 2);
+}
+
+TEST(FastposePoseNMSTest, FullBody136MatchesLegacy) {
+  expectMatchesLegacy(136, 100, 3);
+}
+
+TEST(FastposePoseNMSTest, DuplicatesMergedDistantPoseKept) {
+  const int num_joints = 17;
+  Dets dets = {makeDet(40, 80), makeDet(40, 80), makeDet(40, 80)};
+  Poses poses = {makePose(num_joints, 10, 10, 0.9f),
+                 makePose(num_joints, 10, 10, 0.9f),
+                 makePose(num_joints, 500, 500, 0.8f)};
+  auto original = *poses[0];
+  std::vector<int> ids;
+  poseNMS(poseNMSParams(false), dets, 3, num_joints, 0.f, poses, ids);
+  EXPECT_EQ(ids, (std::vector<int>{0, 2}));
+  // 两个相同姿态合并后关键点不变，得分为归一化权重平方和乘以得分和
+  EXPECT_EQ(poses[0]->keypoints, original.keypoints);
+  for (float score : poses[0]->scores) EXPECT_FLOAT_EQ(score, 0.9f);
+}
+
+TEST(FastposePoseNMSTest, LowScoreAndSmallPosesDropped) {
+  const int num_joints = 17;
+  Dets dets = {makeDet(40, 80), makeDet(40, 80)};
+  // 第一个姿态所有关键点得分低于scoreThreds，第二个外接框面积为15 * 40
+  Poses poses = {makePose(num_joints, 10, 10, 0.1f),
+                 makePose(num_joints, 500, 500, 0.9f)};
+  std::vector<int> ids;
+  poseNMS(poseNMSParams(false), dets, 2, num_joints, 0.f, poses, ids);
+  EXPECT_EQ(ids, (std::vector<int>{1}));
+
+  ids.clear();
+  poses = {makePose(num_joints, 10, 10, 0.1f),
+           makePose(num_joints, 500, 500, 0.9f)};
+  poseNMS(poseNMSParams(false), dets, 2, num_joints, 1.5f * 1.5f * 600.f + 1,
+          poses, ids);
+  EXPECT_TRUE(ids.empty());
+}
+
+}  // namespace fastpose
+}  // namespace element
+}  // namespace sophon_stream
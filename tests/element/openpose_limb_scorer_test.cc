@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "openpose_limb_scorer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+namespace sophon_stream {
+namespace element {
+namespace openpose {
+namespace {
+
+using Connections = std::vector<std::tuple<double, int, int>>;
+
+/**
+ * @brief 原connectBodyPartsCpu中逐对打分的循环，作为逐位比较的基准
+ */
+Connections legacyScore(const float* candidateA, const float* candidateB,
+                        const float* mapX, const float* mapY, int width,
+                        int height, int interMinAboveThreshold,
+                        float interThreshold) {
+  Connections temp;
+  const auto numInter = 10;
+  const auto nA = intRound(candidateA[0]);
+  const auto nB = intRound(candidateB[0]);
+  for (auto i = 1; i <= nA; i++) {
+    for (auto j = 1; j <= nB; j++) {
+      const auto dX = candidateB[j * 3] - candidateA[i * 3];
+      const auto dY = candidateB[j * 3 + 1] - candidateA[i * 3 + 1];
+      const auto normVec = float(std::sqrt(dX * dX + dY * dY));
+      if (normVec > 1e-6) {
+        const auto sX = candidateA[i * 3];
+        const auto sY = candidateA[i * 3 + 1];
+        const auto vecX = dX / normVec;
+        const auto vecY = dY / normVec;
+        auto sum = 0.;
+        auto count = 0;
+        for (auto lm = 0; lm < numInter; lm++) {
+          const auto mX =
+              fastMin(width - 1, intRound(sX + lm * dX / numInter));
+          const auto mY =
+              fastMin(height - 1, intRound(sY + lm * dY / numInter));
+          const auto idx = mY * width + mX;
+          const auto score = (vecX * mapX[idx] + vecY * mapY[idx]);
+          if (score > interThreshold) {
+            sum += score;
+            count++;
+          }
+        }
+        if (count > interMinAboveThreshold)
+          temp.emplace_back(std::make_tuple(sum / count, i, j));
+      }
+    }
+  }
+  if (!temp.empty())
+    std::sort(temp.begin(), temp.end(),
+              std::greater<std::tuple<float, int, int>>());
+  return temp;
+}
+
+/**
+ * @brief 峰值数组：[0]为个数，之后每个峰值占(x, y, score)三个float，从下标3开始
+ */
+std::vector<float> makePeaks(const std::vector<std::pair<float, float>>& xy) {
+  std::vector<float> peaks(3 * (xy.size() + 1), 0.f);
+  peaks[0] = xy.size();
+  for (std::size_t i = 0; i < xy.size(); ++i) {
+    peaks[3 * (i + 1)] = xy[i].first;
+    peaks[3 * (i + 1) + 1] = xy[i].second;
+    peaks[3 * (i + 1) + 2] = 0.9f;
+  }
+  return peaks;
+}
+
+}  // namespace
+
+TEST(OpenposeLimbScorerTest, UniformFieldPrefersAlignedPairs) {
+  const int width = 16, height = 8;
+  // PAF全部指向+x
+  std::vector<float> mapX(width * height, 1.f), mapY(width * height, 0.f);
+  auto a = makePeaks({{1, 2}, {1, 5}});
+  auto b = makePeaks({{10, 2}, {2, 7}});
+  Connections connections;
+  scoreLimbCandidates(a.data(), b.data(), mapX.data(), mapY.data(), width,
+                      height, 8, 0.3f, connections);
+  // 得分为方向余弦：(1,2)->(10,2)为1，(1,5)->(10,2)约0.95，(1,5)->(2,7)约0.45，
+  // (1,2)->(2,7)约0.2低于阈值被拒
+  ASSERT_EQ(connections.size(), 3u);
+  EXPECT_EQ(connections[0], std::make_tuple(1.0, 1, 1));
+  EXPECT_EQ(std::get<1>(connections[1]), 2);
+  EXPECT_EQ(std::get<2>(connections[1]), 1);
+  EXPECT_NEAR(std::get<0>(connections[1]), 9 / std::sqrt(90.0), 1e-6);
+  EXPECT_EQ(std::get<1>(connections[2]), 2);
+  EXPECT_EQ(std::get<2>(connections[2]), 2);
+  EXPECT_NEAR(std::get<0>(connections[2]), 1 / std::sqrt(5.0), 1e-6);
+}
+
+TEST(OpenposeLimbScorerTest, CoincidentAndEmptyCandidatesAreSkipped) {
+  const int width = 8, height = 8;
+  std::vector<float> mapX(width * height, 1.f), mapY(width * height, 0.f);
+  auto a = makePeaks({{3, 3}});
+  auto same = makePeaks({{3, 3}});
+  auto none = makePeaks({});
+  Connections connections = {std::make_tuple(1.0, 1, 1)};
+  scoreLimbCandidates(a.data(), same.data(), mapX.data(), mapY.data(), width,
+                      height, 0, 0.f, connections);
+  EXPECT_TRUE(connections.empty());
+  scoreLimbCandidates(a.data(), none.data(), mapX.data(), mapY.data(), width,
+                      height, 0, 0.f, connections);
+  EXPECT_TRUE(connections.empty());
+}
+
+TEST(OpenposeLimbScorerTest, PairsLongerThanMaxLengthAreRejected) {
+  const int width = 32, height = 8;
+  std::vector<float> mapX(width * height, 1.f), mapY(width * height, 0.f);
+  auto a = makePeaks({{1, 2}});
+  // 距离分别为5、10、20
+  auto b = makePeaks({{6, 2}, {11, 2}, {21, 2}});
+  Connections connections;
+  scoreLimbCandidates(a.data(), b.data(), mapX.data(), mapY.data(), width,
+                      height, 8, 0.3f, connections, 10.f);
+  // 得分都是1，按降序排列时序号大的在前
+  EXPECT_EQ(connections, (Connections{std::make_tuple(1.0, 1, 2),
+                                      std::make_tuple(1.0, 1, 1)}));
+
+  // 不限制时三个组合都保留
+  scoreLimbCandidates(a.data(), b.data(), mapX.data(), mapY.data(), width,
+                      height, 8, 0.3f, connections, 0.f);
+  EXPECT_EQ(connections.size(), 3u);
+}
+
+TEST(OpenposeLimbScorerTest, MatchesLegacyScoringBitForBit) {
+  std::mt19937 rng(2024);
+  std::uniform_real_distribution<float> unit(-1.f, 1.f);
+  for (int round = 0; round < 300; ++round) {
+    const int width = 20 + round % 23, height = 15 + round % 17;
+    std::vector<float> mapX(width * height), mapY(width * height);
+    // 平滑的方向场加噪声，使得分散布在阈值两侧
+    float fx = unit(rng), fy = unit(rng);
+    for (int i = 0; i < width * height; ++i) {
+      mapX[i] = fx + 0.6f * unit(rng);
+      mapY[i] = fy + 0.6f * unit(rng);
+    }
+    std::uniform_real_distribution<float> px(0.f, width + 2.f);
+    std::uniform_real_distribution<float> py(0.f, height + 2.f);
+    auto randomPeaks = [&](int n) {
+      std::vector<std::pair<float, float>> xy;
+      for (int i = 0; i < n; ++i) xy.emplace_back(px(rng), py(rng));
+      // 偶尔放一个重合点
+      if (n > 0 && round % 7 == 0) xy.push_back(xy[0]);
+      return makePeaks(xy);
+    };
+    auto a = randomPeaks(round % 9);
+    auto b = randomPeaks((round / 3) % 9);
+    if (round % 5 == 0) b = a;
+
+    for (int minAbove : {0, 4, 8, 9, 10}) {
+      for (float threshold : {-0.2f, 0.05f, 0.3f}) {
+        Connections connections;
+        scoreLimbCandidates(a.data(), b.data(), mapX.data(), mapY.data(),
+                            width, height, minAbove, threshold, connections);
+        Connections expected =
+            legacyScore(a.data(), b.data(), mapX.data(), mapY.data(), width,
+                        height, minAbove, threshold);
+        ASSERT_EQ(connections, expected)
+            << "round " << round << " minAbove " << minAbove << " threshold "
+            << threshold;
+
+        // 距离上限只去掉过长的组合，其余组合的得分和顺序不变
+        const float maxLength = 0.5f * height;
+        scoreLimbCandidates(a.data(), b.data(), mapX.data(), mapY.data(),
+                            width, height, minAbove, threshold, connections,
+                            maxLength);
+        Connections shortOnly;
+        for (auto& c : expected) {
+          const float dX = b[std::get<2>(c) * 3] - a[std::get<1>(c) * 3];
+          const float dY =
+              b[std::get<2>(c) * 3 + 1] - a[std::get<1>(c) * 3 + 1];
+          if (dX * dX + dY * dY <= maxLength * maxLength)
+            shortOnly.push_back(c);
+        }
+        ASSERT_EQ(connections, shortOnly) << "round " << round;
+      }
+    }
+  }
+}
+
+}  // namespace openpose
+}  // namespace element
+}  // namespace sophon_stream
@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "openpose_peak_finder.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace sophon_stream {
+namespace element {
+namespace openpose {
+namespace {
+
+/**
+ * @brief 原nmsFunc中逐点比较、逐点加权的标量实现，作为对照基准
+ */
+std::vector<float> legacyPeaks(const float* ptr, int h, int w, int max_peaks,
+                               float threshold) {
+  std::vector<float> top(3 * (max_peaks + 1), 0.f);
+  int num_peaks = 0;
+  for (int y = 1; y < h - 1 && num_peaks != max_peaks; ++y) {
+    for (int x = 1; x < w - 1 && num_peaks != max_peaks; ++x) {
+      float value = ptr[y * w + x];
+      if (value > threshold && value > ptr[(y - 1) * w + x - 1] &&
+          value > ptr[(y - 1) * w + x] && value > ptr[(y - 1) * w + x + 1] &&
+          value > ptr[y * w + x - 1] && value > ptr[y * w + x + 1] &&
+          value > ptr[(y + 1) * w + x - 1] && value > ptr[(y + 1) * w + x] &&
+          value > ptr[(y + 1) * w + x + 1]) {
+        float xAcc = 0;
+        float yAcc = 0;
+        float scoreAcc = 0;
+        for (int kx = -3; kx <= 3; ++kx) {
+          int ux = x + kx;
+          if (ux < 0 || ux >= w) continue;
+          for (int ky = -3; ky <= 3; ++ky) {
+            int uy = y + ky;
+            if (uy < 0 || uy >= h) continue;
+            float score = ptr[uy * w + ux];
+            xAcc += ux * score;
+            yAcc += uy * score;
+            scoreAcc += score;
+          }
+        }
+        top[(num_peaks + 1) * 3 + 0] = xAcc / scoreAcc;
+        top[(num_peaks + 1) * 3 + 1] = yAcc / scoreAcc;
+        top[(num_peaks + 1) * 3 + 2] = value;
+        num_peaks++;
+      }
+    }
+  }
+  top[0] = num_peaks;
+  return top;
+}
+
+std::vector<float> findAll(const std::vector<float>& map, int h, int w,
+                           int maxPeaks, float threshold) {
+  std::vector<float> peaks(3 * (maxPeaks + 1), -1.f);
+  findPeaks(map.data(), peaks.data(), h, w, maxPeaks, threshold);
+  return peaks;
+}
+
+void expectSamePeaks(const std::vector<float>& expected,
+                     const std::vector<float>& actual) {
+  ASSERT_EQ(actual[0], expected[0]);
+  for (int i = 1; i <= static_cast<int>(expected[0]); ++i) {
+    // 向量化后求和顺序不同，亚像素坐标只有舍入误差
+    EXPECT_NEAR(actual[i * 3], expected[i * 3], 1e-4f) << "peak " << i;
+    EXPECT_NEAR(actual[i * 3 + 1], expected[i * 3 + 1], 1e-4f) << "peak " << i;
+    EXPECT_EQ(actual[i * 3 + 2], expected[i * 3 + 2]) << "peak " << i;
+  }
+}
+
+}  // namespace
+
+TEST(OpenposePeakFinderTest, SinglePeakIsRefinedToItsCentroid) {
+  const int h = 9, w = 11;
+  std::vector<float> map(h * w, 0.f);
+  map[4 * w + 5] = 1.f;
+  map[4 * w + 6] = 0.5f;
+  auto peaks = findAll(map, h, w, 4, 0.1f);
+  ASSERT_EQ(peaks[0], 1.f);
+  EXPECT_FLOAT_EQ(peaks[3], (5 * 1.f + 6 * 0.5f) / 1.5f);
+  EXPECT_FLOAT_EQ(peaks[4], 4.f);
+  EXPECT_EQ(peaks[5], 1.f);
+}
+
+TEST(OpenposePeakFinderTest, PlateausAndSubThresholdPointsAreNotPeaks) {
+  const int h = 5, w = 8;
+  std::vector<float> map(h * w, 0.f);
+  map[2 * w + 2] = map[2 * w + 3] = 0.9f;
+  map[2 * w + 6] = 0.05f;
+  EXPECT_EQ(findAll(map, h, w, 4, 0.1f)[0], 0.f);
+}
+
+TEST(OpenposePeakFinderTest, FindsPeaksInEveryTailColumn) {
+  // 行尾不足4个点时走补齐分支，每一列都要能找到峰值，最后一列不算
+  for (int w = 3; w <= 12; ++w) {
+    for (int x = 1; x < w; ++x) {
+      const int h = 3;
+      std::vector<float> map(h * w, 0.f);
+      map[w + x] = 1.f;
+      auto peaks = findAll(map, h, w, 4, 0.1f);
+      SCOPED_TRACE("w = " + std::to_string(w) + ", x = " + std::to_string(x));
+      if (x == w - 1) {
+        EXPECT_EQ(peaks[0], 0.f);
+        continue;
+      }
+      ASSERT_EQ(peaks[0], 1.f);
+      EXPECT_FLOAT_EQ(peaks[3], x);
+      EXPECT_FLOAT_EQ(peaks[4], 1.f);
+    }
+  }
+}
+
+TEST(OpenposePeakFinderTest, StopsAtMaxPeaksInRowMajorOrder) {
+  const int h = 7, w = 13;
+  std::vector<float> map(h * w, 0.f);
+  map[1 * w + 9] = 0.7f;
+  map[3 * w + 2] = 0.8f;
+  map[3 * w + 6] = 0.6f;
+  map[5 * w + 10] = 0.9f;
+  auto peaks = findAll(map, h, w, 3, 0.1f);
+  ASSERT_EQ(peaks[0], 3.f);
+  EXPECT_EQ(peaks[5], 0.7f);
+  EXPECT_EQ(peaks[8], 0.8f);
+  EXPECT_EQ(peaks[11], 0.6f);
+  expectSamePeaks(legacyPeaks(map.data(), h, w, 3, 0.1f), peaks);
+}
+
+TEST(OpenposePeakFinderTest, MatchesLegacyOnRandomHeatmaps) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> value(0.f, 1.f);
+  const int sizes[][2] = {{3, 3}, {4, 5}, {7, 9}, {23, 17}, {46, 82}, {61, 37}};
+  for (auto& size : sizes) {
+    const int h = size[0], w = size[1];
+    for (int trial = 0; trial < 20; ++trial) {
+      std::vector<float> map(h * w);
+      // 大部分点接近0，少数点随机抬高，模拟关键点热力图
+      for (auto& v : map)
+        v = value(rng) < 0.15f ? value(rng) : value(rng) * 0.05f;
+      const int maxPeaks = trial % 2 == 0 ? 96 : 5;
+      SCOPED_TRACE(std::to_string(h) + "x" + std::to_string(w));
+      expectSamePeaks(legacyPeaks(map.data(), h, w, maxPeaks, 0.1f),
+                      findAll(map, h, w, maxPeaks, 0.1f));
+    }
+  }
+}
+
+}  // namespace openpose
+}  // namespace element
+}  // namespace sophon_stream
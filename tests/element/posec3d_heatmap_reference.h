@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_TESTS_POSEC3D_HEATMAP_REFERENCE_H_
+#define SOPHON_STREAM_TESTS_POSEC3D_HEATMAP_REFERENCE_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <random>
+
+#include "posec3d_heatmap.h"
+
+namespace sophon_stream {
+namespace tests {
+
+using element::posec3d::fpptr_dim2;
+using element::posec3d::fpptr_dim3;
+
+/**
+ * @brief 原Posec3dPreProcess::generatePoseTarget的逐帧逐像素实现，
+ * 作为generatePoseHeatmap的对照；关键点先按scaling缩放到一份拷贝上
+ */
+inline void legacyPoseHeatmap(const fpptr_dim3& sampled_keypoints_in,
+                              const fpptr_dim3& sampled_keypoint_scores,
+                              int height, int width, int num_c,
+                              float input_scale, float* heatmap, int out_num,
+                              float sigma, float scaling, int clip_len) {
+  // 原实现原地缩放共享的关键点，这里对每个输入帧缩放一次拷贝
+  std::map<const fpptr_dim2*, std::shared_ptr<fpptr_dim2>> scaled;
+  fpptr_dim3 sampled_keypoints;
+  for (auto& frame : sampled_keypoints_in) {
+    auto& copy = scaled[frame.get()];
+    if (copy == nullptr) {
+      copy = std::make_shared<fpptr_dim2>();
+      for (auto& person : *frame) {
+        auto points = std::make_shared<std::vector<float>>(*person);
+        for (auto& v : *points) v *= scaling;
+        copy->push_back(points);
+      }
+    }
+    sampled_keypoints.push_back(copy);
+  }
+
+  const float eps = 1e-4;
+  int img_h = int(height * scaling + 0.5);
+  int img_w = int(width * scaling + 0.5);
+  int num_frame = sampled_keypoints.size();
+  float* data = heatmap;
+  memset((void*)data, 0, out_num * sizeof(float));
+  int heatmap_start_indx = out_num / 2;
+  for (int i = 0; i < num_frame; i++) {
+    for (int j = 0; j < num_c; j++) {
+      for (int person_id = 0; person_id < sampled_keypoints[i]->size();
+           person_id++) {
+        if (sampled_keypoint_scores[i]->at(person_id)->at(j) < eps) continue;
+
+        float mu_x = sampled_keypoints[i]->at(person_id)->at(j * 2);
+        float mu_y = sampled_keypoints[i]->at(person_id)->at(j * 2 + 1);
+
+        int st_x = std::max(int(mu_x - 3 * sigma), 0);
+        int ed_x = std::min(int(mu_x + 3 * sigma) + 1, img_w);
+        int st_y = std::max(int(mu_y - 3 * sigma), 0);
+        int ed_y = std::min(int(mu_y + 3 * sigma) + 1, img_h);
+        if (st_x >= ed_x || st_y >= ed_y) continue;
+
+        float* base = data + i / clip_len * num_c * clip_len * img_h * img_w +
+                      j * clip_len * img_h * img_w +
+                      i % clip_len * img_h * img_w;
+        for (int patch_x = st_x; patch_x < ed_x; patch_x++)
+          for (int patch_y = st_y; patch_y < ed_y; patch_y++) {
+            float value = exp(-(std::pow(patch_x - mu_x, 2) +
+                                std::pow(patch_y - mu_y, 2)) /
+                              2 / std::pow(sigma, 2)) *
+                          sampled_keypoint_scores[i]->at(person_id)->at(j);
+            value *= input_scale;
+            if (value > *(base + patch_y * img_w + patch_x)) {
+              *(base + patch_y * img_w + patch_x) = value;
+              *(base + patch_y * img_w + patch_x + heatmap_start_indx) = value;
+            }
+          }
+      }
+    }
+  }
+}
+
+/**
+ * @brief 随机生成num_frames个输入帧的关键点，再按clip重复引用这些帧，
+ * 与uniformSampleFrames的输出结构相同
+ */
+struct SampledClips {
+  fpptr_dim3 keypoints;
+  fpptr_dim3 scores;
+
+  SampledClips(std::mt19937& rng, int num_frames, int num_persons, int num_c,
+               int num_clips, int clip_len, float extent) {
+    std::uniform_real_distribution<float> coord(-2.f, extent + 2.f);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    fpptr_dim3 frames, frameScores;
+    for (int f = 0; f < num_frames; ++f) {
+      auto persons = std::make_shared<fpptr_dim2>();
+      auto personScores = std::make_shared<fpptr_dim2>();
+      for (int p = 0; p < num_persons; ++p) {
+        auto points = std::make_shared<std::vector<float>>();
+        auto conf = std::make_shared<std::vector<float>>();
+        for (int j = 0; j < num_c; ++j) {
+          points->push_back(coord(rng));
+          points->push_back(coord(rng));
+          // 少量关键点置信度为0，应被跳过
+          conf->push_back(unit(rng) < 0.1f ? 0.f : unit(rng));
+        }
+        persons->push_back(points);
+        personScores->push_back(conf);
+      }
+      frames.push_back(persons);
+      frameScores.push_back(personScores);
+    }
+    for (int c = 0; c < num_clips; ++c) {
+      for (int t = 0; t < clip_len; ++t) {
+        int f = (c * num_frames / num_clips + t) % num_frames;
+        keypoints.push_back(frames[f]);
+        scores.push_back(frameScores[f]);
+      }
+    }
+  }
+};
+
+}  // namespace tests
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_TESTS_POSEC3D_HEATMAP_REFERENCE_H_
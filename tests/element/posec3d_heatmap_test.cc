@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "posec3d_heatmap.h"
+
+#include <gtest/gtest.h>
+
+#include "posec3d_heatmap_reference.h"
+
+namespace sophon_stream {
+namespace element {
+namespace posec3d {
+namespace {
+
+using tests::SampledClips;
+
+int heatmapSize(int num_clips, int num_c, int clip_len, int h, int w) {
+  // 前后两半
+  return 2 * num_clips * num_c * clip_len * h * w;
+}
+
+}  // namespace
+
+TEST(Posec3dHeatmapTest, SingleKeypointGaussian) {
+  const int size = 16, num_c = 2, clip_len = 1;
+  auto persons = std::make_shared<fpptr_dim2>();
+  persons->push_back(
+      std::make_shared<std::vector<float>>(std::vector<float>{5, 6, 0, 0}));
+  auto scores = std::make_shared<fpptr_dim2>();
+  scores->push_back(
+      std::make_shared<std::vector<float>>(std::vector<float>{0.5f, 0.f}));
+  fpptr_dim3 keypoints = {persons}, keypointScores = {scores};
+
+  const int out_num = heatmapSize(1, num_c, clip_len, size, size);
+  std::vector<float> heatmap(out_num, -1.f);
+  generatePoseHeatmap(keypoints, keypointScores, size, size, num_c, 2.f,
+                      heatmap.data(), out_num, 0.6f, 1.f, clip_len);
+
+  auto at = [&](int c, int x, int y) {
+    return heatmap[c * size * size + y * size + x];
+  };
+  // 峰值为score * input_scale，相邻像素衰减exp(-1 / (2 * 0.36))
+  EXPECT_FLOAT_EQ(at(0, 5, 6), 1.f);
+  EXPECT_NEAR(at(0, 6, 6), std::exp(-1 / 0.72f), 1e-6);
+  EXPECT_NEAR(at(0, 4, 7), std::exp(-2 / 0.72f), 1e-6);
+  // 覆盖范围为mu ± 3 * sigma取整
+  EXPECT_GT(at(0, 3, 6), 0.f);
+  EXPECT_EQ(at(0, 2, 6), 0.f);
+  EXPECT_EQ(at(0, 5, 9), 0.f);
+  // 置信度为0的关键点不画
+  for (int i = 0; i < size * size; ++i) EXPECT_EQ(heatmap[size * size + i], 0.f);
+  // 后半与前半相同
+  for (int i = 0; i < out_num / 2; ++i)
+    ASSERT_EQ(heatmap[i], heatmap[out_num / 2 + i]);
+}
+
+TEST(Posec3dHeatmapTest, DoesNotModifyKeypoints) {
+  std::mt19937 rng(3);
+  SampledClips clips(rng, 5, 2, 17, 2, 4, 32);
+  std::vector<std::vector<float>> before;
+  for (auto& person : *clips.keypoints[0]) before.push_back(*person);
+  const int out_num = heatmapSize(2, 17, 4, 32, 32) * 4;
+  std::vector<float> heatmap(out_num);
+  generatePoseHeatmap(clips.keypoints, clips.scores, 32, 32, 17, 1.f,
+                      heatmap.data(), out_num, 0.6f, 2.f, 4);
+  for (std::size_t p = 0; p < before.size(); ++p)
+    EXPECT_EQ(*clips.keypoints[0]->at(p), before[p]);
+}
+
+TEST(Posec3dHeatmapTest, MatchesLegacyImplementation) {
+  std::mt19937 rng(42);
+  for (float scaling : {1.f, 0.5f}) {
+    for (int round = 0; round < 6; ++round) {
+      const int num_clips = 3, clip_len = 8, num_c = 17, size = 32;
+      const int scaled = int(size * scaling + 0.5);
+      SampledClips clips(rng, 10 + round, 1 + round % 3, num_c, num_clips,
+                         clip_len, size);
+      const int out_num =
+          heatmapSize(num_clips, num_c, clip_len, scaled, scaled);
+      std::vector<float> heatmap(out_num, -1.f), expected(out_num, -1.f);
+      const float input_scale = round % 2 ? 1.f : 0.37f;
+      generatePoseHeatmap(clips.keypoints, clips.scores, size, size, num_c,
+                          input_scale, heatmap.data(), out_num, 0.6f, scaling,
+                          clip_len);
+      tests::legacyPoseHeatmap(clips.keypoints, clips.scores, size, size,
+                               num_c, input_scale, expected.data(), out_num,
+                               0.6f, scaling, clip_len);
+      // 可分离计算与原来的exp/pow只差浮点舍入
+      for (int i = 0; i < out_num; ++i)
+        ASSERT_NEAR(heatmap[i], expected[i], 1e-6)
+            << "index " << i << " scaling " << scaling << " round " << round;
+    }
+  }
+}
+
+}  // namespace posec3d
+}  // namespace element
+}  // namespace sophon_stream
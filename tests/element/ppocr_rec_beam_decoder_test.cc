@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ppocr_rec_beam_decoder.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+
+namespace sophon_stream {
+namespace element {
+namespace ppocr_rec {
+namespace {
+
+using Labels = std::vector<int>;
+
+std::vector<float> randomSoftmax(std::mt19937& rng, int timeSteps,
+                                 int numClasses) {
+  std::uniform_real_distribution<float> dist(0.f, 4.f);
+  std::vector<float> probs(timeSteps * numClasses);
+  for (int t = 0; t < timeSteps; ++t) {
+    float sum = 0.f;
+    for (int c = 0; c < numClasses; ++c)
+      sum += probs[t * numClasses + c] = std::exp(dist(rng));
+    for (int c = 0; c < numClasses; ++c) probs[t * numClasses + c] /= sum;
+  }
+  return probs;
+}
+
+/**
+ * @brief 枚举所有路径，按CTC折叠后的标签序列累加概率，返回概率最大的序列
+ */
+Labels bruteForceBest(const std::vector<float>& probs, int timeSteps,
+                      int numClasses) {
+  std::map<Labels, double> labelings;
+  std::vector<int> path(timeSteps, 0);
+  while (true) {
+    double p = 1.0;
+    Labels labels;
+    int last = 0;
+    for (int t = 0; t < timeSteps; ++t) {
+      p *= probs[t * numClasses + path[t]];
+      if (path[t] != 0 && path[t] != last) labels.push_back(path[t]);
+      last = path[t];
+    }
+    labelings[labels] += p;
+    int t = 0;
+    while (t < timeSteps && ++path[t] == numClasses) path[t++] = 0;
+    if (t == timeSteps) break;
+  }
+  auto best = labelings.begin();
+  for (auto it = labelings.begin(); it != labelings.end(); ++it)
+    if (it->second > best->second) best = it;
+  return best->first;
+}
+
+}  // namespace
+
+TEST(CtcBeamDecoderTest, PrefersLabelingOverBestPath) {
+  // 最优路径是两个blank(0.36)，但"a"的三条路径合计0.64
+  std::vector<float> probs = {0.6f, 0.4f,  //
+                              0.6f, 0.4f};
+  CtcBeamDecoder decoder(2, 2);
+  Labels labels;
+  std::vector<float> confs;
+  decoder.decode(probs.data(), 2, labels, confs);
+  EXPECT_EQ(labels, (Labels{1}));
+  ASSERT_EQ(confs.size(), 1u);
+  EXPECT_FLOAT_EQ(confs[0], 0.4f);
+}
+
+TEST(CtcBeamDecoderTest, CollapsesRepeatsAndKeepsBlankSeparatedRepeats) {
+  // 逐帧取最大："a a - a b b" -> "a a b"
+  const int numClasses = 3;
+  std::vector<int> path = {1, 1, 0, 1, 2, 2};
+  std::vector<float> probs;
+  for (int label : path)
+    for (int c = 0; c < numClasses; ++c)
+      probs.push_back(c == label ? 0.98f : 0.01f);
+  CtcBeamDecoder decoder(3, numClasses);
+  Labels labels;
+  std::vector<float> confs;
+  decoder.decode(probs.data(), path.size(), labels, confs);
+  EXPECT_EQ(labels, (Labels{1, 1, 2}));
+  EXPECT_EQ(confs.size(), labels.size());
+}
+
+TEST(CtcBeamDecoderTest, WideBeamMatchesExhaustiveSearch) {
+  std::mt19937 rng(7);
+  const int timeSteps = 5, numClasses = 3;
+  // beam宽度不小于前缀总数时前缀beam search是精确的
+  CtcBeamDecoder decoder(64, numClasses);
+  for (int round = 0; round < 200; ++round) {
+    auto probs = randomSoftmax(rng, timeSteps, numClasses);
+    Labels labels;
+    std::vector<float> confs;
+    decoder.decode(probs.data(), timeSteps, labels, confs);
+    ASSERT_EQ(labels, bruteForceBest(probs, timeSteps, numClasses))
+        << "round " << round;
+  }
+}
+
+TEST(CtcBeamDecoderTest, DecoderIsReusableAcrossRows) {
+  std::mt19937 rng(11);
+  const int timeSteps = 20, numClasses = 50;
+  auto first = randomSoftmax(rng, timeSteps, numClasses);
+  auto second = randomSoftmax(rng, timeSteps, numClasses);
+  Labels expected, labels;
+  std::vector<float> expectedConfs, confs;
+  CtcBeamDecoder(5, numClasses)
+      .decode(second.data(), timeSteps, expected, expectedConfs);
+
+  CtcBeamDecoder decoder(5, numClasses);
+  decoder.decode(first.data(), timeSteps, labels, confs);
+  decoder.decode(second.data(), timeSteps, labels, confs);
+  EXPECT_EQ(labels, expected);
+  EXPECT_EQ(confs, expectedConfs);
+}
+
+TEST(CtcBeamDecoderTest, BeamWiderThanVocabulary) {
+  std::vector<float> probs = {0.1f, 0.9f,  //
+                              0.8f, 0.2f,  //
+                              0.1f, 0.9f};
+  CtcBeamDecoder decoder(10, 2);
+  Labels labels;
+  std::vector<float> confs;
+  decoder.decode(probs.data(), 3, labels, confs);
+  EXPECT_EQ(labels, (Labels{1, 1}));
+}
+
+TEST(CtcBeamDecoderTest, EmptyInputDecodesToNothing) {
+  CtcBeamDecoder decoder(3, 4);
+  Labels labels = {1};
+  std::vector<float> confs = {1.f};
+  decoder.decode(nullptr, 0, labels, confs);
+  EXPECT_TRUE(labels.empty());
+  EXPECT_TRUE(confs.empty());
+}
+
+TEST(CtcBeamDecoderDeathTest, RejectsNonPositiveBeamWidth) {
+  EXPECT_EXIT(CtcBeamDecoder(0, 10), ::testing::ExitedWithCode(1),
+              "beam width");
+  EXPECT_EXIT(CtcBeamDecoder(3, 0), ::testing::ExitedWithCode(1),
+              "class number");
+}
+
+}  // namespace ppocr_rec
+}  // namespace element
+}  // namespace sophon_stream
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ppocr_rec_buckets.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace sophon_stream {
+namespace element {
+namespace ppocr_rec {
+namespace {
+
+using Chunks = std::vector<std::pair<int, int>>;
+
+// 常见的多stage识别模型：宽320和640，各有batch 1/4/8或1/4
+const std::vector<RecStageShape> kStages = {
+    {1, 320}, {4, 320}, {8, 320}, {1, 640}, {4, 640}};
+
+struct WidthTable {
+  std::vector<RecModelSize> img_size;
+  std::vector<float> img_ratio;
+
+  explicit WidthTable(std::vector<RecModelSize> sizes) : img_size(sizes) {
+    for (auto& s : img_size) img_ratio.push_back((float)s.w / (float)s.h);
+  }
+};
+
+}  // namespace
+
+TEST(PpocrRecBucketsTest, PickWidthBucketNarrowestThatFits) {
+  WidthTable table({{320, 48}, {640, 48}});
+  int resize_w;
+  EXPECT_EQ(pickWidthBucket(table.img_size, table.img_ratio, 100, 48,
+                            resize_w),
+            0);
+  EXPECT_EQ(resize_w, 100);
+  // 宽高比恰好等于stage宽高比时放进该stage，不做padding
+  EXPECT_EQ(pickWidthBucket(table.img_size, table.img_ratio, 320, 48,
+                            resize_w),
+            0);
+  EXPECT_EQ(resize_w, 320);
+  EXPECT_EQ(pickWidthBucket(table.img_size, table.img_ratio, 330, 48,
+                            resize_w),
+            1);
+  EXPECT_EQ(resize_w, 330);
+  // 高度不同时按stage高度缩放
+  EXPECT_EQ(pickWidthBucket(table.img_size, table.img_ratio, 200, 96,
+                            resize_w),
+            0);
+  EXPECT_EQ(resize_w, 100);
+}
+
+TEST(PpocrRecBucketsTest, PickWidthBucketTooWideUsesWidestStage) {
+  WidthTable table({{320, 48}, {640, 48}});
+  int resize_w;
+  EXPECT_EQ(pickWidthBucket(table.img_size, table.img_ratio, 2000, 48,
+                            resize_w),
+            1);
+  EXPECT_EQ(resize_w, 640);
+
+  WidthTable single({{320, 48}});
+  EXPECT_EQ(pickWidthBucket(single.img_size, single.img_ratio, 2000, 48,
+                            resize_w),
+            0);
+  EXPECT_EQ(resize_w, 320);
+}
+
+TEST(PpocrRecBucketsTest, PickStageSmallestBatchThatHoldsCount) {
+  EXPECT_EQ(pickStage(kStages, 320, 1), 0);
+  EXPECT_EQ(pickStage(kStages, 320, 2), 1);
+  EXPECT_EQ(pickStage(kStages, 320, 4), 1);
+  EXPECT_EQ(pickStage(kStages, 320, 5), 2);
+  EXPECT_EQ(pickStage(kStages, 320, 8), 2);
+  EXPECT_EQ(pickStage(kStages, 640, 1), 3);
+  EXPECT_EQ(pickStage(kStages, 640, 3), 4);
+}
+
+TEST(PpocrRecBucketsTest, PickStageLargestBatchWhenNothingHoldsCount) {
+  EXPECT_EQ(pickStage(kStages, 320, 9), 2);
+  EXPECT_EQ(pickStage(kStages, 640, 100), 4);
+}
+
+TEST(PpocrRecBucketsTest, PickStageIgnoresStageOrder) {
+  const std::vector<RecStageShape> shuffled = {
+      {8, 320}, {4, 640}, {1, 320}, {1, 640}, {4, 320}};
+  EXPECT_EQ(pickStage(shuffled, 320, 3), 4);
+  EXPECT_EQ(pickStage(shuffled, 320, 1), 2);
+  EXPECT_EQ(pickStage(shuffled, 320, 20), 0);
+  EXPECT_EQ(pickStage(shuffled, 640, 2), 1);
+}
+
+TEST(PpocrRecBucketsTest, PickStageUnknownWidthExits) {
+  EXPECT_EXIT(pickStage(kStages, 480, 1), ::testing::ExitedWithCode(1),
+              "width 480");
+}
+
+TEST(PpocrRecBucketsTest, SplitBucketChunksByLargestThenFits) {
+  Chunks chunks;
+  splitBucket(kStages, 320, 21, chunks);
+  EXPECT_EQ(chunks, (Chunks{{2, 8}, {2, 8}, {2, 5}}));
+  splitBucket(kStages, 320, 19, chunks);
+  EXPECT_EQ(chunks, (Chunks{{2, 8}, {2, 8}, {1, 3}}));
+  splitBucket(kStages, 640, 9, chunks);
+  EXPECT_EQ(chunks, (Chunks{{4, 4}, {4, 4}, {3, 1}}));
+  splitBucket(kStages, 320, 0, chunks);
+  EXPECT_TRUE(chunks.empty());
+}
+
+TEST(PpocrRecBucketsTest, SplitBucketCoversEveryCropOnce) {
+  // 随机的stage组合：每个chunk都落在该宽度的stage上、不超过stage的batch，
+  // 只有最后一个chunk可以不满，前面的chunk都用该宽度最大的batch
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int> batch(1, 16);
+  for (int round = 0; round < 200; ++round) {
+    std::vector<RecStageShape> stages;
+    int num_stages = 1 + round % 6;
+    for (int s = 0; s < num_stages; ++s)
+      stages.push_back({batch(rng), s % 2 ? 640 : 320});
+    int max_batch = 0;
+    for (auto& s : stages)
+      if (s.width == 320) max_batch = std::max(max_batch, s.batch);
+
+    int count = rng() % 64;
+    Chunks chunks;
+    splitBucket(stages, 320, count, chunks);
+    int covered = 0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      const RecStageShape& stage = stages[chunks[i].first];
+      ASSERT_EQ(stage.width, 320);
+      ASSERT_GT(chunks[i].second, 0);
+      ASSERT_LE(chunks[i].second, stage.batch);
+      if (i + 1 < chunks.size()) {
+        ASSERT_EQ(chunks[i].second, max_batch);
+      }
+      covered += chunks[i].second;
+    }
+    ASSERT_EQ(covered, count);
+    if (!chunks.empty()) {
+      // 最后一个chunk选能放下剩余文字框的最小batch
+      int rest = chunks.back().second;
+      for (auto& s : stages) {
+        if (s.width == 320 && s.batch >= rest) {
+          ASSERT_LE(stages[chunks.back().first].batch, s.batch);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace ppocr_rec
+}  // namespace element
+}  // namespace sophon_stream
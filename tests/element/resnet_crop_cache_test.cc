@@ -0,0 +1,286 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "resnet_crop_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <functional>
+
+#include "common/batch_tensors.h"
+#include "common/device_mem_pool.h"
+
+namespace sophon_stream {
+namespace element {
+namespace resnet {
+namespace {
+
+CropKey makeKey() {
+  CropKey key;
+  key.deviceId = 0;
+  key.graphId = 0;
+  key.channelId = 3;
+  key.generation = 1;
+  key.frameId = 100;
+  key.subId = 2;
+  key.cropX = 40;
+  key.cropY = 60;
+  key.cropW = 64;
+  key.cropH = 128;
+  key.netW = 224;
+  key.netH = 224;
+  key.format = 0;
+  key.dtype = 0;
+  key.roiX = key.roiY = key.roiW = key.roiH = -1;
+  for (int i = 0; i < 3; ++i) {
+    key.alpha[i] = 1.f / 58.f;
+    key.beta[i] = -2.f;
+  }
+  return key;
+}
+
+bool sameKey(const CropKey& a, const CropKey& b) {
+  return !(a < b) && !(b < a);
+}
+
+ResNetCropCache::DeviceMemPtr makeMem(unsigned long long addr) {
+  auto mem = std::make_shared<bm_device_mem_t>();
+  mem->u.device.device_addr = addr;
+  return mem;
+}
+
+}  // namespace
+
+TEST(ResNetCropCacheTest, EveryFieldTakesPartInTheKey) {
+  const CropKey base = makeKey();
+  EXPECT_TRUE(sameKey(base, makeKey()));
+
+  std::vector<std::function<void(CropKey&)>> edits = {
+      [](CropKey& k) { k.deviceId = 1; },
+      [](CropKey& k) { k.graphId = 1; },
+      [](CropKey& k) { k.channelId = 4; },
+      [](CropKey& k) { k.generation = 2; },
+      [](CropKey& k) { k.frameId = 101; },
+      [](CropKey& k) { k.subId = 3; },
+      [](CropKey& k) { k.cropX = 41; },
+      [](CropKey& k) { k.cropY = 61; },
+      [](CropKey& k) { k.cropW = 65; },
+      [](CropKey& k) { k.cropH = 129; },
+      [](CropKey& k) { k.netW = 112; },
+      [](CropKey& k) { k.netH = 112; },
+      [](CropKey& k) { k.format = 1; },
+      [](CropKey& k) { k.dtype = 1; },
+      [](CropKey& k) { k.roiX = 0; },
+      [](CropKey& k) { k.roiY = 0; },
+      [](CropKey& k) { k.roiW = 10; },
+      [](CropKey& k) { k.roiH = 10; },
+      [](CropKey& k) { k.alpha[2] = 1.f; },
+      [](CropKey& k) { k.beta[0] = 0.f; },
+  };
+  ResNetCropCache cache;
+  cache.reserve(static_cast<int>(edits.size()) + 1);
+  cache.put(base, makeMem(1));
+  for (std::size_t i = 0; i < edits.size(); ++i) {
+    CropKey key = makeKey();
+    edits[i](key);
+    EXPECT_FALSE(sameKey(base, key)) << "edit " << i;
+    EXPECT_EQ(cache.get(key), nullptr) << "edit " << i;
+    cache.put(key, makeMem(i + 2));
+  }
+  // 所有key都能同时存在，互不覆盖
+  for (std::size_t i = 0; i < edits.size(); ++i) {
+    CropKey key = makeKey();
+    edits[i](key);
+    ASSERT_NE(cache.get(key), nullptr) << "edit " << i;
+    EXPECT_EQ(cache.get(key)->u.device.device_addr, i + 2) << "edit " << i;
+  }
+  EXPECT_EQ(cache.get(base)->u.device.device_addr, 1u);
+}
+
+TEST(ResNetCropCacheTest, SameSizedBoxesAtDifferentPlacesDoNotCollide) {
+  ResNetCropCache cache;
+  cache.reserve(4);
+  CropKey left = makeKey();
+  CropKey right = makeKey();
+  right.cropX += 200;
+  cache.put(left, makeMem(1));
+  EXPECT_EQ(cache.get(right), nullptr);
+  cache.put(right, makeMem(2));
+  EXPECT_EQ(cache.get(left)->u.device.device_addr, 1u);
+  EXPECT_EQ(cache.get(right)->u.device.device_addr, 2u);
+}
+
+TEST(ResNetCropCacheTest, ZeroCapacityDisablesCaching) {
+  ResNetCropCache cache;
+  EXPECT_EQ(cache.getCapacity(), 0);
+  cache.put(makeKey(), makeMem(1));
+  EXPECT_EQ(cache.get(makeKey()), nullptr);
+  EXPECT_EQ(cache.getMisses(), 1u);
+  EXPECT_EQ(cache.getHits(), 0u);
+}
+
+TEST(ResNetCropCacheTest, CapacityOnlyGrows) {
+  ResNetCropCache cache;
+  cache.reserve(8);
+  cache.reserve(2);
+  cache.reserve(0);
+  EXPECT_EQ(cache.getCapacity(), 8);
+}
+
+TEST(ResNetCropCacheTest, EvictsInInsertionOrder) {
+  ResNetCropCache cache;
+  cache.reserve(3);
+  auto keyOf = [](int frameId) {
+    CropKey key = makeKey();
+    key.frameId = frameId;
+    return key;
+  };
+  for (int i = 0; i < 3; ++i) cache.put(keyOf(i), makeMem(i + 1));
+  // 命中和重复put都不改变顺序，最早插入的0仍然先被淘汰
+  EXPECT_NE(cache.get(keyOf(0)), nullptr);
+  cache.put(keyOf(0), makeMem(99));
+  EXPECT_EQ(cache.get(keyOf(0))->u.device.device_addr, 1u);
+
+  cache.put(keyOf(3), makeMem(4));
+  EXPECT_EQ(cache.get(keyOf(0)), nullptr);
+  EXPECT_NE(cache.get(keyOf(1)), nullptr);
+  cache.put(keyOf(4), makeMem(5));
+  EXPECT_EQ(cache.get(keyOf(1)), nullptr);
+  for (int i = 2; i < 5; ++i) EXPECT_NE(cache.get(keyOf(i)), nullptr);
+  EXPECT_EQ(cache.getHits(), 6u);
+  EXPECT_EQ(cache.getMisses(), 2u);
+}
+
+TEST(ResNetCropCacheTest, EvictedMemoryLivesWhileInUse) {
+  ResNetCropCache cache;
+  cache.reserve(1);
+  int freed = 0;
+  ResNetCropCache::DeviceMemPtr mem(new bm_device_mem_t(),
+                                    [&freed](bm_device_mem_t* p) {
+                                      ++freed;
+                                      delete p;
+                                    });
+  CropKey first = makeKey();
+  cache.put(first, mem);
+  auto user = cache.get(first);
+  mem.reset();
+  CropKey second = makeKey();
+  second.subId = 9;
+  cache.put(second, makeMem(2));
+  EXPECT_EQ(cache.get(first), nullptr);
+  // 淘汰后仍在使用的显存由最后一个使用者释放
+  EXPECT_EQ(freed, 0);
+  user.reset();
+  EXPECT_EQ(freed, 1);
+}
+
+namespace {
+
+struct HostAllocator {
+  bool alloc(std::size_t bytes, bm_device_mem_t* mem) {
+    *mem = bm_device_mem_t();
+    mem->u.device.device_addr =
+        reinterpret_cast<unsigned long long>(std::calloc(bytes, 1));
+    mem->size = bytes;
+    return true;
+  }
+  void free(bm_device_mem_t mem) {
+    std::free(reinterpret_cast<void*>(mem.u.device.device_addr));
+  }
+};
+
+// PCIe模式下输出都是视图，不应调用任何显存操作
+struct NoDeviceOps {
+  static bm_status_t alloc(bm_handle_t, bm_device_mem_t*, int, unsigned int) {
+    ADD_FAILURE() << "unexpected alloc";
+    return BM_ERR_FAILURE;
+  }
+  static void free(bm_handle_t, bm_device_mem_t) {
+    ADD_FAILURE() << "unexpected free";
+  }
+  static bm_status_t copy(bm_handle_t, bm_device_mem_t, std::size_t,
+                          bm_device_mem_t, std::size_t, std::size_t) {
+    ADD_FAILURE() << "unexpected copy";
+    return BM_ERR_FAILURE;
+  }
+};
+
+using HostMemPool = common::BasicDeviceMemPool<HostAllocator>;
+
+std::vector<common::BatchTensorLayout> headLayout(int maxBatch, int classes) {
+  std::vector<common::BatchTensorLayout> layouts(1);
+  layouts[0].dtype = BM_FLOAT32;
+  layouts[0].shape = {2, {maxBatch, classes}};
+  layouts[0].bytes = maxBatch * classes * sizeof(float);
+  return layouts;
+}
+
+std::shared_ptr<common::bmTensors> forwardHead(
+    const std::shared_ptr<HostMemPool>& pool,
+    const std::vector<common::BatchTensorLayout>& layouts) {
+  auto outputs = pool->makeTensors(nullptr, 1);
+  EXPECT_TRUE(
+      pool->acquire(layouts[0].bytes, &outputs->tensors[0]->device_mem));
+  return outputs;
+}
+
+}  // namespace
+
+TEST(ResNetCropCacheTest, HeadsSplitTheirOwnOutputs) {
+  const int kMaxBatch = 4;
+  auto pool = std::make_shared<HostMemPool>(HostAllocator{});
+  common::ObjectMetadatas objects;
+  for (int i = 0; i < 3; ++i) {
+    auto obj = std::make_shared<common::ObjectMetadata>();
+    obj->mFrame = std::make_shared<common::Frame>();
+    objects.push_back(obj);
+  }
+  objects[2]->mFrame->mEndOfStream = true;
+
+  // 与ResNetMultiTask::multiTask相同：各head依次推理，每次推理后重新拆分
+  auto attrLayout = headLayout(kMaxBatch, 10);
+  auto colorLayout = headLayout(kMaxBatch, 7);
+  auto attr = forwardHead(pool, attrLayout);
+  common::splitBatchOutputs<NoDeviceOps>(pool, nullptr, attrLayout, kMaxBatch,
+                                         false, objects, attr);
+  for (int i = 0; i < 2; ++i) {
+    auto& tensor = objects[i]->mOutputBMtensors->tensors[0];
+    EXPECT_EQ(bm_mem_get_device_addr(tensor->device_mem),
+              bm_mem_get_device_addr(attr->tensors[0]->device_mem) +
+                  i * 10 * sizeof(float));
+    EXPECT_EQ(tensor->shape.dims[0], 1);
+    EXPECT_EQ(tensor->shape.dims[1], 10);
+  }
+  // EOS之后的目标不拆分
+  EXPECT_EQ(objects[2]->mOutputBMtensors, nullptr);
+
+  auto color = forwardHead(pool, colorLayout);
+  common::splitBatchOutputs<NoDeviceOps>(pool, nullptr, colorLayout, kMaxBatch,
+                                         false, objects, color);
+  for (int i = 0; i < 2; ++i) {
+    auto& outputs = objects[i]->mOutputBMtensors;
+    EXPECT_EQ(outputs->batch, color);
+    EXPECT_EQ(bm_mem_get_device_addr(outputs->tensors[0]->device_mem),
+              bm_mem_get_device_addr(color->tensors[0]->device_mem) +
+                  i * 7 * sizeof(float));
+    EXPECT_EQ(outputs->tensors[0]->shape.dims[1], 7);
+  }
+
+  // 上一个head的输出不再被引用，立即还给显存池
+  attr.reset();
+  EXPECT_EQ(pool->getStats().inUseBytes, colorLayout[0].bytes);
+  color.reset();
+  objects.clear();
+  EXPECT_EQ(pool->getStats().inUseBytes, 0u);
+}
+
+}  // namespace resnet
+}  // namespace element
+}  // namespace sophon_stream
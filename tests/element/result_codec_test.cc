@@ -0,0 +1,334 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "result_codec.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "httplib.h"
+
+namespace sophon_stream {
+namespace element {
+namespace http_push {
+namespace {
+
+/**
+ * @brief 按README中的格式解码，与tools/web-server/result_receiver.py一致
+ */
+class Reader {
+ public:
+  explicit Reader(const std::string& data) : mData(data) {}
+
+  template <typename T>
+  T take() {
+    T value;
+    EXPECT_LE(mPos + sizeof(T), mData.size());
+    std::memcpy(&value, mData.data() + mPos, sizeof(T));
+    mPos += sizeof(T);
+    return value;
+  }
+
+  template <typename T>
+  std::vector<T> takeList() {
+    std::vector<T> values(take<std::uint32_t>());
+    for (auto& value : values) value = take<T>();
+    return values;
+  }
+
+  std::string takeBytes(std::size_t n) {
+    EXPECT_LE(mPos + n, mData.size());
+    std::string value = mData.substr(mPos, n);
+    mPos += n;
+    return value;
+  }
+
+  std::size_t pos() const { return mPos; }
+  void seek(std::size_t pos) { mPos = pos; }
+  bool atEnd() const { return mPos == mData.size(); }
+
+ private:
+  const std::string& mData;
+  std::size_t mPos = 0;
+};
+
+using Obj = std::shared_ptr<common::ObjectMetadata>;
+
+Obj decodeFrame(Reader& r, std::string& jpeg) {
+  auto obj = std::make_shared<common::ObjectMetadata>();
+  obj->mFrame = std::make_shared<common::Frame>();
+  obj->mFrame->mChannelId = r.take<std::int32_t>();
+  obj->mFrame->mFrameId = r.take<std::int64_t>();
+  obj->mFrame->mTimestamp = r.take<std::int64_t>();
+  obj->mFrame->mWidth = r.take<std::int32_t>();
+  obj->mFrame->mHeight = r.take<std::int32_t>();
+  obj->fps = r.take<float>();
+  obj->mGraphId = r.take<std::int32_t>();
+  obj->mSubId = r.take<std::int32_t>();
+
+  for (auto n = r.take<std::uint32_t>(); n > 0; --n) {
+    auto det = std::make_shared<common::DetectedObjectMetadata>();
+    det->mBox.mX = r.take<std::int32_t>();
+    det->mBox.mY = r.take<std::int32_t>();
+    det->mBox.mWidth = r.take<std::int32_t>();
+    det->mBox.mHeight = r.take<std::int32_t>();
+    det->mClassify = r.take<std::int32_t>();
+    det->mScores = r.takeList<float>();
+    obj->mDetectedObjectMetadatas.push_back(det);
+  }
+  for (auto n = r.take<std::uint32_t>(); n > 0; --n) {
+    auto track = std::make_shared<common::TrackedObjectMetadata>();
+    track->mTrackId = r.take<std::int64_t>();
+    obj->mTrackedObjectMetadatas.push_back(track);
+  }
+  for (auto n = r.take<std::uint32_t>(); n > 0; --n) {
+    auto recog = std::make_shared<common::RecognizedObjectMetadata>();
+    recog->mLabelName = r.takeBytes(r.take<std::uint32_t>());
+    recog->mScores = r.takeList<float>();
+    recog->mTopKLabels = r.takeList<std::int32_t>();
+    obj->mRecognizedObjectMetadatas.push_back(recog);
+  }
+  for (auto n = r.take<std::uint32_t>(); n > 0; --n) {
+    auto pose = std::make_shared<common::PosedObjectMetadata>();
+    pose->keypoints = r.takeList<float>();
+    obj->mPosedObjectMetadatas.push_back(pose);
+  }
+  for (auto n = r.take<std::uint32_t>(); n > 0; --n) {
+    auto face = std::make_shared<common::FaceObjectMetadata>();
+    face->top = r.take<std::int32_t>();
+    face->bottom = r.take<std::int32_t>();
+    face->left = r.take<std::int32_t>();
+    face->right = r.take<std::int32_t>();
+    for (auto& x : face->points_x) x = r.take<float>();
+    for (auto& y : face->points_y) y = r.take<float>();
+    face->score = r.take<float>();
+    obj->mFaceObjectMetadatas.push_back(face);
+  }
+  jpeg = r.takeBytes(r.take<std::uint32_t>());
+  return obj;
+}
+
+std::vector<std::pair<Obj, std::string>> decodeBatch(const std::string& data) {
+  Reader r(data);
+  EXPECT_EQ(r.takeBytes(4), "SSRB");
+  EXPECT_EQ(r.take<std::uint16_t>(), ResultCodec::VERSION);
+  std::vector<std::pair<Obj, std::string>> frames(r.take<std::uint16_t>());
+  for (auto& frame : frames) {
+    std::size_t size = r.take<std::uint32_t>();
+    std::size_t end = r.pos() + size;
+    frame.first = decodeFrame(r, frame.second);
+    EXPECT_EQ(r.pos(), end);
+    r.seek(end);
+  }
+  EXPECT_TRUE(r.atEnd());
+  return frames;
+}
+
+Obj makeObj(int channel, int frameId, int scoreCount = 3) {
+  auto obj = std::make_shared<common::ObjectMetadata>();
+  obj->mFrame = std::make_shared<common::Frame>();
+  obj->mFrame->mChannelId = channel;
+  obj->mFrame->mFrameId = frameId;
+  obj->mFrame->mTimestamp = 1700000000123456LL + frameId;
+  obj->mFrame->mWidth = 1920;
+  obj->mFrame->mHeight = 1080;
+  obj->fps = 24.5f;
+  obj->mGraphId = 2;
+  obj->mSubId = -1;
+
+  for (int i = 0; i < 2; ++i) {
+    auto det = std::make_shared<common::DetectedObjectMetadata>();
+    det->mBox.mX = 10 * i - 5;
+    det->mBox.mY = 20 * i;
+    det->mBox.mWidth = 100 + i;
+    det->mBox.mHeight = 200 + i;
+    det->mClassify = i + 7;
+    for (int k = 0; k < scoreCount; ++k) det->mScores.push_back(0.001f * k);
+    obj->mDetectedObjectMetadatas.push_back(det);
+
+    auto track = std::make_shared<common::TrackedObjectMetadata>();
+    track->mTrackId = (1LL << 40) + i;
+    obj->mTrackedObjectMetadatas.push_back(track);
+  }
+
+  auto recog = std::make_shared<common::RecognizedObjectMetadata>();
+  recog->mLabelName = "京A12345";
+  recog->mScores = {0.9f, 0.05f};
+  for (int k = 0; k < scoreCount; ++k) recog->mTopKLabels.push_back(k * 3);
+  obj->mRecognizedObjectMetadatas.push_back(recog);
+
+  auto pose = std::make_shared<common::PosedObjectMetadata>();
+  for (int k = 0; k < 17 * 3; ++k) pose->keypoints.push_back(k * 0.5f);
+  obj->mPosedObjectMetadatas.push_back(pose);
+
+  auto face = std::make_shared<common::FaceObjectMetadata>();
+  face->top = 1;
+  face->bottom = 2;
+  face->left = 3;
+  face->right = 4;
+  for (int k = 0; k < 5; ++k) {
+    face->points_x[k] = k + 0.25f;
+    face->points_y[k] = k + 0.75f;
+  }
+  face->score = 0.875f;
+  obj->mFaceObjectMetadatas.push_back(face);
+  return obj;
+}
+
+void expectSameObj(const Obj& expected, const Obj& actual) {
+  EXPECT_EQ(actual->mFrame->mChannelId, expected->mFrame->mChannelId);
+  EXPECT_EQ(actual->mFrame->mFrameId, expected->mFrame->mFrameId);
+  EXPECT_EQ(actual->mFrame->mTimestamp, expected->mFrame->mTimestamp);
+  EXPECT_EQ(actual->mFrame->mWidth, expected->mFrame->mWidth);
+  EXPECT_EQ(actual->mFrame->mHeight, expected->mFrame->mHeight);
+  EXPECT_EQ(actual->fps, expected->fps);
+  EXPECT_EQ(actual->mGraphId, expected->mGraphId);
+  EXPECT_EQ(actual->mSubId, expected->mSubId);
+
+  ASSERT_EQ(actual->mDetectedObjectMetadatas.size(),
+            expected->mDetectedObjectMetadatas.size());
+  for (std::size_t i = 0; i < actual->mDetectedObjectMetadatas.size(); ++i) {
+    auto& a = actual->mDetectedObjectMetadatas[i];
+    auto& e = expected->mDetectedObjectMetadatas[i];
+    EXPECT_EQ(a->mBox.mX, e->mBox.mX);
+    EXPECT_EQ(a->mBox.mY, e->mBox.mY);
+    EXPECT_EQ(a->mBox.mWidth, e->mBox.mWidth);
+    EXPECT_EQ(a->mBox.mHeight, e->mBox.mHeight);
+    EXPECT_EQ(a->mClassify, e->mClassify);
+    EXPECT_EQ(a->mScores, e->mScores);
+  }
+  ASSERT_EQ(actual->mTrackedObjectMetadatas.size(),
+            expected->mTrackedObjectMetadatas.size());
+  for (std::size_t i = 0; i < actual->mTrackedObjectMetadatas.size(); ++i)
+    EXPECT_EQ(actual->mTrackedObjectMetadatas[i]->mTrackId,
+              expected->mTrackedObjectMetadatas[i]->mTrackId);
+  ASSERT_EQ(actual->mRecognizedObjectMetadatas.size(),
+            expected->mRecognizedObjectMetadatas.size());
+  for (std::size_t i = 0; i < actual->mRecognizedObjectMetadatas.size(); ++i) {
+    auto& a = actual->mRecognizedObjectMetadatas[i];
+    auto& e = expected->mRecognizedObjectMetadatas[i];
+    EXPECT_EQ(a->mLabelName, e->mLabelName);
+    EXPECT_EQ(a->mScores, e->mScores);
+    EXPECT_EQ(a->mTopKLabels, e->mTopKLabels);
+  }
+  ASSERT_EQ(actual->mPosedObjectMetadatas.size(),
+            expected->mPosedObjectMetadatas.size());
+  for (std::size_t i = 0; i < actual->mPosedObjectMetadatas.size(); ++i)
+    EXPECT_EQ(actual->mPosedObjectMetadatas[i]->keypoints,
+              expected->mPosedObjectMetadatas[i]->keypoints);
+  ASSERT_EQ(actual->mFaceObjectMetadatas.size(),
+            expected->mFaceObjectMetadatas.size());
+  for (std::size_t i = 0; i < actual->mFaceObjectMetadatas.size(); ++i) {
+    auto& a = actual->mFaceObjectMetadatas[i];
+    auto& e = expected->mFaceObjectMetadatas[i];
+    EXPECT_EQ(a->top, e->top);
+    EXPECT_EQ(a->bottom, e->bottom);
+    EXPECT_EQ(a->left, e->left);
+    EXPECT_EQ(a->right, e->right);
+    EXPECT_EQ(0, std::memcmp(a->points_x, e->points_x, sizeof(a->points_x)));
+    EXPECT_EQ(0, std::memcmp(a->points_y, e->points_y, sizeof(a->points_y)));
+    EXPECT_EQ(a->score, e->score);
+  }
+}
+
+std::string encodeBatch(const std::vector<std::pair<Obj, std::string>>& in) {
+  std::vector<std::shared_ptr<std::string>> frames;
+  for (auto& frame : in)
+    frames.push_back(std::make_shared<std::string>(
+        ResultCodec::encodeFrame(frame.first, frame.second)));
+  return ResultCodec::encodeBatch(frames);
+}
+
+}  // namespace
+
+TEST(ResultCodecTest, SingleFrameRoundTrips) {
+  auto obj = makeObj(3, 42);
+  std::string jpeg("\xff\xd8\x00jpeg\xff\xd9", 9);
+  auto frames = decodeBatch(encodeBatch({{obj, jpeg}}));
+  ASSERT_EQ(frames.size(), 1u);
+  expectSameObj(obj, frames[0].first);
+  EXPECT_EQ(frames[0].second, jpeg);
+}
+
+TEST(ResultCodecTest, BatchRoundTripsInOrder) {
+  std::vector<std::pair<Obj, std::string>> in;
+  for (int i = 0; i < 5; ++i)
+    in.emplace_back(makeObj(i % 2, i), i % 2 ? std::string(i * 100, 'j') : "");
+  auto frames = decodeBatch(encodeBatch(in));
+  ASSERT_EQ(frames.size(), in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    expectSameObj(in[i].first, frames[i].first);
+    EXPECT_EQ(frames[i].second, in[i].second);
+  }
+}
+
+TEST(ResultCodecTest, EmptyFrameRoundTrips) {
+  auto obj = std::make_shared<common::ObjectMetadata>();
+  obj->mFrame = std::make_shared<common::Frame>();
+  obj->mFrame->mFrameId = 7;
+  auto frames = decodeBatch(encodeBatch({{obj, ""}}));
+  ASSERT_EQ(frames.size(), 1u);
+  expectSameObj(obj, frames[0].first);
+  EXPECT_TRUE(frames[0].second.empty());
+}
+
+TEST(ResultCodecTest, LongListsAreNotTruncated) {
+  // 1000类的分类结果以及超过u16的关键点数
+  auto obj = makeObj(0, 1, 1000);
+  obj->mPosedObjectMetadatas[0]->keypoints.assign(70000, 1.5f);
+  obj->mRecognizedObjectMetadatas[0]->mLabelName = std::string(300, 'x');
+  auto frames = decodeBatch(encodeBatch({{obj, ""}}));
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(frames[0].first->mDetectedObjectMetadatas[0]->mScores.size(),
+            1000u);
+  EXPECT_EQ(frames[0].first->mRecognizedObjectMetadatas[0]->mTopKLabels.size(),
+            1000u);
+  expectSameObj(obj, frames[0].first);
+}
+
+TEST(ResultCodecTest, RoundTripsThroughHttpServer) {
+  httplib::Server server;
+  std::string body, contentType;
+  server.Post("/stream/test", [&](const httplib::Request& req,
+                                  httplib::Response& res) {
+    body = req.body;
+    contentType = req.get_header_value("Content-Type");
+    res.status = 200;
+  });
+  int port = server.bind_to_any_port("127.0.0.1");
+  ASSERT_GT(port, 0);
+  std::thread listener([&] { server.listen_after_bind(); });
+  while (!server.is_running())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  std::vector<std::pair<Obj, std::string>> in = {{makeObj(0, 1), "jpeg"},
+                                                 {makeObj(1, 2), ""}};
+  httplib::Client cli("127.0.0.1", port);
+  auto res = cli.Post("/stream/test", encodeBatch(in),
+                      ResultCodec::CONTENT_TYPE);
+  server.stop();
+  listener.join();
+
+  ASSERT_TRUE(res);
+  EXPECT_EQ(res->status, 200);
+  EXPECT_EQ(contentType, ResultCodec::CONTENT_TYPE);
+  auto frames = decodeBatch(body);
+  ASSERT_EQ(frames.size(), in.size());
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    expectSameObj(in[i].first, frames[i].first);
+    EXPECT_EQ(frames[i].second, in[i].second);
+  }
+}
+
+}  // namespace http_push
+}  // namespace element
+}  // namespace sophon_stream
@@ -0,0 +1,286 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "retinaface_decoder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace sophon_stream {
+namespace element {
+namespace retinaface {
+namespace {
+
+bool legacyCompareBBox(const FaceDetectInfo& a, const FaceDetectInfo& b) {
+  return a.score > b.score;
+}
+
+/**
+ * @brief 原RetinafacePostProcess::nms，返回新的vector
+ */
+std::vector<FaceDetectInfo> legacyNms(std::vector<FaceDetectInfo>& bboxes,
+                                      float threshold) {
+  std::vector<FaceDetectInfo> bboxes_nms;
+  std::sort(bboxes.begin(), bboxes.end(), legacyCompareBBox);
+
+  int32_t select_idx = 0;
+  int32_t num_bbox = static_cast<int32_t>(bboxes.size());
+  std::vector<int32_t> mask_merged(num_bbox, 0);
+  bool all_merged = false;
+
+  while (!all_merged) {
+    while (select_idx < num_bbox && mask_merged[select_idx] == 1) select_idx++;
+    if (select_idx == num_bbox) {
+      all_merged = true;
+      continue;
+    }
+
+    bboxes_nms.push_back(bboxes[select_idx]);
+    mask_merged[select_idx] = 1;
+
+    anchor_box select_bbox = bboxes[select_idx].rect;
+    float area1 = static_cast<float>((select_bbox.x2 - select_bbox.x1 + 1) *
+                                     (select_bbox.y2 - select_bbox.y1 + 1));
+    float x1 = static_cast<float>(select_bbox.x1);
+    float y1 = static_cast<float>(select_bbox.y1);
+    float x2 = static_cast<float>(select_bbox.x2);
+    float y2 = static_cast<float>(select_bbox.y2);
+
+    select_idx++;
+    for (int32_t i = select_idx; i < num_bbox; i++) {
+      if (mask_merged[i] == 1) {
+        continue;
+      }
+      anchor_box& bbox_i = bboxes[i].rect;
+      float x = std::max<float>(x1, static_cast<float>(bbox_i.x1));
+      float y = std::max<float>(y1, static_cast<float>(bbox_i.y1));
+      float w = std::min<float>(x2, static_cast<float>(bbox_i.x2)) - x + 1;
+      float h = std::min<float>(y2, static_cast<float>(bbox_i.y2)) - y + 1;
+      if (w <= 0 || h <= 0) {
+        continue;
+      }
+      float area2 = static_cast<float>((bbox_i.x2 - bbox_i.x1 + 1) *
+                                       (bbox_i.y2 - bbox_i.y1 + 1));
+      float area_intersect = w * h;
+
+      if (static_cast<float>(area_intersect) /
+              (area1 + area2 - area_intersect) >
+          threshold) {
+        mask_merged[i] = 1;
+      }
+    }
+  }
+  return bboxes_nms;
+}
+
+/**
+ * @brief 原RetinafacePostProcess::get_faceInfo，每帧逐个anchor计算位置并判断
+ * 置信度，作为anchor表解码的对照
+ */
+void legacyFaceInfo(int ws, int hs, std::vector<FaceDetectInfo>& faceInfo,
+                    const float* loc_data, const float* cls_data,
+                    const float* land_data, float ratio_, float threshold,
+                    float thresh_nms) {
+  const int num_layer = 3;
+  const size_t steps[] = {8, 16, 32};
+  const int num_anchor = 2;
+  const size_t anchor_sizes[][2] = {{16, 32}, {64, 128}, {256, 512}};
+  const float variances[] = {0.1, 0.2};
+
+  size_t index = 0, min_size;
+  const float *loc, *land;
+  float x, y, w, h, conf;
+  float anchor_w, anchor_h, anchor_x, anchor_y;
+  FaceDetectInfo obj;
+  for (int il = 0; il < num_layer; ++il) {
+    int feature_width = (ws + steps[il] - 1) / steps[il];
+    int feature_height = (hs + steps[il] - 1) / steps[il];
+    for (int iy = 0; iy < feature_height; ++iy) {
+      for (int ix = 0; ix < feature_width; ++ix) {
+        for (int ia = 0; ia < num_anchor; ++ia) {
+          conf = cls_data[index * 2 + 1];
+          if (conf < threshold) goto cond;
+          min_size = anchor_sizes[il][ia];
+          anchor_x = (ix + 0.5) * steps[il] / ws;
+          anchor_y = (iy + 0.5) * steps[il] / hs;
+          anchor_w = min_size * 1. / ws;
+          anchor_h = min_size * 1. / hs;
+          obj.score = conf;
+          loc = loc_data + index * 4;
+          w = exp(loc[2] * variances[1]) * anchor_w;
+          h = exp(loc[3] * variances[1]) * anchor_h;
+          x = anchor_x + loc[0] * variances[0] * anchor_w;
+          y = anchor_y + loc[1] * variances[0] * anchor_h;
+          obj.rect.x1 = (x - w / 2) * 640 / ratio_;
+          obj.rect.x2 = (x + w / 2) * 640 / ratio_;
+          obj.rect.y1 = (y - h / 2) * 640 / ratio_;
+          obj.rect.y2 = (y + h / 2) * 640 / ratio_;
+          land = land_data + index * 10;
+          for (int i = 0; i < 5; ++i) {
+            obj.pts.x[i] =
+                (anchor_x + land[i * 2] * variances[0] * anchor_w) * 640 /
+                ratio_;
+            obj.pts.y[i] =
+                (anchor_y + land[i * 2 + 1] * variances[0] * anchor_h) * 640 /
+                ratio_;
+          }
+          faceInfo.push_back(obj);
+        cond:
+          ++index;
+        }
+      }
+    }
+  }
+  faceInfo = legacyNms(faceInfo, thresh_nms);
+}
+
+/**
+ * @brief 随机的模型输出：大部分anchor置信度很低，少数成簇地超过阈值
+ */
+struct FakeOutputs {
+  std::vector<float> loc, cls, land;
+
+  FakeOutputs(std::mt19937& rng, int anchor_num, float positive_rate) {
+    std::normal_distribution<float> offset(0.f, 1.f);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    loc.resize(anchor_num * 4);
+    cls.resize(anchor_num * 2);
+    land.resize(anchor_num * 10);
+    for (auto& v : loc) v = offset(rng);
+    for (auto& v : land) v = offset(rng);
+    for (int i = 0; i < anchor_num; ++i) {
+      float score = unit(rng) < positive_rate ? 0.3f + 0.7f * unit(rng)
+                                              : 0.3f * unit(rng);
+      cls[i * 2] = 1.f - score;
+      cls[i * 2 + 1] = score;
+    }
+  }
+};
+
+void expectSameFaces(const std::vector<FaceDetectInfo>& actual,
+                     const std::vector<FaceDetectInfo>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i)
+    ASSERT_EQ(std::memcmp(&actual[i], &expected[i], sizeof(FaceDetectInfo)),
+              0)
+        << "face " << i;
+}
+
+FaceDetectInfo makeFace(float score, float x1, float y1, float x2, float y2) {
+  FaceDetectInfo face = {};
+  face.score = score;
+  face.rect = {x1, y1, x2, y2};
+  return face;
+}
+
+}  // namespace
+
+TEST(RetinafaceDecoderTest, AnchorTableLayout) {
+  AnchorTable anchors;
+  buildAnchorTable(640, 640, anchors);
+  ASSERT_EQ(anchors.x.size(), 2u * (80 * 80 + 40 * 40 + 20 * 20));
+  EXPECT_EQ(anchors.y.size(), anchors.x.size());
+  EXPECT_EQ(anchors.w.size(), anchors.x.size());
+  EXPECT_EQ(anchors.h.size(), anchors.x.size());
+
+  // stride 8的第一个位置，两个anchor中心相同、尺寸为16和32
+  EXPECT_FLOAT_EQ(anchors.x[0], 4.f / 640);
+  EXPECT_FLOAT_EQ(anchors.y[0], 4.f / 640);
+  EXPECT_FLOAT_EQ(anchors.w[0], 16.f / 640);
+  EXPECT_FLOAT_EQ(anchors.w[1], 32.f / 640);
+  EXPECT_FLOAT_EQ(anchors.x[1], anchors.x[0]);
+  // 先沿x方向排列
+  EXPECT_FLOAT_EQ(anchors.x[2], 12.f / 640);
+  EXPECT_FLOAT_EQ(anchors.y[2 * 80], 12.f / 640);
+  // stride 32的最后一个anchor
+  EXPECT_FLOAT_EQ(anchors.x.back(), 624.f / 640);
+  EXPECT_FLOAT_EQ(anchors.y.back(), 624.f / 640);
+  EXPECT_FLOAT_EQ(anchors.w.back(), 512.f / 640);
+}
+
+TEST(RetinafaceDecoderTest, AnchorTableRoundsFeatureMapsUp) {
+  AnchorTable anchors;
+  buildAnchorTable(600, 420, anchors);
+  // ceil(600/8)=75, ceil(420/8)=53, ceil(600/16)=38, ceil(420/16)=27,
+  // ceil(600/32)=19, ceil(420/32)=14
+  EXPECT_EQ(anchors.x.size(), 2u * (75 * 53 + 38 * 27 + 19 * 14));
+  EXPECT_FLOAT_EQ(anchors.w[0], 16.f / 600);
+  EXPECT_FLOAT_EQ(anchors.h[0], 16.f / 420);
+}
+
+TEST(RetinafaceDecoderTest, MatchesLegacyDecoder) {
+  std::mt19937 rng(1);
+  size_t total = 0;
+  for (auto size : {std::make_pair(640, 640), std::make_pair(320, 256)}) {
+    AnchorTable anchors;
+    buildAnchorTable(size.first, size.second, anchors);
+    const int anchor_num = anchors.x.size();
+    for (int round = 0; round < 30; ++round) {
+      FakeOutputs outputs(rng, anchor_num, round % 2 ? 0.001f : 0.02f);
+      float ratio = 0.5f + round * 0.05f;
+      float threshold = round % 3 == 0 ? 0.5f : 0.8f;
+      float thresh_nms = round % 2 ? 0.4f : 0.6f;
+
+      std::vector<FaceDetectInfo> expected;
+      legacyFaceInfo(size.first, size.second, expected, outputs.loc.data(),
+                     outputs.cls.data(), outputs.land.data(), ratio,
+                     threshold, thresh_nms);
+      // 缓冲中残留上一轮的结果，解码时要整个覆盖
+      std::vector<FaceDetectInfo> faces(7, makeFace(9.f, 1, 2, 3, 4));
+      decodeFaces(anchors, outputs.loc.data(), outputs.cls.data(),
+                  outputs.land.data(), ratio, threshold, thresh_nms, faces);
+      expectSameFaces(faces, expected);
+      total += faces.size();
+    }
+  }
+  // 随机输出要覆盖有大量重叠候选框的情况
+  EXPECT_GT(total, 1000u);
+}
+
+TEST(RetinafaceDecoderTest, ScoreEqualToThresholdIsKept) {
+  AnchorTable anchors;
+  buildAnchorTable(64, 64, anchors);
+  const int anchor_num = anchors.x.size();
+  std::vector<float> loc(anchor_num * 4, 0.f), cls(anchor_num * 2, 0.f),
+      land(anchor_num * 10, 0.f);
+  cls[5 * 2 + 1] = 0.5f;
+  cls[7 * 2 + 1] = std::nextafter(0.5f, 0.f);
+  std::vector<FaceDetectInfo> faces;
+  decodeFaces(anchors, loc.data(), cls.data(), land.data(), 1.f, 0.5f, 0.4f,
+              faces);
+  ASSERT_EQ(faces.size(), 1u);
+  // 偏移全为0时框就是anchor本身：第5个anchor为stride 8第3个位置的大anchor
+  EXPECT_FLOAT_EQ(faces[0].rect.x1, (20.f - 16.f) * 10);
+  EXPECT_FLOAT_EQ(faces[0].rect.x2, (20.f + 16.f) * 10);
+  EXPECT_FLOAT_EQ(faces[0].pts.x[0], 20.f * 10);
+}
+
+TEST(RetinafaceDecoderTest, NmsKeepsHighestScoreInPlace) {
+  std::vector<FaceDetectInfo> faces = {
+      makeFace(0.6f, 0, 0, 99, 99), makeFace(0.9f, 5, 5, 104, 104),
+      makeFace(0.7f, 200, 200, 249, 249), makeFace(0.8f, 210, 210, 259, 259),
+      makeFace(0.5f, 500, 0, 519, 19)};
+  nmsFaces(faces, 0.4f);
+  ASSERT_EQ(faces.size(), 3u);
+  EXPECT_FLOAT_EQ(faces[0].score, 0.9f);
+  EXPECT_FLOAT_EQ(faces[1].score, 0.8f);
+  EXPECT_FLOAT_EQ(faces[2].score, 0.5f);
+
+  std::vector<FaceDetectInfo> empty;
+  nmsFaces(empty, 0.4f);
+  EXPECT_TRUE(empty.empty());
+}
+
+}  // namespace retinaface
+}  // namespace element
+}  // namespace sophon_stream
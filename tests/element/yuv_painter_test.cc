@@ -0,0 +1,296 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "yuv_painter.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace sophon_stream {
+namespace element {
+namespace osd {
+namespace {
+
+constexpr std::uint8_t kBgY = 16;
+constexpr std::uint8_t kBgUV = 128;
+
+/**
+ * @brief 带stride填充的YUV420P测试图，填充区域写入哨兵值以检查越界
+ */
+struct TestImage {
+  static constexpr std::uint8_t kGuard = 0xEE;
+  static constexpr int kPad = 3;
+
+  int width, height;
+  std::vector<std::uint8_t> planes[3];
+
+  TestImage(int w, int h) : width(w), height(h) {
+    planes[0].assign(stride(0) * height, kGuard);
+    planes[1].assign(stride(1) * ((height + 1) / 2), kGuard);
+    planes[2].assign(stride(2) * ((height + 1) / 2), kGuard);
+    for (int p = 0; p < 3; ++p)
+      for (int r = 0; r < planeHeight(p); ++r)
+        for (int c = 0; c < planeWidth(p); ++c)
+          at(p, c, r) = p == 0 ? kBgY : kBgUV;
+  }
+
+  int planeWidth(int p) const { return p == 0 ? width : (width + 1) / 2; }
+  int planeHeight(int p) const { return p == 0 ? height : (height + 1) / 2; }
+  int stride(int p) const { return planeWidth(p) + kPad; }
+  std::uint8_t& at(int p, int x, int y) {
+    return planes[p][y * stride(p) + x];
+  }
+
+  YuvPlanes view() {
+    YuvPlanes view;
+    view.width = width;
+    view.height = height;
+    for (int p = 0; p < 3; ++p) {
+      view.data[p] = planes[p].data();
+      view.stride[p] = stride(p);
+    }
+    return view;
+  }
+
+  /**
+   * @brief 平面p的内容，每行一个字符串，'.'为背景，'#'为value，其它值为'?'
+   */
+  std::vector<std::string> mask(int p, std::uint8_t value) {
+    std::vector<std::string> rows;
+    std::uint8_t bg = p == 0 ? kBgY : kBgUV;
+    for (int r = 0; r < planeHeight(p); ++r) {
+      std::string row;
+      for (int c = 0; c < planeWidth(p); ++c) {
+        std::uint8_t v = at(p, c, r);
+        row += v == bg ? '.' : v == value ? '#' : '?';
+      }
+      rows.push_back(row);
+    }
+    return rows;
+  }
+
+  bool guardsIntact() const {
+    for (int p = 0; p < 3; ++p)
+      for (int r = 0; r < planeHeight(p); ++r)
+        for (int c = planeWidth(p); c < stride(p); ++c)
+          if (planes[p][r * stride(p) + c] != kGuard) return false;
+    return true;
+  }
+};
+
+using Rows = std::vector<std::string>;
+
+// 白色的BT.601 limited range
+const YuvColor kWhite{235, 128, 128};
+// 用于检查色度平面的颜色，与背景在三个平面上都不同
+const YuvColor kRed{82, 90, 240};
+
+}  // namespace
+
+TEST(YuvPainterTest, FromRGBMatchesBT601LimitedRange) {
+  auto check = [](YuvColor c, int y, int u, int v) {
+    EXPECT_EQ(c.y, y);
+    EXPECT_EQ(c.u, u);
+    EXPECT_EQ(c.v, v);
+  };
+  check(YuvColor::fromRGB(0, 0, 0), 16, 128, 128);
+  check(YuvColor::fromRGB(255, 255, 255), 235, 128, 128);
+  check(YuvColor::fromRGB(255, 0, 0), 82, 90, 240);
+  check(YuvColor::fromRGB(0, 255, 0), 144, 54, 34);
+  check(YuvColor::fromRGB(0, 0, 255), 41, 240, 110);
+}
+
+TEST(YuvPainterTest, FillRectOddRectCoversTouchedChromaSamples) {
+  TestImage image(8, 6);
+  YuvPainter(image.view()).fillRect(1, 1, 3, 2, kRed);
+  EXPECT_EQ(image.mask(0, kRed.y), (Rows{"........",
+                                         ".###....",
+                                         ".###....",
+                                         "........",
+                                         "........",
+                                         "........"}));
+  EXPECT_EQ(image.mask(1, kRed.u), (Rows{"##..",
+                                         "##..",
+                                         "...."}));
+  EXPECT_EQ(image.mask(2, kRed.v), (Rows{"##..",
+                                         "##..",
+                                         "...."}));
+  EXPECT_TRUE(image.guardsIntact());
+}
+
+TEST(YuvPainterTest, FillRectClipsToImage) {
+  TestImage image(6, 4);
+  YuvPainter(image.view()).fillRect(-2, 2, 5, 10, kRed);
+  EXPECT_EQ(image.mask(0, kRed.y), (Rows{"......",
+                                         "......",
+                                         "###...",
+                                         "###..."}));
+  EXPECT_EQ(image.mask(1, kRed.u), (Rows{"...",
+                                         "##."}));
+  YuvPainter(image.view()).fillRect(10, 10, 4, 4, kWhite);
+  YuvPainter(image.view()).fillRect(1, 1, 0, 3, kWhite);
+  EXPECT_EQ(image.mask(0, kRed.y)[0], "......");
+  EXPECT_TRUE(image.guardsIntact());
+}
+
+TEST(YuvPainterTest, DrawRectangleBorder) {
+  TestImage image(8, 8);
+  YuvPainter(image.view()).drawRectangle(1, 1, 6, 5, 1, kWhite);
+  EXPECT_EQ(image.mask(0, kWhite.y), (Rows{"........",
+                                           ".######.",
+                                           ".#....#.",
+                                           ".#....#.",
+                                           ".#....#.",
+                                           ".######.",
+                                           "........",
+                                           "........"}));
+  EXPECT_TRUE(image.guardsIntact());
+}
+
+TEST(YuvPainterTest, DrawRectangleThicknessClampedToSize) {
+  TestImage image(8, 4);
+  YuvPainter(image.view()).drawRectangle(0, 0, 3, 2, 5, kWhite);
+  EXPECT_EQ(image.mask(0, kWhite.y), (Rows{"###.....",
+                                           "###.....",
+                                           "........",
+                                           "........"}));
+}
+
+TEST(YuvPainterTest, DrawAxisAlignedLines) {
+  TestImage image(8, 8);
+  YuvPainter painter(image.view());
+  // 端点向外延伸thickness / 2，偶数线宽时偏向起点一侧
+  painter.drawLine(1, 2, 6, 2, 2, kWhite);
+  painter.drawLine(4, 4, 4, 6, 1, kWhite);
+  EXPECT_EQ(image.mask(0, kWhite.y), (Rows{"........",
+                                           "#######.",
+                                           "#######.",
+                                           "........",
+                                           "....#...",
+                                           "....#...",
+                                           "....#...",
+                                           "........"}));
+}
+
+TEST(YuvPainterTest, DrawDiagonalLines) {
+  TestImage image(8, 8);
+  YuvPainter painter(image.view());
+  painter.drawLine(0, 0, 5, 5, 1, kWhite);
+  painter.drawLine(7, 0, 5, 6, 1, kWhite);
+  EXPECT_EQ(image.mask(0, kWhite.y), (Rows{"#......#",
+                                           ".#.....#",
+                                           "..#...#.",
+                                           "...#..#.",
+                                           "....#.#.",
+                                           ".....#..",
+                                           ".....#..",
+                                           "........"}));
+}
+
+TEST(YuvPainterTest, DrawMaskBlendsExactly) {
+  TestImage image(4, 2);
+  std::vector<std::uint8_t> alpha = {0, 128, 255, 64};
+  common::Glyph mask;
+  mask.width = 4;
+  mask.height = 1;
+  mask.stride = 4;
+  mask.alpha = alpha.data();
+  YuvPainter(image.view()).drawMask(0, 0, mask, kWhite);
+  // round((16 * (255 - a) + 235 * a) / 255)
+  EXPECT_EQ(image.at(0, 0, 0), 16);
+  EXPECT_EQ(image.at(0, 1, 0), 126);
+  EXPECT_EQ(image.at(0, 2, 0), 235);
+  EXPECT_EQ(image.at(0, 3, 0), 71);
+  EXPECT_EQ(image.at(0, 0, 1), 16);
+  EXPECT_TRUE(image.guardsIntact());
+}
+
+TEST(YuvPainterTest, DrawMaskChromaAveragesFourLumaSamples) {
+  TestImage image(4, 4);
+  std::vector<std::uint8_t> alpha = {255, 255, 255, 255,  //
+                                     255, 255, 0, 0};
+  common::Glyph mask;
+  mask.width = 4;
+  mask.height = 2;
+  mask.stride = 4;
+  mask.alpha = alpha.data();
+  YuvPainter(image.view()).drawMask(0, 0, mask, kRed);
+  // 左侧2x2全覆盖，右侧2x2覆盖一半：alpha均值128
+  EXPECT_EQ(image.at(1, 0, 0), kRed.u);
+  EXPECT_EQ(image.at(2, 0, 0), kRed.v);
+  EXPECT_EQ(image.at(1, 1, 0), 109);  // round((128*127 + 90*128) / 255)
+  EXPECT_EQ(image.at(2, 1, 0), 184);  // round((128*127 + 240*128) / 255)
+  EXPECT_EQ(image.at(1, 0, 1), kBgUV);
+
+  // 奇数偏移时位图外的位置按alpha 0计算
+  TestImage shifted(4, 4);
+  std::vector<std::uint8_t> one = {255};
+  common::Glyph dot;
+  dot.width = 1;
+  dot.height = 1;
+  dot.stride = 1;
+  dot.alpha = one.data();
+  YuvPainter(shifted.view()).drawMask(1, 1, dot, kRed);
+  EXPECT_EQ(shifted.at(0, 1, 1), kRed.y);
+  EXPECT_EQ(shifted.at(1, 0, 0), 118);  // alpha均值64
+  EXPECT_EQ(shifted.at(1, 1, 0), kBgUV);
+}
+
+TEST(YuvPainterTest, VectorBlendMatchesExactRounding) {
+  // 宽度不是8的倍数，同时覆盖向量路径和标量尾部
+  const int width = 256 + 5;
+  std::vector<std::uint8_t> alpha(width);
+  for (int i = 0; i < width; ++i) alpha[i] = static_cast<std::uint8_t>(i);
+  common::Glyph mask;
+  mask.width = width;
+  mask.height = 1;
+  mask.stride = width;
+  mask.alpha = alpha.data();
+
+  for (int bg : {0, 16, 77, 200, 255}) {
+    for (int c : {0, 35, 128, 235, 255}) {
+      TestImage image(width, 2);
+      for (int x = 0; x < width; ++x) image.at(0, x, 0) = bg;
+      YuvColor color{static_cast<std::uint8_t>(c), 128, 128};
+      YuvPainter(image.view()).drawMask(0, 0, mask, color);
+      for (int x = 0; x < width; ++x) {
+        int a = alpha[x];
+        int expected = (bg * (255 - a) + c * a + 127) / 255;
+        ASSERT_EQ(image.at(0, x, 0), expected)
+            << "bg " << bg << " color " << c << " alpha " << a;
+      }
+    }
+  }
+}
+
+TEST(YuvPainterTest, DrawGlyphsAdvancesPen) {
+  TestImage image(12, 6);
+  std::vector<std::uint8_t> full(4, 255);
+  common::Glyph glyph;
+  glyph.width = 2;
+  glyph.height = 2;
+  glyph.stride = 2;
+  glyph.alpha = full.data();
+  glyph.left = 1;
+  glyph.top = 3;
+  glyph.advance = 4;
+  YuvPainter(image.view())
+      .drawGlyphs(0, 4, {&glyph, nullptr, &glyph}, kWhite);
+  EXPECT_EQ(image.mask(0, kWhite.y), (Rows{"............",
+                                           ".##..##.....",
+                                           ".##..##.....",
+                                           "............",
+                                           "............",
+                                           "............"}));
+}
+
+}  // namespace osd
+}  // namespace element
+}  // namespace sophon_stream
@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "auto_tune_policy.h"
+
+#include <gtest/gtest.h>
+
+namespace sophon_stream {
+namespace framework {
+namespace auto_tune {
+namespace {
+
+// decode(1) -> yolov5 group(pre 10, infer 11, post 12) -> resnet(3) -> osd(4)
+nlohmann::json makeGraph() {
+  return nlohmann::json::parse(R"({
+    "graph_id": 0,
+    "elements": [
+      {"id": 1, "name": "decode", "thread_number": 4},
+      {"id": 5000, "name": "yolov5_group", "thread_number": 2,
+       "inner_elements_id": [10, 11, 12],
+       "configure": {"stage_thread_number": {"infer": 1},
+                     "stage_queue_capacity": {"post": 40}}},
+      {"id": 3, "name": "resnet", "thread_number": 1, "queue_capacity": 30,
+       "configure": {"batch_timeout_ms": 10}},
+      {"id": 4, "name": "osd", "thread_number": 2}
+    ]
+  })");
+}
+
+AutoTuneTrial makeTrial(std::map<int, double> queueFill) {
+  AutoTuneTrial trial;
+  trial.graph = makeGraph();
+  trial.queueFill = std::move(queueFill);
+  return trial;
+}
+
+std::vector<std::string> changes(
+    const std::vector<AutoTuneCandidate>& candidates) {
+  std::vector<std::string> result;
+  for (auto& candidate : candidates) result.push_back(candidate.change);
+  return result;
+}
+
+using Changes = std::vector<std::string>;
+
+}  // namespace
+
+TEST(AutoTunePolicyTest, FindElementResolvesGroupStages) {
+  auto graph = makeGraph();
+  std::string stage = "stale";
+  EXPECT_EQ(findElement(graph, 1, stage), 0);
+  EXPECT_EQ(stage, "");
+  EXPECT_EQ(findElement(graph, 10, stage), 1);
+  EXPECT_EQ(stage, "pre");
+  EXPECT_EQ(findElement(graph, 11, stage), 1);
+  EXPECT_EQ(stage, "infer");
+  EXPECT_EQ(findElement(graph, 12, stage), 1);
+  EXPECT_EQ(stage, "post");
+  EXPECT_EQ(findElement(graph, 4, stage), 3);
+  // group自身的id不对应任何阶段
+  EXPECT_EQ(findElement(graph, 5000, stage), -1);
+  EXPECT_EQ(findElement(graph, 99, stage), -1);
+}
+
+TEST(AutoTunePolicyTest, StageValuesFallBackToGroupSettings) {
+  auto graph = makeGraph();
+  const auto& group = graph["elements"][1];
+  EXPECT_EQ(getThreadNumber(group, "infer"), 1);
+  EXPECT_EQ(getThreadNumber(group, "pre"), 2);
+  EXPECT_EQ(getQueueCapacity(group, "post"), 40);
+  EXPECT_EQ(getQueueCapacity(group, "pre"), 20);
+  EXPECT_EQ(getThreadNumber(graph["elements"][2], ""), 1);
+  EXPECT_EQ(getQueueCapacity(graph["elements"][2], ""), 30);
+  EXPECT_EQ(getQueueCapacity(graph["elements"][3], ""), 20);
+
+  auto bad = nlohmann::json::parse(
+      R"({"configure": {"stage_thread_number": {"pre": "4"}}})");
+  EXPECT_EQ(getStageValue(bad, "pre", "stage_thread_number", 7), 7);
+  EXPECT_EQ(getStageValue(bad, "post", "stage_thread_number", 7), 7);
+  EXPECT_EQ(getStageValue(nlohmann::json::object(), "pre",
+                          "stage_thread_number", 7),
+            7);
+}
+
+TEST(AutoTunePolicyTest, SettersEditOnlyTheTargetStage) {
+  auto graph = makeGraph();
+  auto& group = graph["elements"][1];
+  setThreadNumber(group, "post", 3);
+  setQueueCapacity(group, "infer", 16);
+  EXPECT_EQ(group["configure"]["stage_thread_number"],
+            nlohmann::json::parse(R"({"infer": 1, "post": 3})"));
+  EXPECT_EQ(group["configure"]["stage_queue_capacity"],
+            nlohmann::json::parse(R"({"infer": 16, "post": 40})"));
+  EXPECT_EQ(group["thread_number"], 2);
+
+  auto& osd = graph["elements"][3];
+  setThreadNumber(osd, "", 5);
+  setQueueCapacity(osd, "", 24);
+  EXPECT_EQ(osd["thread_number"], 5);
+  EXPECT_EQ(osd["queue_capacity"], 24);
+  EXPECT_EQ(osd.count("configure"), 0u);
+}
+
+TEST(AutoTunePolicyTest, ProposesForTheTwoFullestQueues) {
+  AutoTuneOptions options;
+  // 1低于阈值不算瓶颈，3和11最满，4排第三不处理
+  auto best = makeTrial({{1, 0.05}, {3, 0.5}, {4, 0.3}, {11, 0.9}});
+  auto candidates = propose(options, best);
+  EXPECT_EQ(changes(candidates),
+            (Changes{"element 11 (group stage infer) thread_number 1 -> 2",
+                     "element 11 (group stage infer) queue_capacity 20 -> 40",
+                     "element 3 thread_number 1 -> 2",
+                     "element 3 batch_timeout_ms 10 -> 20",
+                     "element 3 batch_timeout_ms 10 -> 5"}));
+
+  // 每个候选只改一处，其余与best相同
+  auto expected = makeGraph();
+  expected["elements"][1]["configure"]["stage_thread_number"]["infer"] = 2;
+  EXPECT_EQ(candidates[0].graph, expected);
+  expected = makeGraph();
+  expected["elements"][1]["configure"]["stage_queue_capacity"]["infer"] = 40;
+  EXPECT_EQ(candidates[1].graph, expected);
+  expected = makeGraph();
+  expected["elements"][2]["configure"]["batch_timeout_ms"] = 5;
+  EXPECT_EQ(candidates[4].graph, expected);
+  EXPECT_EQ(best.graph, makeGraph());
+}
+
+TEST(AutoTunePolicyTest, NothingToProposeForIdleQueues) {
+  AutoTuneOptions options;
+  EXPECT_TRUE(propose(options, makeTrial({})).empty());
+  EXPECT_TRUE(propose(options, makeTrial({{1, 0.09}, {4, 0.}})).empty());
+  // 不在graph中的element(如已经删除的)被跳过
+  EXPECT_TRUE(propose(options, makeTrial({{99, 0.9}})).empty());
+}
+
+TEST(AutoTunePolicyTest, FrozenElementsAreSkipped) {
+  AutoTuneOptions options;
+  options.frozenElements = {11};
+  auto candidates = propose(options, makeTrial({{11, 0.9}, {4, 0.85}}));
+  EXPECT_EQ(changes(candidates),
+            (Changes{"element 4 thread_number 2 -> 3",
+                     "element 4 queue_capacity 20 -> 40"}));
+}
+
+TEST(AutoTunePolicyTest, RespectsThreadAndQueueCaps) {
+  AutoTuneOptions options;
+  options.maxThreadNumber = 2;
+  options.maxQueueCapacity = 30;
+  // osd已达线程上限，队列只能加到上限
+  EXPECT_EQ(changes(propose(options, makeTrial({{4, 0.9}}))),
+            (Changes{"element 4 queue_capacity 20 -> 30"}));
+  // post阶段线程和队列都已到上限
+  EXPECT_TRUE(propose(options, makeTrial({{12, 0.9}})).empty());
+  // 放开线程上限后，队列40已超过上限，只加线程
+  options.maxThreadNumber = 3;
+  EXPECT_EQ(changes(propose(options, makeTrial({{12, 0.9}}))),
+            (Changes{"element 12 (group stage post) thread_number 2 -> 3"}));
+}
+
+TEST(AutoTunePolicyTest, BatchTimeoutStaysInRange) {
+  AutoTuneOptions options;
+  options.maxThreadNumber = 1;
+  auto best = makeTrial({{3, 0.5}});
+  best.graph["elements"][2]["configure"]["batch_timeout_ms"] = 100;
+  EXPECT_EQ(changes(propose(options, best)),
+            (Changes{"element 3 batch_timeout_ms 100 -> 50"}));
+  best.graph["elements"][2]["configure"]["batch_timeout_ms"] = 1;
+  EXPECT_EQ(changes(propose(options, best)),
+            (Changes{"element 3 batch_timeout_ms 1 -> 2"}));
+}
+
+TEST(AutoTunePolicyTest, AcceptsOnlyClearImprovements) {
+  AutoTuneOptions options;
+  options.minGain = 0.05;
+  AutoTuneTrial best;
+  best.fps = 100.;
+  best.p99Ms = 200.;
+  auto trial = [](double fps, double p99Ms) {
+    AutoTuneTrial t;
+    t.fps = fps;
+    t.p99Ms = p99Ms;
+    return t;
+  };
+  EXPECT_TRUE(better(options, trial(106., 300.), best));
+  EXPECT_FALSE(better(options, trial(105., 200.), best));
+  EXPECT_FALSE(better(options, trial(104., 195.), best));
+  // 吞吐持平时看p99
+  EXPECT_TRUE(better(options, trial(96., 180.), best));
+  EXPECT_FALSE(better(options, trial(96., 191.), best));
+  // 吞吐下降超过minGain时p99再好也不接受
+  EXPECT_FALSE(better(options, trial(94., 50.), best));
+}
+
+TEST(AutoTunePolicyTest, PercentileEdgeCases) {
+  std::vector<double> empty;
+  EXPECT_EQ(percentile(empty, 0.5), 0.);
+  EXPECT_EQ(percentile(empty, 0.99), 0.);
+
+  std::vector<double> one = {7.5};
+  EXPECT_EQ(percentile(one, 0.), 7.5);
+  EXPECT_EQ(percentile(one, 0.5), 7.5);
+  EXPECT_EQ(percentile(one, 0.99), 7.5);
+
+  std::vector<double> values;
+  for (int i = 100; i >= 1; --i) values.push_back(i);
+  EXPECT_EQ(percentile(values, 0.), 1.);
+  EXPECT_EQ(percentile(values, 0.5), 50.);
+  EXPECT_EQ(percentile(values, 0.99), 99.);
+  EXPECT_EQ(percentile(values, 1.), 100.);
+}
+
+}  // namespace auto_tune
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,333 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/batch_tensors.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <set>
+
+#include "common/device_mem_pool.h"
+
+namespace sophon_stream {
+namespace common {
+namespace {
+
+/**
+ * @brief 在主机内存上分配的allocator，与device_mem_pool_test相同
+ */
+struct HostAllocator {
+  struct Heap {
+    std::set<unsigned long long> live;
+    int allocs = 0;
+    int frees = 0;
+  };
+  std::shared_ptr<Heap> heap;
+
+  bool alloc(std::size_t bytes, bm_device_mem_t* mem) {
+    void* p = std::calloc(bytes, 1);
+    *mem = bm_device_mem_t();
+    mem->u.device.device_addr = reinterpret_cast<unsigned long long>(p);
+    mem->size = bytes;
+    heap->live.insert(mem->u.device.device_addr);
+    ++heap->allocs;
+    return true;
+  }
+
+  void free(bm_device_mem_t mem) {
+    EXPECT_EQ(heap->live.erase(mem.u.device.device_addr), 1u)
+        << "double free or foreign memory";
+    std::free(reinterpret_cast<void*>(mem.u.device.device_addr));
+    ++heap->frees;
+  }
+};
+
+using HostMemPool = BasicDeviceMemPool<HostAllocator>;
+
+/**
+ * @brief 代替bmlib的显存操作：申请和释放走同一个Heap，拷贝用memcpy
+ */
+struct HostOps {
+  static std::shared_ptr<HostAllocator::Heap> heap;
+  static int copies;
+
+  static bm_status_t alloc(bm_handle_t, bm_device_mem_t* mem, int,
+                           unsigned int bytes) {
+    HostAllocator{heap}.alloc(bytes, mem);
+    return BM_SUCCESS;
+  }
+  static void free(bm_handle_t, bm_device_mem_t mem) {
+    HostAllocator{heap}.free(mem);
+  }
+  static bm_status_t copy(bm_handle_t, bm_device_mem_t dst,
+                          std::size_t dstOffset, bm_device_mem_t src,
+                          std::size_t srcOffset, std::size_t bytes) {
+    EXPECT_LE(dstOffset + bytes, dst.size);
+    EXPECT_LE(srcOffset + bytes, src.size);
+    std::memcpy(reinterpret_cast<char*>(dst.u.device.device_addr) + dstOffset,
+                reinterpret_cast<char*>(src.u.device.device_addr) + srcOffset,
+                bytes);
+    ++copies;
+    return BM_SUCCESS;
+  }
+};
+
+std::shared_ptr<HostAllocator::Heap> HostOps::heap;
+int HostOps::copies = 0;
+
+class BatchTensorsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    HostOps::heap = heap;
+    HostOps::copies = 0;
+  }
+
+  void TearDown() override {
+    objects.clear();
+    pool.reset();
+    // 所有显存都已经归还
+    EXPECT_TRUE(heap->live.empty());
+  }
+
+  ObjectMetadatas makeObjects(int n) {
+    ObjectMetadatas result;
+    for (int i = 0; i < n; ++i) {
+      auto obj = std::make_shared<ObjectMetadata>();
+      obj->mFrame = std::make_shared<Frame>();
+      obj->mFrame->mFrameId = i;
+      result.push_back(obj);
+    }
+    return result;
+  }
+
+  // 1x3x4x4的int8输入，两路输入大小不同
+  static std::vector<BatchTensorLayout> inputLayouts(int maxBatch) {
+    std::vector<BatchTensorLayout> layouts(2);
+    layouts[0].dtype = BM_INT8;
+    layouts[0].shape = {4, {maxBatch, 3, 4, 4}};
+    layouts[0].bytes = maxBatch * 48;
+    layouts[1].dtype = BM_FLOAT32;
+    layouts[1].shape = {2, {maxBatch, 2}};
+    layouts[1].bytes = maxBatch * 8;
+    return layouts;
+  }
+
+  static unsigned long long addr(const bm_device_mem_t& mem) {
+    return bm_mem_get_device_addr(mem);
+  }
+
+  std::shared_ptr<HostAllocator::Heap> heap =
+      std::make_shared<HostAllocator::Heap>();
+  std::shared_ptr<HostMemPool> pool =
+      std::make_shared<HostMemPool>(HostAllocator{heap});
+  bm_handle_t handle = nullptr;
+  ObjectMetadatas objects;
+};
+
+}  // namespace
+
+TEST_F(BatchTensorsTest, InputsAreSlotsOfOneBatch) {
+  objects = makeObjects(3);
+  auto batch =
+      stageBatchInputs<HostOps>(pool, handle, inputLayouts(4), 4, objects);
+  ASSERT_EQ(batch->tensors.size(), 2u);
+  EXPECT_EQ(batch->tensors[0]->device_mem.size, 4u * 48);
+  EXPECT_EQ(heap->allocs, 2);
+
+  for (int j = 0; j < 3; ++j) {
+    auto& inputs = objects[j]->mInputBMtensors;
+    EXPECT_EQ(inputs->batch, batch);
+    EXPECT_EQ(inputs->batchIndex, j);
+    EXPECT_EQ(addr(inputs->tensors[0]->device_mem),
+              addr(batch->tensors[0]->device_mem) + j * 48);
+    EXPECT_EQ(inputs->tensors[0]->device_mem.size, 48u);
+    EXPECT_EQ(addr(inputs->tensors[1]->device_mem),
+              addr(batch->tensors[1]->device_mem) + j * 8);
+    EXPECT_EQ(inputs->tensors[1]->shape.dims[0], 1);
+    EXPECT_EQ(inputs->tensors[1]->shape.dims[1], 2);
+    EXPECT_EQ(inputs->tensors[1]->dtype, BM_FLOAT32);
+  }
+}
+
+TEST_F(BatchTensorsTest, SlotsReturnToPoolWithTheBatch) {
+  objects = makeObjects(2);
+  stageBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, objects);
+  objects[0].reset();
+  // 还有目标引用batch，显存不能归还
+  EXPECT_EQ(pool->getStats().inUseBytes, 2u * 48 + 2u * 8);
+  objects[1].reset();
+  EXPECT_EQ(pool->getStats().inUseBytes, 0u);
+  EXPECT_EQ(heap->frees, 0);
+
+  // 下一批复用同一块batch显存
+  objects = makeObjects(2);
+  stageBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, objects);
+  EXPECT_EQ(heap->allocs, 2);
+  EXPECT_EQ(pool->getStats().reused, 2u);
+}
+
+TEST_F(BatchTensorsTest, SlotUsedWhenPreprocessFits) {
+  objects = makeObjects(2);
+  stageBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, objects);
+  bm_device_mem_t mem;
+  auto& inputs = *objects[1]->mInputBMtensors;
+  ASSERT_EQ(acquireSlotOrAlloc<HostOps>(inputs, 48, &mem), BM_SUCCESS);
+  EXPECT_EQ(addr(mem), addr(inputs.tensors[0]->device_mem));
+  EXPECT_EQ(heap->allocs, 2);
+}
+
+TEST_F(BatchTensorsTest, DeleterFreesOnlyReplacedMemory) {
+  objects = makeObjects(2);
+  stageBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, objects);
+  // 预处理结果放不下槽位时单独申请，并替换目标的输入
+  bm_device_mem_t mem;
+  auto& inputs = *objects[0]->mInputBMtensors;
+  ASSERT_EQ(acquireSlotOrAlloc<HostOps>(inputs, 64, &mem), BM_SUCCESS);
+  EXPECT_EQ(heap->allocs, 3);
+  inputs.tensors[0]->device_mem = mem;
+
+  objects[0].reset();
+  EXPECT_EQ(heap->frees, 1);
+  EXPECT_EQ(heap->live.count(addr(mem)), 0u);
+  // 第二个目标的槽位不由目标释放
+  objects[1].reset();
+  EXPECT_EQ(heap->frees, 1);
+  EXPECT_EQ(pool->getStats().inUseBytes, 0u);
+}
+
+TEST_F(BatchTensorsTest, StagedBatchIsMergedWithoutCopy) {
+  objects = makeObjects(3);
+  auto batch =
+      stageBatchInputs<HostOps>(pool, handle, inputLayouts(4), 4, objects);
+  EXPECT_EQ(getStagedBatch(objects, 4), batch);
+  EXPECT_EQ(mergeBatchInputs<HostOps>(pool, handle, inputLayouts(4), 4,
+                                      objects),
+            batch);
+  EXPECT_EQ(HostOps::copies, 0);
+
+  // EOS帧之后的目标不参与推理，不检查
+  objects.push_back(makeObjects(1)[0]);
+  objects[3]->mFrame->mEndOfStream = true;
+  EXPECT_EQ(getStagedBatch(objects, 4), batch);
+}
+
+TEST_F(BatchTensorsTest, SplitBatchFallsBackToCopy) {
+  auto first = makeObjects(2);
+  auto second = makeObjects(2);
+  stageBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, first);
+  stageBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, second);
+  for (int j = 0; j < 2; ++j) {
+    std::memset(reinterpret_cast<void*>(
+                    addr(second[j]->mInputBMtensors->tensors[0]->device_mem)),
+                10 + j, 48);
+  }
+  // 来自两个batch的目标凑成一批：second[1]排在第0个
+  objects = {second[1], first[0]};
+  EXPECT_EQ(getStagedBatch(objects, 2), nullptr);
+  auto merged =
+      mergeBatchInputs<HostOps>(pool, handle, inputLayouts(2), 2, objects);
+  EXPECT_NE(merged, second[1]->mInputBMtensors->batch);
+  EXPECT_EQ(HostOps::copies, 4);
+  auto data =
+      reinterpret_cast<const char*>(addr(merged->tensors[0]->device_mem));
+  EXPECT_EQ(data[0], 11);
+  EXPECT_EQ(data[47], 11);
+  EXPECT_EQ(data[48], 0);
+
+  // 目标的输入被换成自己申请的显存时也不再是槽位
+  objects = second;
+  EXPECT_NE(getStagedBatch(objects, 2), nullptr);
+  auto& moved = objects[1]->mInputBMtensors->tensors[1]->device_mem;
+  moved.u.device.device_addr += 4;
+  EXPECT_EQ(getStagedBatch(objects, 2), nullptr);
+  moved.u.device.device_addr -= 4;
+
+  // 没有batch的目标(max_batch为1或超过max_batch)一律拷贝
+  objects = makeObjects(1);
+  EXPECT_EQ(getStagedBatch(objects, 2), nullptr);
+  first.clear();
+  second.clear();
+  merged.reset();
+}
+
+TEST_F(BatchTensorsTest, OutputsAreViewsWhenAligned) {
+  objects = makeObjects(3);
+  std::vector<BatchTensorLayout> layouts(1);
+  layouts[0].dtype = BM_FLOAT32;
+  layouts[0].shape = {2, {4, 1024}};
+  layouts[0].bytes = 4 * kMmapAlignBytes;
+  auto outputs = pool->makeTensors(handle, 1);
+  ASSERT_TRUE(
+      pool->acquire(layouts[0].bytes, &outputs->tensors[0]->device_mem));
+
+  splitBatchOutputs<HostOps>(pool, handle, layouts, 4, true, objects, outputs);
+  EXPECT_EQ(HostOps::copies, 0);
+  for (int i = 0; i < 3; ++i) {
+    auto& out = objects[i]->mOutputBMtensors;
+    EXPECT_EQ(out->batch, outputs);
+    EXPECT_EQ(out->batchIndex, i);
+    EXPECT_EQ(addr(out->tensors[0]->device_mem),
+              addr(outputs->tensors[0]->device_mem) + i * kMmapAlignBytes);
+    EXPECT_EQ(out->tensors[0]->device_mem.size, kMmapAlignBytes);
+    EXPECT_EQ(out->tensors[0]->shape.dims[0], 1);
+  }
+
+  // batch输出在最后一个视图释放后才还给pool
+  outputs.reset();
+  EXPECT_EQ(pool->getStats().inUseBytes, 4 * kMmapAlignBytes);
+  objects.clear();
+  EXPECT_EQ(pool->getStats().inUseBytes, 0u);
+}
+
+TEST_F(BatchTensorsTest, UnalignedSocOutputsAreCopied) {
+  objects = makeObjects(2);
+  std::vector<BatchTensorLayout> layouts(2);
+  layouts[0].dtype = BM_FLOAT32;
+  layouts[0].shape = {2, {2, 1024}};
+  layouts[0].bytes = 2 * kMmapAlignBytes;
+  // 第二路每段100字节，不是页对齐的
+  layouts[1].dtype = BM_INT8;
+  layouts[1].shape = {2, {2, 100}};
+  layouts[1].bytes = 200;
+  auto outputs = pool->makeTensors(handle, 2);
+  for (int j = 0; j < 2; ++j)
+    ASSERT_TRUE(
+        pool->acquire(layouts[j].bytes, &outputs->tensors[j]->device_mem));
+  auto src = reinterpret_cast<char*>(addr(outputs->tensors[1]->device_mem));
+  for (int k = 0; k < 200; ++k) src[k] = k;
+
+  // PCIe模式不mmap，仍然用视图
+  splitBatchOutputs<HostOps>(pool, handle, layouts, 2, false, objects,
+                             outputs);
+  EXPECT_EQ(HostOps::copies, 0);
+  EXPECT_EQ(objects[1]->mOutputBMtensors->batch, outputs);
+
+  // SoC模式下任一路不对齐，所有输出都拷贝
+  splitBatchOutputs<HostOps>(pool, handle, layouts, 2, true, objects, outputs);
+  EXPECT_EQ(HostOps::copies, 4);
+  auto& out = objects[1]->mOutputBMtensors;
+  EXPECT_EQ(out->batch, nullptr);
+  EXPECT_NE(addr(out->tensors[1]->device_mem),
+            addr(outputs->tensors[1]->device_mem) + 100);
+  EXPECT_EQ(out->tensors[1]->device_mem.size, 100u);
+  auto copied =
+      reinterpret_cast<const char*>(addr(out->tensors[1]->device_mem));
+  EXPECT_EQ(copied[0], 100);
+  EXPECT_EQ(copied[99], static_cast<char>(199));
+
+  // 拷贝出的显存随目标还给pool，batch输出可以立即复用
+  outputs.reset();
+  objects.clear();
+  EXPECT_EQ(pool->getStats().inUseBytes, 0u);
+}
+
+}  // namespace common
+}  // namespace sophon_stream
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "connector.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace sophon_stream {
+namespace framework {
+namespace {
+
+// 每个dataPipe上当前分到的通道数
+std::vector<int> pipeLoads(Connector& connector,
+                           const std::vector<int>& channels) {
+  std::vector<int> loads(connector.getCapacity(), 0);
+  for (int channel : channels) ++loads[connector.getDataPipeId(channel)];
+  return loads;
+}
+
+}  // namespace
+
+TEST(ConnectorTest, DefaultRoutesByChannelModulo) {
+  Connector connector(4);
+  for (int channel : {0, 1, 4, 7, 8, 12, 13})
+    EXPECT_EQ(connector.getDataPipeId(channel), channel % 4);
+  // EOS不影响取模分配
+  EXPECT_EQ(connector.getDataPipeId(5, true), 1);
+  EXPECT_EQ(connector.getDataPipeId(5), 1);
+}
+
+TEST(ConnectorTest, BalancedSpreadsStridedChannels) {
+  // 取模时通道0、4、8、12全部落到dataPipe 0
+  Connector connector(4);
+  connector.setBalanced(true);
+  std::vector<int> channels = {0, 4, 8, 12};
+  EXPECT_EQ(pipeLoads(connector, channels), (std::vector<int>{1, 1, 1, 1}));
+}
+
+TEST(ConnectorTest, BalancedKeepsChannelOnItsPipe) {
+  Connector connector(3);
+  connector.setBalanced(true);
+  std::vector<int> first;
+  for (int channel = 0; channel < 7; ++channel)
+    first.push_back(connector.getDataPipeId(channel * 10));
+  for (int round = 0; round < 3; ++round)
+    for (int channel = 0; channel < 7; ++channel)
+      EXPECT_EQ(connector.getDataPipeId(channel * 10), first[channel]);
+  // 7个通道分到3个dataPipe，差距不超过1
+  auto loads = std::vector<int>(3, 0);
+  for (int id : first) ++loads[id];
+  EXPECT_LE(*std::max_element(loads.begin(), loads.end()) -
+                *std::min_element(loads.begin(), loads.end()),
+            1);
+}
+
+TEST(ConnectorTest, BalancedReleasesChannelAtEndOfStream) {
+  Connector connector(2);
+  connector.setBalanced(true);
+  EXPECT_EQ(connector.getDataPipeId(10), 0);
+  EXPECT_EQ(connector.getDataPipeId(11), 1);
+  EXPECT_EQ(connector.getDataPipeId(12), 0);
+  // EOS帧仍然推入通道原来的dataPipe，之后释放
+  EXPECT_EQ(connector.getDataPipeId(10, true), 0);
+  EXPECT_EQ(connector.getDataPipeId(12, true), 0);
+  // dataPipe 0空出来，新通道和重新出现的通道都分到它
+  EXPECT_EQ(connector.getDataPipeId(13), 0);
+  EXPECT_EQ(connector.getDataPipeId(10), 0);
+  EXPECT_EQ(connector.getDataPipeId(14), 1);
+}
+
+TEST(ConnectorTest, BalancedConcurrentRoutingStaysEven) {
+  const int kPipes = 4;
+  const int kThreads = 8;
+  const int kChannelsPerThread = 16;
+  Connector connector(kPipes);
+  connector.setBalanced(true);
+  std::vector<std::vector<int>> routes(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t)
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 4; ++round)
+        for (int c = 0; c < kChannelsPerThread; ++c) {
+          int id = connector.getDataPipeId(t * kChannelsPerThread + c);
+          if (round == 0)
+            routes[t].push_back(id);
+          else
+            EXPECT_EQ(id, routes[t][c]);
+        }
+    });
+  for (auto& thread : threads) thread.join();
+
+  std::vector<int> loads(kPipes, 0);
+  for (auto& route : routes)
+    for (int id : route) ++loads[id];
+  EXPECT_EQ(loads, std::vector<int>(kPipes,
+                                    kThreads * kChannelsPerThread / kPipes));
+}
+
+TEST(ConnectorTest, DataPipeCapacity) {
+  Connector sized(2, 3);
+  auto pipe = sized.getDataPipe(1);
+  EXPECT_EQ(pipe->getCapacity(), 3u);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(sized.pushData(1, std::make_shared<int>(i)),
+              common::ErrorCode::SUCCESS);
+  EXPECT_EQ(sized.pushData(1, std::make_shared<int>(3)),
+            common::ErrorCode::DATA_PIPE_FULL);
+  EXPECT_EQ(*std::static_pointer_cast<int>(sized.popData(1)), 0);
+
+  // 不大于0时使用默认长度
+  Connector defaults(1, 0);
+  EXPECT_EQ(defaults.getDataPipe(0)->getCapacity(), 20u);
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "device_balancer.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace sophon_stream {
+namespace framework {
+
+TEST(DeviceBalancerTest, EmptyDeviceListIsRejected) {
+  DeviceBalancer balancer;
+  EXPECT_EQ(balancer.acquire({}), -1);
+}
+
+TEST(DeviceBalancerTest, SpreadsChannelsWithoutMeasurements) {
+  DeviceBalancer balancer;
+  // 都没有测量值时按通道数轮流分配，并列时取列表中靠前的设备
+  EXPECT_EQ(balancer.acquire({2, 0, 1}), 2);
+  EXPECT_EQ(balancer.acquire({2, 0, 1}), 0);
+  EXPECT_EQ(balancer.acquire({2, 0, 1}), 1);
+  EXPECT_EQ(balancer.acquire({2, 0, 1}), 2);
+  EXPECT_EQ(balancer.getChannels(2), 2);
+  EXPECT_EQ(balancer.getChannels(0), 1);
+  EXPECT_EQ(balancer.getChannels(1), 1);
+  EXPECT_EQ(balancer.getLatency(0), 1.);
+}
+
+TEST(DeviceBalancerTest, ReleaseFreesTheDevice) {
+  DeviceBalancer balancer;
+  EXPECT_EQ(balancer.acquire({0, 1}), 0);
+  EXPECT_EQ(balancer.acquire({0, 1}), 1);
+  balancer.release(0);
+  EXPECT_EQ(balancer.getChannels(0), 0);
+  EXPECT_EQ(balancer.acquire({0, 1}), 0);
+
+  // 多余的release和未知设备不会让通道数变成负数
+  balancer.release(1);
+  balancer.release(1);
+  balancer.release(7);
+  EXPECT_EQ(balancer.getChannels(1), 0);
+  EXPECT_EQ(balancer.getChannels(7), 0);
+}
+
+TEST(DeviceBalancerTest, PrefersTheFasterDevice) {
+  DeviceBalancer balancer;
+  balancer.reportLatency(0, 40., 4);  // 10ms每帧
+  balancer.reportLatency(1, 30., 1);  // 30ms每帧
+  // 负载为(通道数 + 1) * 每帧耗时，第3路时两者并列取靠前的设备0
+  std::vector<int> picks;
+  for (int i = 0; i < 4; ++i) picks.push_back(balancer.acquire({0, 1}));
+  EXPECT_EQ(picks, (std::vector<int>{0, 0, 0, 1}));
+}
+
+TEST(DeviceBalancerTest, LatencyIsSmoothed) {
+  DeviceBalancer balancer;
+  balancer.reportLatency(0, 20., 2);
+  EXPECT_DOUBLE_EQ(balancer.getLatency(0), 10.);
+  balancer.reportLatency(0, 20., 1);
+  EXPECT_DOUBLE_EQ(balancer.getLatency(0), 11.);
+  // 空批次不计入
+  balancer.reportLatency(0, 100., 0);
+  EXPECT_DOUBLE_EQ(balancer.getLatency(0), 11.);
+}
+
+TEST(DeviceBalancerTest, UnmeasuredDeviceUsesAverageLatency) {
+  DeviceBalancer balancer;
+  balancer.reportLatency(0, 10., 1);
+  balancer.reportLatency(1, 30., 1);
+  // 新设备按已测设备的平均值估计，而不是0，避免把所有通道都分给它
+  EXPECT_DOUBLE_EQ(balancer.getLatency(2), 20.);
+  EXPECT_EQ(balancer.acquire({2, 0}), 0);
+  EXPECT_EQ(balancer.acquire({2, 0}), 2);
+  EXPECT_EQ(balancer.acquire({2, 0}), 0);
+}
+
+TEST(DeviceBalancerTest, ConcurrentAcquireStaysBalanced) {
+  DeviceBalancer balancer;
+  const int kThreads = 8;
+  const int kChannelsPerThread = 32;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t)
+    threads.emplace_back([&] {
+      for (int c = 0; c < kChannelsPerThread; ++c)
+        balancer.acquire({0, 1, 2, 3});
+    });
+  for (auto& thread : threads) thread.join();
+  for (int device = 0; device < 4; ++device)
+    EXPECT_EQ(balancer.getChannels(device), kThreads * kChannelsPerThread / 4);
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/device_mem_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <set>
+#include <thread>
+
+namespace sophon_stream {
+namespace common {
+namespace {
+
+/**
+ * @brief 在主机内存上分配的allocator，记录仍未释放的地址
+ * @brief allocator按值保存在池里，状态放在共享的Heap中
+ */
+struct HostAllocator {
+  struct Heap {
+    std::mutex mutex;
+    std::set<unsigned long long> live;
+    int allocs = 0;
+    int frees = 0;
+    bool fail = false;
+  };
+  std::shared_ptr<Heap> heap;
+
+  bool alloc(std::size_t bytes, bm_device_mem_t* mem) {
+    std::lock_guard<std::mutex> lock(heap->mutex);
+    if (heap->fail) return false;
+    void* p = std::malloc(bytes);
+    *mem = bm_device_mem_t();
+    mem->u.device.device_addr = reinterpret_cast<unsigned long long>(p);
+    mem->size = bytes;
+    heap->live.insert(mem->u.device.device_addr);
+    ++heap->allocs;
+    return true;
+  }
+
+  void free(bm_device_mem_t mem) {
+    std::lock_guard<std::mutex> lock(heap->mutex);
+    EXPECT_EQ(heap->live.erase(mem.u.device.device_addr), 1u)
+        << "double free or foreign memory";
+    std::free(reinterpret_cast<void*>(mem.u.device.device_addr));
+    ++heap->frees;
+  }
+};
+
+using HostMemPool = BasicDeviceMemPool<HostAllocator>;
+
+std::shared_ptr<HostMemPool> makePool(std::shared_ptr<HostAllocator::Heap> heap,
+                                      int maxCachedPerSize = 16) {
+  return std::make_shared<HostMemPool>(HostAllocator{heap}, maxCachedPerSize);
+}
+
+}  // namespace
+
+TEST(DeviceMemPoolTest, ReleasedMemoryIsReusedBySize) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  auto pool = makePool(heap);
+  bm_device_mem_t a, b;
+  ASSERT_TRUE(pool->acquire(1024, &a));
+  pool->release(a);
+  ASSERT_TRUE(pool->acquire(1024, &b));
+  EXPECT_EQ(b.u.device.device_addr, a.u.device.device_addr);
+
+  // 大小不同时不复用
+  bm_device_mem_t c;
+  ASSERT_TRUE(pool->acquire(2048, &c));
+  EXPECT_NE(c.u.device.device_addr, a.u.device.device_addr);
+  EXPECT_EQ(heap->allocs, 2);
+  pool->release(b);
+  pool->release(c);
+}
+
+TEST(DeviceMemPoolTest, StatsTrackReuseAndBytes) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  auto pool = makePool(heap);
+  bm_device_mem_t a, b;
+  ASSERT_TRUE(pool->acquire(100, &a));
+  ASSERT_TRUE(pool->acquire(100, &b));
+  auto stats = pool->getStats();
+  EXPECT_EQ(stats.acquired, 2u);
+  EXPECT_EQ(stats.allocated, 2u);
+  EXPECT_EQ(stats.reused, 0u);
+  EXPECT_EQ(stats.inUseBytes, 200u);
+  EXPECT_EQ(stats.cachedBytes, 0u);
+
+  pool->release(a);
+  stats = pool->getStats();
+  EXPECT_EQ(stats.inUseBytes, 100u);
+  EXPECT_EQ(stats.cachedBytes, 100u);
+
+  ASSERT_TRUE(pool->acquire(100, &a));
+  stats = pool->getStats();
+  EXPECT_EQ(stats.acquired, 3u);
+  EXPECT_EQ(stats.reused, 1u);
+  EXPECT_EQ(stats.allocated, 2u);
+  EXPECT_EQ(stats.inUseBytes, 200u);
+  EXPECT_EQ(stats.cachedBytes, 0u);
+  pool->release(a);
+  pool->release(b);
+}
+
+TEST(DeviceMemPoolTest, CachedBlocksCappedPerSize) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  auto pool = makePool(heap, 2);
+  std::vector<bm_device_mem_t> mems(5);
+  for (auto& mem : mems) ASSERT_TRUE(pool->acquire(64, &mem));
+  bm_device_mem_t other;
+  ASSERT_TRUE(pool->acquire(32, &other));
+  for (auto& mem : mems) pool->release(mem);
+  pool->release(other);
+
+  // 64字节只缓存2块，其余3块直接还给allocator；32字节不受64字节的上限影响
+  auto stats = pool->getStats();
+  EXPECT_EQ(stats.freed, 3u);
+  EXPECT_EQ(stats.cachedBytes, 2u * 64 + 32);
+  EXPECT_EQ(stats.inUseBytes, 0u);
+  EXPECT_EQ(heap->frees, 3);
+  EXPECT_EQ(heap->live.size(), 3u);
+}
+
+TEST(DeviceMemPoolTest, AllocatorFailureIsReported) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  auto pool = makePool(heap);
+  heap->fail = true;
+  bm_device_mem_t mem;
+  EXPECT_FALSE(pool->acquire(16, &mem));
+  auto stats = pool->getStats();
+  EXPECT_EQ(stats.allocated, 0u);
+  EXPECT_EQ(stats.inUseBytes, 0u);
+}
+
+TEST(DeviceMemPoolTest, DestructorFreesCachedBlocks) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  {
+    auto pool = makePool(heap);
+    bm_device_mem_t a, b;
+    ASSERT_TRUE(pool->acquire(10, &a));
+    ASSERT_TRUE(pool->acquire(20, &b));
+    pool->release(a);
+    pool->release(b);
+  }
+  EXPECT_EQ(heap->allocs, 2);
+  EXPECT_EQ(heap->frees, 2);
+  EXPECT_TRUE(heap->live.empty());
+}
+
+TEST(DeviceMemPoolTest, TensorsOutlivingPoolReleaseOnDestruction) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  auto pool = makePool(heap);
+  auto tensors = pool->makeTensors(nullptr, 3);
+  ASSERT_TRUE(pool->acquire(128, &tensors->tensors[0]->device_mem));
+  ASSERT_TRUE(pool->acquire(256, &tensors->tensors[1]->device_mem));
+  // tensors[2]没有申请显存，析构时跳过
+
+  // 使用者先释放内存池，tensors仍持有它，显存在tensors析构时归还并释放
+  pool.reset();
+  EXPECT_EQ(heap->frees, 0);
+  tensors.reset();
+  EXPECT_EQ(heap->allocs, 2);
+  EXPECT_EQ(heap->frees, 2);
+  EXPECT_TRUE(heap->live.empty());
+}
+
+TEST(DeviceMemPoolTest, ConcurrentAcquireRelease) {
+  auto heap = std::make_shared<HostAllocator::Heap>();
+  auto pool = makePool(heap, 4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([pool, t] {
+      for (int i = 0; i < 1000; ++i) {
+        bm_device_mem_t mem;
+        ASSERT_TRUE(pool->acquire(64 * (1 + (i + t) % 3), &mem));
+        pool->release(mem);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  auto stats = pool->getStats();
+  EXPECT_EQ(stats.acquired, 4000u);
+  EXPECT_EQ(stats.reused + stats.allocated, 4000u);
+  EXPECT_EQ(stats.inUseBytes, 0u);
+  pool.reset();
+  EXPECT_TRUE(heap->live.empty());
+}
+
+}  // namespace common
+}  // namespace sophon_stream
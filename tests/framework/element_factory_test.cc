@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "element_factory.h"
+
+#include <gtest/gtest.h>
+
+namespace sophon_stream {
+namespace framework {
+
+TEST(ElementFactoryTest, MakeCallsRegisteredMaker) {
+  ElementFactory factory;
+  int made = 0;
+  auto maker = [&made] {
+    ++made;
+    return std::shared_ptr<Element>();
+  };
+  EXPECT_EQ(factory.addElementMaker("fake", maker),
+            common::ErrorCode::SUCCESS);
+  factory.make("fake");
+  EXPECT_EQ(made, 1);
+  EXPECT_EQ(factory.addElementMaker("fake", maker),
+            common::ErrorCode::REPEATED_WORKER_NAME);
+}
+
+TEST(ElementFactoryTest, RemovedMakerCanBeRegisteredAgain) {
+  // 模拟element动态库被第一个Graph卸载、又被第二个Graph重新加载
+  ElementFactory factory;
+  int generation = 0;
+  auto firstMaker = [&generation] {
+    generation = 1;
+    return std::shared_ptr<Element>();
+  };
+  auto secondMaker = [&generation] {
+    generation = 2;
+    return std::shared_ptr<Element>();
+  };
+  factory.addElementMaker("fake", firstMaker);
+  factory.removeElementMaker("fake");
+  factory.make("fake");
+  EXPECT_EQ(generation, 0);
+
+  EXPECT_EQ(factory.addElementMaker("fake", secondMaker),
+            common::ErrorCode::SUCCESS);
+  factory.make("fake");
+  EXPECT_EQ(generation, 2);
+  factory.removeElementMaker("missing");
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SOPHON_STREAM_TESTS_FAKE_INFERENCE_BACKEND_H_
+#define SOPHON_STREAM_TESTS_FAKE_INFERENCE_BACKEND_H_
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace sophon_stream {
+namespace tests {
+
+/**
+ * @brief 用sleep模拟TPU推理延迟的假后端，记录同时在推理的batch数
+ * @brief 替代bmrt_launch_tensor_ex + bm_thread_sync，在没有设备的主机上驱动
+ * InflightQueue的流水逻辑
+ */
+class FakeInferenceBackend {
+ public:
+  explicit FakeInferenceBackend(std::chrono::milliseconds latency)
+      : mLatency(latency) {}
+
+  /**
+   * @brief 推理一个batch，latency为负时使用构造时的延迟
+   */
+  void forward(std::chrono::milliseconds latency =
+                   std::chrono::milliseconds(-1)) {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      ++mRunning;
+      mMaxRunning = std::max(mMaxRunning, mRunning);
+      ++mLaunched;
+    }
+    std::this_thread::sleep_for(latency.count() < 0 ? mLatency : latency);
+    std::lock_guard<std::mutex> lock(mMutex);
+    --mRunning;
+  }
+
+  int getRunning() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRunning;
+  }
+
+  int getMaxRunning() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMaxRunning;
+  }
+
+  int getLaunched() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLaunched;
+  }
+
+ private:
+  std::chrono::milliseconds mLatency;
+  std::mutex mMutex;
+  int mRunning = 0;
+  int mMaxRunning = 0;
+  int mLaunched = 0;
+};
+
+}  // namespace tests
+}  // namespace sophon_stream
+
+#endif  // SOPHON_STREAM_TESTS_FAKE_INFERENCE_BACKEND_H_
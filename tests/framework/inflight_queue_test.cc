@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/inflight_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+
+#include "fake_inference_backend.h"
+
+namespace sophon_stream {
+namespace common {
+namespace {
+
+using tests::FakeInferenceBackend;
+using Ms = std::chrono::milliseconds;
+
+// 提交n个batch，run在假后端上推理，done记录完成顺序和在途数
+struct Pipeline {
+  std::mutex mutex;
+  std::vector<int> doneOrder;
+  int outstanding = 0;
+  int maxOutstanding = 0;
+
+  void run(FakeInferenceBackend& backend, Ms latency) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++outstanding;
+      maxOutstanding = std::max(maxOutstanding, outstanding);
+    }
+    backend.forward(latency);
+  }
+
+  void done(int index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    doneOrder.push_back(index);
+    --outstanding;
+  }
+};
+
+std::vector<int> iota(int n) {
+  std::vector<int> v(n);
+  for (int i = 0; i < n; ++i) v[i] = i;
+  return v;
+}
+
+}  // namespace
+
+TEST(InflightQueueTest, DoneRunsInSubmissionOrder) {
+  FakeInferenceBackend backend(Ms(5));
+  Pipeline pipeline;
+  {
+    InflightQueue queue(4);
+    // 后提交的batch推理更快，done仍按提交顺序执行
+    for (int i = 0; i < 16; ++i) {
+      Ms latency(5 * (4 - i % 4));
+      queue.submit([&, latency] { pipeline.run(backend, latency); },
+                   [&, i] { pipeline.done(i); });
+    }
+    queue.drain();
+  }
+  EXPECT_EQ(pipeline.doneOrder, iota(16));
+}
+
+TEST(InflightQueueTest, InflightBatchesBoundedByDepth) {
+  for (int depth : {1, 2, 3}) {
+    FakeInferenceBackend backend(Ms(10));
+    Pipeline pipeline;
+    InflightQueue queue(depth);
+    for (int i = 0; i < 12; ++i)
+      queue.submit([&] { pipeline.run(backend, Ms(-1)); },
+                   [&, i] { pipeline.done(i); });
+    queue.drain();
+    EXPECT_EQ(backend.getLaunched(), 12);
+    EXPECT_LE(backend.getMaxRunning(), depth);
+    EXPECT_LE(pipeline.maxOutstanding, depth);
+    // 延迟足够长，在途batch能达到depth
+    EXPECT_EQ(pipeline.maxOutstanding, depth);
+    EXPECT_EQ(pipeline.doneOrder, iota(12));
+  }
+}
+
+TEST(InflightQueueTest, SubmitBlocksWhileQueueIsFull) {
+  InflightQueue queue(1);
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  queue.submit([released] { released.wait(); }, [] {});
+
+  std::atomic<bool> submitted(false);
+  std::thread producer([&] {
+    queue.submit([] {}, [] {});
+    submitted = true;
+  });
+  std::this_thread::sleep_for(Ms(50));
+  EXPECT_FALSE(submitted);
+  release.set_value();
+  producer.join();
+  EXPECT_TRUE(submitted);
+  queue.drain();
+}
+
+TEST(InflightQueueTest, DrainWaitsForEveryDone) {
+  FakeInferenceBackend backend(Ms(5));
+  std::atomic<int> done(0);
+  InflightQueue queue(3);
+  for (int i = 0; i < 9; ++i)
+    queue.submit([&] { backend.forward(); }, [&] { ++done; });
+  queue.drain();
+  EXPECT_EQ(done, 9);
+  EXPECT_EQ(backend.getRunning(), 0);
+}
+
+TEST(InflightQueueTest, DestructorFinishesSubmittedBatches) {
+  FakeInferenceBackend backend(Ms(5));
+  std::atomic<int> done(0);
+  {
+    InflightQueue queue(2);
+    for (int i = 0; i < 6; ++i)
+      queue.submit([&] { backend.forward(); }, [&] { ++done; });
+  }
+  EXPECT_EQ(done, 6);
+}
+
+TEST(InflightQueueTest, NonPositiveDepthFallsBackToOne) {
+  InflightQueue queue(0);
+  EXPECT_EQ(queue.getDepth(), 1);
+}
+
+TEST(InflightQueueTest, DeeperQueueHidesLatency) {
+  auto elapsed = [](int depth) {
+    FakeInferenceBackend backend(Ms(20));
+    auto start = std::chrono::steady_clock::now();
+    {
+      InflightQueue queue(depth);
+      for (int i = 0; i < 12; ++i)
+        queue.submit([&] { backend.forward(); }, [] {});
+    }
+    return std::chrono::steady_clock::now() - start;
+  };
+  auto sequential = elapsed(1);
+  auto pipelined = elapsed(3);
+  EXPECT_GE(sequential, Ms(240));
+  EXPECT_LT(pipelined, sequential * 3 / 4);
+}
+
+}  // namespace common
+}  // namespace sophon_stream
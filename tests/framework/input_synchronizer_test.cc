@@ -0,0 +1,270 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "input_synchronizer.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+
+namespace sophon_stream {
+namespace framework {
+namespace {
+
+std::shared_ptr<common::ObjectMetadata> makeObj(std::int64_t frameId,
+                                                std::int64_t timestamp = 0,
+                                                bool eos = false) {
+  auto obj = std::make_shared<common::ObjectMetadata>();
+  obj->mFrame = std::make_shared<common::Frame>();
+  obj->mFrame->mFrameId = frameId;
+  obj->mFrame->mTimestamp = timestamp;
+  obj->mFrame->mEndOfStream = eos;
+  return obj;
+}
+
+SyncOptions makeOptions(SyncOptions::MissingPolicy policy,
+                        std::int64_t tolerance = 0, int queueSize = 8) {
+  SyncOptions options;
+  options.policy = policy;
+  options.tolerance = tolerance;
+  options.queueSize = queueSize;
+  return options;
+}
+
+std::vector<std::int64_t> frameIds(const common::ObjectMetadatas& inputs) {
+  std::vector<std::int64_t> ids;
+  for (auto& obj : inputs) ids.push_back(obj->mFrame->mFrameId);
+  return ids;
+}
+
+using Ids = std::vector<std::int64_t>;
+
+}  // namespace
+
+TEST(InputSynchronizerTest, AlignsInOrderInputs) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::DROP));
+  common::ObjectMetadatas inputs;
+  sync.push(0, makeObj(0));
+  EXPECT_FALSE(sync.pop(inputs));
+  sync.push(1, makeObj(0));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{0, 0}));
+  EXPECT_FALSE(sync.pop(inputs));
+  EXPECT_EQ(sync.getDropped(), 0u);
+}
+
+TEST(InputSynchronizerTest, DropDiscardsFramesMissingOnOtherPort) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::DROP));
+  common::ObjectMetadatas inputs;
+  for (int i = 0; i < 4; ++i) sync.push(0, makeObj(i));
+  sync.push(1, makeObj(2));
+  sync.push(1, makeObj(3));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{2, 2}));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{3, 3}));
+  EXPECT_EQ(sync.getDropped(), 2u);
+  EXPECT_EQ(sync.getRepeated(), 0u);
+}
+
+TEST(InputSynchronizerTest, RepeatFillsLaggingGapWithLastFrame) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::REPEAT));
+  common::ObjectMetadatas inputs;
+  sync.push(0, makeObj(0));
+  sync.push(1, makeObj(0));
+  ASSERT_TRUE(sync.pop(inputs));
+  auto last = inputs[1];
+
+  // 端口1缺了1、2两帧，端口0的这两帧与端口1上一次的帧组成一组
+  for (int i = 1; i < 4; ++i) sync.push(0, makeObj(i));
+  sync.push(1, makeObj(3));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{1, 0}));
+  EXPECT_EQ(inputs[1], last);
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{2, 0}));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{3, 3}));
+  EXPECT_EQ(sync.getRepeated(), 2u);
+  EXPECT_EQ(sync.getDropped(), 0u);
+}
+
+TEST(InputSynchronizerTest, RepeatWithoutHistoryDrops) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::REPEAT));
+  common::ObjectMetadatas inputs;
+  sync.push(0, makeObj(1));
+  sync.push(0, makeObj(2));
+  sync.push(1, makeObj(2));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{2, 2}));
+  EXPECT_EQ(sync.getDropped(), 1u);
+  EXPECT_EQ(sync.getRepeated(), 0u);
+}
+
+TEST(InputSynchronizerTest, DropOnStalledPortAfterQueueSize) {
+  InputSynchronizer sync(2,
+                         makeOptions(SyncOptions::MissingPolicy::DROP, 0, 2));
+  common::ObjectMetadatas inputs;
+  sync.push(0, makeObj(0));
+  sync.push(0, makeObj(1));
+  EXPECT_FALSE(sync.pop(inputs));
+  EXPECT_EQ(sync.getDropped(), 0u);
+  sync.push(0, makeObj(2));
+  EXPECT_FALSE(sync.pop(inputs));
+  EXPECT_EQ(sync.getDropped(), 1u);
+  sync.push(1, makeObj(1));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{1, 1}));
+}
+
+TEST(InputSynchronizerTest, RepeatOnStalledPortAfterQueueSize) {
+  InputSynchronizer sync(2,
+                         makeOptions(SyncOptions::MissingPolicy::REPEAT, 0, 2));
+  common::ObjectMetadatas inputs;
+  sync.push(0, makeObj(0));
+  sync.push(1, makeObj(0));
+  ASSERT_TRUE(sync.pop(inputs));
+  for (int i = 1; i < 4; ++i) sync.push(0, makeObj(i));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{1, 0}));
+  EXPECT_FALSE(sync.pop(inputs));
+  EXPECT_EQ(sync.getRepeated(), 1u);
+}
+
+TEST(InputSynchronizerTest, FrameIdTolerance) {
+  InputSynchronizer loose(2,
+                          makeOptions(SyncOptions::MissingPolicy::DROP, 1));
+  common::ObjectMetadatas inputs;
+  loose.push(0, makeObj(10));
+  loose.push(1, makeObj(11));
+  ASSERT_TRUE(loose.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{10, 11}));
+
+  InputSynchronizer strict(2, makeOptions(SyncOptions::MissingPolicy::DROP));
+  strict.push(0, makeObj(10));
+  strict.push(1, makeObj(11));
+  EXPECT_FALSE(strict.pop(inputs));
+  EXPECT_EQ(strict.getDropped(), 1u);
+}
+
+TEST(InputSynchronizerTest, TimestampToleranceIsMilliseconds) {
+  auto options = makeOptions(SyncOptions::MissingPolicy::DROP, 5);
+  options.key = SyncOptions::Key::TIMESTAMP;
+  InputSynchronizer sync(2, options);
+  common::ObjectMetadatas inputs;
+  // mTimestamp单位为微秒
+  sync.push(0, makeObj(0, 100000));
+  sync.push(1, makeObj(7, 104000));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{0, 7}));
+
+  sync.push(0, makeObj(1, 200000));
+  sync.push(1, makeObj(8, 206000));
+  EXPECT_FALSE(sync.pop(inputs));
+  EXPECT_EQ(sync.getDropped(), 1u);
+}
+
+TEST(InputSynchronizerTest, EndOfStreamFramesAlignByKey) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::DROP));
+  common::ObjectMetadatas inputs;
+  for (int i = 0; i < 2; ++i) {
+    sync.push(0, makeObj(i));
+    sync.push(1, makeObj(i));
+  }
+  sync.push(0, makeObj(2, 0, true));
+  sync.push(1, makeObj(2, 0, true));
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(sync.pop(inputs));
+    EXPECT_EQ(frameIds(inputs), (Ids{i, i}));
+  }
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_TRUE(inputs[0]->mFrame->mEndOfStream);
+  EXPECT_TRUE(inputs[1]->mFrame->mEndOfStream);
+  EXPECT_FALSE(sync.pop(inputs));
+}
+
+TEST(InputSynchronizerTest, ClearForgetsRepeatHistory) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::REPEAT));
+  common::ObjectMetadatas inputs;
+  sync.push(0, makeObj(0));
+  sync.push(1, makeObj(0));
+  ASSERT_TRUE(sync.pop(inputs));
+  sync.clear();
+  sync.push(0, makeObj(1));
+  sync.push(0, makeObj(2));
+  sync.push(1, makeObj(2));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{2, 2}));
+  EXPECT_EQ(sync.getRepeated(), 0u);
+}
+
+TEST(InputSynchronizerTest, PollPullsEveryPortUntilAligned) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::DROP));
+  // 端口1落后一帧到达，端口0的第0帧没有对应帧被丢弃
+  std::vector<std::deque<std::shared_ptr<common::ObjectMetadata>>> ports = {
+      {makeObj(0), makeObj(1), makeObj(2)}, {nullptr, makeObj(1), makeObj(2)}};
+  std::vector<int> pulls(2, 0);
+  auto pull = [&](int index) -> std::shared_ptr<common::ObjectMetadata> {
+    ++pulls[index];
+    if (ports[index].empty()) return nullptr;
+    auto obj = ports[index].front();
+    ports[index].pop_front();
+    return obj;
+  };
+  auto running = [] { return true; };
+
+  common::ObjectMetadatas inputs;
+  ASSERT_TRUE(sync.poll(pull, running, inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{1, 1}));
+  EXPECT_EQ(pulls, (std::vector<int>{2, 2}));
+  ASSERT_TRUE(sync.poll(pull, running, inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{2, 2}));
+  EXPECT_EQ(sync.getDropped(), 1u);
+}
+
+TEST(InputSynchronizerTest, PollReturnsFalseOnceStoppedAndIdle) {
+  InputSynchronizer sync(2, makeOptions(SyncOptions::MissingPolicy::DROP));
+  bool delivered = false;
+  auto pull = [&](int index) -> std::shared_ptr<common::ObjectMetadata> {
+    if (index != 0 || delivered) return nullptr;
+    delivered = true;
+    return makeObj(0);
+  };
+  int checks = 0;
+  auto running = [&] { return ++checks < 2; };
+
+  common::ObjectMetadatas inputs;
+  EXPECT_FALSE(sync.poll(pull, running, inputs));
+  // 收到数据的一轮不检查running，之后空转两轮：第一轮等待，第二轮退出
+  EXPECT_EQ(checks, 2);
+  EXPECT_TRUE(inputs.empty());
+  // 已收到的数据留在缓冲中
+  sync.push(1, makeObj(0));
+  ASSERT_TRUE(sync.pop(inputs));
+  EXPECT_EQ(frameIds(inputs), (Ids{0, 0}));
+}
+
+TEST(InputSynchronizerTest, OptionsFromJson) {
+  auto options = SyncOptions::fromJson(nlohmann::json::parse(
+      R"({"sync_key": "TIMESTAMP", "sync_policy": "REPEAT",
+          "sync_tolerance": 20, "sync_queue_size": 4})"));
+  EXPECT_EQ(options.key, SyncOptions::Key::TIMESTAMP);
+  EXPECT_EQ(options.policy, SyncOptions::MissingPolicy::REPEAT);
+  EXPECT_EQ(options.tolerance, 20);
+  EXPECT_EQ(options.queueSize, 4);
+
+  auto defaults = SyncOptions::fromJson(nlohmann::json::object());
+  EXPECT_EQ(defaults.key, SyncOptions::Key::FRAME_ID);
+  EXPECT_EQ(defaults.policy, SyncOptions::MissingPolicy::DROP);
+  EXPECT_EQ(defaults.tolerance, 0);
+  EXPECT_EQ(defaults.queueSize, 8);
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "keypoint_window.h"
+
+#include <gtest/gtest.h>
+
+namespace sophon_stream {
+namespace framework {
+namespace {
+
+std::shared_ptr<const KeypointFrame> makeFrame(std::int64_t frameId) {
+  auto frame = std::make_shared<KeypointFrame>();
+  frame->frameId = frameId;
+  frame->keypoints.push_back({static_cast<float>(frameId), 0.f});
+  frame->scores.push_back({1.f});
+  return frame;
+}
+
+std::vector<std::int64_t> frameIds(const KeypointClip& clip) {
+  std::vector<std::int64_t> ids;
+  for (auto& frame : clip) ids.push_back(frame->frameId);
+  return ids;
+}
+
+}  // namespace
+
+TEST(KeypointWindowTest, EmitsOnceWindowIsFull) {
+  KeypointWindow window(3, 3);
+  KeypointClip clip;
+  EXPECT_FALSE(window.push(0, makeFrame(0), clip));
+  EXPECT_FALSE(window.push(0, makeFrame(1), clip));
+  EXPECT_TRUE(clip.empty());
+  ASSERT_TRUE(window.push(0, makeFrame(2), clip));
+  EXPECT_EQ(frameIds(clip), (std::vector<std::int64_t>{0, 1, 2}));
+}
+
+TEST(KeypointWindowTest, StrideEqualToWindowGivesDisjointClips) {
+  KeypointWindow window(3, 3);
+  KeypointClip clip;
+  std::vector<std::vector<std::int64_t>> clips;
+  for (int i = 0; i < 9; ++i)
+    if (window.push(0, makeFrame(i), clip)) clips.push_back(frameIds(clip));
+  ASSERT_EQ(clips.size(), 3u);
+  EXPECT_EQ(clips[0], (std::vector<std::int64_t>{0, 1, 2}));
+  EXPECT_EQ(clips[1], (std::vector<std::int64_t>{3, 4, 5}));
+  EXPECT_EQ(clips[2], (std::vector<std::int64_t>{6, 7, 8}));
+}
+
+TEST(KeypointWindowTest, SmallStrideGivesOverlappingClipsInOrder) {
+  KeypointWindow window(4, 2);
+  KeypointClip clip;
+  std::vector<std::vector<std::int64_t>> clips;
+  for (int i = 0; i < 8; ++i)
+    if (window.push(0, makeFrame(i), clip)) clips.push_back(frameIds(clip));
+  ASSERT_EQ(clips.size(), 3u);
+  EXPECT_EQ(clips[0], (std::vector<std::int64_t>{0, 1, 2, 3}));
+  EXPECT_EQ(clips[1], (std::vector<std::int64_t>{2, 3, 4, 5}));
+  EXPECT_EQ(clips[2], (std::vector<std::int64_t>{4, 5, 6, 7}));
+}
+
+TEST(KeypointWindowTest, OverlappingClipsShareFrames) {
+  KeypointWindow window(3, 1);
+  KeypointClip first, second;
+  for (int i = 0; i < 3; ++i) window.push(0, makeFrame(i), first);
+  ASSERT_TRUE(window.push(0, makeFrame(3), second));
+  // 重叠的两帧是同一个对象，没有拷贝
+  EXPECT_EQ(first[1].get(), second[0].get());
+  EXPECT_EQ(first[2].get(), second[1].get());
+}
+
+TEST(KeypointWindowTest, ChannelsDoNotMix) {
+  KeypointWindow window(2, 2);
+  KeypointClip clip;
+  EXPECT_FALSE(window.push(0, makeFrame(0), clip));
+  EXPECT_FALSE(window.push(1, makeFrame(100), clip));
+  ASSERT_TRUE(window.push(0, makeFrame(1), clip));
+  EXPECT_EQ(frameIds(clip), (std::vector<std::int64_t>{0, 1}));
+  ASSERT_TRUE(window.push(1, makeFrame(101), clip));
+  EXPECT_EQ(frameIds(clip), (std::vector<std::int64_t>{100, 101}));
+}
+
+TEST(KeypointWindowTest, ResetDropsBufferedFrames) {
+  KeypointWindow window(3, 3);
+  KeypointClip clip;
+  window.push(0, makeFrame(0), clip);
+  window.push(0, makeFrame(1), clip);
+  window.reset(0);
+  EXPECT_FALSE(window.push(0, makeFrame(10), clip));
+  EXPECT_FALSE(window.push(0, makeFrame(11), clip));
+  ASSERT_TRUE(window.push(0, makeFrame(12), clip));
+  EXPECT_EQ(frameIds(clip), (std::vector<std::int64_t>{10, 11, 12}));
+}
+
+TEST(KeypointWindowTest, FromObjectMetadataCopiesKeypoints) {
+  common::ObjectMetadata obj;
+  obj.mFrame = std::make_shared<common::Frame>();
+  obj.mFrame->mFrameId = 7;
+  obj.mFrame->mWidth = 640;
+  obj.mFrame->mHeight = 480;
+  auto pose = std::make_shared<common::PosedObjectMetadata>();
+  pose->keypoints = {1.f, 2.f, 0.5f};
+  pose->scores = {0.5f};
+  obj.mPosedObjectMetadatas.push_back(pose);
+
+  auto frame = KeypointFrame::fromObjectMetadata(obj);
+  EXPECT_EQ(frame->frameId, 7);
+  EXPECT_EQ(frame->width, 640);
+  EXPECT_EQ(frame->height, 480);
+  ASSERT_EQ(frame->keypoints.size(), 1u);
+  EXPECT_EQ(frame->keypoints[0], pose->keypoints);
+  EXPECT_EQ(frame->scores[0], pose->scores);
+}
+
+TEST(KeypointWindowDeathTest, RejectsNonPositiveSizes) {
+  EXPECT_EXIT(KeypointWindow(0, 1), ::testing::ExitedWithCode(1),
+              "window size");
+  EXPECT_EXIT(KeypointWindow(-3, 1), ::testing::ExitedWithCode(1),
+              "window size");
+  EXPECT_EXIT(KeypointWindow(3, 0), ::testing::ExitedWithCode(1),
+              "window stride");
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,261 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "micro_batcher.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+namespace sophon_stream {
+namespace framework {
+namespace {
+
+using Ms = std::chrono::milliseconds;
+
+std::shared_ptr<common::ObjectMetadata> makeObj(int channel,
+                                                std::int64_t frameId,
+                                                bool eos = false,
+                                                bool filter = false) {
+  auto obj = std::make_shared<common::ObjectMetadata>();
+  obj->mFrame = std::make_shared<common::Frame>();
+  obj->mFrame->mChannelIdInternal = channel;
+  obj->mFrame->mFrameId = frameId;
+  obj->mFrame->mEndOfStream = eos;
+  obj->mFilter = filter;
+  return obj;
+}
+
+std::vector<std::int64_t> frameIds(const common::ObjectMetadatas& objs) {
+  std::vector<std::int64_t> ids;
+  for (auto& obj : objs) ids.push_back(obj->mFrame->mFrameId);
+  return ids;
+}
+
+using Ids = std::vector<std::int64_t>;
+
+}  // namespace
+
+TEST(MicroBatcherTest, PopsFullBatchBeforeTimeout) {
+  MicroBatcher batcher(3, 10000);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  batcher.push(makeObj(0, 0));
+  batcher.push(makeObj(1, 1));
+  EXPECT_FALSE(batcher.pop(pending, objects, ticket, logStats));
+  batcher.push(makeObj(0, 2));
+  batcher.push(makeObj(1, 3));
+  ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats));
+  EXPECT_EQ(frameIds(objects), (Ids{0, 1, 2}));
+  EXPECT_EQ(frameIds(pending), (Ids{0, 1, 2}));
+  EXPECT_EQ(ticket, 0u);
+  EXPECT_EQ(batcher.size(), 1u);
+}
+
+TEST(MicroBatcherTest, PopsPartialBatchAfterTimeout) {
+  MicroBatcher batcher(4, 20);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  batcher.push(makeObj(0, 0));
+  EXPECT_FALSE(batcher.pop(pending, objects, ticket, logStats));
+  std::this_thread::sleep_for(Ms(30));
+  ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats));
+  EXPECT_EQ(frameIds(objects), (Ids{0}));
+}
+
+TEST(MicroBatcherTest, FlushIgnoresTimeout) {
+  MicroBatcher batcher(4, 10000);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  EXPECT_FALSE(batcher.pop(pending, objects, ticket, logStats, true));
+  batcher.push(makeObj(0, 0));
+  ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats, true));
+  EXPECT_EQ(frameIds(objects), (Ids{0}));
+}
+
+TEST(MicroBatcherTest, EosEndsBatchAndFilteredObjectsOnlyPending) {
+  MicroBatcher batcher(4, 10000);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  batcher.push(makeObj(0, 0));
+  batcher.push(makeObj(0, 1, false, true));
+  batcher.push(makeObj(0, 2, true));
+  batcher.push(makeObj(1, 3));
+  // EOS不等凑满maxBatch，且batch在EOS处截断
+  ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats));
+  EXPECT_EQ(frameIds(pending), (Ids{0, 1, 2}));
+  EXPECT_EQ(frameIds(objects), (Ids{0}));
+  EXPECT_EQ(batcher.size(), 1u);
+  EXPECT_FALSE(batcher.pop(pending, objects, ticket, logStats));
+}
+
+TEST(MicroBatcherTest, FilteredObjectsDoNotCountTowardsMaxBatch) {
+  MicroBatcher batcher(2, 10000);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  batcher.push(makeObj(0, 0, false, true));
+  batcher.push(makeObj(0, 1));
+  batcher.push(makeObj(0, 2, false, true));
+  EXPECT_FALSE(batcher.pop(pending, objects, ticket, logStats));
+  batcher.push(makeObj(0, 3));
+  batcher.push(makeObj(0, 4, false, true));
+  ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats));
+  EXPECT_EQ(frameIds(pending), (Ids{0, 1, 2, 3, 4}));
+  EXPECT_EQ(frameIds(objects), (Ids{1, 3}));
+}
+
+TEST(MicroBatcherTest, TicketsFollowPopOrder) {
+  MicroBatcher batcher(1, 10000);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  for (int i = 0; i < 5; ++i) batcher.push(makeObj(0, i));
+  for (std::uint64_t i = 0; i < 5; ++i) {
+    ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats));
+    EXPECT_EQ(ticket, i);
+    EXPECT_EQ(frameIds(objects), (Ids{static_cast<std::int64_t>(i)}));
+  }
+  // 空的EOS batch同样占用一个序号
+  batcher.push(makeObj(0, 5, true));
+  ASSERT_TRUE(batcher.pop(pending, objects, ticket, logStats));
+  EXPECT_EQ(ticket, 5u);
+  EXPECT_TRUE(objects.empty());
+}
+
+TEST(MicroBatcherTest, WaitTurnBlocksUntilEarlierTicketsFinish) {
+  MicroBatcher batcher(1, 10000);
+  std::atomic<bool> sent(false);
+  std::thread later([&] {
+    batcher.waitTurn(1);
+    sent = true;
+    batcher.finish(1);
+  });
+  std::this_thread::sleep_for(Ms(30));
+  EXPECT_FALSE(sent);
+  batcher.waitTurn(0);
+  batcher.finish(0);
+  later.join();
+  EXPECT_TRUE(sent);
+  // 之后的序号不再阻塞
+  batcher.waitTurn(2);
+  batcher.finish(2);
+}
+
+TEST(MicroBatcherTest, ConcurrentWorkersSendInArrivalOrder) {
+  // 多个工作线程同时取batch并以随机耗时"推理"，按序号发送后，所有数据
+  // 的发送顺序与放入顺序相同
+  const int numWorkers = 4, numObjects = 2000;
+  MicroBatcher batcher(3, 1);
+  std::mutex sentMutex;
+  Ids sent;
+  std::atomic<bool> running(true);
+
+  std::vector<std::thread> workers;
+  for (int w = 0; w < numWorkers; ++w) {
+    workers.emplace_back([&, w] {
+      std::mt19937 rng(w);
+      std::uniform_int_distribution<int> work(0, 200);
+      common::ObjectMetadatas pending, objects;
+      std::uint64_t ticket;
+      bool logStats;
+      while (true) {
+        bool flush = !running;
+        if (!batcher.pop(pending, objects, ticket, logStats, flush)) {
+          if (flush) break;
+          std::this_thread::yield();
+          continue;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(work(rng)));
+        batcher.waitTurn(ticket);
+        {
+          std::lock_guard<std::mutex> lock(sentMutex);
+          for (auto& obj : pending) sent.push_back(obj->mFrame->mFrameId);
+        }
+        batcher.finish(ticket);
+      }
+    });
+  }
+  for (int i = 0; i < numObjects; ++i) {
+    // 每隔几个放入一个过滤掉的数据，它们也要按顺序发送
+    batcher.push(makeObj(i % 3, i, false, i % 7 == 0));
+  }
+  while (batcher.size() > 0) std::this_thread::sleep_for(Ms(1));
+  running = false;
+  for (auto& worker : workers) worker.join();
+
+  Ids expected(numObjects);
+  for (int i = 0; i < numObjects; ++i) expected[i] = i;
+  EXPECT_EQ(sent, expected);
+}
+
+TEST(MicroBatcherTest, LogStatsEveryIntervalNonEmptyBatches) {
+  MicroBatcher batcher(1, 10000, 3);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  std::vector<bool> flags;
+  // 只有EOS的batch不计数，也不提示
+  batcher.push(makeObj(0, 100, true));
+  for (int i = 0; i < 7; ++i) batcher.push(makeObj(0, i));
+  while (batcher.pop(pending, objects, ticket, logStats, true))
+    flags.push_back(logStats);
+  EXPECT_EQ(flags, (std::vector<bool>{false, false, false, true, false, false,
+                                      true, false}));
+  EXPECT_EQ(batcher.getBatches(), 7u);
+
+  MicroBatcher silent(1, 10000);
+  silent.push(makeObj(0, 0));
+  ASSERT_TRUE(silent.pop(pending, objects, ticket, logStats, true));
+  EXPECT_FALSE(logStats);
+}
+
+TEST(MicroBatcherTest, LogStatsGivenToExactlyOneConcurrentPop) {
+  const int numWorkers = 4, numObjects = 4000, interval = 10;
+  MicroBatcher batcher(1, 0, interval);
+  for (int i = 0; i < numObjects; ++i) batcher.push(makeObj(0, i));
+  std::atomic<int> logged(0);
+  std::vector<std::thread> workers;
+  for (int w = 0; w < numWorkers; ++w) {
+    workers.emplace_back([&] {
+      common::ObjectMetadatas pending, objects;
+      std::uint64_t ticket;
+      bool logStats;
+      while (batcher.pop(pending, objects, ticket, logStats))
+        if (logStats) ++logged;
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  EXPECT_EQ(batcher.getBatches(), static_cast<std::uint64_t>(numObjects));
+  EXPECT_EQ(logged, numObjects / interval);
+}
+
+TEST(MicroBatcherTest, OccupancyCountsOnlyNonEmptyBatches) {
+  MicroBatcher batcher(4, 10000);
+  common::ObjectMetadatas pending, objects;
+  std::uint64_t ticket;
+  bool logStats;
+  EXPECT_EQ(batcher.getOccupancy(), 0.);
+  for (int i = 0; i < 6; ++i) batcher.push(makeObj(0, i));
+  batcher.push(makeObj(0, 6, true));
+  while (batcher.pop(pending, objects, ticket, logStats, true)) {
+  }
+  EXPECT_EQ(batcher.getBatches(), 2u);
+  EXPECT_EQ(batcher.getObjects(), 6u);
+  EXPECT_DOUBLE_EQ(batcher.getOccupancy(), 6. / 8.);
+}
+
+}  // namespace framework
+}  // namespace sophon_stream
@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+// Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+//
+// SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+// third-party components.
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/bmnn_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace sophon_stream {
+namespace common {
+namespace {
+
+struct FakeHandle {
+  explicit FakeHandle(int id) : id(id) {}
+  int dev_id() { return id; }
+  int id;
+};
+
+struct FakeContext {
+  FakeContext(std::shared_ptr<FakeHandle> handle, std::string file)
+      : handle(handle), file(std::move(file)) {}
+  bool warmed() const { return warmUps > 0; }
+  int warmUp() {
+    ++warmUps;
+    return failWarmUp ? -1 : 0;
+  }
+
+  std::shared_ptr<FakeHandle> handle;
+  std::string file;
+  int warmUps = 0;
+  bool failWarmUp = false;
+};
+
+/**
+ * @brief 不访问设备的loader，记录打开句柄和加载模型的次数
+ * @brief loader按值保存在表里，计数放在共享的Counters中
+ */
+struct FakeLoader {
+  using Handle = FakeHandle;
+  using Context = FakeContext;
+
+  struct Counters {
+    std::atomic<int> handles{0};
+    std::atomic<int> loads{0};
+  };
+
+  std::shared_ptr<Handle> openHandle(int dev_id) {
+    ++counters->handles;
+    return std::make_shared<Handle>(dev_id);
+  }
+  std::shared_ptr<Context> loadContext(std::shared_ptr<Handle> handle,
+                                       const std::string& file) {
+    ++counters->loads;
+    // 放大加载耗时，让并发的context调用有机会重叠
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    return std::make_shared<Context>(handle, file);
+  }
+
+  std::shared_ptr<Counters> counters = std::make_shared<Counters>();
+};
+
+using Registry = BasicModelRegistry<FakeLoader>;
+
+}  // namespace
+
+TEST(ModelRegistryTest, ReusesHandlePerDevice) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto a = registry.handle(0);
+  auto b = registry.handle(0);
+  auto c = registry.handle(1);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(c->dev_id(), 1);
+  EXPECT_EQ(loader.counters->handles, 2);
+}
+
+TEST(ModelRegistryTest, ReusesContextWhileAlive) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto handle = registry.handle(0);
+  auto a = registry.context(handle, "a.bmodel");
+  auto b = registry.context(handle, "a.bmodel");
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(loader.counters->loads, 1);
+  // 表中只保存weak_ptr，引用全部来自使用者
+  EXPECT_EQ(a.use_count(), 2);
+}
+
+TEST(ModelRegistryTest, ReloadsAfterLastRelease) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto handle = registry.handle(0);
+  std::weak_ptr<FakeContext> first = registry.context(handle, "a.bmodel");
+  EXPECT_TRUE(first.expired());
+  auto ctx = registry.context(handle, "a.bmodel");
+  EXPECT_EQ(loader.counters->loads, 2);
+
+  // 模型持有句柄，模型存活时句柄也不会重新打开
+  std::weak_ptr<FakeHandle> weakHandle = handle;
+  handle.reset();
+  EXPECT_FALSE(weakHandle.expired());
+  EXPECT_EQ(registry.handle(0), ctx->handle);
+  ctx.reset();
+  EXPECT_TRUE(weakHandle.expired());
+  registry.handle(0);
+  EXPECT_EQ(loader.counters->handles, 2);
+}
+
+TEST(ModelRegistryTest, KeysByFileAndDevice) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto dev0 = registry.handle(0);
+  auto dev1 = registry.handle(1);
+  auto a0 = registry.context(dev0, "a.bmodel");
+  auto b0 = registry.context(dev0, "b.bmodel");
+  auto a1 = registry.context(dev1, "a.bmodel");
+  EXPECT_NE(a0, b0);
+  EXPECT_NE(a0, a1);
+  EXPECT_EQ(a1->handle, dev1);
+  EXPECT_EQ(loader.counters->loads, 3);
+  EXPECT_EQ(registry.context(dev1, "a.bmodel"), a1);
+  EXPECT_EQ(loader.counters->loads, 3);
+}
+
+TEST(ModelRegistryTest, ConcurrentContextLoadsOnce) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto handle = registry.handle(0);
+  const int kThreads = 8;
+  std::vector<std::shared_ptr<FakeContext>> contexts(kThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i)
+    threads.emplace_back([&, i] {
+      contexts[i] = registry.context(registry.handle(0), "a.bmodel");
+    });
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(loader.counters->loads, 1);
+  EXPECT_EQ(loader.counters->handles, 1);
+  for (auto& ctx : contexts) EXPECT_EQ(ctx, contexts[0]);
+}
+
+TEST(ModelRegistryTest, WarmUpSkipsReleasedAndWarmedModels) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto handle = registry.handle(0);
+  auto a = registry.context(handle, "a.bmodel");
+  auto b = registry.context(handle, "b.bmodel");
+  registry.context(handle, "released.bmodel");
+  EXPECT_EQ(registry.warmUp(), 2);
+  EXPECT_EQ(a->warmUps, 1);
+  EXPECT_EQ(b->warmUps, 1);
+
+  // 后加载的graph再次预热时只处理新模型
+  auto c = registry.context(handle, "c.bmodel");
+  EXPECT_EQ(registry.warmUp(), 1);
+  EXPECT_EQ(a->warmUps, 1);
+  EXPECT_EQ(c->warmUps, 1);
+  EXPECT_EQ(registry.warmUp(), 0);
+}
+
+TEST(ModelRegistryTest, WarmUpFailureStillCounts) {
+  FakeLoader loader;
+  Registry registry(loader);
+  auto ctx = registry.context(registry.handle(0), "a.bmodel");
+  ctx->failWarmUp = true;
+  EXPECT_EQ(registry.warmUp(), 1);
+  // 与BMNNContext一致，失败也只尝试一次
+  EXPECT_EQ(registry.warmUp(), 0);
+  EXPECT_EQ(ctx->warmUps, 1);
+}
+
+}  // namespace common
+}  // namespace sophon_stream
@@ -0,0 +1,150 @@
+#===----------------------------------------------------------------------===#
+#
+# Copyright (C) 2022 Sophgo Technologies Inc.  All rights reserved.
+#
+# SOPHON-STREAM is licensed under the 2-Clause BSD License except for the
+# third-party components.
+#
+#===----------------------------------------------------------------------===#
+
+# 本地调试http_push用的接收端，同时支持JSON和BINARY格式、批量和gzip压缩。
+# BINARY格式会被解码成与JSON格式相同的字段名后打印，便于对比两种格式的结果。
+# 用法: python3 result_receiver.py --port 10002 [--save_dir ./recv]
+
+import argparse
+import base64
+import gzip
+import json
+import os
+import struct
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+BINARY_CONTENT_TYPE = 'application/x-sophon-stream-result'
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.data, self.pos)
+        self.pos += struct.calcsize('<' + fmt)
+        return values if len(values) > 1 else values[0]
+
+    def bytes(self, n):
+        value = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return value
+
+    def floats(self, n):
+        values = struct.unpack_from('<%df' % n, self.data, self.pos)
+        self.pos += 4 * n
+        return list(values)
+
+
+def decode_frame(r):
+    obj = {}
+    (channel_id, frame_id, timestamp, width, height, fps, graph_id,
+     sub_id) = r.take('iqqiifii')
+    dets = []
+    for _ in range(r.take('I')):
+        x, y, w, h, classify = r.take('iiiii')
+        dets.append({'mBox': {'mX': x, 'mY': y, 'mWidth': w, 'mHeight': h},
+                     'mClassify': classify, 'mScores': r.floats(r.take('I'))})
+    tracks = [{'mTrackId': r.take('q')} for _ in range(r.take('I'))]
+    recogs = []
+    for _ in range(r.take('I')):
+        label = r.bytes(r.take('I')).decode('utf-8', errors='replace')
+        scores = r.floats(r.take('I'))
+        k = r.take('I')
+        topk = [r.take('i') for _ in range(k)]
+        recogs.append({'mLabelName': label, 'mScores': scores, 'mTopKLabels': topk})
+    poses = [{'keypoints': r.floats(r.take('I'))} for _ in range(r.take('I'))]
+    faces = []
+    for _ in range(r.take('I')):
+        top, bottom, left, right = r.take('iiii')
+        faces.append({'top': top, 'bottom': bottom, 'left': left, 'right': right,
+                      'points_x': r.floats(5), 'points_y': r.floats(5),
+                      'score': r.take('f')})
+    jpeg = r.bytes(r.take('I'))
+
+    for key, value in (('mDetectedObjectMetadatas', dets),
+                       ('mTrackedObjectMetadatas', tracks),
+                       ('mRecognizedObjectMetadatas', recogs),
+                       ('mPosedObjectMetadatas', poses),
+                       ('mFaceObjectMetadata', faces)):
+        if value:
+            obj[key] = value
+    obj['mFps'] = fps
+    obj['mFrame'] = {'mChannelId': channel_id, 'mFrameId': frame_id,
+                     'mTimestamp': timestamp, 'mWidth': width,
+                     'mHeight': height, 'mEndOfStream': False}
+    obj['mSubId'] = sub_id
+    obj['mGraphId'] = graph_id
+    return obj, jpeg
+
+
+def decode_batch(data):
+    if data[:4] != b'SSRB':
+        raise ValueError('bad magic')
+    r = Reader(data)
+    r.pos = 4
+    version, count = r.take('HH')
+    if version != 2:
+        raise ValueError('unsupported version %d' % version)
+    frames = []
+    for _ in range(count):
+        size = r.take('I')
+        end = r.pos + size
+        frames.append(decode_frame(r))
+        # 跳过新版本追加在帧尾部的字段
+        r.pos = end
+    return frames
+
+
+class Handler(BaseHTTPRequestHandler):
+    save_dir = None
+
+    def do_POST(self):
+        body = self.rfile.read(int(self.headers.get('Content-Length', 0)))
+        if self.headers.get('Content-Encoding') == 'gzip':
+            body = gzip.decompress(body)
+        if self.headers.get('Content-Type', '').startswith(BINARY_CONTENT_TYPE):
+            results = []
+            for obj, jpeg in decode_batch(body):
+                if jpeg:
+                    if self.save_dir:
+                        name = '%d_%d.jpg' % (obj['mFrame']['mChannelId'],
+                                              obj['mFrame']['mFrameId'])
+                        with open(os.path.join(self.save_dir, name), 'wb') as f:
+                            f.write(jpeg)
+                    obj['mFrame']['mSpData'] = base64.b64encode(jpeg).decode()
+                results.append(obj)
+        else:
+            results = json.loads(body)
+            if isinstance(results, dict):
+                results = [results]
+        for obj in results:
+            summary = dict(obj)
+            if 'mSpData' in summary.get('mFrame', {}):
+                summary['mFrame'] = dict(summary['mFrame'], mSpData='<%d bytes>'
+                                         % len(summary['mFrame']['mSpData']))
+            print(json.dumps(summary))
+        print('received %d bytes, %d frames' % (len(body), len(results)))
+        self.send_response(200)
+        self.end_headers()
+
+    def log_message(self, format, *args):
+        pass
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--port', type=int, default=10002)
+    parser.add_argument('--save_dir', type=str, default='')
+    args = parser.parse_args()
+    if args.save_dir:
+        os.makedirs(args.save_dir, exist_ok=True)
+        Handler.save_dir = args.save_dir
+    ThreadingHTTPServer(('0.0.0.0', args.port), Handler).serve_forever()